@@ -0,0 +1,143 @@
+/*************************************************************************
+	clock_bench  -  Convergence of the clock synchronization against an
+					emulated Sphero whose clock drifts : offset, drift
+					estimate and error of the host timestamps given to
+					collisions, against their reception time
+							 -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+//-------------------------------------------------------- System includes
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <unistd.h>
+
+//--------------------------------------------------------- Local includes
+#include "Sphero.hpp"
+#include "bluetooth/loopback_connector.h"
+#include "packets/Toolbox.hpp"
+#include "packets/async/CollisionStruct.hpp"
+
+//-------------------------------------------------------------- Constants
+	/* Rate error of the emulated Sphero clock */
+static double const EMULATED_DRIFT_PPM = 300.0;
+
+static unsigned int const PROBE_PERIOD_MS = 100;
+
+	/* Long enough for the kept probes, one per CLOCK_FILTER_SIZE, to span
+	 * CLOCK_MIN_DRIFT_SPAN_US */
+static unsigned int const DURATION_S = 15;
+
+static unsigned int const COLLISIONS_PER_S = 4;
+
+	/* Once the drift is known, every timestamp must fall within it */
+static int64_t const MAX_ERROR_US = 2000;
+
+//-------------------------------------------------------------- Functions
+
+	//Injects a collision stamped with the current Sphero time and returns
+	//the host timestamp it was given, minus the host time of the stamping
+static int64_t collisionError(SpheroEmulator& emulator,
+		const std::atomic<uint64_t>& stamp, const std::atomic<uint32_t>& nbReported)
+{
+	CollisionStruct collision = CollisionStruct();
+	collision.threshold_axis = CollisionStruct::XAXIS;
+	collision.timestamp = emulator.getDeviceTime();
+	uint64_t stampedAt = packet_toolbox::monotonicUs();
+
+	uint32_t target = nbReported + 1;
+	emulator.injectCollision(collision);
+	while(nbReported < target)
+	{
+		usleep(1000);
+	}
+
+	return (int64_t) stamp - (int64_t) stampedAt;
+}
+
+
+int main()
+{
+	loopback_connector* connector = new loopback_connector();
+	SpheroEmulator& emulator = connector->getEmulator();
+	emulator.setClockDrift(EMULATED_DRIFT_PPM);
+
+	Sphero* sphero = new Sphero("00:00:00:00:00:00", connector);
+	if(!sphero->connect())
+	{
+		fprintf(stderr, "Emulator connection failed\n");
+		return EXIT_FAILURE;
+	}
+
+	std::atomic<uint64_t> stamp(0);
+	std::atomic<uint32_t> nbReported(0);
+	sphero->onCollision([&stamp, &nbReported](CollisionStruct* infos){
+		stamp = infos->hostTimestampUs;
+		++nbReported;
+	});
+
+		//Not synchronized : the reception time stands for the timestamp
+	int64_t unsynchronizedError = collisionError(emulator, stamp, nbReported);
+
+	sphero->startClockSync(PROBE_PERIOD_MS);
+	uint64_t start = packet_toolbox::monotonicUs();
+
+	printf("%-6s %8s %10s %12s %8s %12s\n", "t (s)", "probes", "rtt (us)",
+			"drift (ppm)", "mean", "max |error|");
+
+	bool converged = false;
+	uint64_t synchronizedAfterUs = 0;
+	int64_t worstError = 0;
+	ClockEstimate estimate = ClockEstimate();
+	for(unsigned int second = 1 ; second <= DURATION_S ; ++second)
+	{
+		int64_t sum = 0;
+		int64_t worst = 0;
+		for(unsigned int i = 0 ; i < COLLISIONS_PER_S ; ++i)
+		{
+			usleep(1000000 / COLLISIONS_PER_S);
+
+			estimate = sphero->getClockEstimate();
+			if(estimate.synchronized && synchronizedAfterUs == 0)
+			{
+				synchronizedAfterUs = estimate.updatedAtUs - start;
+			}
+
+			int64_t error = collisionError(emulator, stamp, nbReported);
+			int64_t magnitude = error < 0 ? -error : error;
+			sum += error;
+			worst = magnitude > worst ? magnitude : worst;
+		}
+
+		printf("%-6u %8u %10u %12.1f %8lld %12lld\n", second, estimate.nbSamples,
+				estimate.rttUs, estimate.driftPpm,
+				(long long) (sum / COLLISIONS_PER_S), (long long) worst);
+
+			//The error of the timestamps is judged once the drift is known
+		if(converged)
+		{
+			worstError = worst > worstError ? worst : worstError;
+		}
+		converged = estimate.driftPpm != 0;
+	}
+
+	sphero->stopClockSync();
+	sphero->disconnect();
+	delete sphero;
+
+	printf("%-28s %lld\n", "unsynchronized error (us)", (long long) unsynchronizedError);
+	printf("%-28s %.1f\n", "first estimate after (ms)", synchronizedAfterUs / 1e3);
+	printf("%-28s %.1f / %.1f\n", "drift estimated (ppm)", estimate.driftPpm,
+			EMULATED_DRIFT_PPM);
+	printf("%-28s %lld\n", "max |error| after fit (us)", (long long) worstError);
+
+	double driftError = estimate.driftPpm - EMULATED_DRIFT_PPM;
+	if(!converged || driftError < -100 || driftError > 100 || worstError > MAX_ERROR_US)
+	{
+		fprintf(stderr, "Clock synchronization did not converge\n");
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,139 @@
+/*************************************************************************
+	executor_bench  -  Time spent by the reception thread on a collision
+					   frame when the listener blocks, with the callbacks
+					   inline, on the Sphero executor (drop-oldest and
+					   block) and on a pool shared by two Spheros
+							 -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+//-------------------------------------------------------- System includes
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include <unistd.h>
+
+//--------------------------------------------------------- Local includes
+#include "Sphero.hpp"
+#include "CallbackExecutor.hpp"
+#include "bluetooth/loopback_connector.h"
+#include "packets/PacketFramer.hpp"
+#include "packets/SpheroAsyncPacket.hpp"
+#include "packets/Toolbox.hpp"
+
+//-------------------------------------------------------------- Constants
+static size_t const NB_FRAMES = 2000;
+
+	/* Time taken by the listener, like a blocking send() */
+static unsigned int const LISTENER_US = 200;
+
+static size_t const QUEUE_CAPACITY = 64;
+
+//------------------------------------------------------------------ Types
+
+struct scenario
+{
+	const char* name;
+	dispatchPolicy policy;
+	overflowPolicy overflow;
+};
+
+//-------------------------------------------------------------- Functions
+
+static double seconds()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+	//Builds a collision frame, checksum included
+static size_t collisionFrame(uint8_t* frame)
+{
+	uint8_t data[16] = {0, 10, 0, 20, 0, 30, 1, 0, 40, 0, 50, 60, 0, 0, 1, 0};
+
+	frame[0] = START_OF_PACKET_FLAG;
+	frame[1] = ASYNC_FLAG;
+	frame[2] = COLLISION_DETECTED;
+	frame[3] = 0;
+	frame[4] = sizeof(data) + 1;
+	memcpy(frame + FRAME_HEADER_SIZE, data, sizeof(data));
+	frame[FRAME_HEADER_SIZE + sizeof(data)] =
+		packet_toolbox::checksum(frame + 2, sizeof(data) + 3);
+	return FRAME_HEADER_SIZE + sizeof(data) + 1;
+}
+
+
+int main()
+{
+	uint8_t frame[64];
+	size_t frameSize = collisionFrame(frame);
+
+	scenario scenarios[] = {
+		{"inline", dispatchPolicy::INLINE, overflowPolicy::DROP_OLDEST},
+		{"robot, drop oldest", dispatchPolicy::ROBOT_EXECUTOR,
+			overflowPolicy::DROP_OLDEST},
+		{"robot, block", dispatchPolicy::ROBOT_EXECUTOR, overflowPolicy::BLOCK},
+		{"shared x2, drop oldest", dispatchPolicy::SHARED_EXECUTOR,
+			overflowPolicy::DROP_OLDEST}
+	};
+
+	printf("%-24s %10s %10s %10s %10s %10s %10s\n", "dispatch", "p50 ns",
+			"p99 ns", "max ns", "run", "dropped", "blocked");
+	for(const scenario& s : scenarios)
+	{
+		CallbackExecutor pool(2, QUEUE_CAPACITY, s.overflow);
+		Sphero* spheros[2];
+		std::atomic<size_t> calls(0);
+		for(Sphero*& sphero : spheros)
+		{
+			sphero = new Sphero("00:00:00:00:00:00", new loopback_connector());
+			sphero->configureRobotExecutor(QUEUE_CAPACITY, s.overflow);
+			sphero->setSharedExecutor(&pool);
+			sphero->setDispatchPolicy(eventKind::COLLISION, s.policy);
+			sphero->onCollision([&calls](CollisionStruct*){
+				usleep(LISTENER_US);
+				++calls;
+			});
+		}
+
+		std::vector<double> latencies(NB_FRAMES);
+		for(size_t i = 0 ; i < NB_FRAMES ; ++i)
+		{
+			double start = seconds();
+			spheros[i % 2]->dispatchFrame(frame, frameSize);
+			latencies[i] = (seconds() - start) * 1e9;
+		}
+		std::sort(latencies.begin(), latencies.end());
+
+		ExecutorStats stats = pool.getStats();
+		for(Sphero* sphero : spheros)
+		{
+			ExecutorStats own = sphero->getRobotExecutorStats();
+			stats.blocked += own.blocked;
+			stats.dropped += own.dropped;
+			delete sphero;
+		}
+
+		printf("%-24s %10.0f %10.0f %10.0f %10zu %10llu %10llu\n", s.name,
+				latencies[NB_FRAMES / 2], latencies[NB_FRAMES * 99 / 100],
+				latencies.back(), (size_t) calls,
+				(unsigned long long) stats.dropped,
+				(unsigned long long) stats.blocked);
+
+			//Every event is either run or counted as dropped
+		if(calls + stats.dropped != NB_FRAMES)
+		{
+			fprintf(stderr, "%zu events lost\n",
+					NB_FRAMES - (size_t) calls - (size_t) stats.dropped);
+			return EXIT_FAILURE;
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
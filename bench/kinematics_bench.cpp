@@ -0,0 +1,180 @@
+/*************************************************************************
+	kinematics_bench  -  Reader throughput of the kinematic snapshot while
+						 the reception thread publishes at 400 Hz, against
+						 the same values behind a mutex
+							 -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+//-------------------------------------------------------- System includes
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+#include <unistd.h>
+
+//--------------------------------------------------------- Local includes
+#include "packets/async/KinematicState.hpp"
+
+//-------------------------------------------------------------- Constants
+static unsigned int const WRITER_PERIOD_US = 2500;
+static double const RUN_SECONDS = 1.0;
+static unsigned int const MAX_READERS = 4;
+
+//------------------------------------------------------------------ Types
+
+/*
+ * The former layout : one field per value, here behind a mutex so that
+ * the comparison is with a correct reader
+ */
+struct lockedKinematics
+{
+	pthread_mutex_t lock;
+	KinematicSnapshot values;
+
+	lockedKinematics()
+	{
+		pthread_mutex_init(&lock, NULL);
+		values = KinematicSnapshot();
+	}
+
+	void publish(const KinematicSnapshot& snapshot)
+	{
+		pthread_mutex_lock(&lock);
+		uint64_t seq = values.seq + 1;
+		values = snapshot;
+		values.seq = seq;
+		pthread_mutex_unlock(&lock);
+	}
+
+	KinematicSnapshot read()
+	{
+		pthread_mutex_lock(&lock);
+		KinematicSnapshot snapshot = values;
+		pthread_mutex_unlock(&lock);
+		return snapshot;
+	}
+};
+
+struct result_t
+{
+	double readsPerSecond;
+	unsigned long long torn;
+	unsigned long long published;
+};
+
+//-------------------------------------------------------------- Functions
+
+static double seconds()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+	//Every value is derived from i, so that a reader can check them
+static KinematicSnapshot frame(uint64_t i)
+{
+	KinematicSnapshot snapshot;
+	snapshot.x = (int16_t) i;
+	snapshot.y = (int16_t) -i;
+	snapshot.speedX = (int16_t) (i * 3);
+	snapshot.speedY = (int16_t) (i * 5);
+	snapshot.normalisedSpeed = (uint16_t) (i * 7);
+	snapshot.timestampUs = i;
+	snapshot.seq = 0;
+	return snapshot;
+}
+
+
+static bool consistent(const KinematicSnapshot& snapshot)
+{
+	uint64_t i = snapshot.timestampUs;
+	return snapshot.x == (int16_t) i && snapshot.y == (int16_t) -i
+		&& snapshot.speedX == (int16_t) (i * 3)
+		&& snapshot.speedY == (int16_t) (i * 5)
+		&& snapshot.normalisedSpeed == (uint16_t) (i * 7)
+		&& snapshot.seq == i;
+}
+
+
+template<typename State>
+static result_t run(State& state, unsigned int nbReaders, unsigned int periodUs)
+{
+	std::atomic<bool> stop(false);
+	std::atomic<unsigned long long> reads(0);
+	std::atomic<unsigned long long> torn(0);
+	unsigned long long published = 0;
+
+	std::vector<std::thread> readers;
+	for(unsigned int r = 0 ; r < nbReaders ; ++r)
+	{
+		readers.push_back(std::thread([&]{
+			unsigned long long localReads = 0;
+			unsigned long long localTorn = 0;
+			while(!stop.load(std::memory_order_relaxed))
+			{
+				if(!consistent(state.read()))
+				{
+					++localTorn;
+				}
+				++localReads;
+			}
+			reads += localReads;
+			torn += localTorn;
+		}));
+	}
+
+	double start = seconds();
+	while(seconds() - start < RUN_SECONDS)
+	{
+		state.publish(frame(++published));
+		if(periodUs != 0)
+		{
+			usleep(periodUs);
+		}
+	}
+	stop = true;
+
+	for(std::thread& reader : readers)
+	{
+		reader.join();
+	}
+
+	result_t result;
+	result.readsPerSecond = reads / RUN_SECONDS / nbReaders;
+	result.torn = torn;
+	result.published = published;
+	return result;
+}
+
+
+int main()
+{
+	printf("%-8s %-10s %-18s %-18s %-8s\n", "readers", "writer",
+			"seqlock reads/s", "mutex reads/s", "torn");
+
+	unsigned int const periods[] = {WRITER_PERIOD_US, 0};
+	for(unsigned int periodUs : periods)
+	{
+		for(unsigned int nbReaders = 1 ; nbReaders <= MAX_READERS ; nbReaders *= 2)
+		{
+			KinematicState seqlock;
+			lockedKinematics locked;
+
+			result_t lockFree = run(seqlock, nbReaders, periodUs);
+			result_t mutex = run(locked, nbReaders, periodUs);
+
+			printf("%-8u %-10s %-18.3e %-18.3e %-8llu\n", nbReaders,
+					periodUs == 0 ? "unpaced" : "400 Hz",
+					lockFree.readsPerSecond, mutex.readsPerSecond,
+					lockFree.torn + mutex.torn);
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
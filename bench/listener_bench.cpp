@@ -0,0 +1,179 @@
+/*************************************************************************
+	listener_bench  -  Cost of reportAction from 1 to 100 listeners, with
+					   the copy-on-write array against the former
+					   std::list (bare and behind a mutex), and reports while another thread keeps
+					   subscribing and unsubscribing
+							 -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+//-------------------------------------------------------- System includes
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <atomic>
+#include <functional>
+#include <list>
+#include <thread>
+#include <pthread.h>
+
+//--------------------------------------------------------- Local includes
+#include "ActionHandler.hpp"
+
+//-------------------------------------------------------------- Constants
+static size_t const LISTENERS[] = {1, 2, 4, 8, 16, 32, 64, 100};
+static size_t const NB_LISTENED_CALLS = 20000000;
+static size_t const NB_CHURN_REPORTS = 2000000;
+
+//------------------------------------------------------------------ Types
+
+/*
+ * The former handler : a list walked by the reports and modified, without
+ * lock, by the registrations. Only correct from a single thread
+ */
+struct listHandler
+{
+	std::list<std::function<void(uint32_t)>> listeners;
+
+	void addActionListener(std::function<void(uint32_t)> listener)
+	{
+		listeners.push_front(listener);
+	}
+
+	void reportAction(uint32_t value)
+	{
+		for(auto it = listeners.begin() ; it != listeners.end() ; it++)
+		{
+			(*it)(value);
+		}
+	}
+};
+
+/*
+ * The former handler made correct : the same list behind a mutex
+ */
+struct lockedListHandler : listHandler
+{
+	pthread_mutex_t lock;
+
+	lockedListHandler()
+	{
+		pthread_mutex_init(&lock, NULL);
+	}
+
+	~lockedListHandler()
+	{
+		pthread_mutex_destroy(&lock);
+	}
+
+	void addActionListener(std::function<void(uint32_t)> listener)
+	{
+		pthread_mutex_lock(&lock);
+		listHandler::addActionListener(listener);
+		pthread_mutex_unlock(&lock);
+	}
+
+	void reportAction(uint32_t value)
+	{
+		pthread_mutex_lock(&lock);
+		listHandler::reportAction(value);
+		pthread_mutex_unlock(&lock);
+	}
+};
+
+//-------------------------------------------------------------- Functions
+
+static double seconds()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+	//Registers count listeners, then gives the mean cost of a report. The
+	//number of reports keeps the number of listener calls constant
+template<typename Handler>
+static double nsPerReport(size_t count, uint64_t& sink)
+{
+	Handler handler;
+	uint64_t total = 0;
+	for(size_t i = 0 ; i < count ; ++i)
+	{
+		handler.addActionListener([&total](uint32_t value){
+			total += value;
+		});
+	}
+
+	size_t nbReports = NB_LISTENED_CALLS / count;
+	double start = seconds();
+	for(size_t i = 0 ; i < nbReports ; ++i)
+	{
+		handler.reportAction(i);
+	}
+	double elapsed = seconds() - start;
+	sink += total;
+	return elapsed * 1e9 / nbReports;
+}
+
+
+int main()
+{
+	uint64_t sink = 0;
+
+	printf("%-10s %16s %16s %16s\n", "listeners", "list ns/report",
+			"locked ns/report", "array ns/report");
+	for(size_t count : LISTENERS)
+	{
+		double listNs = nsPerReport<listHandler>(count, sink);
+		double lockedNs = nsPerReport<lockedListHandler>(count, sink);
+		double arrayNs = nsPerReport<ActionHandler<uint32_t>>(count, sink);
+		printf("%-10zu %16.1f %16.1f %16.1f\n", count, listNs, lockedNs,
+				arrayNs);
+	}
+
+		//Reports while the listeners change : the permanent listener must
+		//see every report, the temporary ones at most every report
+	ActionHandler<uint32_t> handler;
+	std::atomic<size_t> permanentCalls(0);
+	std::atomic<size_t> temporaryCalls(0);
+	handler.addActionListener([&permanentCalls](uint32_t){
+		permanentCalls.fetch_add(1, std::memory_order_relaxed);
+	});
+
+	std::atomic<bool> reporting(true);
+	size_t nbChanges = 0;
+	std::thread churn([&]{
+		while(reporting.load(std::memory_order_relaxed))
+		{
+			listenerToken_t token = handler.addActionListener(
+					[&temporaryCalls](uint32_t){
+						temporaryCalls.fetch_add(1, std::memory_order_relaxed);
+					});
+			handler.removeActionListener(token);
+			++nbChanges;
+		}
+	});
+
+	double start = seconds();
+	for(size_t i = 0 ; i < NB_CHURN_REPORTS ; ++i)
+	{
+		handler.reportAction(i);
+	}
+	double elapsed = seconds() - start;
+	reporting = false;
+	churn.join();
+
+	printf("%-28s %.1f\n", "ns/report (with churn)",
+			elapsed * 1e9 / NB_CHURN_REPORTS);
+	printf("%-28s %zu\n", "subscribe+unsubscribe", nbChanges);
+
+	if(permanentCalls != NB_CHURN_REPORTS || temporaryCalls > NB_CHURN_REPORTS)
+	{
+		fprintf(stderr, "Lost or duplicated reports : %zu / %zu\n",
+				(size_t) permanentCalls, (size_t) NB_CHURN_REPORTS);
+		return EXIT_FAILURE;
+	}
+
+	return sink == 0xFFFFFFFF ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,211 @@
+/*************************************************************************
+	motion_bench  -  Drives the emulated Sphero around a course with the
+					 closed-loop MotionController and with the former
+					 blocking rollToPosition loop : convergence time,
+					 final error and roll commands per meter, at two
+					 streaming rates, with and without a heading error
+							 -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+//-------------------------------------------------------- System includes
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <unistd.h>
+
+//--------------------------------------------------------- Local includes
+#include "Sphero.hpp"
+#include "bluetooth/loopback_connector.h"
+#include "packets/Toolbox.hpp"
+
+//-------------------------------------------------------------- Constants
+
+	/* Targets visited in turn, in cm, from the origin */
+static int16_t const COURSE[][2] = {
+	{0, 100}, {100, 100}, {150, -50}, {0, 0}
+};
+static size_t const COURSE_LENGTH = sizeof(COURSE) / sizeof(COURSE[0]);
+
+	/* Streaming rates, in Hz (80 is the rate set on connection) */
+static uint16_t const RATES[] = {80, 10};
+
+	/* Heading errors of the emulated ball, in degrees */
+static int16_t const HEADING_ERRORS[] = {0, 10};
+
+	/* Time given to the ball to stop before measuring the final error */
+static unsigned int const SETTLE_US = 500000;
+
+	/* The former loop is stopped after this long, in µs */
+static uint64_t const LEGACY_TIMEOUT_US = 20000000;
+
+//------------------------------------------------------------------ Types
+
+struct tour_t
+{
+	double seconds;
+	double distanceM;
+	double meanErrorCm;
+	double maxErrorCm;
+	uint64_t rolls;
+	size_t reached;
+};
+
+//-------------------------------------------------------------- Functions
+
+	//rollToPosition before the MotionController : a roll pulse every
+	//24 ms, whatever the streaming rate
+static void legacyRollToPosition(Sphero* sphero, int16_t x, int16_t y,
+		uint8_t initSpeed)
+{
+	int16_t actualX, actualY;
+	uint8_t speed = initSpeed;
+	KinematicSnapshot state = sphero->getKinematics();
+	actualX = state.x;
+	actualY = state.y;
+
+	unsigned int sleeptime = 3000;
+	int angle = 0;
+	size_t nbPoints = 0;
+	int i = 0;
+	uint64_t start = packet_toolbox::monotonicUs();
+
+	while((abs(actualX - x) > 2 || abs(actualY - y) > 2 || speed > 35)
+			&& packet_toolbox::monotonicUs() < start + LEGACY_TIMEOUT_US)
+	{
+		if(i <= 6)
+			speed = 60;
+		else
+			speed = std::min(20 + std::max(abs(actualX - x), abs(actualY - y)), 100);
+		i++;
+
+		angle = ((int) (atan2(x - actualX, y - actualY)
+					* 180.0 / 3.14159268) + 360) % 360;
+
+		sphero->roll(speed, angle);
+		usleep(5 * sleeptime);
+		sphero->roll(0, angle);
+
+		state = sphero->getKinematics();
+		if(abs(state.speedX) < 10 && abs(state.speedY) < 10)
+		{
+			if(nbPoints++ > 40)
+			{
+				sphero->roll(0, angle);
+				return;
+			}
+		}
+		else
+		{
+			nbPoints = 0;
+		}
+
+		usleep(3 * sleeptime);
+
+		state = sphero->getKinematics();
+		actualX = state.x;
+		actualY = state.y;
+	}
+	sphero->roll(0, angle);
+}
+
+
+	//Visits the course, with the controller or the former loop
+static tour_t drive(bool legacy, uint16_t rate, int16_t headingError)
+{
+	loopback_connector* connector = new loopback_connector();
+	SpheroEmulator& emulator = connector->getEmulator();
+	emulator.setHeadingError(headingError);
+
+	Sphero* sphero = new Sphero("00:00:00:00:00:00", connector);
+	if(!sphero->connect())
+	{
+		fprintf(stderr, "Emulator connection failed\n");
+		exit(EXIT_FAILURE);
+	}
+	sphero->setDataStreaming(rate, 1, 0, 0, mask2::ODOMETER_X
+			| mask2::ODOMETER_Y | mask2::ACCELONE_0 | mask2::VELOCITY_X
+			| mask2::VELOCITY_Y);
+	usleep(SETTLE_US);
+
+	tour_t tour = tour_t();
+	uint64_t rollsBefore = emulator.getStats().rolls;
+	uint64_t drivenUs = 0;
+	int16_t fromX = 0, fromY = 0;
+
+	for(size_t i = 0 ; i < COURSE_LENGTH ; ++i)
+	{
+		int16_t x = COURSE[i][0];
+		int16_t y = COURSE[i][1];
+
+		uint64_t start = packet_toolbox::monotonicUs();
+		if(legacy)
+		{
+			legacyRollToPosition(sphero, x, y, 90);
+		}
+		else
+		{
+			MotionResult result = sphero->moveTo(x, y).get();
+			tour.reached += result.outcome == motionOutcome::REACHED ? 1 : 0;
+		}
+		drivenUs += packet_toolbox::monotonicUs() - start;
+
+		usleep(SETTLE_US);
+		KinematicSnapshot state = sphero->getKinematics();
+		double error = hypot(x - state.x, y - state.y);
+		tour.meanErrorCm += error / COURSE_LENGTH;
+		tour.maxErrorCm = std::max(tour.maxErrorCm, error);
+		tour.distanceM += hypot(x - fromX, y - fromY) / 100;
+		fromX = x;
+		fromY = y;
+	}
+
+	tour.seconds = drivenUs / 1e6;
+	tour.rolls = emulator.getStats().rolls - rollsBefore;
+
+	sphero->disconnect();
+	delete sphero;
+
+	return tour;
+}
+
+
+int main()
+{
+	printf("%-11s %8s %8s %9s %10s %10s %8s %11s %8s\n", "driver",
+			"stream", "yaw err", "time (s)", "mean (cm)", "max (cm)",
+			"rolls", "rolls/m", "reached");
+
+	bool regression = false;
+	for(uint16_t rate : RATES)
+	{
+		for(int16_t headingError : HEADING_ERRORS)
+		{
+			tour_t before = drive(true, rate, headingError);
+			tour_t after = drive(false, rate, headingError);
+
+			printf("%-11s %6u Hz %8d %9.2f %10.1f %10.1f %8llu %11.1f %8s\n",
+					"legacy", rate, headingError, before.seconds,
+					before.meanErrorCm, before.maxErrorCm,
+					(unsigned long long) before.rolls,
+					before.rolls / before.distanceM, "-");
+			printf("%-11s %6u Hz %8d %9.2f %10.1f %10.1f %8llu %11.1f %5zu/%zu\n",
+					"controller", rate, headingError, after.seconds,
+					after.meanErrorCm, after.maxErrorCm,
+					(unsigned long long) after.rolls,
+					after.rolls / after.distanceM, after.reached, COURSE_LENGTH);
+
+			regression |= after.reached != COURSE_LENGTH
+				|| after.rolls >= before.rolls;
+		}
+	}
+
+	if(regression)
+	{
+		fprintf(stderr, "Motion controller regression\n");
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,342 @@
+/*************************************************************************
+	packet_bench  -  Cost of building client packets, and heap
+					 allocations done by a roll() command, by the
+					 reception of streaming and collision packets and by
+					 getColor() queries
+							 -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+//-------------------------------------------------------- System includes
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <atomic>
+#include <new>
+#include <thread>
+#include <unistd.h>
+#include <sys/socket.h>
+
+//--------------------------------------------------------- Local includes
+#include "Sphero.hpp"
+#include "bluetooth/loopback_connector.h"
+#include "packets/Commands.hpp"
+#include "packets/PacketFramer.hpp"
+#include "packets/SpheroAsyncPacket.hpp"
+#include "packets/Toolbox.hpp"
+#include "packets/async/CollisionStruct.hpp"
+
+//-------------------------------------------------------------- Constants
+static size_t const NB_PACKETS = 10000000;
+static size_t const NB_ROLLS = 100000;
+static size_t const NB_RECEIVED = 20000;
+static size_t const NB_QUERIES = 200;
+
+	/* Between two queries : a few per wheel tick, as an application would */
+static unsigned int const QUERY_PERIOD_US = 2000;
+
+//------------------------------------------------------------------ Types
+
+/*
+ * Connector faking a Sphero with one end of a socketpair
+ */
+class socketpair_connector : public bluetooth_connector
+{
+	public:
+		socketpair_connector():_peer(-1), _socket(-1)
+		{}
+
+		virtual int connection(const char*)
+		{
+			int sv[2];
+			if(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == -1)
+			{
+				return -1;
+			}
+			_socket = sv[0];
+			_peer = sv[1];
+			return _socket;
+		}
+
+		virtual int disconnect(void)
+		{
+			shutdown(_peer, SHUT_RDWR);
+			return close(_socket);
+		}
+
+		virtual bool isConnected(void)
+		{
+			return _socket != -1;
+		}
+
+		int getPeer()
+		{
+			return _peer;
+		}
+
+	private:
+		int _peer;
+		int _socket;
+};
+
+//------------------------------------------------------ Allocation counter
+
+static std::atomic<size_t> nbAllocations(0);
+
+	//The replaced operators pair malloc and free on purpose
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void* operator new(size_t size)
+{
+	++nbAllocations;
+	void* ptr = malloc(size == 0 ? 1 : size);
+	if(ptr == NULL)
+	{
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+	free(ptr);
+}
+
+//-------------------------------------------------------------- Functions
+
+static double seconds()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+	//Builds an asynchronous frame, checksum included
+static size_t asyncFrame(uint8_t* frame, uint8_t id, const uint8_t* data,
+		size_t length)
+{
+	frame[0] = START_OF_PACKET_FLAG;
+	frame[1] = ASYNC_FLAG;
+	frame[2] = id;
+	frame[3] = (length + 1) >> 8;
+	frame[4] = (length + 1);
+	memcpy(frame + FRAME_HEADER_SIZE, data, length);
+	frame[FRAME_HEADER_SIZE + length] =
+		packet_toolbox::checksum(frame + 2, length + 3);
+	return FRAME_HEADER_SIZE + length + 1;
+}
+
+
+	//Sends count streaming and collision frames, in turn, to the monitor
+	//thread and waits until every one was reported
+static void receive(int peer, size_t count, const std::atomic<size_t>& reported)
+{
+	uint8_t data[4 * 2 * 2];
+	uint8_t streaming[64];
+	uint8_t collision[64];
+	uint8_t collisionData[16] = {0, 10, 0, 20, 0, 30, 1, 0, 40, 0, 50, 60,
+		0, 0, 1, 0};
+
+	for(size_t i = 0 ; i < sizeof(data) ; ++i)
+	{
+		data[i] = i;
+	}
+	size_t streamingSize = asyncFrame(streaming, SENSOR_DATA_STREAMING,
+			data, sizeof(data));
+	size_t collisionSize = asyncFrame(collision, COLLISION_DETECTED,
+			collisionData, sizeof(collisionData));
+
+	size_t target = reported + count;
+	for(size_t i = 0 ; i < count ; ++i)
+	{
+		if(i % 2 == 0)
+		{
+			send(peer, streaming, streamingSize, MSG_NOSIGNAL);
+		}
+		else
+		{
+			send(peer, collision, collisionSize, MSG_NOSIGNAL);
+		}
+	}
+
+	while(reported < target)
+	{
+		usleep(1000);
+	}
+}
+
+
+int main()
+{
+		//Packet construction alone
+	uint8_t payload[4] = {80, 0, 90, 1};
+	uint32_t sink = 0;
+
+	size_t allocationsBefore = nbAllocations;
+	double start = seconds();
+	for(size_t i = 0 ; i < NB_PACKETS ; ++i)
+	{
+		payload[2] = i;
+		ClientCommandPacket packet(DID::sphero, CID::roll, 0, 0x05, payload);
+		sink += packet.toByteArray()[packet.getSize() - 1];
+	}
+	double elapsed = seconds() - start;
+	size_t packetAllocations = nbAllocations - allocationsBefore;
+
+	printf("%-28s %.2f\n", "ns/packet", elapsed * 1e9 / NB_PACKETS);
+	printf("%-28s %.3f\n", "allocations/packet",
+			(double) packetAllocations / NB_PACKETS);
+
+		//Same packet, from its compile-time descriptor
+	uint8_t buffer[command::roll::size];
+
+	allocationsBefore = nbAllocations;
+	start = seconds();
+	for(size_t i = 0 ; i < NB_PACKETS ; ++i)
+	{
+		command::roll::serialize(buffer, 0, false, false, 80, i, 1);
+		sink += buffer[command::roll::size - 1];
+	}
+	elapsed = seconds() - start;
+	packetAllocations = nbAllocations - allocationsBefore;
+
+	printf("%-28s %.2f\n", "ns/packet (descriptor)", elapsed * 1e9 / NB_PACKETS);
+	printf("%-28s %.3f\n", "allocations/packet (desc.)",
+			(double) packetAllocations / NB_PACKETS);
+
+		//Whole roll() path, up to the outbound queue
+	socketpair_connector* connector = new socketpair_connector();
+	Sphero* sphero = new Sphero("00:00:00:00:00:00", connector);
+	if(!sphero->connect())
+	{
+		fprintf(stderr, "Simulated connection failed\n");
+		return EXIT_FAILURE;
+	}
+
+	int peer = connector->getPeer();
+	std::thread drain([peer]{
+		uint8_t buffer[4096];
+		while(read(peer, buffer, sizeof(buffer)) > 0)
+		{ }
+	});
+
+		//Warm up : lets the queues reach their steady capacity
+	for(size_t i = 0 ; i < NB_ROLLS ; ++i)
+	{
+		sphero->roll(80, i % 360);
+	}
+
+	allocationsBefore = nbAllocations;
+	start = seconds();
+	for(size_t i = 0 ; i < NB_ROLLS ; ++i)
+	{
+		sphero->roll(80, i % 360);
+	}
+	elapsed = seconds() - start;
+	size_t rollAllocations = nbAllocations - allocationsBefore;
+
+	printf("%-28s %.2f\n", "ns/roll()", elapsed * 1e9 / NB_ROLLS);
+	printf("%-28s %.3f\n", "allocations/roll()",
+			(double) rollAllocations / NB_ROLLS);
+
+	sphero->disconnect();
+	close(peer);
+	drain.join();
+	delete sphero;
+
+		//Reception path : streaming (odometer and velocity, 2 frames per
+		//packet) and collisions, decoded and reported by the monitor thread
+	connector = new socketpair_connector();
+	sphero = new Sphero("00:00:00:00:00:00", connector);
+	if(!sphero->connect())
+	{
+		fprintf(stderr, "Simulated connection failed\n");
+		return EXIT_FAILURE;
+	}
+	sphero->updateParameters(2, 0, mask2::ODOMETER_X | mask2::ODOMETER_Y
+			| mask2::VELOCITY_X | mask2::VELOCITY_Y);
+
+	std::atomic<size_t> reported(0);
+	std::atomic<uint32_t> collisionSpeed(0);
+	sphero->onData([&reported]{
+		++reported;
+	});
+	sphero->onCollision([&reported, &collisionSpeed](CollisionStruct* infos){
+		collisionSpeed += infos->speed;
+		++reported;
+	});
+
+	peer = connector->getPeer();
+	receive(peer, NB_RECEIVED, reported);
+
+	allocationsBefore = nbAllocations;
+	start = seconds();
+	receive(peer, NB_RECEIVED, reported);
+	elapsed = seconds() - start;
+	size_t receiveAllocations = nbAllocations - allocationsBefore;
+
+	printf("%-28s %.2f\n", "ns/received packet", elapsed * 1e9 / NB_RECEIVED);
+	printf("%-28s %.3f\n", "allocations/received packet",
+			(double) receiveAllocations / NB_RECEIVED);
+
+	sphero->disconnect();
+	close(peer);
+	delete sphero;
+	sink += collisionSpeed;
+
+		//Answered queries, decoded into a caller-owned structure
+	sphero = new Sphero("00:00:00:00:00:00", new loopback_connector());
+	if(!sphero->connect())
+	{
+		fprintf(stderr, "Emulator connection failed\n");
+		return EXIT_FAILURE;
+	}
+	sphero->setColor(10, 20, 30);
+
+	ColorStruct color;
+	size_t nbAnswered = 0;
+	for(size_t i = 0 ; i < NB_QUERIES ; ++i)
+	{
+		sphero->getColor(color);
+		usleep(QUERY_PERIOD_US);
+	}
+
+	allocationsBefore = nbAllocations;
+	for(size_t i = 0 ; i < NB_QUERIES ; ++i)
+	{
+		nbAnswered += sphero->getColor(color) ? 1 : 0;
+		usleep(QUERY_PERIOD_US);
+	}
+	size_t queryAllocations = nbAllocations - allocationsBefore;
+
+	printf("%-28s %.3f\n", "allocations/getColor()",
+			(double) queryAllocations / NB_QUERIES);
+
+	sphero->disconnect();
+	delete sphero;
+	sink += color.blue;
+
+		//Steady-state reception must not touch the heap
+	if(receiveAllocations != 0)
+	{
+		fprintf(stderr, "Reception allocated %zu times\n", receiveAllocations);
+		return EXIT_FAILURE;
+	}
+
+		//Nor a query, answered or not
+	if(nbAnswered != NB_QUERIES || queryAllocations != 0)
+	{
+		fprintf(stderr, "%zu answers, %zu allocations\n", nbAnswered,
+				queryAllocations);
+		return EXIT_FAILURE;
+	}
+
+	return sink == 0xFFFFFFFF ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,213 @@
+/*************************************************************************
+	path_bench  -  Drives the emulated Sphero through waypoints with
+				   followPath (blended polyline, spline) and with chained
+				   rollToPosition calls : total path time, roll commands,
+				   largest distance to the polyline and final error
+							 -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+//-------------------------------------------------------- System includes
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+//--------------------------------------------------------- Local includes
+#include "Sphero.hpp"
+#include "bluetooth/loopback_connector.h"
+#include "packets/Toolbox.hpp"
+
+//-------------------------------------------------------------- Constants
+
+	/* Waypoints, in cm, from the origin : a zigzag then a square */
+static Waypoint const COURSE[] = {
+	{0, 80}, {60, 140}, {0, 200}, {60, 260}, {160, 260}, {160, 160},
+	{60, 160}, {60, 60}, {0, 0}
+};
+static size_t const COURSE_LENGTH = sizeof(COURSE) / sizeof(COURSE[0]);
+
+	/* Streaming rates, in Hz (80 is the rate set on connection) */
+static uint16_t const RATES[] = {80, 10};
+
+	/* Position sampling period of the deviation tracker */
+static unsigned int const TRACK_PERIOD_US = 10000;
+
+	/* Time given to the ball to stop before measuring the final error */
+static unsigned int const SETTLE_US = 500000;
+
+//------------------------------------------------------------------ Types
+
+enum driver_t
+{
+	CHAINED,
+	POLYLINE,
+	SPLINE,
+	NB_DRIVERS
+};
+
+static const char* const DRIVER_NAMES[NB_DRIVERS] = {
+	"rollToPosition", "polyline", "spline"
+};
+
+struct run_t
+{
+	double seconds;
+	double plannedSeconds;
+	uint64_t rolls;
+	double maxDeviationCm;
+	double finalErrorCm;
+	bool reached;
+};
+
+//-------------------------------------------------------------- Functions
+
+	//Distance from a point to the polyline through the course
+static double deviation(double x, double y)
+{
+	double best = -1;
+	double fromX = 0, fromY = 0;
+
+	for(size_t i = 0 ; i < COURSE_LENGTH ; ++i)
+	{
+		double toX = COURSE[i].x;
+		double toY = COURSE[i].y;
+		double length2 = (toX - fromX) * (toX - fromX) + (toY - fromY) * (toY - fromY);
+		double u = ((x - fromX) * (toX - fromX) + (y - fromY) * (toY - fromY)) / length2;
+		u = u < 0 ? 0 : (u > 1 ? 1 : u);
+
+		double distance = hypot(fromX + (toX - fromX) * u - x, fromY + (toY - fromY) * u - y);
+		best = (best < 0 || distance < best) ? distance : best;
+
+		fromX = toX;
+		fromY = toY;
+	}
+
+	return best;
+}
+
+
+static run_t drive(driver_t driver, uint16_t rate)
+{
+	loopback_connector* connector = new loopback_connector();
+	SpheroEmulator& emulator = connector->getEmulator();
+
+	Sphero* sphero = new Sphero("00:00:00:00:00:00", connector);
+	if(!sphero->connect())
+	{
+		fprintf(stderr, "Emulator connection failed\n");
+		exit(EXIT_FAILURE);
+	}
+	sphero->setDataStreaming(rate, 1, 0, 0, mask2::ODOMETER_X
+			| mask2::ODOMETER_Y | mask2::ACCELONE_0 | mask2::VELOCITY_X
+			| mask2::VELOCITY_Y);
+	usleep(SETTLE_US);
+
+		//Largest distance to the polyline, sampled while driving
+	std::atomic<bool> driving(true);
+	std::atomic<uint32_t> maxDeviation(0);
+	std::thread tracker([&]{
+		while(driving)
+		{
+			KinematicSnapshot state = sphero->getKinematics();
+			uint32_t mm = (uint32_t) (deviation(state.x, state.y) * 10);
+			if(mm > maxDeviation)
+			{
+				maxDeviation = mm;
+			}
+			usleep(TRACK_PERIOD_US);
+		}
+	});
+
+	std::vector<Waypoint> waypoints(COURSE, COURSE + COURSE_LENGTH);
+	run_t run = run_t();
+	uint64_t rollsBefore = emulator.getStats().rolls;
+	uint64_t start = packet_toolbox::monotonicUs();
+
+	if(driver == CHAINED)
+	{
+		run.reached = true;
+		for(const Waypoint& waypoint : waypoints)
+		{
+			sphero->rollToPosition(waypoint.x, waypoint.y);
+		}
+	}
+	else
+	{
+		pathShape shape = driver == SPLINE ? pathShape::SPLINE : pathShape::POLYLINE;
+		Trajectory planned;
+		Waypoint origin = {0, 0};
+		planned.plan(origin, waypoints, shape, TrajectoryLimits());
+		run.plannedSeconds = planned.getDuration();
+
+		MotionResult result = sphero->followPath(waypoints, shape).get();
+		run.reached = result.outcome == motionOutcome::REACHED;
+	}
+
+	run.seconds = (packet_toolbox::monotonicUs() - start) / 1e6;
+	run.rolls = emulator.getStats().rolls - rollsBefore;
+
+	driving = false;
+	tracker.join();
+	run.maxDeviationCm = maxDeviation / 10.0;
+
+	usleep(SETTLE_US);
+	KinematicSnapshot state = sphero->getKinematics();
+	run.finalErrorCm = hypot(COURSE[COURSE_LENGTH - 1].x - state.x,
+			COURSE[COURSE_LENGTH - 1].y - state.y);
+
+	sphero->disconnect();
+	delete sphero;
+
+	return run;
+}
+
+
+int main()
+{
+	double length = 0;
+	for(size_t i = 0 ; i < COURSE_LENGTH ; ++i)
+	{
+		length += hypot(COURSE[i].x - (i == 0 ? 0 : COURSE[i - 1].x),
+				COURSE[i].y - (i == 0 ? 0 : COURSE[i - 1].y));
+	}
+	printf("%zu waypoints, %.1f m of polyline\n", COURSE_LENGTH, length / 100);
+	printf("%-15s %8s %9s %9s %7s %9s %11s %10s\n", "driver", "stream",
+			"time (s)", "plan (s)", "rolls", "rolls/m", "max dev cm",
+			"final cm");
+
+	bool regression = false;
+	for(uint16_t rate : RATES)
+	{
+		run_t runs[NB_DRIVERS];
+		for(int driver = 0 ; driver < NB_DRIVERS ; ++driver)
+		{
+			run_t& run = runs[driver];
+			run = drive((driver_t) driver, rate);
+
+			printf("%-15s %6u Hz %9.2f %9.2f %7llu %9.1f %11.1f %10.1f\n",
+					DRIVER_NAMES[driver], rate, run.seconds,
+					run.plannedSeconds, (unsigned long long) run.rolls,
+					run.rolls / (length / 100), run.maxDeviationCm,
+					run.finalErrorCm);
+		}
+
+		for(int driver = POLYLINE ; driver < NB_DRIVERS ; ++driver)
+		{
+			regression |= !runs[driver].reached
+				|| runs[driver].seconds >= runs[CHAINED].seconds;
+		}
+	}
+
+	if(regression)
+	{
+		fprintf(stderr, "Trajectory executor regression\n");
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
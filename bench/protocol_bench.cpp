@@ -0,0 +1,361 @@
+/*************************************************************************
+	protocol_bench  -  End-to-end protocol costs, measured against the
+					   loopback emulator, written as JSON on stdout :
+					   frame decoding, packet building, acknowledged
+					   command round trips, blocking queries from a
+					   timeout completion and callback fan-out
+							 -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+//-------------------------------------------------------- System includes
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <sys/socket.h>
+
+//--------------------------------------------------------- Local includes
+#include "Sphero.hpp"
+#include "ActionHandler.hpp"
+#include "bluetooth/loopback_connector.h"
+#include "capture/WireReplay.hpp"
+#include "packets/Commands.hpp"
+#include "packets/PacketFramer.hpp"
+#include "packets/SpheroAsyncPacket.hpp"
+#include "packets/Toolbox.hpp"
+
+//-------------------------------------------------------------- Constants
+static size_t const NB_DECODED_FRAMES = 2000000;
+static size_t const NB_BUILT_PACKETS = 10000000;
+static size_t const NB_ROUND_TRIPS = 5000;
+static size_t const NB_REPORTS = 1000000;
+static size_t const NB_REPLAYED_FRAMES = 1000000;
+
+	//Streaming recorded from the emulator for the replay corpus, in ms
+static unsigned int const CAPTURE_DURATION_MS = 500;
+static size_t const FANOUT_LISTENERS[] = {1, 8, 64};
+
+//------------------------------------------------------------------ Types
+
+struct decodeResult_t
+{
+	size_t frameSize;
+	double nsPerFrame;
+};
+
+	//Longest wait for a timeout completion, in s
+static unsigned int const COMPLETION_WAIT_S = NB_SEC_SYNC_BEFORE_FAILURE + 2;
+
+//-------------------------------------------------------------- Functions
+
+static double seconds()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+	//Builds an asynchronous frame, checksum included
+static size_t asyncFrame(uint8_t* frame, uint8_t id, const uint8_t* data,
+		size_t length)
+{
+	frame[0] = START_OF_PACKET_FLAG;
+	frame[1] = ASYNC_FLAG;
+	frame[2] = id;
+	frame[3] = (length + 1) >> 8;
+	frame[4] = (length + 1);
+	memcpy(frame + FRAME_HEADER_SIZE, data, length);
+	frame[FRAME_HEADER_SIZE + length] =
+		packet_toolbox::checksum(frame + 2, length + 3);
+	return FRAME_HEADER_SIZE + length + 1;
+}
+
+
+/*
+ * Reception path without the Bluetooth link : a thread keeps a socket
+ * full of copies of the frame, read back through the PacketFramer and the
+ * extractors, as the monitor thread does
+ */
+static decodeResult_t decode(Sphero* sphero, const uint8_t* frame,
+		size_t frameSize)
+{
+	int sv[2];
+	if(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == -1)
+	{
+		perror("socketpair");
+		exit(EXIT_FAILURE);
+	}
+
+	std::vector<uint8_t> block;
+	while(block.size() + frameSize <= FRAMER_BUFFER_SIZE)
+	{
+		block.insert(block.end(), frame, frame + frameSize);
+	}
+
+	std::thread feeder([&]{
+		while(send(sv[1], block.data(), block.size(), MSG_NOSIGNAL) > 0)
+		{ }
+	});
+
+	PacketFramer framer;
+	const uint8_t* received;
+	size_t length;
+	size_t nbFrames = 0;
+
+	double start = seconds();
+	while(nbFrames < NB_DECODED_FRAMES && framer.fill(sv[0]) > 0)
+	{
+		while(framer.nextFrame(received, length))
+		{
+			SpheroPacket::extractPacket(received, length, sphero);
+			++nbFrames;
+		}
+	}
+	double elapsed = seconds() - start;
+
+	shutdown(sv[0], SHUT_RDWR);
+	feeder.join();
+	close(sv[0]);
+	close(sv[1]);
+
+	decodeResult_t result;
+	result.frameSize = frameSize;
+	result.nsPerFrame = elapsed * 1e9 / nbFrames;
+	return result;
+}
+
+
+static void printDecode(const char* name, decodeResult_t result, bool last)
+{
+	printf("  \"%s\": {\"frame_bytes\": %zu, \"frames_per_s\": %.0f, "
+			"\"ns_per_frame\": %.1f}%s\n", name, result.frameSize,
+			1e9 / result.nsPerFrame, result.nsPerFrame, last ? "" : ",");
+}
+
+
+static uint32_t percentile(const std::vector<uint32_t>& sorted, double p)
+{
+	size_t index = (size_t) (p * (sorted.size() - 1) + 0.5);
+	return sorted[index];
+}
+
+
+int main()
+{
+	loopback_connector* connector = new loopback_connector();
+	Sphero* sphero = new Sphero("00:00:00:00:00:00", connector);
+
+	printf("{\n");
+
+		//Decoding : default streaming set, every field over 4 frames,
+		//and collisions
+	uint8_t data[STREAM_MAX_VALUES * 2];
+	uint8_t frame[FRAMER_BUFFER_SIZE];
+
+	for(size_t i = 0 ; i < sizeof(data) ; ++i)
+	{
+		data[i] = i;
+	}
+
+	sphero->updateParameters(1, 0, mask2::ODOMETER_X | mask2::ODOMETER_Y
+			| mask2::ACCELONE_0 | mask2::VELOCITY_X | mask2::VELOCITY_Y);
+	size_t size = asyncFrame(frame, SENSOR_DATA_STREAMING, data, 5 * 2);
+	printDecode("streaming_decode", decode(sphero, frame, size), false);
+
+	sphero->updateParameters(4, 0xFFFFFFFF, 0xFFFFFFFF);
+	size = asyncFrame(frame, SENSOR_DATA_STREAMING, data,
+			4 * NB_DATA_TYPES * 2);
+	printDecode("streaming_decode_all_fields_4_frames",
+			decode(sphero, frame, size), false);
+
+	uint8_t collision[16] = {0, 10, 0, 20, 0, 30, 1, 0, 40, 0, 50, 60, 0, 0, 1, 0};
+	size = asyncFrame(frame, COLLISION_DETECTED, collision, sizeof(collision));
+	printDecode("collision_decode", decode(sphero, frame, size), false);
+
+		//Building client packets
+	uint8_t payload[4] = {80, 0, 90, 1};
+	uint32_t sink = 0;
+
+	double start = seconds();
+	for(size_t i = 0 ; i < NB_BUILT_PACKETS ; ++i)
+	{
+		payload[2] = i;
+		ClientCommandPacket packet(DID::sphero, CID::roll, 0, 0x05, payload);
+		sink += packet.toByteArray()[packet.getSize() - 1];
+	}
+	double packetNs = (seconds() - start) * 1e9 / NB_BUILT_PACKETS;
+
+	uint8_t buffer[command::roll::size];
+	start = seconds();
+	for(size_t i = 0 ; i < NB_BUILT_PACKETS ; ++i)
+	{
+		command::roll::serialize(buffer, 0, false, false, 80, i, 1);
+		sink += buffer[command::roll::size - 1];
+	}
+	double descriptorNs = (seconds() - start) * 1e9 / NB_BUILT_PACKETS;
+
+	printf("  \"client_packet_build\": {\"ns_per_packet\": %.2f, "
+			"\"descriptor_ns_per_packet\": %.2f},\n", packetNs, descriptorNs);
+
+		//Acknowledged round trips, one at a time
+	if(!sphero->connect())
+	{
+		fprintf(stderr, "Loopback connection failed\n");
+		return EXIT_FAILURE;
+	}
+	sphero->setDataStreaming(80, 1, 0, 0, 0);
+
+	std::vector<uint32_t> rtts;
+	rtts.reserve(NB_ROUND_TRIPS);
+	for(size_t i = 0 ; i < NB_ROUND_TRIPS ; ++i)
+	{
+		std::shared_ptr<std::promise<uint32_t> > rtt =
+			std::make_shared<std::promise<uint32_t> >();
+		std::future<uint32_t> answer = rtt->get_future();
+
+		sphero->ping([rtt](const CommandAnswer& result){
+			rtt->set_value(result.status == commandStatus::ANSWERED ?
+					result.rttUs : UINT32_MAX);
+		});
+
+		uint32_t value = answer.get();
+		if(value != UINT32_MAX)
+		{
+			rtts.push_back(value);
+		}
+	}
+
+		//Blocking query from a timeout completion : refused at once, the
+		//deferred thread going on with the following timeouts
+	connector->getEmulator().setAnswering(false);
+
+	std::promise<double> refusal;
+	std::future<double> refused = refusal.get_future();
+	sphero->ping([sphero, &refusal](const CommandAnswer& result){
+		ColorStruct color;
+		double queryStart = seconds();
+		bool answered = result.status == commandStatus::TIMEOUT
+			&& sphero->getColor(color);
+		refusal.set_value(answered ? -1 : (seconds() - queryStart) * 1e3);
+	});
+
+	std::promise<double> timedOut;
+	std::future<double> nextTimeout = timedOut.get_future();
+	start = seconds();
+	sphero->ping([&timedOut, start](const CommandAnswer&){
+		timedOut.set_value((seconds() - start) * 1e3);
+	});
+
+	if(refused.wait_for(std::chrono::seconds(COMPLETION_WAIT_S))
+			!= std::future_status::ready
+		|| nextTimeout.wait_for(std::chrono::seconds(COMPLETION_WAIT_S))
+			!= std::future_status::ready)
+	{
+			//The deferred thread is stuck : nothing can be torn down
+		fprintf(stderr, "Blocking query deadlocked the timeout completions\n");
+		_exit(EXIT_FAILURE);
+	}
+	double refusedMs = refused.get();
+	if(refusedMs < 0)
+	{
+		fprintf(stderr, "Blocking query not refused in a timeout completion\n");
+		return EXIT_FAILURE;
+	}
+	printf("  \"blocking_query_in_timeout\": {\"refused_after_ms\": %.3f, "
+			"\"next_timeout_ms\": %.0f},\n", refusedMs, nextTimeout.get());
+
+	connector->getEmulator().setAnswering(true);
+
+		//Replay corpus : every field at 400 Hz
+	char capturePath[] = "/tmp/sphero_capture_XXXXXX";
+	int captureFd = mkstemp(capturePath);
+	if(captureFd == -1 || !sphero->startCapture(capturePath))
+	{
+		fprintf(stderr, "Capture file creation failed\n");
+		return EXIT_FAILURE;
+	}
+	close(captureFd);
+
+	sphero->setDataStreaming(400, 1, 0xFFFFFFFF, 0, 0xFFFFFFFF);
+	usleep(CAPTURE_DURATION_MS * 1000);
+	sphero->setDataStreaming(80, 1, 0, 0, 0);
+	sphero->stopCapture();
+
+	sphero->disconnect();
+
+	std::sort(rtts.begin(), rtts.end());
+	if(rtts.empty())
+	{
+		rtts.push_back(0);
+	}
+	printf("  \"ack_round_trip_us\": {\"samples\": %zu, \"p50\": %u, "
+			"\"p90\": %u, \"p99\": %u, \"p999\": %u, \"max\": %u},\n",
+			rtts.size(), percentile(rtts, 0.5), percentile(rtts, 0.9),
+			percentile(rtts, 0.99), percentile(rtts, 0.999), rtts.back());
+
+		//Replaying the capture as fast as possible, with the streaming
+		//parameters it was recorded with
+	WireReplay capture;
+	if(!capture.open(capturePath))
+	{
+		fprintf(stderr, "Capture replay failed\n");
+		return EXIT_FAILURE;
+	}
+	unlink(capturePath);
+
+	sphero->updateParameters(1, 0xFFFFFFFF, 0xFFFFFFFF);
+	size_t nbReplayed = 0;
+	size_t captureFrames = 0;
+	start = seconds();
+	do
+	{
+		captureFrames = capture.replay(sphero);
+		nbReplayed += captureFrames;
+	} while(captureFrames != 0 && nbReplayed < NB_REPLAYED_FRAMES);
+	double replayNs = (seconds() - start) * 1e9 / std::max<size_t>(nbReplayed, 1);
+
+	printf("  \"capture_replay\": {\"capture_frames\": %zu, "
+			"\"ns_per_frame\": %.1f},\n", captureFrames, replayNs);
+
+		//Callback fan-out
+	printf("  \"callback_fanout\": [");
+	size_t nbFanouts = sizeof(FANOUT_LISTENERS) / sizeof(FANOUT_LISTENERS[0]);
+	for(size_t f = 0 ; f < nbFanouts ; ++f)
+	{
+		ActionHandler<uint32_t> handler;
+		std::atomic<uint32_t> total(0);
+		for(size_t i = 0 ; i < FANOUT_LISTENERS[f] ; ++i)
+		{
+			handler.addActionListener([&total](uint32_t value){
+				total.fetch_add(value, std::memory_order_relaxed);
+			});
+		}
+
+		start = seconds();
+		for(size_t i = 0 ; i < NB_REPORTS ; ++i)
+		{
+			handler.reportAction(i);
+		}
+		double reportNs = (seconds() - start) * 1e9 / NB_REPORTS;
+		sink += total;
+
+		printf("%s\n    {\"listeners\": %zu, \"ns_per_report\": %.1f, "
+				"\"ns_per_listener\": %.2f}", f == 0 ? "" : ",",
+				FANOUT_LISTENERS[f], reportNs, reportNs / FANOUT_LISTENERS[f]);
+	}
+	printf("\n  ]\n}\n");
+
+	delete sphero;
+
+	return sink == 0xFFFFFFFF ? EXIT_FAILURE : EXIT_SUCCESS;
+}
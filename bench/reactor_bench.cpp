@@ -0,0 +1,163 @@
+/*************************************************************************
+	reactor_bench  -  CPU cost per robot of the thread-per-robot reception
+					  compared to the epoll reactor
+							 -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+//-------------------------------------------------------- System includes
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+#include <unistd.h>
+#include <sys/socket.h>
+
+//--------------------------------------------------------- Local includes
+#include "Sphero.hpp"
+#include "SpheroReactor.hpp"
+
+//-------------------------------------------------------------- Constants
+static unsigned int const STREAM_PERIOD_US = 12500;	//80 Hz
+static double const RUN_SECONDS = 3.0;
+
+//------------------------------------------------------------------ Types
+
+/*
+ * Connector faking a Sphero with one end of a socketpair
+ */
+class socketpair_connector : public bluetooth_connector
+{
+	public:
+		socketpair_connector():_peer(-1), _socket(-1)
+		{}
+
+		virtual int connection(const char*)
+		{
+			int sv[2];
+			if(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == -1)
+			{
+				return -1;
+			}
+			_socket = sv[0];
+			_peer = sv[1];
+			return _socket;
+		}
+
+		virtual int disconnect(void)
+		{
+			close(_peer);
+			return close(_socket);
+		}
+
+		virtual bool isConnected(void)
+		{
+			return _socket != -1;
+		}
+
+		int getPeer()
+		{
+			return _peer;
+		}
+
+	private:
+		int _peer;
+		int _socket;
+};
+
+//-------------------------------------------------------------- Functions
+
+static double cpuSeconds(clockid_t clock)
+{
+	struct timespec ts;
+	clock_gettime(clock, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+/**
+ * @brief streamingFrame : Builds the default (odometer, speed) streaming frame
+ */
+static std::vector<uint8_t> streamingFrame()
+{
+	std::vector<uint8_t> frame = {0xFF, 0xFE, 0x03, 0x00, 0x0B,
+		0x00, 0x10, 0x00, 0x20, 0x00, 0x05, 0x00, 0x03, 0x00, 0x04};
+
+	uint8_t sum = 0;
+	for(size_t i = 2 ; i < frame.size() ; sum += frame[i++])
+	{ }
+	frame.push_back(~sum);
+
+	return frame;
+}
+
+
+/**
+ * @brief run : Streams at 80 Hz to nbRobots simulated Spheros
+ * @return The CPU time spent receiving, per robot, in % of a core
+ */
+static double run(size_t nbRobots, bool useReactor)
+{
+	SpheroReactor* reactor = useReactor ? new SpheroReactor(1) : NULL;
+	std::vector<Sphero*> spheros;
+	std::vector<int> peers;
+
+	for(size_t i = 0 ; i < nbRobots ; ++i)
+	{
+		socketpair_connector* connector = new socketpair_connector();
+		Sphero* sphero = new Sphero("00:00:00:00:00:00", connector);
+		sphero->setReactor(reactor);
+		if(!sphero->connect())
+		{
+			fprintf(stderr, "Simulated connection failed\n");
+			exit(EXIT_FAILURE);
+		}
+		spheros.push_back(sphero);
+		peers.push_back(connector->getPeer());
+	}
+
+	std::vector<uint8_t> frame = streamingFrame();
+	size_t nbPeriods = RUN_SECONDS * 1000000 / STREAM_PERIOD_US;
+
+	double processStart = cpuSeconds(CLOCK_PROCESS_CPUTIME_ID);
+	double feederStart = cpuSeconds(CLOCK_THREAD_CPUTIME_ID);
+
+	for(size_t period = 0 ; period < nbPeriods ; ++period)
+	{
+		for(int peer : peers)
+		{
+			if(write(peer, frame.data(), frame.size()) != (ssize_t) frame.size())
+			{
+				perror("Feeding");
+			}
+		}
+		usleep(STREAM_PERIOD_US);
+	}
+
+	double feederCpu = cpuSeconds(CLOCK_THREAD_CPUTIME_ID) - feederStart;
+	double processCpu = cpuSeconds(CLOCK_PROCESS_CPUTIME_ID) - processStart;
+
+	for(Sphero* sphero : spheros)
+	{
+		delete sphero;
+	}
+	delete reactor;
+
+	return 100.0 * (processCpu - feederCpu) / RUN_SECONDS / nbRobots;
+}
+
+
+int main()
+{
+	size_t const fleets[] = {1, 10, 100};
+
+	printf("%-10s %-22s %-22s\n", "robots", "thread/robot %cpu", "reactor %cpu");
+	for(size_t nbRobots : fleets)
+	{
+		double threaded = run(nbRobots, false);
+		double reactor = run(nbRobots, true);
+		printf("%-10zu %-22.4f %-22.4f\n", nbRobots, threaded, reactor);
+	}
+
+	return EXIT_SUCCESS;
+}
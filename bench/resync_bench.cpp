@@ -0,0 +1,404 @@
+/*************************************************************************
+	resync_bench  -  Recovery of the framer on a corrupted link : frames
+					 lost per corruption (flipped bit, dropped byte,
+					 inserted junk), bogus frames accepted and bytes
+					 skipped, against the former skip-the-claimed-frame
+					 resynchronization
+							 -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+//-------------------------------------------------------- System includes
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <algorithm>
+#include <vector>
+#include <unistd.h>
+#include <sys/socket.h>
+
+//--------------------------------------------------------- Local includes
+#include "packets/PacketFramer.hpp"
+#include "packets/SpheroPacket.hpp"
+#include "packets/SpheroAsyncPacket.hpp"
+#include "packets/Toolbox.hpp"
+
+//-------------------------------------------------------------- Constants
+static size_t const NB_FRAMES = 200000;
+
+	/* One corruption every CORRUPTION_PERIOD frames */
+static size_t const CORRUPTION_PERIOD = 16;
+
+	/* Bytes written to the socket between two reads of the framer */
+static size_t const CHUNK_SIZE = 256;
+
+static uint8_t const JUNK[] = {
+		//Looks like a streaming header
+	START_OF_PACKET_FLAG, ASYNC_FLAG, SENSOR_DATA_STREAMING, 0x00, 0x0B,
+		//Looks like an answer header
+	START_OF_PACKET_FLAG, ANSWER_FLAG, 0x00, 0x01, 0x09
+};
+
+//------------------------------------------------------------------ Types
+
+enum corruption_t
+{
+	BIT_FLIP,
+	DROPPED_BYTE,
+	INSERTED_JUNK,
+	NB_CORRUPTIONS
+};
+
+static const char* const CORRUPTION_NAMES[NB_CORRUPTIONS] = {
+	"flipped bit", "dropped byte", "inserted junk"
+};
+
+struct recovery_t
+{
+	size_t genuine;
+	size_t bogus;
+	uint64_t discarded;
+	double nsPerByte;
+};
+
+/*
+ * Framer of the previous version : a frame failing its checksum is skipped
+ * as a whole, and any DLEN is trusted
+ */
+class LegacyFramer
+{
+	public:
+		LegacyFramer():_begin(0), _end(0)
+		{}
+
+		ssize_t fill(int fd)
+		{
+			if(_begin == _end)
+			{
+				_begin = 0;
+				_end = 0;
+			}
+			else if(_begin > 0)
+			{
+				memmove(_buffer, _buffer + _begin, _end - _begin);
+				_end -= _begin;
+				_begin = 0;
+			}
+
+			ssize_t rcvVal = recv(fd, _buffer + _end, FRAMER_BUFFER_SIZE - _end, 0);
+			if(rcvVal > 0)
+			{
+				_end += rcvVal;
+			}
+			return rcvVal;
+		}
+
+		bool nextFrame(const uint8_t*& frame, size_t& length)
+		{
+			for(;;)
+			{
+				size_t available = _end - _begin;
+				uint8_t* cursor = _buffer + _begin;
+
+				if(available == 0)
+				{
+					return false;
+				}
+				if(*cursor != START_OF_PACKET_FLAG)
+				{
+					uint8_t* sop = (uint8_t*) memchr(cursor, START_OF_PACKET_FLAG, available);
+					_begin = (sop == NULL) ? _end : (size_t) (sop - _buffer);
+					continue;
+				}
+				if(available < 2)
+				{
+					return false;
+				}
+				if(cursor[1] != ANSWER_FLAG && cursor[1] != ASYNC_FLAG)
+				{
+					++_begin;
+					continue;
+				}
+				if(available < FRAME_HEADER_SIZE)
+				{
+					return false;
+				}
+
+				size_t dlen = (cursor[1] == ANSWER_FLAG) ? cursor[4]
+					: (size_t) ((cursor[3] << 8) | cursor[4]);
+				if(dlen == 0 || FRAME_HEADER_SIZE + dlen > FRAMER_BUFFER_SIZE)
+				{
+					++_begin;
+					continue;
+				}
+
+				size_t frameLength = FRAME_HEADER_SIZE + dlen;
+				if(available < frameLength)
+				{
+					return false;
+				}
+
+				uint8_t sum = 0;
+				for(size_t i = 2 ; i < frameLength - 1 ; sum += cursor[i++])
+				{ }
+
+				_begin += frameLength;
+				if((uint8_t) ~sum != cursor[frameLength - 1])
+				{
+					continue;
+				}
+
+				frame = cursor;
+				length = frameLength;
+				return true;
+			}
+		}
+
+		uint64_t discarded() const
+		{
+				//Not counted by the former framer
+			return 0;
+		}
+
+	private:
+		uint8_t _buffer[FRAMER_BUFFER_SIZE];
+		size_t _begin;
+		size_t _end;
+};
+
+/*
+ * Adds the skipped bytes counter to PacketFramer, for the report
+ */
+class CountingFramer : public PacketFramer
+{
+	public:
+		uint64_t discarded() const
+		{
+			return getStats().discardedBytes;
+		}
+};
+
+//-------------------------------------------------------------- Functions
+
+static double seconds()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+static uint32_t nextRandom(uint32_t& state)
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+
+	//Frame number i : a streaming frame, an answer or a collision, every
+	//one carrying some FFh bytes in its payload and ending with i
+static std::vector<uint8_t> buildFrame(uint32_t i)
+{
+	uint8_t id[4] = {(uint8_t) (i >> 24), (uint8_t) (i >> 16),
+		(uint8_t) (i >> 8), (uint8_t) i};
+	std::vector<uint8_t> frame;
+
+	frame.push_back(START_OF_PACKET_FLAG);
+	switch(i % 3)
+	{
+		case 0:
+			frame.push_back(ASYNC_FLAG);
+			frame.push_back(SENSOR_DATA_STREAMING);
+			frame.push_back(0x00);
+			frame.push_back(11);
+			frame.push_back(START_OF_PACKET_FLAG);
+			frame.push_back(ASYNC_FLAG);
+			frame.push_back(START_OF_PACKET_FLAG);
+			frame.push_back(ANSWER_FLAG);
+			frame.push_back(0x00);
+			frame.push_back(0x05);
+			break;
+		case 1:
+			frame.push_back(ANSWER_FLAG);
+			frame.push_back(0x00);
+			frame.push_back((uint8_t) i);
+			frame.push_back(7);
+			frame.push_back(START_OF_PACKET_FLAG);
+			frame.push_back(ANSWER_FLAG);
+			break;
+		default:
+			frame.push_back(ASYNC_FLAG);
+			frame.push_back(COLLISION_DETECTED);
+			frame.push_back(0x00);
+			frame.push_back(17);
+			frame.push_back(START_OF_PACKET_FLAG);
+			frame.push_back(ASYNC_FLAG);
+			frame.insert(frame.end(), 10, 0x10);
+			break;
+	}
+		//Last data bytes
+	frame.insert(frame.end(), id, id + 4);
+	frame.push_back(packet_toolbox::checksum(frame.data() + 2, frame.size() - 2));
+
+	return frame;
+}
+
+
+	//Whole stream, with one corruption of the given kind every
+	//CORRUPTION_PERIOD frames
+static std::vector<uint8_t> buildStream(corruption_t kind, size_t& nbEvents)
+{
+	std::vector<uint8_t> stream;
+	uint32_t state = 0x2545F491;
+	nbEvents = 0;
+
+	for(uint32_t i = 0 ; i < NB_FRAMES ; ++i)
+	{
+		std::vector<uint8_t> frame = buildFrame(i);
+		if(i % CORRUPTION_PERIOD == CORRUPTION_PERIOD / 2)
+		{
+			size_t at = nextRandom(state) % frame.size();
+			switch(kind)
+			{
+				case BIT_FLIP:
+					frame[at] ^= 1 << (nextRandom(state) % 8);
+					break;
+				case DROPPED_BYTE:
+					frame.erase(frame.begin() + at);
+					break;
+				default:
+					stream.insert(stream.end(), JUNK, JUNK + sizeof(JUNK));
+					break;
+			}
+			++nbEvents;
+		}
+		stream.insert(stream.end(), frame.begin(), frame.end());
+	}
+
+	return stream;
+}
+
+
+	//Feeds the stream to a framer through a socketpair and sorts what it
+	//gives back
+template<typename Framer>
+static recovery_t recover(const std::vector<uint8_t>& stream)
+{
+	int sv[2];
+	if(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == -1)
+	{
+		perror("socketpair");
+		exit(EXIT_FAILURE);
+	}
+
+	Framer* framer = new Framer();
+	recovery_t result = {0, 0, 0, 0};
+	double start = seconds();
+
+	for(size_t sent = 0 ; sent < stream.size() ; sent += CHUNK_SIZE)
+	{
+		size_t chunk = std::min(CHUNK_SIZE, stream.size() - sent);
+		if(send(sv[1], stream.data() + sent, chunk, MSG_NOSIGNAL) != (ssize_t) chunk
+				|| framer->fill(sv[0]) != (ssize_t) chunk)
+		{
+			fprintf(stderr, "Short transfer\n");
+			exit(EXIT_FAILURE);
+		}
+
+		const uint8_t* frame;
+		size_t length;
+		while(framer->nextFrame(frame, length))
+		{
+			if(length < FRAME_HEADER_SIZE + 4)
+			{
+				++result.bogus;
+				continue;
+			}
+
+			const uint8_t* id = frame + length - 5;
+			uint32_t i = (id[0] << 24) | (id[1] << 16) | (id[2] << 8) | id[3];
+			std::vector<uint8_t> original = buildFrame(i);
+			if(i < NB_FRAMES && original.size() == length
+					&& memcmp(original.data(), frame, length) == 0)
+			{
+				++result.genuine;
+			}
+			else
+			{
+				++result.bogus;
+			}
+		}
+	}
+
+	result.nsPerByte = (seconds() - start) * 1e9 / stream.size();
+	result.discarded = framer->discarded();
+
+	delete framer;
+	close(sv[0]);
+	close(sv[1]);
+
+	return result;
+}
+
+
+	//Frames lost per corruption, 1.0 when only the damaged frame is lost
+static double lostPerEvent(const recovery_t& recovery, size_t nbEvents)
+{
+	return nbEvents == 0 ? 0 : (double) (NB_FRAMES - recovery.genuine) / nbEvents;
+}
+
+
+int main()
+{
+	printf("%-16s %-8s %12s %8s %12s %10s\n", "corruption", "framer",
+			"lost/event", "bogus", "discarded", "ns/byte");
+
+	bool regression = false;
+	for(int kind = 0 ; kind < NB_CORRUPTIONS ; ++kind)
+	{
+		size_t nbEvents;
+		std::vector<uint8_t> stream = buildStream((corruption_t) kind, nbEvents);
+
+		recovery_t legacy = recover<LegacyFramer>(stream);
+		recovery_t current = recover<CountingFramer>(stream);
+
+		printf("%-16s %-8s %12.3f %8zu %12s %10.2f\n", CORRUPTION_NAMES[kind],
+				"legacy", lostPerEvent(legacy, nbEvents), legacy.bogus, "-",
+				legacy.nsPerByte);
+		printf("%-16s %-8s %12.3f %8zu %12llu %10.2f\n", CORRUPTION_NAMES[kind],
+				"resync", lostPerEvent(current, nbEvents), current.bogus,
+				(unsigned long long) current.discarded, current.nsPerByte);
+
+		regression |= current.genuine < legacy.genuine;
+	}
+
+		//Clean link : nothing may be skipped
+	size_t nbEvents;
+	std::vector<uint8_t> clean;
+	for(uint32_t i = 0 ; i < NB_FRAMES ; ++i)
+	{
+		std::vector<uint8_t> frame = buildFrame(i);
+		clean.insert(clean.end(), frame.begin(), frame.end());
+	}
+	nbEvents = 0;
+	recovery_t cleanLegacy = recover<LegacyFramer>(clean);
+	recovery_t cleanCurrent = recover<CountingFramer>(clean);
+
+	printf("%-16s %-8s %12.3f %8zu %12s %10.2f\n", "none", "legacy",
+			lostPerEvent(cleanLegacy, nbEvents), cleanLegacy.bogus, "-",
+			cleanLegacy.nsPerByte);
+	printf("%-16s %-8s %12.3f %8zu %12llu %10.2f\n", "none", "resync",
+			lostPerEvent(cleanCurrent, nbEvents), cleanCurrent.bogus,
+			(unsigned long long) cleanCurrent.discarded, cleanCurrent.nsPerByte);
+
+	if(regression || cleanCurrent.genuine != NB_FRAMES || cleanCurrent.discarded != 0)
+	{
+		fprintf(stderr, "Resynchronization regression\n");
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
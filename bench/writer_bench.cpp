@@ -0,0 +1,191 @@
+/*************************************************************************
+	writer_bench  -  System calls spent on the outbound path, and commands
+					 coalesced on a saturated link, while a controller
+					 rolls every 8 ms and other threads send LED commands
+							 -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+//-------------------------------------------------------- System includes
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <sys/socket.h>
+
+//--------------------------------------------------------- Local includes
+#include "Sphero.hpp"
+
+//-------------------------------------------------------------- Constants
+static unsigned int const ROLL_PERIOD_US = 8000;
+static unsigned int const NB_LED_THREADS = 3;
+static unsigned int const LED_PERIOD_US = 2000;
+static double const RUN_SECONDS = 2.0;
+
+	/* Saturated link : the simulated Sphero reads SLOW_READ_SIZE bytes
+	 * every SLOW_READ_PERIOD_US (about 8 kB/s) */
+static size_t const SLOW_READ_SIZE = 16;
+static unsigned int const SLOW_READ_PERIOD_US = 2000;
+static int const SLOW_SOCKET_BUFFER = 1024;
+
+//------------------------------------------------------------------ Types
+
+/*
+ * Connector faking a Sphero with one end of a socketpair
+ */
+class socketpair_connector : public bluetooth_connector
+{
+	public:
+		/**
+		 * @param bufferSize : If not 0, the socket buffers size
+		 */
+		socketpair_connector(int bufferSize = 0):_peer(-1), _socket(-1),
+			_bufferSize(bufferSize)
+		{}
+
+		virtual int connection(const char*)
+		{
+			int sv[2];
+			if(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == -1)
+			{
+				return -1;
+			}
+			_socket = sv[0];
+			_peer = sv[1];
+			if(_bufferSize != 0)
+			{
+				setsockopt(_socket, SOL_SOCKET, SO_SNDBUF, &_bufferSize,
+						sizeof(_bufferSize));
+				setsockopt(_peer, SOL_SOCKET, SO_RCVBUF, &_bufferSize,
+						sizeof(_bufferSize));
+			}
+			return _socket;
+		}
+
+		virtual int disconnect(void)
+		{
+			shutdown(_peer, SHUT_RDWR);
+			return close(_socket);
+		}
+
+		virtual bool isConnected(void)
+		{
+			return _socket != -1;
+		}
+
+		int getPeer()
+		{
+			return _peer;
+		}
+
+	private:
+		int _peer;
+		int _socket;
+		int _bufferSize;
+};
+
+//-------------------------------------------------------------- Functions
+
+/**
+ * @brief run : Sends the commands for RUN_SECONDS
+ * @param slowLink : If true, the simulated Sphero reads slowly
+ * @return The writer counters
+ */
+static WriterStats run(bool slowLink)
+{
+	socketpair_connector* connector = new socketpair_connector(
+			slowLink ? SLOW_SOCKET_BUFFER : 0);
+	Sphero sphero("00:00:00:00:00:00", connector);
+	if(!sphero.connect())
+	{
+		fprintf(stderr, "Simulated connection failed\n");
+		exit(EXIT_FAILURE);
+	}
+
+		//Simulated Sphero : swallows everything
+	int peer = connector->getPeer();
+	std::thread drain([peer, slowLink]{
+		uint8_t buffer[4096];
+		size_t readSize = slowLink ? SLOW_READ_SIZE : sizeof(buffer);
+		while(read(peer, buffer, readSize) > 0)
+		{
+			if(slowLink)
+			{
+				usleep(SLOW_READ_PERIOD_US);
+			}
+		}
+	});
+
+	std::atomic<bool> running(true);
+	std::vector<std::thread> senders;
+
+	senders.emplace_back([&]{
+		for(uint16_t heading = 0 ; running ; heading = (heading + 1) % 360)
+		{
+			sphero.roll(80, heading);
+			usleep(ROLL_PERIOD_US);
+		}
+	});
+
+	for(unsigned int t = 0 ; t < NB_LED_THREADS ; ++t)
+	{
+		senders.emplace_back([&, t]{
+			for(uint8_t level = 0 ; running ; ++level)
+			{
+				if(t % 2 == 0)
+				{
+					sphero.setColor(level, 0, 255 - level);
+				}
+				else
+				{
+					sphero.setBackLedOutput(level);
+				}
+				usleep(LED_PERIOD_US);
+			}
+		});
+	}
+
+	usleep(RUN_SECONDS * 1000000);
+	running = false;
+	for(std::thread& sender : senders)
+	{
+		sender.join();
+	}
+
+	sphero.disconnect();
+	WriterStats stats = sphero.getWriterStats();
+	close(peer);
+	drain.join();
+
+	return stats;
+}
+
+
+int main()
+{
+	WriterStats fast = run(false);
+	WriterStats slow = run(true);
+
+	printf("%-22s %-14s %-14s\n", "", "fast link", "saturated link");
+	printf("%-22s %-14llu %-14llu\n", "packets",
+			(unsigned long long) fast.frames, (unsigned long long) slow.frames);
+	printf("%-22s %-14llu %-14llu\n", "system calls",
+			(unsigned long long) fast.syscalls, (unsigned long long) slow.syscalls);
+	printf("%-22s %-14.2f %-14.2f\n", "packets/syscall",
+			fast.syscalls ? (double) fast.frames / fast.syscalls : 0.0,
+			slow.syscalls ? (double) slow.frames / slow.syscalls : 0.0);
+	printf("%-22s %-14.2f %-14.2f\n", "bytes/syscall",
+			fast.syscalls ? (double) fast.bytes / fast.syscalls : 0.0,
+			slow.syscalls ? (double) slow.bytes / slow.syscalls : 0.0);
+	printf("%-22s %-14zu %-14zu\n", "max batch", fast.maxBatch, slow.maxBatch);
+	printf("%-22s %-14zu %-14zu\n", "max queue depth",
+			fast.maxQueueDepth, slow.maxQueueDepth);
+	printf("%-22s %-14llu %-14llu\n", "coalesced",
+			(unsigned long long) fast.coalesced, (unsigned long long) slow.coalesced);
+	printf("%-22s %-14llu %-14llu\n", "dropped",
+			(unsigned long long) fast.dropped, (unsigned long long) slow.dropped);
+
+	return EXIT_SUCCESS;
+}
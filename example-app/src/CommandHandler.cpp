@@ -190,13 +190,12 @@ static void testBTInfo()
 		return;
 	}
 
-	BTInfoStruct* booza = sm.getSphero()->getBTInfo();	
-	if(booza != NULL)
+	BTInfoStruct booza;
+	if(sm.getSphero()->getBTInfo(booza))
 	{
 
-		std::cout << "Get BTInfo(s) BT Name : " << booza->bt_name << 
-			" BT Address : " << booza->bt_adress << std::endl;
-		delete booza;
+		std::cout << "Get BTInfo(s) BT Name : " << booza.bt_name << 
+			" BT Address : " << booza.bt_adress << std::endl;
 		return;
 	}
 
@@ -8,13 +8,40 @@
 #define ACTIONHANDLER_HPP
 
 //-------------------------------------------------------- System includes
-#include <list>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <functional>
+#include <utility>
+#include <vector>
+#include <pthread.h>
+
+//------------------------------------------------------------------ Types
+
+/*
+ * Identifies one registered listener. Tokens are unique across every
+ * handler of the process, 0 is never given.
+ */
+typedef uint64_t listenerToken_t;
+
+/**
+ * @brief nextListenerToken : Gives a new listener token
+ */
+inline listenerToken_t nextListenerToken()
+{
+	static std::atomic<listenerToken_t> lastToken(0);
+	return lastToken.fetch_add(1, std::memory_order_relaxed) + 1;
+}
 
 
 //------------------------------------------------------- Class definition
 /**
  * T : Data structure type which will be communicated to all listeners
+ *
+ * The listeners are kept in an immutable array : registering or removing a
+ * listener publishes a new array, so that reportAction never takes a lock
+ * and may run on the reception thread while other threads subscribe.
+ * Replaced arrays are freed once no report is still walking them.
  */
 template<typename ...T>
 class ActionHandler 
@@ -45,8 +72,12 @@ class ActionHandler
 
 		/**
 		 * @brief reportAction : Reports the ocurred actions to actionHandler.
-		 *				All listeners are then notified.
+		 *				All listeners are then notified, the most recently
+		 *				registered first.
 		 * @param action : A pointer to the action informations data structure
+		 *
+		 * Lock-free : the listeners registered when the report starts are
+		 * called, even if one of them is removed in the meantime.
 		 */
 		void reportAction(T... action);
 
@@ -54,8 +85,20 @@ class ActionHandler
 		/**
 		 * @brief addActionListener : Registers a new listener
 		 * @param : listener : The new listener which will be registered
+		 * @return The token to give to removeActionListener
+		 */
+		listenerToken_t addActionListener(listener_t listener);
+
+
+		/**
+		 * @brief removeActionListener : Unregisters one listener
+		 * @param token : The token given by addActionListener
+		 * @return true if the listener was registered in this handler
+		 *
+		 * A report running on another thread may still call the listener
+		 * once after the return.
 		 */
-		void addActionListener(listener_t listener);
+		bool removeActionListener(listenerToken_t token);
 
 
 		/**
@@ -63,12 +106,63 @@ class ActionHandler
 		 */
 		void clearListener();
 
+		/**
+		 * @return true if at least one listener is registered
+		 */
+		bool hasListener() const;
+
 	private:
 		//-------------------------------------------------- Private types
-		using listenerList_t = std::list<listener_t>;
+		struct slot
+		{
+			listener_t listener;
+			listenerToken_t token;
+		};
+
+			/* Sorted by decreasing token : the newest listener first */
+		using listenerList_t = std::vector<slot>;
+
+			/* Counts the reports in progress for as long as it lives */
+		class readGuard
+		{
+			public:
+				readGuard(std::atomic<size_t>& readers):_readers(readers)
+				{
+					_readers.fetch_add(1, std::memory_order_seq_cst);
+				}
+
+				~readGuard()
+				{
+					_readers.fetch_sub(1, std::memory_order_release);
+				}
+
+			private:
+				std::atomic<size_t>& _readers;
+		};
+
+		//------------------------------------------------ Private methods
+
+		/**
+		 * @brief publish : Replaces the listener array, then frees the
+		 * 				   replaced ones if no report can still see them
+		 * @param listeners : The new array, NULL if empty
+		 *
+		 * Contract : _writeLock is taken
+		 */
+		void publish(listenerList_t* listeners);
 
 		//--------------------------------------------- Private attributes
-		listenerList_t _listenerList;
+			/* NULL while no listener is registered */
+		std::atomic<listenerList_t*> _listeners;
+
+			/* Number of reportAction in progress */
+		mutable std::atomic<size_t> _readers;
+
+			/* Serializes the writers, never taken by the reports */
+		pthread_mutex_t _writeLock;
+
+			/* Arrays replaced while a report was running */
+		std::vector<listenerList_t*> _retired;
 };
 
 #include "ActionHandler.tpp"
@@ -12,29 +12,49 @@
  * @brief ActionHandler : Constructor
  */
 template<typename ...T>
-ActionHandler<T...>::ActionHandler():_listenerList()
-{}
+ActionHandler<T...>::ActionHandler():_listeners(NULL), _readers(0),
+	_retired()
+{
+	pthread_mutex_init(&_writeLock, NULL);
+}
 
 
 template<typename ...T>
 ActionHandler<T...>::~ActionHandler ( )
-{}
+{
+	delete _listeners.load();
+	for(listenerList_t* listeners : _retired)
+	{
+		delete listeners;
+	}
+	pthread_mutex_destroy(&_writeLock);
+}
 
 
 //--------------------------------------------------------- Public methods
 
 /**
  * @brief reportAction : Reports the ocurred actions to actionHandler.
- *				All listeners are then notified.
+ *				All listeners are then notified, the most recently
+ *				registered first.
  * @param action : A pointer to the action informations data structure
+ *
+ * Lock-free : the listeners registered when the report starts are
+ * called, even if one of them is removed in the meantime.
  */
 template<typename ...T>
 void ActionHandler<T...>::reportAction(T... action)
 {
-	typename listenerList_t::iterator it;
-	for(it = _listenerList.begin() ; it != _listenerList.end() ; it++)
+	readGuard guard(_readers);
+	const listenerList_t* listeners = _listeners.load(std::memory_order_seq_cst);
+	if(listeners == NULL)
 	{
-		(*it)(action...);
+		return;
+	}
+
+	for(const slot& registered : *listeners)
+	{
+		registered.listener(action...);
 	}
 }
 
@@ -42,11 +62,72 @@ void ActionHandler<T...>::reportAction(T... action)
 /**
  * @brief addActionListener : Registers a new listener
  * @param : listener : The new listener which will be registered
+ * @return The token to give to removeActionListener
+ */
+template<typename ...T>
+listenerToken_t ActionHandler<T...>::addActionListener(listener_t listener)
+{
+	pthread_mutex_lock(&_writeLock);
+	listenerToken_t token = nextListenerToken();
+
+		//Writers are serialized : the current array cannot be freed here
+	const listenerList_t* current = _listeners.load(std::memory_order_relaxed);
+	listenerList_t* listeners = new listenerList_t();
+	listeners->reserve(current == NULL ? 1 : current->size() + 1);
+	listeners->push_back(slot{std::move(listener), token});
+	if(current != NULL)
+	{
+		listeners->insert(listeners->end(), current->begin(), current->end());
+	}
+
+	publish(listeners);
+	pthread_mutex_unlock(&_writeLock);
+	return token;
+}
+
+
+/**
+ * @brief removeActionListener : Unregisters one listener
+ * @param token : The token given by addActionListener
+ * @return true if the listener was registered in this handler
+ *
+ * A report running on another thread may still call the listener
+ * once after the return.
  */
 template<typename ...T>
-void ActionHandler<T...>::addActionListener(listener_t listener)
+bool ActionHandler<T...>::removeActionListener(listenerToken_t token)
 {
-	_listenerList.push_front(listener);
+	pthread_mutex_lock(&_writeLock);
+	const listenerList_t* current = _listeners.load(std::memory_order_relaxed);
+	if(current == NULL)
+	{
+		pthread_mutex_unlock(&_writeLock);
+		return false;
+	}
+
+	typename listenerList_t::const_iterator removed = std::lower_bound(
+			current->begin(), current->end(), token,
+			[](const slot& registered, listenerToken_t searched){
+				return registered.token > searched;
+			});
+	if(removed == current->end() || removed->token != token)
+	{
+		pthread_mutex_unlock(&_writeLock);
+		return false;
+	}
+
+	listenerList_t* listeners = NULL;
+	if(current->size() > 1)
+	{
+		listeners = new listenerList_t();
+		listeners->reserve(current->size() - 1);
+		listeners->insert(listeners->end(), current->begin(), removed);
+		listeners->insert(listeners->end(), removed + 1, current->end());
+	}
+
+	publish(listeners);
+	pthread_mutex_unlock(&_writeLock);
+	return true;
 }
 
 
@@ -56,7 +137,51 @@ void ActionHandler<T...>::addActionListener(listener_t listener)
 template<typename ...T>
 void ActionHandler<T...>::clearListener()
 {
-	listenerList_t empty;
-	std::swap(_listenerList, empty);
+	pthread_mutex_lock(&_writeLock);
+	publish(NULL);
+	pthread_mutex_unlock(&_writeLock);
+}
+
+
+/**
+ * @return true if at least one listener is registered
+ */
+template<typename ...T>
+bool ActionHandler<T...>::hasListener() const
+{
+		//Only the pointer is read : the array itself is never touched
+	return _listeners.load(std::memory_order_acquire) != NULL;
+}
+
+
+//-------------------------------------------------------- Private methods
+
+/**
+ * @brief publish : Replaces the listener array, then frees the
+ * 				   replaced ones if no report can still see them
+ * @param listeners : The new array, NULL if empty
+ *
+ * Contract : _writeLock is taken
+ */
+template<typename ...T>
+void ActionHandler<T...>::publish(listenerList_t* listeners)
+{
+	listenerList_t* replaced = _listeners.exchange(listeners,
+			std::memory_order_seq_cst);
+	if(replaced != NULL)
+	{
+		_retired.push_back(replaced);
+	}
 
+		//A report starting from now loads the new array : with no report in
+		//progress, nothing can still read the replaced ones. Otherwise they
+		//wait for a later write (a listener may subscribe from a report)
+	if(_readers.load(std::memory_order_seq_cst) == 0)
+	{
+		for(listenerList_t* retired : _retired)
+		{
+			delete retired;
+		}
+		_retired.clear();
+	}
 }
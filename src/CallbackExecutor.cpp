@@ -0,0 +1,339 @@
+/*************************************************************************
+	CallbackExecutor  -  Threads running the user callbacks out of the
+						 reception thread, fed by a bounded queue
+							 -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+//-------------------------------------------------------- System includes
+#include <algorithm>
+#include <utility>
+
+//--------------------------------------------------------- Local includes
+#include "CallbackExecutor.hpp"
+#include "Sphero.hpp"
+
+//------------------------------------------------ Constructors/Destructor
+
+/**
+ * @brief CallbackExecutor : Constructor. Starts the threads
+ * @param nbThreads : The number of threads (at least 1)
+ * @param capacity : The most events queued at once (at least 1)
+ * @param overflow : What to do with an event when the queue is full
+ */
+CallbackExecutor::CallbackExecutor(size_t nbThreads, size_t capacity,
+		overflowPolicy overflow):_overflow(overflow), _head(0), _count(0),
+	_stop(false), _stats()
+{
+	pthread_mutex_init(&_lock, NULL);
+	pthread_cond_init(&_notEmpty, NULL);
+	pthread_cond_init(&_notFull, NULL);
+	pthread_cond_init(&_idle, NULL);
+
+	_queue.resize(std::max<size_t>(capacity, 1));
+
+		//Never resized afterwards : the threads keep a pointer to their entry
+	_workers.resize(std::max<size_t>(nbThreads, 1));
+
+		//The threads only look at the identifiers with the lock held
+	pthread_mutex_lock(&_lock);
+	for(worker& w : _workers)
+	{
+		w.executor = this;
+		w.running = NULL;
+		pthread_create(&w.thread, NULL, workerRoutine, &w);
+	}
+	pthread_mutex_unlock(&_lock);
+}
+
+
+CallbackExecutor::~CallbackExecutor()
+{
+	pthread_mutex_lock(&_lock);
+	_stop = true;
+	_stats.dropped += _count;
+	_count = 0;
+	pthread_cond_broadcast(&_notEmpty);
+	pthread_cond_broadcast(&_notFull);
+	pthread_cond_broadcast(&_idle);
+	pthread_mutex_unlock(&_lock);
+
+	for(worker& w : _workers)
+	{
+		if(!pthread_equal(w.thread, pthread_self()))
+		{
+			pthread_join(w.thread, NULL);
+		}
+	}
+
+	pthread_cond_destroy(&_idle);
+	pthread_cond_destroy(&_notFull);
+	pthread_cond_destroy(&_notEmpty);
+	pthread_mutex_destroy(&_lock);
+}
+
+
+//--------------------------------------------------------- Public methods
+
+/**
+ * @brief submit : Queues an event of a Sphero
+ * @param sphero : The Sphero whose listeners will be called
+ * @param event : The event, copied
+ * @return false if the executor is stopping
+ */
+bool CallbackExecutor::submit(Sphero* sphero, const callbackEvent& event)
+{
+	pthread_mutex_lock(&_lock);
+
+	bool waited = false;
+	while(!_stop && _count == _queue.size())
+	{
+			//An executor thread waiting for itself would never wake up
+		if(_overflow == overflowPolicy::BLOCK && !isWorker())
+		{
+			if(!waited)
+			{
+				++_stats.blocked;
+				waited = true;
+			}
+			pthread_cond_wait(&_notFull, &_lock);
+		}
+		else
+		{
+			removeAt(0);
+			++_stats.dropped;
+		}
+	}
+
+	if(_stop)
+	{
+		++_stats.dropped;
+		pthread_mutex_unlock(&_lock);
+		return false;
+	}
+
+	task& slot = slotAt(_count);
+	slot.sphero = sphero;
+	slot.event = event;
+	slot.event.data = NULL;
+	if(event.kind == eventKind::ASYNC_PACKET)
+	{
+		slot.payload.assign(event.data, event.data + event.length);
+	}
+	++_count;
+
+	++_stats.submitted;
+	_stats.queueDepth = _count;
+	_stats.maxQueueDepth = std::max(_stats.maxQueueDepth, _count);
+
+	pthread_cond_signal(&_notEmpty);
+	pthread_mutex_unlock(&_lock);
+
+	return true;
+}
+
+
+/**
+ * @brief drain : Waits until no event of a Sphero is queued or running.
+ * 				  Called from a thread of the executor, the queued events of
+ * 				  the Sphero are dropped instead
+ * @param sphero : The Sphero
+ */
+void CallbackExecutor::drain(Sphero* sphero)
+{
+	pthread_mutex_lock(&_lock);
+
+	bool dropQueued = isWorker();
+	for(;;)
+	{
+		bool queued = false;
+		for(size_t position = 0 ; position < _count ; )
+		{
+			if(slotAt(position).sphero != sphero)
+			{
+				++position;
+			}
+			else if(dropQueued || _stop)
+			{
+				removeAt(position);
+				++_stats.dropped;
+				pthread_cond_signal(&_notFull);
+			}
+			else
+			{
+				queued = true;
+				++position;
+			}
+		}
+		_stats.queueDepth = _count;
+
+		bool running = false;
+		for(worker& w : _workers)
+		{
+			running = running || (w.running == sphero
+					&& !pthread_equal(w.thread, pthread_self()));
+		}
+
+		if(!queued && !running)
+		{
+			break;
+		}
+		pthread_cond_wait(&_idle, &_lock);
+	}
+
+	pthread_mutex_unlock(&_lock);
+}
+
+
+/**
+ * @return A consistent copy of the executor counters
+ */
+ExecutorStats CallbackExecutor::getStats()
+{
+	pthread_mutex_lock(&_lock);
+	ExecutorStats stats = _stats;
+	pthread_mutex_unlock(&_lock);
+
+	return stats;
+}
+
+
+/**
+ * @return The number of threads
+ */
+size_t CallbackExecutor::getNbThreads()
+{
+	return _workers.size();
+}
+
+
+//-------------------------------------------------------- Private methods
+
+void* CallbackExecutor::workerRoutine(void* worker_ptr)
+{
+	worker* self = (worker*) worker_ptr;
+	CallbackExecutor* executor = self->executor;
+
+		//Swapped with the queue slots : both keep their payload capacity
+	task running = task();
+
+	pthread_mutex_lock(&executor->_lock);
+
+	for(;;)
+	{
+		size_t position = executor->_count;
+		while(!executor->_stop
+				&& (position = executor->nextRunnable()) == executor->_count)
+		{
+			pthread_cond_wait(&executor->_notEmpty, &executor->_lock);
+		}
+
+		if(executor->_stop)
+		{
+			break;
+		}
+
+		std::swap(running, executor->slotAt(position));
+		executor->removeAt(position);
+		executor->_stats.queueDepth = executor->_count;
+		self->running = running.sphero;
+		pthread_cond_signal(&executor->_notFull);
+
+		pthread_mutex_unlock(&executor->_lock);
+
+		if(running.event.kind == eventKind::ASYNC_PACKET)
+		{
+			running.event.data = running.payload.data();
+		}
+		running.sphero->runEvent(running.event);
+
+		pthread_mutex_lock(&executor->_lock);
+
+		self->running = NULL;
+		++executor->_stats.executed;
+		pthread_cond_broadcast(&executor->_idle);
+	}
+
+	pthread_mutex_unlock(&executor->_lock);
+
+	return NULL;
+}
+
+
+/**
+ * @brief isWorker : The lock must be held
+ * @return true if the calling thread is one of the executor threads
+ */
+bool CallbackExecutor::isWorker()
+{
+	for(worker& w : _workers)
+	{
+		if(pthread_equal(w.thread, pthread_self()))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+
+/**
+ * @brief isRunning : The lock must be held
+ * @param sphero : A Sphero
+ * @return true if an event of the Sphero runs on a thread
+ */
+bool CallbackExecutor::isRunning(Sphero* sphero)
+{
+	for(worker& w : _workers)
+	{
+		if(w.running == sphero)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+
+/**
+ * @brief nextRunnable : The lock must be held
+ * @return The position from the head of the oldest event whose Sphero is
+ * 		   not running, _count if there is none
+ */
+size_t CallbackExecutor::nextRunnable()
+{
+	size_t position = 0;
+	while(position < _count && isRunning(slotAt(position).sphero))
+	{
+		++position;
+	}
+	return position;
+}
+
+
+/**
+ * @brief removeAt : Removes a queued event, keeping the order of the
+ * 					others. The lock must be held
+ * @param position : The position of the event from the head
+ */
+void CallbackExecutor::removeAt(size_t position)
+{
+		//The removed slot ends up at the head, which then moves past it
+	for( ; position > 0 ; --position)
+	{
+		std::swap(slotAt(position), slotAt(position - 1));
+	}
+	_head = (_head + 1) % _queue.size();
+	--_count;
+}
+
+
+/**
+ * @brief slotAt : The lock must be held
+ * @param position : A position from the head
+ * @return The slot of the queued event
+ */
+CallbackExecutor::task& CallbackExecutor::slotAt(size_t position)
+{
+	return _queue[(_head + position) % _queue.size()];
+}
@@ -0,0 +1,242 @@
+/******************************************************************************
+	CallbackExecutor  -  Threads running the user callbacks out of the
+						 reception thread, fed by a bounded queue
+							-------------------
+	started                : 17/10/2026
+******************************************************************************/
+
+#ifndef CALLBACKEXECUTOR_HPP
+#define CALLBACKEXECUTOR_HPP
+
+//------------------------------------------------------------- System includes
+#include <pthread.h>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+//-------------------------------------------------------------- Local includes
+#include "packets/async/CollisionStruct.hpp"
+#include "packets/async/NotificationTypes.hpp"
+
+//------------------------------------------------------------------- Constants
+
+	/* Events waiting in a queue created without an explicit capacity */
+static size_t const EXECUTOR_DEFAULT_CAPACITY = 256;
+
+//----------------------------------------------------------------------- Types
+class Sphero;
+
+	/* The events a Sphero reports to its listeners */
+enum class eventKind : uint8_t
+{
+	CONNECT,
+	DISCONNECT,
+	PRE_SLEEP,
+	COLLISION,
+	DATA,
+	POWER_STATE,
+	SELF_LEVEL,
+	ASYNC_PACKET,
+	NB_KINDS
+};
+
+	/* Where the listeners of an event are called */
+enum class dispatchPolicy : uint8_t
+{
+		/* On the thread detecting the event, usually the reception one */
+	INLINE,
+		/* On a thread of the Sphero, started on first use */
+	ROBOT_EXECUTOR,
+		/* On the executor given to Sphero::setSharedExecutor */
+	SHARED_EXECUTOR
+};
+
+	/* What happens to a new event when the queue is full */
+enum class overflowPolicy : uint8_t
+{
+		/* The oldest queued event is dropped : the reporter never waits */
+	DROP_OLDEST,
+		/* The reporter waits for a free slot. Events reported from an
+		 * executor thread fall back to DROP_OLDEST */
+	BLOCK
+};
+
+/*
+ * An event and its data. The fields other than kind are only meaningful
+ * for their event
+ */
+struct callbackEvent
+{
+	eventKind kind;
+
+	CollisionStruct collision;
+	powerState power;
+	selfLevelResult selfLevel;
+
+		/* ASYNC_PACKET : the ID code and the payload, copied when queued */
+	uint8_t asyncId;
+	const uint8_t* data;
+	size_t length;
+};
+
+struct ExecutorStats
+{
+		/* Events queued, and run by the threads */
+	uint64_t submitted;
+	uint64_t executed;
+
+		/* Events dropped by a full queue, or still queued on destruction */
+	uint64_t dropped;
+
+		/* Number of reports which had to wait for a free slot (BLOCK) */
+	uint64_t blocked;
+
+		/* Events currently waiting, and the most seen at once */
+	size_t queueDepth;
+	size_t maxQueueDepth;
+};
+
+//------------------------------------------------------------ Class definition
+/*
+ * The events of a Sphero run in the order they were reported, one at a
+ * time, even when the executor has several threads : a thread takes the
+ * oldest event of a Sphero which is not already running elsewhere. A
+ * single executor can thus be shared by several Spheros, their callbacks
+ * running in parallel.
+ *
+ * The queued events are copied into slots allocated once, so that the
+ * reporting thread does not allocate in steady state.
+ */
+class CallbackExecutor
+{
+	public:
+
+		//----------------------------------------------------------- Operators
+			//No sense
+		CallbackExecutor& operator=(const CallbackExecutor&) = delete;
+
+		//--------------------------------------------- Constructors/Destructor
+			//No sense
+		CallbackExecutor(const CallbackExecutor&) = delete;
+
+		/**
+		 * @brief CallbackExecutor : Constructor. Starts the threads
+		 * @param nbThreads : The number of threads (at least 1)
+		 * @param capacity : The most events queued at once (at least 1)
+		 * @param overflow : What to do with an event when the queue is full
+		 */
+		CallbackExecutor(size_t nbThreads = 1,
+				size_t capacity = EXECUTOR_DEFAULT_CAPACITY,
+				overflowPolicy overflow = overflowPolicy::DROP_OLDEST);
+
+		/**
+		 * Stops the threads, once their running callbacks return. The events
+		 * still queued are dropped
+		 */
+		virtual ~CallbackExecutor();
+
+		//------------------------------------------------------ Public methods
+
+		/**
+		 * @brief submit : Queues an event of a Sphero
+		 * @param sphero : The Sphero whose listeners will be called
+		 * @param event : The event, copied
+		 * @return false if the executor is stopping
+		 */
+		bool submit(Sphero* sphero, const callbackEvent& event);
+
+		/**
+		 * @brief drain : Waits until no event of a Sphero is queued or
+		 * 				  running. Called from a thread of the executor, the
+		 * 				  queued events of the Sphero are dropped instead
+		 * @param sphero : The Sphero
+		 */
+		void drain(Sphero* sphero);
+
+		/**
+		 * @return A consistent copy of the executor counters
+		 */
+		ExecutorStats getStats();
+
+		/**
+		 * @return The number of threads
+		 */
+		size_t getNbThreads();
+
+	private:
+		//------------------------------------------------------- Private types
+		struct task
+		{
+			Sphero* sphero;
+			callbackEvent event;
+
+				/* Keeps its capacity from an event to the next */
+			std::vector<uint8_t> payload;
+		};
+
+		struct worker
+		{
+			CallbackExecutor* executor;
+			pthread_t thread;
+
+				/* The Sphero whose event is running, NULL if none */
+			Sphero* running;
+		};
+
+		//----------------------------------------------------- Private methods
+		static void* workerRoutine(void* worker_ptr);
+
+		/**
+		 * @brief isWorker : The lock must be held
+		 * @return true if the calling thread is one of the executor threads
+		 */
+		bool isWorker();
+
+		/**
+		 * @brief isRunning : The lock must be held
+		 * @param sphero : A Sphero
+		 * @return true if an event of the Sphero runs on a thread
+		 */
+		bool isRunning(Sphero* sphero);
+
+		/**
+		 * @brief nextRunnable : The lock must be held
+		 * @return The position from the head of the oldest event whose
+		 * 		   Sphero is not running, _count if there is none
+		 */
+		size_t nextRunnable();
+
+		/**
+		 * @brief removeAt : Removes a queued event, keeping the order of the
+		 * 					others. The lock must be held
+		 * @param position : The position of the event from the head
+		 */
+		void removeAt(size_t position);
+
+		/**
+		 * @brief slotAt : The lock must be held
+		 * @param position : A position from the head
+		 * @return The slot of the queued event
+		 */
+		task& slotAt(size_t position);
+
+		//-------------------------------------------------- Private attributes
+		overflowPolicy _overflow;
+
+			/* Circular queue : _count events from _head */
+		std::vector<task> _queue;
+		size_t _head;
+		size_t _count;
+
+		std::vector<worker> _workers;
+		bool _stop;
+
+		ExecutorStats _stats;
+
+		pthread_mutex_t _lock;
+		pthread_cond_t _notEmpty;
+		pthread_cond_t _notFull;
+		pthread_cond_t _idle;
+};
+
+#endif // CALLBACKEXECUTOR_HPP
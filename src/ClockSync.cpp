@@ -0,0 +1,325 @@
+/******************************************************************************
+	ClockSync  -  Estimates the offset and drift of the Sphero millisecond
+				  clock against the host monotonic clock, from periodic
+				  pollPacketTimes probes
+							-------------------
+	started                : 17/10/2026
+******************************************************************************/
+
+//------------------------------------------------------------- System includes
+#include <ctime>
+
+//-------------------------------------------------------------- Local includes
+#include "ClockSync.hpp"
+
+//--------------------------------------------- Constructors/Destructor
+
+ClockSync::ClockSync():_running(false), _stop(false),
+	_periodMs(CLOCK_SYNC_PERIOD_MS), _probe(NULL), _context(NULL)
+{
+	pthread_mutex_init(&_lock, NULL);
+	pthread_mutex_init(&_threadLock, NULL);
+
+	pthread_condattr_t condAttr;
+	pthread_condattr_init(&condAttr);
+	pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC);
+	pthread_cond_init(&_wake, &condAttr);
+	pthread_condattr_destroy(&condAttr);
+
+	reset();
+}
+
+
+ClockSync::~ClockSync()
+{
+	stop();
+
+	pthread_cond_destroy(&_wake);
+	pthread_mutex_destroy(&_threadLock);
+	pthread_mutex_destroy(&_lock);
+}
+
+
+//------------------------------------------------------ Public methods
+
+/**
+ * @brief start : Starts the probe thread
+ * @param periodMs : The delay between two probes
+ * @param probe : Sends a probe
+ * @param context : The probe argument
+ * @return false if it is already running
+ */
+bool ClockSync::start(unsigned int periodMs, clockProbe_t probe, void* context)
+{
+	pthread_mutex_lock(&_threadLock);
+	if(_running)
+	{
+		pthread_mutex_unlock(&_threadLock);
+		return false;
+	}
+
+	_periodMs = periodMs == 0 ? 1 : periodMs;
+	_probe = probe;
+	_context = context;
+	_stop = false;
+	_running = pthread_create(&_thread, NULL, probeRoutine, this) == 0;
+	bool running = _running;
+	pthread_mutex_unlock(&_threadLock);
+
+	return running;
+}
+
+
+/**
+ * @brief stop : Stops the probe thread. Answers of the probes already sent
+ * 				may still be added
+ */
+void ClockSync::stop()
+{
+	pthread_mutex_lock(&_threadLock);
+	if(!_running)
+	{
+		pthread_mutex_unlock(&_threadLock);
+		return;
+	}
+	_stop = true;
+	pthread_cond_signal(&_wake);
+	pthread_mutex_unlock(&_threadLock);
+
+	pthread_join(_thread, NULL);
+
+	pthread_mutex_lock(&_threadLock);
+	_running = false;
+	pthread_mutex_unlock(&_threadLock);
+}
+
+
+/**
+ * @return true while the probe thread runs
+ */
+bool ClockSync::isRunning()
+{
+	pthread_mutex_lock(&_threadLock);
+	bool running = _running;
+	pthread_mutex_unlock(&_threadLock);
+
+	return running;
+}
+
+
+/**
+ * @brief reset : Forgets every probe (the Sphero clock changed)
+ */
+void ClockSync::reset()
+{
+	pthread_mutex_lock(&_lock);
+	_nbSamples = 0;
+	_nbKept = 0;
+	_lastDeviceMs = 0;
+	_deviceBaseMs = 0;
+	_reference = sample();
+	_hostRefUs = 0;
+	_rate = 1.0;
+	pthread_mutex_unlock(&_lock);
+}
+
+
+/**
+ * @brief addSample : Adds the timestamps of an answered probe
+ * @param sentUs : T1, host monotonic time of the sending
+ * @param deviceReceivedMs : T2, Sphero time of the reception
+ * @param deviceSentMs : T3, Sphero time of the answer
+ * @param receivedUs : T4, host monotonic time of the answer
+ */
+void ClockSync::addSample(uint64_t sentUs, uint32_t deviceReceivedMs,
+		uint32_t deviceSentMs, uint64_t receivedUs)
+{
+	pthread_mutex_lock(&_lock);
+
+	if(_nbSamples == 0)
+	{
+		_lastDeviceMs = deviceReceivedMs;
+		_deviceBaseMs = 0;
+	}
+
+		//Differences are taken on 32 bits : the Sphero clock may wrap
+	int64_t receivedMs = _deviceBaseMs + (int32_t) (deviceReceivedMs - _lastDeviceMs);
+	int64_t answeredMs = _deviceBaseMs + (int32_t) (deviceSentMs - _lastDeviceMs);
+	_lastDeviceMs = deviceSentMs;
+	_deviceBaseMs = answeredMs;
+
+	int64_t rttUs = (int64_t) (receivedUs - sentUs) - (answeredMs - receivedMs) * 1000;
+
+	sample& probe = _filter[_nbSamples % CLOCK_FILTER_SIZE];
+	probe.deviceUs = (receivedMs + answeredMs) * 500;
+	probe.hostUs = (int64_t) (sentUs + receivedUs) / 2;
+	probe.rttUs = rttUs < 0 ? 0 : (uint32_t) rttUs;
+	++_nbSamples;
+
+		//Fastest probe of the window
+	size_t nbFiltered = _nbSamples < CLOCK_FILTER_SIZE ? _nbSamples : CLOCK_FILTER_SIZE;
+	const sample* fastest = &probe;
+	for(size_t i = 0 ; i < nbFiltered ; ++i)
+	{
+		if(_filter[i].rttUs < fastest->rttUs)
+		{
+			fastest = &_filter[i];
+		}
+	}
+
+	if(_nbSamples % CLOCK_FILTER_SIZE == 0)
+	{
+			//One probe kept per window : the kept ones span a longer time
+		_history[_nbKept % CLOCK_HISTORY_SIZE] = *fastest;
+		++_nbKept;
+		fit();
+	}
+	else if(_nbKept == 0)
+	{
+			//Until the first window is full, the offset alone
+		_reference = *fastest;
+		_hostRefUs = fastest->hostUs;
+		_rate = 1.0;
+	}
+
+	pthread_mutex_unlock(&_lock);
+}
+
+
+/**
+ * @brief toHostUs : Converts a Sphero timestamp (collision...)
+ * @param deviceMs : The Sphero time, in ms
+ * @param hostUs : Receives the host monotonic time, in µs
+ * @return false while no probe was answered
+ */
+bool ClockSync::toHostUs(uint32_t deviceMs, uint64_t& hostUs)
+{
+	pthread_mutex_lock(&_lock);
+	if(_nbSamples == 0)
+	{
+		pthread_mutex_unlock(&_lock);
+		return false;
+	}
+
+	int64_t deviceUs = (_deviceBaseMs + (int32_t) (deviceMs - _lastDeviceMs)) * 1000;
+	double host = _hostRefUs + _rate * (deviceUs - _reference.deviceUs);
+	pthread_mutex_unlock(&_lock);
+
+	hostUs = host < 0 ? 0 : (uint64_t) host;
+	return true;
+}
+
+
+/**
+ * @return The current estimation
+ */
+ClockEstimate ClockSync::getEstimate()
+{
+	ClockEstimate estimate = ClockEstimate();
+
+	pthread_mutex_lock(&_lock);
+	estimate.nbSamples = _nbSamples;
+	estimate.synchronized = _nbSamples > 0;
+	if(estimate.synchronized)
+	{
+			//Sphero time of the reference, before unwrapping
+		int64_t deviceUs = _reference.deviceUs
+			- (_deviceBaseMs - (int64_t) _lastDeviceMs) * 1000;
+		estimate.offsetUs = (int64_t) _hostRefUs - deviceUs;
+		estimate.driftPpm = (1.0 / _rate - 1.0) * 1e6;
+		estimate.rttUs = _reference.rttUs;
+		estimate.updatedAtUs = _reference.hostUs;
+	}
+	pthread_mutex_unlock(&_lock);
+
+	return estimate;
+}
+
+
+//----------------------------------------------------- Private methods
+
+void* ClockSync::probeRoutine(void* clock_ptr)
+{
+	ClockSync* clock = (ClockSync*) clock_ptr;
+
+	pthread_mutex_lock(&clock->_threadLock);
+	while(!clock->_stop)
+	{
+		pthread_mutex_unlock(&clock->_threadLock);
+		clock->_probe(clock->_context);
+		pthread_mutex_lock(&clock->_threadLock);
+
+		struct timespec deadline;
+		clock_gettime(CLOCK_MONOTONIC, &deadline);
+		deadline.tv_sec += clock->_periodMs / 1000;
+		deadline.tv_nsec += (clock->_periodMs % 1000) * 1000000L;
+		if(deadline.tv_nsec >= 1000000000L)
+		{
+			++deadline.tv_sec;
+			deadline.tv_nsec -= 1000000000L;
+		}
+
+		while(!clock->_stop && pthread_cond_timedwait(&clock->_wake,
+					&clock->_threadLock, &deadline) == 0)
+		{ }
+	}
+	pthread_mutex_unlock(&clock->_threadLock);
+
+	return NULL;
+}
+
+
+/**
+ * @brief fit : Updates the line through the kept probes
+ *
+ * Contract: _lock is held
+ */
+void ClockSync::fit()
+{
+	size_t nbPoints = _nbKept < CLOCK_HISTORY_SIZE ? _nbKept : CLOCK_HISTORY_SIZE;
+	const sample& latest = _history[(_nbKept - 1) % CLOCK_HISTORY_SIZE];
+
+		//Relative to the latest probe, to keep the precision of doubles
+	double meanX = 0, meanY = 0;
+	int64_t oldest = 0;
+	for(size_t i = 0 ; i < nbPoints ; ++i)
+	{
+		const sample& point = _history[i];
+		meanX += point.deviceUs - latest.deviceUs;
+		meanY += point.hostUs - latest.hostUs;
+		if(point.deviceUs - latest.deviceUs < oldest)
+		{
+			oldest = point.deviceUs - latest.deviceUs;
+		}
+	}
+	meanX /= nbPoints;
+	meanY /= nbPoints;
+
+	double rate = 1.0;
+	if(-oldest >= CLOCK_MIN_DRIFT_SPAN_US)
+	{
+		double sxx = 0, sxy = 0;
+		for(size_t i = 0 ; i < nbPoints ; ++i)
+		{
+			double dx = _history[i].deviceUs - latest.deviceUs - meanX;
+			double dy = _history[i].hostUs - latest.hostUs - meanY;
+			sxx += dx * dx;
+			sxy += dx * dy;
+		}
+		rate = sxy / sxx;
+
+		double maxError = CLOCK_MAX_DRIFT_PPM / 1e6;
+		if(rate < 1.0 - maxError)
+		{
+			rate = 1.0 - maxError;
+		}
+		else if(rate > 1.0 + maxError)
+		{
+			rate = 1.0 + maxError;
+		}
+	}
+
+	_rate = rate;
+	_reference = latest;
+	_hostRefUs = latest.hostUs + meanY - rate * meanX;
+}
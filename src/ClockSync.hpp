@@ -0,0 +1,197 @@
+/******************************************************************************
+	ClockSync  -  Estimates the offset and drift of the Sphero millisecond
+				  clock against the host monotonic clock, from periodic
+				  pollPacketTimes probes
+							-------------------
+	started                : 17/10/2026
+******************************************************************************/
+
+#ifndef CLOCKSYNC_HPP
+#define CLOCKSYNC_HPP
+
+//------------------------------------------------------------- System includes
+#include <pthread.h>
+#include <cstdint>
+#include <cstddef>
+
+//------------------------------------------------------------------- Constants
+
+	/* Delay between two probes, in milliseconds */
+static unsigned int const CLOCK_SYNC_PERIOD_MS = 1000;
+
+	/* Probes among which the fastest one is kept (NTP clock filter) */
+static size_t const CLOCK_FILTER_SIZE = 8;
+
+	/* Kept probes the drift is fitted on */
+static size_t const CLOCK_HISTORY_SIZE = 16;
+
+	/* Below this span of kept probes, in µs, the drift is not estimated :
+	 * the millisecond resolution of the Sphero would dominate it */
+static int64_t const CLOCK_MIN_DRIFT_SPAN_US = 10000000;
+
+	/* Drifts beyond it are taken for measurement errors, in ppm */
+static double const CLOCK_MAX_DRIFT_PPM = 1000.0;
+
+//----------------------------------------------------------------------- Types
+
+	/* Called by the probe thread with the context given to start. Sends
+	 * a pollPacketTimes command, which answer is given to addSample */
+typedef void (*clockProbe_t)(void* context);
+
+/*
+ * State of the estimation. Around updatedAtUs :
+ * 		host µs = device ms * 1000 + offsetUs
+ */
+struct ClockEstimate
+{
+		/* At least one probe was answered since the last reset */
+	bool synchronized;
+
+	int64_t offsetUs;
+
+		/* Rate error of the Sphero clock, positive when it runs fast. 0
+		 * until the kept probes span CLOCK_MIN_DRIFT_SPAN_US */
+	double driftPpm;
+
+		/* Round-trip time of the probe the offset refers to */
+	uint32_t rttUs;
+
+		/* Probes answered since the last reset */
+	uint32_t nbSamples;
+
+		/* Host monotonic time of that probe */
+	uint64_t updatedAtUs;
+};
+
+//------------------------------------------------------------ Class definition
+/*
+ * Each probe gives the four NTP timestamps : host send time T1, Sphero
+ * reception T2 and answer T3 times, host reception time T4. The probe with
+ * the shortest round trip suffers the least from the queues : only the
+ * fastest one of every CLOCK_FILTER_SIZE probes is kept, and a line
+ * host time = f(device time) is fitted by least squares through the kept
+ * ones. Until the first window is full, the fastest probe so far gives the
+ * offset alone.
+ */
+class ClockSync
+{
+	public:
+
+		//----------------------------------------------------------- Operators
+			//No sense
+		ClockSync& operator=(const ClockSync&) = delete;
+
+		//--------------------------------------------- Constructors/Destructor
+			//No sense
+		ClockSync(const ClockSync&) = delete;
+
+		ClockSync();
+
+		virtual ~ClockSync();
+
+		//------------------------------------------------------ Public methods
+
+		/**
+		 * @brief start : Starts the probe thread
+		 * @param periodMs : The delay between two probes
+		 * @param probe : Sends a probe
+		 * @param context : The probe argument
+		 * @return false if it is already running
+		 */
+		bool start(unsigned int periodMs, clockProbe_t probe, void* context);
+
+		/**
+		 * @brief stop : Stops the probe thread. Answers of the probes already
+		 * 				sent may still be added
+		 */
+		void stop();
+
+		/**
+		 * @return true while the probe thread runs
+		 */
+		bool isRunning();
+
+		/**
+		 * @brief reset : Forgets every probe (the Sphero clock changed)
+		 */
+		void reset();
+
+		/**
+		 * @brief addSample : Adds the timestamps of an answered probe
+		 * @param sentUs : T1, host monotonic time of the sending
+		 * @param deviceReceivedMs : T2, Sphero time of the reception
+		 * @param deviceSentMs : T3, Sphero time of the answer
+		 * @param receivedUs : T4, host monotonic time of the answer
+		 */
+		void addSample(uint64_t sentUs, uint32_t deviceReceivedMs,
+				uint32_t deviceSentMs, uint64_t receivedUs);
+
+		/**
+		 * @brief toHostUs : Converts a Sphero timestamp (collision...)
+		 * @param deviceMs : The Sphero time, in ms
+		 * @param hostUs : Receives the host monotonic time, in µs
+		 * @return false while no probe was answered
+		 */
+		bool toHostUs(uint32_t deviceMs, uint64_t& hostUs);
+
+		/**
+		 * @return The current estimation
+		 */
+		ClockEstimate getEstimate();
+
+	private:
+		//------------------------------------------------------- Private types
+		struct sample
+		{
+				/* Sphero time of the middle of the probe, unwrapped */
+			int64_t deviceUs;
+
+				/* Host time of the middle of the probe */
+			int64_t hostUs;
+
+			uint32_t rttUs;
+		};
+
+		//----------------------------------------------------- Private methods
+		static void* probeRoutine(void* clock_ptr);
+
+		/**
+		 * @brief fit : Updates the line through the kept probes
+		 *
+		 * Contract: _lock is held
+		 */
+		void fit();
+
+		//-------------------------------------------------- Private attributes
+
+			/* Protects everything below but the thread control */
+		pthread_mutex_t _lock;
+
+			/* Last probes, _nbSamples % CLOCK_FILTER_SIZE being the next */
+		sample _filter[CLOCK_FILTER_SIZE];
+		uint32_t _nbSamples;
+
+		sample _history[CLOCK_HISTORY_SIZE];
+		size_t _nbKept;
+
+			/* Unwrapping of the 32 bits Sphero time */
+		uint32_t _lastDeviceMs;
+		int64_t _deviceBaseMs;
+
+			/* host µs = _hostRefUs + _rate * (device µs - _reference.deviceUs) */
+		sample _reference;
+		double _hostRefUs;
+		double _rate;
+
+			/* Probe thread */
+		pthread_mutex_t _threadLock;
+		pthread_cond_t _wake;
+		pthread_t _thread;
+		bool _running;
+		bool _stop;
+		unsigned int _periodMs;
+		clockProbe_t _probe;
+		void* _context;
+};
+
+#endif // CLOCKSYNC_HPP
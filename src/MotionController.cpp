@@ -0,0 +1,616 @@
+/******************************************************************************
+	MotionController  -  Closed-loop drive to a position or along a
+						 trajectory, stepped by the streaming frames : PID
+						 on the distance and on the heading, roll commands
+						 sent only when the setpoint changes
+							-------------------
+	started                : 17/10/2026
+******************************************************************************/
+
+//------------------------------------------------------------- System includes
+#include <cmath>
+#include <algorithm>
+
+//-------------------------------------------------------------- Local includes
+#include "MotionController.hpp"
+#include "Sphero.hpp"
+#include "packets/Toolbox.hpp"
+#include "TimerWheel.hpp"
+
+//------------------------------------------------------------------- Functions
+
+	//Angle in [-180, 180)
+static double wrapAngle(double degrees)
+{
+	degrees = fmod(degrees + 180.0, 360.0);
+	return (degrees < 0 ? degrees + 360.0 : degrees) - 180.0;
+}
+
+
+	//Heading of a vector of the plane : 0 faces +Y, 90 faces +X
+static double headingOf(double x, double y)
+{
+	return atan2(x, y) * 180.0 / M_PI;
+}
+
+
+static double clamp(double value, double low, double high)
+{
+	return value < low ? low : (value > high ? high : value);
+}
+
+//--------------------------------------------- Constructors/Destructor
+
+MotionParams::MotionParams():maxSpeed(90), minSpeed(20), toleranceCm(2),
+	distanceKp(MOTION_DISTANCE_KP), distanceKi(MOTION_DISTANCE_KI),
+	distanceKd(MOTION_DISTANCE_KD), headingKp(MOTION_HEADING_KP),
+	headingKi(MOTION_HEADING_KI), headingKd(MOTION_HEADING_KD),
+	speedDeadband(MOTION_SPEED_DEADBAND),
+	headingDeadband(MOTION_HEADING_DEADBAND),
+	commandIntervalMs(MOTION_COMMAND_INTERVAL_MS), stopOnCollision(true),
+	stallMs(MOTION_STALL_MS), timeoutMs(0)
+{
+}
+
+
+MotionController::MotionController(Sphero* sphero):_sphero(sphero),
+	_active(false), _drive(0), _following(false), _posted(false)
+{
+	pthread_mutex_init(&_sendLock, NULL);
+	pthread_mutex_init(&_lock, NULL);
+}
+
+
+MotionController::~MotionController()
+{
+	TimerWheel::shared().cancel(this);
+
+	pthread_mutex_lock(&_lock);
+	if(_active)
+	{
+		finish(motionOutcome::CANCELLED, false);
+	}
+	pthread_mutex_unlock(&_lock);
+
+	pthread_mutex_destroy(&_lock);
+	pthread_mutex_destroy(&_sendLock);
+}
+
+
+//------------------------------------------------------ Public methods
+
+/**
+ * @brief moveTo : Starts driving to a position, ending the drive in progress
+ * 				  (PREEMPTED)
+ * @param x : The target abscissa, in cm
+ * @param y : The target ordinate, in cm
+ * @param params : The drive settings
+ * @param start : The current kinematic state
+ * @return The end of the drive
+ */
+std::future<MotionResult> MotionController::moveTo(int16_t x, int16_t y,
+		const MotionParams& params, const KinematicSnapshot& start)
+{
+	pthread_mutex_lock(&_lock);
+	std::future<MotionResult> result = begin(x, y, params, start);
+	schedule(_startUs);
+	pthread_mutex_unlock(&_lock);
+
+	return result;
+}
+
+
+/**
+ * @brief follow : Starts following a trajectory, ending the drive in
+ * 				  progress (PREEMPTED)
+ * @param trajectory : The planned path, copied
+ * @param params : The drive settings
+ * @param start : The current kinematic state
+ * @return The end of the drive, at the end of the path
+ */
+std::future<MotionResult> MotionController::follow(const Trajectory& trajectory,
+		const MotionParams& params, const KinematicSnapshot& start)
+{
+	const std::vector<TrajectorySample>& samples = trajectory.getSamples();
+	if(samples.empty())
+	{
+		return fail(motionOutcome::REACHED, start);
+	}
+	const TrajectorySample& end = samples.back();
+
+	pthread_mutex_lock(&_lock);
+	std::future<MotionResult> result = begin((int16_t) lround(end.x),
+			(int16_t) lround(end.y), params, start);
+	_following = true;
+	_trajectory = trajectory;
+	_pathS = 0;
+	_closestCm = _trajectory.getLength();
+	schedule(_startUs);
+	pthread_mutex_unlock(&_lock);
+
+	return result;
+}
+
+
+/**
+ * @brief cancel : Stops the Sphero and ends the drive in progress (CANCELLED)
+ * @return false if there was none
+ */
+bool MotionController::cancel()
+{
+	pthread_mutex_lock(&_lock);
+	bool active = _active;
+	if(active)
+	{
+		finish(motionOutcome::CANCELLED, true);
+	}
+	pthread_mutex_unlock(&_lock);
+
+	flush();
+
+	return active;
+}
+
+
+/**
+ * @return true while a drive is in progress
+ */
+bool MotionController::isActive()
+{
+	pthread_mutex_lock(&_lock);
+	bool active = _active;
+	pthread_mutex_unlock(&_lock);
+
+	return active;
+}
+
+
+/**
+ * @brief update : Steps the drive in progress
+ * @param state : The kinematic state of the latest streaming frame
+ *
+ * Contract: called by the reception thread
+ */
+void MotionController::update(const KinematicSnapshot& state)
+{
+	pthread_mutex_lock(&_lock);
+	if(!_active || state.timestampUs <= _lastUpdateUs)
+	{
+		pthread_mutex_unlock(&_lock);
+		return;
+	}
+
+	double dt = _lastUpdateUs == 0 ? 0 : (state.timestampUs - _lastUpdateUs) / 1e6;
+	uint64_t now = state.timestampUs;
+	_lastUpdateUs = now;
+	_state = state;
+	++_updates;
+
+	if(_params.timeoutMs != 0 && now >= _startUs + _params.timeoutMs * 1000ull)
+	{
+		finish(motionOutcome::TIMED_OUT, true);
+		pthread_mutex_unlock(&_lock);
+		flush();
+		return;
+	}
+
+		//Distances in cm, speeds in cm/s
+	double vx = state.speedX / 10.0;
+	double vy = state.speedY / 10.0;
+	double speed = hypot(vx, vy);
+	double distance = hypot(_targetX - state.x, _targetY - state.y);
+
+		//Point aimed at, and distance left to drive
+	double aimX = _targetX;
+	double aimY = _targetY;
+	double remaining = distance;
+	if(_following)
+	{
+		_pathS = _trajectory.locate(state.x, state.y, _pathS, MOTION_SEARCH_WINDOW);
+		remaining = _trajectory.getLength() - _pathS;
+
+		TrajectorySample aim = _trajectory.at(_pathS
+				+ std::max(MOTION_MIN_LOOKAHEAD, speed * MOTION_LOOKAHEAD_S));
+		aimX = aim.x;
+		aimY = aim.y;
+	}
+
+		//A closed path starts at its end : only its last stretch counts
+	if(distance <= _params.toleranceCm && remaining <= MOTION_MIN_LOOKAHEAD)
+	{
+		if(speed * 10 < MOTION_SETTLED_SPEED)
+		{
+			finish(motionOutcome::REACHED, true);
+		}
+		else
+		{
+			send(0, _sentHeading, now, false);
+		}
+		_progressUs = now;
+		pthread_mutex_unlock(&_lock);
+		flush();
+		return;
+	}
+
+	if(remaining < _closestCm - 1)
+	{
+		_closestCm = remaining;
+		_progressUs = now;
+	}
+	else if(_params.stallMs != 0 && now >= _progressUs + _params.stallMs * 1000ull)
+	{
+		finish(motionOutcome::STALLED, true);
+		pthread_mutex_unlock(&_lock);
+		flush();
+		return;
+	}
+
+	double dx = aimX - state.x;
+	double dy = aimY - state.y;
+	double heading = steer(headingOf(dx, dy), vx, vy, dt);
+
+	double command;
+	if(_following)
+	{
+			//Planned speed where the Sphero will be once it responded
+		command = _trajectory.at(_pathS + speed * MOTION_RESPONSE_S).speed
+			* TRAJECTORY_UNITS_PER_CM_S;
+		command = clamp(command, _params.minSpeed, 255);
+	}
+	else
+	{
+			//Derivative on the measured closing speed, no kick when the
+			//target changes
+		double closing = (vx * dx + vy * dy) / distance;
+		if(_params.distanceKi > 0)
+		{
+			_distanceIntegral = clamp(_distanceIntegral + distance * dt, 0,
+					_params.maxSpeed / _params.distanceKi);
+		}
+		command = _params.distanceKp * distance
+			+ _params.distanceKi * _distanceIntegral
+			- _params.distanceKd * closing;
+		command = clamp(command, _params.minSpeed, _params.maxSpeed);
+	}
+
+	send((uint8_t) lround(command), (uint16_t) lround(heading) % 360, now, false);
+	pthread_mutex_unlock(&_lock);
+
+	flush();
+}
+
+
+/**
+ * @brief collided : Ends the drive in progress if it stops on collisions
+ */
+void MotionController::collided()
+{
+	pthread_mutex_lock(&_lock);
+	if(_active && _params.stopOnCollision)
+	{
+		finish(motionOutcome::COLLISION, true);
+	}
+	pthread_mutex_unlock(&_lock);
+
+	flush();
+}
+
+
+/**
+ * @brief disconnected : Ends the drive in progress without command
+ */
+void MotionController::disconnected()
+{
+	pthread_mutex_lock(&_lock);
+	if(_active)
+	{
+		finish(motionOutcome::DISCONNECTED, false);
+	}
+	pthread_mutex_unlock(&_lock);
+}
+
+
+/**
+ * @brief fail : Ends at once a drive which cannot start
+ * @param outcome : The reason
+ * @param state : The current kinematic state
+ * @return A ready future
+ */
+std::future<MotionResult> MotionController::fail(motionOutcome outcome,
+		const KinematicSnapshot& state)
+{
+	MotionResult result = MotionResult();
+	result.outcome = outcome;
+	result.x = state.x;
+	result.y = state.y;
+
+	std::promise<MotionResult> promise;
+	promise.set_value(result);
+	return promise.get_future();
+}
+
+
+//----------------------------------------------------- Private methods
+
+/**
+ * @brief begin : Ends the drive in progress and resets the state for a new
+ * 				 one
+ * @return The end of the new drive
+ *
+ * Contract: _lock is held
+ */
+std::future<MotionResult> MotionController::begin(int16_t x, int16_t y,
+		const MotionParams& params, const KinematicSnapshot& start)
+{
+	if(_active)
+	{
+		finish(motionOutcome::PREEMPTED, false);
+	}
+
+	_promise = std::promise<MotionResult>();
+	std::future<MotionResult> result = _promise.get_future();
+
+	_active = true;
+	++_drive;
+	_targetX = x;
+	_targetY = y;
+	_params = params;
+	if(_params.minSpeed > _params.maxSpeed)
+	{
+		_params.minSpeed = _params.maxSpeed;
+	}
+	_following = false;
+
+	_startUs = packet_toolbox::monotonicUs();
+	_state = start;
+	_lastUpdateUs = 0;
+
+	_distanceIntegral = 0;
+	_headingIntegral = 0;
+	_lastHeadingError = 0;
+	_lastBearing = 0;
+	_courseKnown = false;
+
+	_closestCm = hypot(x - start.x, y - start.y);
+	_progressUs = _startUs;
+
+	_commands = 0;
+	_updates = 0;
+	_sent = false;
+	_sentSpeed = 0;
+	_sentHeading = 0;
+	_sentUs = 0;
+
+	return result;
+}
+
+
+/**
+ * @brief steer : Corrects a bearing by the heading PID
+ * @param bearing : The direction to go, in °
+ * @param vx, vy : The measured velocity, in cm/s
+ * @param dt : The time since the previous packet, in s
+ * @return The heading setpoint, in [0, 360)
+ *
+ * Contract: _lock is held
+ */
+double MotionController::steer(double bearing, double vx, double vy, double dt)
+{
+	double correction = _params.headingKi * _headingIntegral;
+	bool steady = fabs(wrapAngle(bearing - _lastBearing)) < MOTION_STEADY_BEARING;
+	_lastBearing = bearing;
+
+	if(hypot(vx, vy) * 10 >= MOTION_COURSE_MIN_SPEED && _sent && _sentSpeed > 0)
+	{
+		double error = wrapAngle(bearing - headingOf(vx, vy));
+
+			//Turning around : the course says nothing of the heading error
+		if(fabs(error) < 90)
+		{
+			if(_params.headingKi > 0 && steady)
+			{
+				_headingIntegral = clamp(_headingIntegral + error * dt,
+						-MOTION_MAX_CORRECTION / _params.headingKi,
+						MOTION_MAX_CORRECTION / _params.headingKi);
+			}
+			double derivative = (_courseKnown && dt > 0)
+				? (error - _lastHeadingError) / dt : 0;
+			_lastHeadingError = error;
+			_courseKnown = true;
+
+			correction = _params.headingKp * error
+				+ _params.headingKi * _headingIntegral
+				+ _params.headingKd * derivative;
+		}
+	}
+	else
+	{
+		_courseKnown = false;
+	}
+	correction = clamp(correction, -MOTION_MAX_CORRECTION, MOTION_MAX_CORRECTION);
+
+	double heading = wrapAngle(bearing + correction);
+	return heading < 0 ? heading + 360 : heading;
+}
+
+
+
+/**
+ * @brief send : Posts a roll command for flush if it differs enough from the
+ * 				last one, or the last one is getting old
+ * @param speed : The speed setpoint
+ * @param heading : The heading setpoint, in °
+ * @param nowUs : The time of the frame the setpoint comes from
+ * @param force : Posts it anyway
+ *
+ * Contract: _lock is held
+ */
+void MotionController::send(uint8_t speed, uint16_t heading, uint64_t nowUs,
+		bool force)
+{
+	if(!force && _sent)
+	{
+		int speedChange = abs((int) speed - (int) _sentSpeed);
+		double headingChange = fabs(wrapAngle((double) heading - _sentHeading));
+
+			//Stopped : the heading does not matter
+		bool changed = speedChange >= _params.speedDeadband
+			|| (speed > 0 && headingChange >= _params.headingDeadband);
+		bool stopping = (speed == 0) != (_sentSpeed == 0);
+		bool due = nowUs >= _sentUs + _params.commandIntervalMs * 1000ull;
+		bool stale = nowUs >= _sentUs + MOTION_REFRESH_MS * 1000ull;
+
+			//Starts and stops are not delayed
+		if(!stopping && !(changed && due) && !stale)
+		{
+			return;
+		}
+	}
+
+		//A later command replaces the one not sent yet
+	_posted = true;
+	_postedSpeed = speed;
+	_postedHeading = heading;
+
+	_sentSpeed = speed;
+	_sentHeading = heading;
+	_sentUs = nowUs;
+	_sent = true;
+	++_commands;
+}
+
+
+/**
+ * @brief flush : Sends the posted roll command, unless another thread is
+ * 				 sending one : that thread sends it next
+ *
+ * Contract: _lock is not held
+ */
+void MotionController::flush()
+{
+		//Never waits : the sending thread may be blocked by a batch
+	while(pthread_mutex_trylock(&_sendLock) == 0)
+	{
+		pthread_mutex_lock(&_lock);
+		bool posted = _posted;
+		uint8_t speed = _postedSpeed;
+		uint16_t heading = _postedHeading;
+		_posted = false;
+		pthread_mutex_unlock(&_lock);
+
+		if(posted)
+		{
+			_sphero->roll(speed, heading);
+		}
+		pthread_mutex_unlock(&_sendLock);
+
+			//Posted while the lock was held, by a thread which gave up
+		pthread_mutex_lock(&_lock);
+		posted = _posted;
+		pthread_mutex_unlock(&_lock);
+
+		if(!posted)
+		{
+			break;
+		}
+	}
+}
+
+
+/**
+ * @brief schedule : Arms the timer of the nearest deadline (timeout or
+ * 					stall) of the drive in progress
+ * @param nowUs : The current time
+ *
+ * Contract: _lock is held
+ */
+void MotionController::schedule(uint64_t nowUs)
+{
+	uint64_t deadline = UINT64_MAX;
+	if(_params.timeoutMs != 0)
+	{
+		deadline = _startUs + _params.timeoutMs * 1000ull;
+	}
+	if(_params.stallMs != 0)
+	{
+		deadline = std::min<uint64_t>(deadline,
+				_progressUs + _params.stallMs * 1000ull);
+	}
+
+	if(deadline != UINT64_MAX)
+	{
+		unsigned int delayMs = deadline > nowUs ? (deadline - nowUs + 999) / 1000 : 0;
+		TimerWheel::shared().schedule(delayMs, onDeadline, this, _drive);
+	}
+}
+
+
+/**
+ * @brief onDeadline : Timer wheel callback. Ends the drive if it timed out
+ * 					  or stalled, or arms the timer again
+ * @param controller_ptr : The controller
+ * @param drive : The drive number the timer was armed for
+ */
+void MotionController::onDeadline(void* controller_ptr, uint32_t drive)
+{
+	MotionController* controller = (MotionController*) controller_ptr;
+	uint64_t now = packet_toolbox::monotonicUs();
+
+	pthread_mutex_lock(&controller->_lock);
+
+		//Ended, or a later drive
+	if(!controller->_active || controller->_drive != drive)
+	{
+		pthread_mutex_unlock(&controller->_lock);
+		return;
+	}
+
+	const MotionParams& params = controller->_params;
+	if(params.timeoutMs != 0
+			&& now >= controller->_startUs + params.timeoutMs * 1000ull)
+	{
+		controller->finish(motionOutcome::TIMED_OUT, true);
+	}
+	else if(params.stallMs != 0
+			&& now >= controller->_progressUs + params.stallMs * 1000ull)
+	{
+		controller->finish(motionOutcome::STALLED, true);
+	}
+	else
+	{
+			//Progress was made since the timer was armed
+		controller->schedule(now);
+	}
+
+	pthread_mutex_unlock(&controller->_lock);
+
+	controller->flush();
+}
+
+
+/**
+ * @brief finish : Ends the drive in progress
+ * @param outcome : How it ended
+ * @param stop : Posts a stop command first
+ *
+ * Contract: _lock is held and a drive is in progress
+ */
+void MotionController::finish(motionOutcome outcome, bool stop)
+{
+	if(stop && !(_sent && _sentSpeed == 0 && outcome == motionOutcome::REACHED))
+	{
+		send(0, _sentHeading, packet_toolbox::monotonicUs(), true);
+	}
+
+	MotionResult result = MotionResult();
+	result.outcome = outcome;
+	result.x = _state.x;
+	result.y = _state.y;
+	result.errorCm = hypot(_targetX - _state.x, _targetY - _state.y);
+	result.durationMs = (packet_toolbox::monotonicUs() - _startUs) / 1000;
+	result.commands = _commands;
+	result.updates = _updates;
+
+	_active = false;
+	_promise.set_value(result);
+}
@@ -0,0 +1,390 @@
+/******************************************************************************
+	MotionController  -  Closed-loop drive to a position or along a
+						 trajectory, stepped by the streaming frames : PID
+						 on the distance and on the heading, roll commands
+						 sent only when the setpoint changes
+							-------------------
+	started                : 17/10/2026
+******************************************************************************/
+
+#ifndef MOTIONCONTROLLER_HPP
+#define MOTIONCONTROLLER_HPP
+
+//------------------------------------------------------------- System includes
+#include <pthread.h>
+#include <cstdint>
+#include <future>
+
+//-------------------------------------------------------------- Local includes
+#include "packets/async/KinematicState.hpp"
+#include "Trajectory.hpp"
+
+//------------------------------------------------------------------- Constants
+
+	/* Distance PID : roll speed units per cm, per cm.s, per cm/s of
+	 * closing speed */
+static double const MOTION_DISTANCE_KP = 1.5;
+static double const MOTION_DISTANCE_KI = 0.1;
+static double const MOTION_DISTANCE_KD = 0.3;
+
+	/* Heading PID, on the angle between the bearing to the target and the
+	 * course over ground : degrees of correction per degree, per degree.s,
+	 * per degree/s */
+static double const MOTION_HEADING_KP = 0.2;
+static double const MOTION_HEADING_KI = 1.0;
+static double const MOTION_HEADING_KD = 0.0;
+
+	/* Largest heading correction, in degrees */
+static double const MOTION_MAX_CORRECTION = 30.0;
+
+	/* Below this speed, in mm/s, the course is not measured */
+static double const MOTION_COURSE_MIN_SPEED = 80.0;
+
+	/* The course error is only integrated while the bearing moves by less
+	 * than this between two packets, in degrees : in curves the course
+	 * lags behind the heading, whatever the yaw error */
+static double const MOTION_STEADY_BEARING = 2.0;
+
+	/* Below this speed, in mm/s, the Sphero is taken as stopped */
+static double const MOTION_SETTLED_SPEED = 30.0;
+
+	/* A roll command is sent when the speed or the heading setpoint moves
+	 * by this much from the last one sent */
+static uint8_t const MOTION_SPEED_DEADBAND = 4;
+static uint16_t const MOTION_HEADING_DEADBAND = 3;
+
+	/* Changed setpoints are not sent closer than this, in ms : the Sphero
+	 * takes about 250 ms to follow a command anyway */
+static unsigned int const MOTION_COMMAND_INTERVAL_MS = 100;
+
+	/* Unchanged setpoints are sent again after this delay, in ms, within
+	 * the default motion timeout of the Sphero (2 s) */
+static unsigned int const MOTION_REFRESH_MS = 1000;
+
+	/* Along a trajectory, the heading aims at the point this far ahead :
+	 * the distance covered in MOTION_LOOKAHEAD_S, at least
+	 * MOTION_MIN_LOOKAHEAD cm */
+static double const MOTION_LOOKAHEAD_S = 0.5;
+static double const MOTION_MIN_LOOKAHEAD = 10.0;
+
+	/* Along a trajectory, the speed setpoint is the planned speed where the
+	 * Sphero will be after its response time, in s */
+static double const MOTION_RESPONSE_S = 0.25;
+
+	/* How far ahead of its last position the Sphero is searched on the
+	 * trajectory, in cm */
+static double const MOTION_SEARCH_WINDOW = 50.0;
+
+	/* Without getting 1 cm closer for this long, in ms, the drive is
+	 * stalled */
+static unsigned int const MOTION_STALL_MS = 1500;
+
+//----------------------------------------------------------------------- Types
+class Sphero;
+
+	/* How a drive ended */
+enum class motionOutcome : uint8_t
+{
+		/* Stopped within the tolerance */
+	REACHED,
+		/* By cancel() */
+	CANCELLED,
+		/* By a newer drive */
+	PREEMPTED,
+		/* A collision was reported (stopOnCollision) */
+	COLLISION,
+		/* No progress (towards the target, or along the trajectory) for
+		 * stallMs */
+	STALLED,
+		/* Not reached after timeoutMs */
+	TIMED_OUT,
+		/* Not connected, or disconnected during the drive */
+	DISCONNECTED,
+		/* The position is not streamed (ODOMETER_X, ODOMETER_Y) */
+	NO_ODOMETRY
+};
+
+/*
+ * Settings of a drive. The constructor gives the defaults
+ */
+struct MotionParams
+{
+	MotionParams();
+
+		/* Roll speed range while out of the tolerance. minSpeed keeps the
+		 * Sphero moving on the last centimeters. Along a trajectory, the
+		 * planned speeds replace maxSpeed */
+	uint8_t maxSpeed;
+	uint8_t minSpeed;
+
+		/* Distance to the target considered reached, in cm */
+	uint8_t toleranceCm;
+
+	double distanceKp, distanceKi, distanceKd;
+	double headingKp, headingKi, headingKd;
+
+	uint8_t speedDeadband;
+	uint16_t headingDeadband;
+
+		/* Least delay between two roll commands, in ms, but for starts
+		 * and stops */
+	unsigned int commandIntervalMs;
+
+	bool stopOnCollision;
+
+		/* 0 for none */
+	unsigned int stallMs;
+	unsigned int timeoutMs;
+};
+
+/*
+ * End of a drive
+ */
+struct MotionResult
+{
+	motionOutcome outcome;
+
+		/* Position at the end, in cm */
+	int16_t x;
+	int16_t y;
+
+		/* Distance to the target at the end, in cm */
+	double errorCm;
+
+	uint32_t durationMs;
+
+		/* Roll commands sent by the controller, the final stop included */
+	uint32_t commands;
+
+		/* Streaming packets the controller was stepped by */
+	uint32_t updates;
+};
+
+//------------------------------------------------------------ Class definition
+/*
+ * Every streaming packet steps the drive in progress, on the reception
+ * thread : the speed setpoint comes from a PID on the distance to the
+ * target (derivative on the measured closing speed), and the heading is
+ * the bearing to the target, corrected by a PID on the angle between that
+ * bearing and the course over ground (a misaligned yaw, a slope...). The
+ * resulting roll command is only sent when it differs enough from the
+ * last one. Within the tolerance the Sphero is stopped, and the drive is
+ * reached once it stands still there.
+ *
+ * Along a trajectory, the Sphero is located on the path, the bearing is
+ * taken to a point ahead on it (pure pursuit) and the speed setpoint is
+ * the planned one : corners are taken without stopping.
+ *
+ * The timeout and the stall delay are also enforced by a timer of the
+ * shared TimerWheel, so that a drive ends even if the stream stops. Roll
+ * commands are decided under the lock and sent once it is released.
+ */
+class MotionController
+{
+	public:
+
+		//----------------------------------------------------------- Operators
+			//No sense
+		MotionController& operator=(const MotionController&) = delete;
+
+		//--------------------------------------------- Constructors/Destructor
+			//No sense
+		MotionController(const MotionController&) = delete;
+
+		/**
+		 * @param sphero : The Sphero the roll commands are sent to
+		 */
+		MotionController(Sphero* sphero);
+
+		virtual ~MotionController();
+
+		//------------------------------------------------------ Public methods
+
+		/**
+		 * @brief moveTo : Starts driving to a position, ending the drive in
+		 * 				  progress (PREEMPTED)
+		 * @param x : The target abscissa, in cm
+		 * @param y : The target ordinate, in cm
+		 * @param params : The drive settings
+		 * @param start : The current kinematic state
+		 * @return The end of the drive
+		 */
+		std::future<MotionResult> moveTo(int16_t x, int16_t y,
+				const MotionParams& params, const KinematicSnapshot& start);
+
+		/**
+		 * @brief follow : Starts following a trajectory, ending the drive
+		 * 				  in progress (PREEMPTED)
+		 * @param trajectory : The planned path, copied
+		 * @param params : The drive settings
+		 * @param start : The current kinematic state
+		 * @return The end of the drive, at the end of the path
+		 */
+		std::future<MotionResult> follow(const Trajectory& trajectory,
+				const MotionParams& params, const KinematicSnapshot& start);
+
+		/**
+		 * @brief cancel : Stops the Sphero and ends the drive in progress
+		 * 				  (CANCELLED)
+		 * @return false if there was none
+		 */
+		bool cancel();
+
+		/**
+		 * @return true while a drive is in progress
+		 */
+		bool isActive();
+
+		/**
+		 * @brief update : Steps the drive in progress
+		 * @param state : The kinematic state of the latest streaming frame
+		 *
+		 * Contract: called by the reception thread
+		 */
+		void update(const KinematicSnapshot& state);
+
+		/**
+		 * @brief collided : Ends the drive in progress if it stops on
+		 * 					collisions
+		 */
+		void collided();
+
+		/**
+		 * @brief disconnected : Ends the drive in progress without command
+		 */
+		void disconnected();
+
+		/**
+		 * @brief fail : Ends at once a drive which cannot start
+		 * @param outcome : The reason
+		 * @param state : The current kinematic state
+		 * @return A ready future
+		 */
+		static std::future<MotionResult> fail(motionOutcome outcome,
+				const KinematicSnapshot& state);
+
+	private:
+		//----------------------------------------------------- Private methods
+
+		/**
+		 * @brief begin : Ends the drive in progress and resets the state for
+		 * 				 a new one
+		 * @return The end of the new drive
+		 *
+		 * Contract: _lock is held
+		 */
+		std::future<MotionResult> begin(int16_t x, int16_t y,
+				const MotionParams& params, const KinematicSnapshot& start);
+
+		/**
+		 * @brief steer : Corrects a bearing by the heading PID
+		 * @param bearing : The direction to go, in °
+		 * @param vx, vy : The measured velocity, in cm/s
+		 * @param dt : The time since the previous packet, in s
+		 * @return The heading setpoint, in [0, 360)
+		 *
+		 * Contract: _lock is held
+		 */
+		double steer(double bearing, double vx, double vy, double dt);
+
+		/**
+		 * @brief send : Posts a roll command for flush if it differs enough
+		 * 				from the last one, or the last one is getting old
+		 * @param speed : The speed setpoint
+		 * @param heading : The heading setpoint, in °
+		 * @param nowUs : The time of the frame the setpoint comes from
+		 * @param force : Posts it anyway
+		 *
+		 * Contract: _lock is held
+		 */
+		void send(uint8_t speed, uint16_t heading, uint64_t nowUs, bool force);
+
+		/**
+		 * @brief flush : Sends the posted roll command, unless another
+		 * 				 thread is sending one : that thread sends it next
+		 *
+		 * Contract: _lock is not held
+		 */
+		void flush();
+
+		/**
+		 * @brief schedule : Arms the timer of the nearest deadline (timeout
+		 * 					or stall) of the drive in progress
+		 * @param nowUs : The current time
+		 *
+		 * Contract: _lock is held
+		 */
+		void schedule(uint64_t nowUs);
+
+		/**
+		 * @brief onDeadline : Timer wheel callback. Ends the drive if it
+		 * 					  timed out or stalled, or arms the timer again
+		 * @param controller_ptr : The controller
+		 * @param drive : The drive number the timer was armed for
+		 */
+		static void onDeadline(void* controller_ptr, uint32_t drive);
+
+		/**
+		 * @brief finish : Ends the drive in progress
+		 * @param outcome : How it ended
+		 * @param stop : Posts a stop command first
+		 *
+		 * Contract: _lock is held and a drive is in progress
+		 */
+		void finish(motionOutcome outcome, bool stop);
+
+		//-------------------------------------------------- Private attributes
+		Sphero* _sphero;
+
+			/* Held while sending a roll command : keeps them in order */
+		pthread_mutex_t _sendLock;
+
+			/* Protects everything below */
+		pthread_mutex_t _lock;
+
+		bool _active;
+
+			/* Incremented by every drive, tells apart their timers */
+		uint32_t _drive;
+		std::promise<MotionResult> _promise;
+
+		int16_t _targetX;
+		int16_t _targetY;
+		MotionParams _params;
+
+			/* Trajectory, and the arc length the Sphero reached on it */
+		bool _following;
+		Trajectory _trajectory;
+		double _pathS;
+
+		uint64_t _startUs;
+		KinematicSnapshot _state;
+		uint64_t _lastUpdateUs;
+
+			/* PID states */
+		double _distanceIntegral;
+		double _headingIntegral;
+		double _lastHeadingError;
+		double _lastBearing;
+		bool _courseKnown;
+
+			/* Stall detection : the least distance left so far */
+		double _closestCm;
+		uint64_t _progressUs;
+
+			/* Roll command posted by send, waiting for flush */
+		bool _posted;
+		uint8_t _postedSpeed;
+		uint16_t _postedHeading;
+
+			/* Last roll command sent */
+		uint8_t _sentSpeed;
+		uint16_t _sentHeading;
+		uint64_t _sentUs;
+		bool _sent;
+
+		uint32_t _commands;
+		uint32_t _updates;
+};
+
+#endif // MOTIONCONTROLLER_HPP
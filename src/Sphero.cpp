@@ -7,84 +7,398 @@
 
 //-------------------------------------------------------- System includes
 
-#include <endian.h>
 #include <sys/socket.h>
 #include <pthread.h>
 #include <unistd.h>
 #include <cmath>
 
 #include <algorithm>
+#include <chrono>
 #include <iostream>
 using namespace std;
 //--------------------------------------------------------- Local includes
 
 #include "Sphero.hpp"
+#include "SpheroReactor.hpp"
 #include "packets/SpheroPacket.hpp"
 #include "packets/Constants.hpp"
+#include "packets/Toolbox.hpp"
 #include "packets/async/SpheroStreamingPacket.hpp"
-#include "packets/answer/AskedCommandCode.hpp"
+#include "packets/AnswerSlot.hpp"
+
+//-------------------------------------------------------------- Functions
+
+/**
+ * @brief decodeAnswer : Decodes the answer to a command, in place
+ * @param answer : The command completion
+ * @param decode : The decoder of the command answer
+ * @param result : Receives the decoded answer
+ * @return false if there was no valid answer, or the Sphero refused the
+ * 		   command (MRSP not OK)
+ */
+template<typename Result>
+static bool decodeAnswer(const CommandAnswer& answer,
+		bool (*decode)(uint8_t, const uint8_t*, Result&), Result& result)
+{
+	return answer.status == commandStatus::ANSWERED
+		&& answer.mrsp == 0
+		&& decode(answer.dlen, answer.data, result);
+}
+
+/**
+ * @brief decodeAcknowledgement : Decoder of the answers without data
+ * @return false if the answer carries data
+ */
+static bool decodeAcknowledgement(uint8_t dlen, const uint8_t*, bool& acknowledged)
+{
+	acknowledged = dlen == 1;
+	return acknowledged;
+}
 
 //-------------------------------------------------------- Private methods
 
 void* Sphero::monitorStream(void* sphero_ptr)
 {
 	Sphero* sphero = (Sphero*) sphero_ptr;
-	int _bt_sock = sphero->_bt_socket;
-	uint8_t buf;
-	SpheroPacket* packet_ptr;
 
-	for(;;)
+		//A command sent from a listener must not wait for an answer this
+		//thread would read
+	CommandTracker::setReceptionThread(true);
+
+	while(sphero->_connected && sphero->processIncoming())
+	{
+	}
+
+		//Closed by the Sphero, or shut down by disconnect() : the thread is
+		//joined by the next connect() or the destructor
+	sphero->disconnect();
+
+	return NULL;
+}
+//END monitorStream
+
+/**
+ * @brief joinMonitor : Waits for the end of the monitor thread. On the
+ * 					   monitor thread itself, it is detached instead
+ */
+void Sphero::joinMonitor()
+{
+	if(!_monitorStarted)
+	{
+		return;
+	}
+
+	if(pthread_equal(monitor, pthread_self()))
+	{
+		pthread_detach(monitor);
+	}
+	else
+	{
+		pthread_join(monitor, NULL);
+	}
+	_monitorStarted = false;
+}//END joinMonitor
+
+/**
+ * @brief processIncoming : Reads the available bytes on the socket and
+ * 							dispatches every complete frame
+ * @return false if the connection is closed
+ */
+bool Sphero::processIncoming()
+{
+	const uint8_t* frame;
+	size_t frameLength;
+
+	if(_framer.fill(_bt_socket) <= 0)
+	{
+		return false;
+	}
+
+	while(_framer.nextFrame(frame, frameLength))
+	{
+		_recorder.record(captureDirection::INBOUND, frame, frameLength);
+		dispatchFrame(frame, frameLength);
+	}
+
+	return true;
+}//END processIncoming
+
+/**
+ * @brief dispatchFrame : Decodes a frame and performs its action, as done for
+ * 						  every frame received
+ * @param frame : The frame, starting at SOP1
+ * @param length : The frame length, checksum included
+ *
+ * Contract: the frame is checksum-valid, and dispatched by the reception
+ * thread or while it is not running (replay)
+ */
+void Sphero::dispatchFrame(const uint8_t* frame, size_t length)
+{
+	SpheroPacket::extractPacket(frame, length, this);
+}//END dispatchFrame
+
+/**
+ * @brief sendPacket : Queues the packet for the writer thread
+ * @param packet : The packet to send to the Sphero
+ * @param kind : Coalescing class, the unsent packet of the same class being
+ * 				 dropped
+ */
+void Sphero::sendPacket(ClientCommandPacket& packet, coalesceClass kind)
+{
+		//A broken link is noticed, and disconnected, by the reception side
+	_writer.enqueue(packet.toByteArray(), packet.getSize(), kind);
+}//END sendPacket
+
+/**
+ * @brief sendSerialized : Sends a serialized command expecting no data in
+ * 						   return, acknowledged if the calling thread opened
+ * 						   a batch
+ * @param packet : The packet, which sequence number may be changed
+ * @param size : The packet size
+ * @param kind : Coalescing class, used only when not acknowledged
+ */
+void Sphero::sendSerialized(uint8_t* packet, size_t size, coalesceClass kind)
+{
+	commandBatch* batch = NULL;
+
+		//The reception thread has no batch : it would wait for a slot
+	if(!CommandTracker::isReceptionThread())
 	{
-		if(recv(_bt_sock, &buf, sizeof(buf), MSG_PEEK) <= 0)
+		pthread_mutex_lock(&_batchLock);
+		batch = batchOf();
+		if(batch != NULL)
 		{
-			sphero->disconnect();
+			++batch->outstanding;
 		}
-		else
-		{
-			if(SpheroPacket::extractPacket(_bt_sock, sphero, &packet_ptr))
+		pthread_mutex_unlock(&_batchLock);
+	}
+
+	if(batch == NULL)
+	{
+		_writer.enqueue(packet, size, kind);
+		return;
+	}
+
+	sendSerializedAcknowledged(packet, size,
+		[this, batch](const CommandAnswer& answer){
+			pthread_mutex_lock(&_batchLock);
+			if(answer.status != commandStatus::ANSWERED || answer.mrsp != 0)
 			{
-				packet_ptr->packetAction();
+				batch->failed = true;
 			}
-		}
+			batch->maxRttUs = max(batch->maxRttUs, answer.rttUs);
+			if(--batch->outstanding == 0)
+			{
+				pthread_cond_broadcast(&_batchDone);
+			}
+			pthread_mutex_unlock(&_batchLock);
+		});
+}//END sendSerialized
+
+/**
+ * @brief sendSerializedAcknowledged : Sends a serialized command asking for
+ * 									   an answer, without waiting for it
+ * @param packet : The packet, which sequence number is set
+ * @param size : The packet size
+ * @param completion : Called once with the answer, or after
+ * 					   NB_SEC_SYNC_BEFORE_FAILURE without answer
+ * 					   (see commandCompletion_t for its thread)
+ */
+void Sphero::sendSerializedAcknowledged(uint8_t* packet, size_t size,
+		commandCompletion_t completion)
+{
+	uint8_t seq;
+	if(_commands.acquire(completion, NB_SEC_SYNC_BEFORE_FAILURE * 1000, seq,
+			packet[2], packet[3]))
+	{
+		ClientCommandPacket::setSequence(packet, size, seq);
+		_writer.enqueue(packet, size);
 	}
+}//END sendSerializedAcknowledged
 
+/**
+ * @brief batchOf : Finds the batch opened by the calling thread. The batch
+ * 				   lock must be held
+ * @return The batch, NULL if the thread has none open
+ */
+Sphero::commandBatch* Sphero::batchOf()
+{
+	for(commandBatch* batch : _batches)
+	{
+		if(pthread_equal(batch->owner, pthread_self()))
+		{
+			return batch;
+		}
+	}
 	return NULL;
-}
-//END monitorStream
+}//END batchOf
 
 /**
- * @brief sendPacket : Send the specified packet to the Sphero
- * @param packet : The packet to send to the Sphero
+ * @brief deliver : Calls the listeners of an event, or queues it, according
+ * 				   to the event dispatch policy
+ * @param event : The event
  */
-void Sphero::sendPacket(ClientCommandPacket& packet)
+void Sphero::deliver(const callbackEvent& event)
 {
-	ssize_t retour;
-	if((retour = send(_bt_socket, packet.toByteArray(),  packet.getSize(), 0)) <= 0)
+	CallbackExecutor* executor = NULL;
+	switch((dispatchPolicy) _dispatchPolicies[(size_t) event.kind].load(
+				std::memory_order_relaxed))
 	{
-		disconnect();
+		case dispatchPolicy::ROBOT_EXECUTOR:
+			executor = _robotExecutor.load(std::memory_order_acquire);
+			break;
+		case dispatchPolicy::SHARED_EXECUTOR:
+			executor = _sharedExecutor.load(std::memory_order_acquire);
+			break;
+		default:
+			break;
 	}
 
-	fsync(_bt_socket);
+	if(executor == NULL || !executor->submit(this, event))
+	{
+		runEvent(event);
+	}
+}//END deliver
+
+/**
+ * @brief runEvent : Calls the listeners of an event
+ * @param event : The event
+ */
+void Sphero::runEvent(const callbackEvent& event)
+{
+	switch(event.kind)
+	{
+		case eventKind::CONNECT:
+			_connect_handler.reportAction();
+			break;
+		case eventKind::DISCONNECT:
+			_disconnect_handler.reportAction();
+			break;
+		case eventKind::PRE_SLEEP:
+			_preSleep_handler.reportAction();
+			break;
+		case eventKind::COLLISION:
+		{
+				//The listeners get a pointer, valid during the call
+			CollisionStruct infos = event.collision;
+			_collision_handler.reportAction(&infos);
+			break;
+		}
+		case eventKind::DATA:
+			_data_handler.reportAction();
+			break;
+		case eventKind::POWER_STATE:
+			_powerState_handler.reportAction(event.power);
+			break;
+		case eventKind::SELF_LEVEL:
+			_selfLevel_handler.reportAction(event.selfLevel);
+			break;
+		case eventKind::ASYNC_PACKET:
+			_async_handlers[event.asyncId].reportAction(event.data, event.length);
+			break;
+		default:
+			break;
+	}
+}//END runEvent
+
+/**
+ * @brief checkMotion : Checks that a drive can start
+ * @param outcome : Receives the reason it cannot
+ * @return false if it cannot
+ */
+bool Sphero::checkMotion(motionOutcome& outcome)
+{
+	if(!_connected)
+	{
+		outcome = motionOutcome::DISCONNECTED;
+		return false;
+	}
+
+	requestLock();
+	bool odometry = _stream.getIndex(ODOMETER_X) != -1
+		&& _stream.getIndex(ODOMETER_Y) != -1;
+	requestLock(false);
+	if(!odometry)
+	{
+		outcome = motionOutcome::NO_ODOMETRY;
+		return false;
+	}
+
+	return true;
+}
 
-}//END sendPacket
 
-void Sphero::sendAcknowledgedPacket(ClientCommandPacket& packet, 
-		uint8_t seqToWait){
-	
-	struct timeval tv;
-	struct timespec timer;
-
-	gettimeofday(&tv, NULL);
-	timer.tv_sec = tv.tv_sec + NB_SEC_SYNC_BEFORE_FAILURE;
-	timer.tv_nsec = 1000 * tv.tv_usec;
-
-	sendPacket(packet);
-	sem_timedwait(&(_syncSempahores[seqToWait]), &timer);
-	pthread_mutex_lock(&(_mutex_syncParameters[seqToWait]));	
-	_syncTodo[seqToWait] = pendingCommandType::NONE;
-	pthread_mutex_unlock(&(_mutex_syncParameters[seqToWait]));
+/**
+ * @brief readLinkCounters : Reads every link counter once, one by one
+ * @param snapshot : Receives them, but takenAtUs and consistent
+ */
+void Sphero::readLinkCounters(LinkSnapshot& snapshot)
+{
+	FramerStats received = _framer.getStats();
+	snapshot.bytesIn = received.bytes;
+	snapshot.framesIn = received.frames;
+	snapshot.checksumFailures = received.checksumFailures;
+	snapshot.resyncs = received.resyncs;
+	snapshot.bytesDiscarded = received.discardedBytes;
+
+	WriterStats sent = _writer.getStats();
+	snapshot.bytesOut = sent.bytes;
+	snapshot.framesOut = sent.frames;
+	snapshot.droppedOut = sent.dropped;
+	snapshot.coalescedOut = sent.coalesced;
+
+	_linkStats.fill(snapshot);
 }
 
+
+/**
+ * @brief sendClockProbe : ClockSync probe, setting the Sphero clock first
+ * 						  after a connection
+ * @param sphero_ptr : The Sphero
+ */
+void Sphero::sendClockProbe(void* sphero_ptr)
+{
+	Sphero* sphero = (Sphero*) sphero_ptr;
+	if(!sphero->_connected)
+	{
+		return;
+	}
+
+		//The Sphero clock restarts with each wake-up : set to the host one,
+		//in ms, and the former probes forgotten
+	uint32_t connection = sphero->_connections;
+	if(connection != sphero->_clockConnection)
+	{
+		bool acknowledged = false;
+		AnswerSlot<bool> slot(acknowledged, decodeAcknowledgement);
+
+		sphero->sendAcknowledgedCommand<command::assignTimeValue>(
+			[&slot](const CommandAnswer& answer){
+				slot.complete(answer);
+			}, (uint32_t) (packet_toolbox::monotonicUs() / 1000));
+
+		if(!slot.wait())
+		{
+			return;
+		}
+		sphero->_clock.reset();
+		sphero->_clockConnection = connection;
+	}
+
+	uint64_t sentUs = packet_toolbox::monotonicUs();
+	uint32_t sentMs = sentUs / 1000;
+	sphero->sendAcknowledgedCommand<command::pollPacketTimes>(
+		[sphero, sentUs, sentMs](const CommandAnswer& answer){
+			PacketTimesStruct times;
+			if(decodeAnswer(answer, SpheroAnswerPacket::decodePacketTimes, times)
+					&& times.clientSent == sentMs)
+			{
+				sphero->_clock.addSample(sentUs, times.deviceReceived,
+						times.deviceSent, packet_toolbox::monotonicUs());
+			}
+		}, sentMs);
+}//END sendClockProbe
+
 //------------------------------------------------ Constructors/Destructor
 
 /**
@@ -93,125 +407,171 @@ void Sphero::sendAcknowledgedPacket(ClientCommandPacket& packet,
  */
 Sphero::Sphero(char const* const btaddr, bluetooth_connector* btcon):
 	_connected(false), _bt_adapter(btcon), _address(btaddr),
-	_seq(0), _resetTimer(true), _waitConfirm(false)
+	_resetTimer(true), _waitConfirm(false), _monitorStarted(false),
+	_reactor(NULL), _activeReactor(NULL), _connections(0),
+	_clockConnection(0), _motion(this), _writer(&_recorder), _commands(&_linkStats)
 {
 	pthread_mutex_init(&lock, NULL);
+	pthread_mutex_init(&_batchLock, NULL);
+	pthread_cond_init(&_batchDone, NULL);
+	_powerState = (uint8_t) powerState::UNKNOWN;
 	_data = new DataBuffer();
-	_mutex_seqNum = PTHREAD_MUTEX_INITIALIZER;
-	_mutex_syncParameters = new pthread_mutex_t[256];
-	
-	_syncSempahores = new sem_t[256];
-	_syncMRSPCode = new uint8_t[256];
-	_syncPacketParameters = new void* [256];
-	_syncTodo = new pendingCommandType[256];
-
 
-	for(size_t i = 0 ; i < 256 ; i++)	
+	for(std::atomic<uint8_t>& policy : _dispatchPolicies)
 	{
-		_syncTodo[i] = pendingCommandType::NONE;
-		_syncMRSPCode[i] = 0xFF;
-		_syncPacketParameters[i] = NULL;
-		sem_init(&(_syncSempahores[i]), 0, 0);
-		pthread_mutex_init(&(_mutex_syncParameters[i]), NULL);
+		policy = (uint8_t) dispatchPolicy::INLINE;
 	}
-	
+	_robotExecutor = NULL;
+	_sharedExecutor = NULL;
+	_robotCapacity = EXECUTOR_DEFAULT_CAPACITY;
+	_robotOverflow = overflowPolicy::DROP_OLDEST;
+	pthread_mutex_init(&_executorLock, NULL);
 }
 
 
 Sphero::~Sphero()
 {
-	delete _data;
+	_clock.stop();
 	disconnect();
-	delete _bt_adapter;
-	
+	joinMonitor();
 
-	for(size_t i = 0 ; i < 256 ; i++)
+		//Queued events still point to this Sphero
+	setSharedExecutor(NULL);
+	CallbackExecutor* robotExecutor = _robotExecutor.load();
+	if(robotExecutor != NULL)
 	{
-		sem_destroy(&(_syncSempahores[i]));
-		pthread_mutex_destroy(&(_mutex_syncParameters[i]));
+		robotExecutor->drain(this);
+		delete robotExecutor;
 	}
+	pthread_mutex_destroy(&_executorLock);
+
+	delete _data;
+	delete _bt_adapter;
 
-	pthread_mutex_destroy(&_mutex_seqNum);
-	delete[] _syncPacketParameters;
-	delete[] _syncMRSPCode;
-	delete[] _syncTodo;
-	delete[] _syncSempahores;
+		//Never ended : their commands were cancelled by disconnect()
+	for(commandBatch* batch : _batches)
+	{
+		delete batch;
+	}
+	pthread_cond_destroy(&_batchDone);
+	pthread_mutex_destroy(&_batchLock);
 }//END destructor
 
 
 //--------------------------------------------------------- Public methods
 
+/**
+ * @brief rollToPosition : Enables the collision detection and drives to a
+ * 						  position, waiting for the end of the drive (see
+ * 						  moveTo)
+ * @param x : The target abscissa, in cm
+ * @param y : The target ordinate, in cm
+ * @param initSpeed : The highest roll speed
+ *
+ * Blocks the calling thread : never call it from an INLINE listener, which
+ * runs on the reception thread. Gives up if no streaming packet comes for
+ * MOTION_STALL_MS.
+ */
 void Sphero::rollToPosition(spherocoord_t x, spherocoord_t y, uint8_t initSpeed)
 {
-
-	spherocoord_t actualX, actualY;
-	uint8_t speed = initSpeed;
-
 	enableCollisionDetection(90, 30, 90, 30, 90);
 
 	collision = false;
 
-	actualX = getX();
-	actualY = getY();
-
-	unsigned int sleeptime;
+	MotionParams params;
+	params.maxSpeed = initSpeed;
+	std::future<MotionResult> result = moveTo(x, y, params);
 
-	int angle;
-	size_t nbPoints = 0;
-	//roll(45, 0);
-	//usleep(6000);
+		//Stalls are detected on the streaming packets : the drive is
+		//cancelled if they stop coming
+	uint64_t lastSeq = getKinematics().seq;
+	while(result.wait_for(std::chrono::milliseconds(MOTION_STALL_MS))
+			!= std::future_status::ready)
+	{
+		uint64_t seq = getKinematics().seq;
+		if(seq == lastSeq)
+		{
+			cancelMotion();
+		}
+		lastSeq = seq;
+	}
+}//END rollToPosition
 
-	int i = 0;
 
-	while( (abs(actualX - x) > 2 || abs(actualY- y) > 2 || speed > 35) && !collision )
+/**
+ * @brief moveTo : Drives to a position without waiting, the roll commands
+ * 				  being computed on every streaming packet (see
+ * 				  MotionController), and ends the drive in progress
+ * @param x : The target abscissa, in cm
+ * @param y : The target ordinate, in cm
+ * @param params : The speeds, tolerance, gains...
+ * @return The end of the drive. It needs ODOMETER_X and ODOMETER_Y in the
+ * 		   stream, VELOCITY_X and VELOCITY_Y to stop cleanly and correct the
+ * 		   heading
+ */
+std::future<MotionResult> Sphero::moveTo(spherocoord_t x, spherocoord_t y,
+		const MotionParams& params)
+{
+	KinematicSnapshot state = getKinematics();
+	motionOutcome outcome;
+	if(!checkMotion(outcome))
 	{
-		if(i <= 6)
-			speed = 60;
-		else
-			speed = min(20 + max(abs(actualX - x), abs(actualY- y)), 100);
-		i++;
-		sleeptime = 3000;
-
-		angle = ((int) (atan2(x - actualX, y - actualY)
-					* 180.0 / 3.14159268) + 360) % 360;
-		
-	/*	std::cout << "Speed : " << (uint32_t)speed << endl << "Angle : " << angle << endl;
-		std::cout << "ActualX : " << actualX << endl << "ActualY : " << actualY << endl;
-*/
-		roll(speed, angle);
-		usleep(5*sleeptime);
-		roll(0, angle);
+		return MotionController::fail(outcome, state);
+	}
 
-		if(abs(getSpeedX()) < 10 && abs(getSpeedY()) < 10)
-		{
-			if(nbPoints++ > 40)
-			{
-				roll(0,angle);
-				return;
-			}
-		}
-		else
-		{
-			nbPoints = 0;
-		}
+	return _motion.moveTo(x, y, params, state);
+}//END moveTo
 
-		usleep(3*sleeptime);
 
-		actualX = getX();
-		actualY = getY();
+/**
+ * @brief followPath : Drives through waypoints without stopping at them,
+ * 					  and ends the drive in progress. The path from the
+ * 					  current position and its velocity profile are computed
+ * 					  first (see Trajectory), then the heading and speed
+ * 					  setpoints on every streaming packet (see
+ * 					  MotionController)
+ * @param waypoints : The points to go through, in cm
+ * @param shape : POLYLINE (corners blended) or SPLINE
+ * @param limits : The speed and accelerations planned
+ * @param params : The tolerance at the last waypoint, gains...
+ * @return The end of the drive, at the last waypoint. It needs the same
+ * 		   streamed fields as moveTo
+ */
+std::future<MotionResult> Sphero::followPath(const std::vector<Waypoint>& waypoints,
+		pathShape shape, const TrajectoryLimits& limits, const MotionParams& params)
+{
+	KinematicSnapshot state = getKinematics();
+	motionOutcome outcome;
+	if(!checkMotion(outcome))
+	{
+		return MotionController::fail(outcome, state);
+	}
 
+	Waypoint start = {state.x, state.y};
+	Trajectory trajectory;
+	if(!trajectory.plan(start, waypoints, shape, limits))
+	{
+			//Already there
+		return MotionController::fail(motionOutcome::REACHED, state);
 	}
-	roll(0,angle);
-}
 
-uint16_t Sphero::getNormalisedSpeed()
+	return _motion.follow(trajectory, params, state);
+}//END followPath
+
+
+/**
+ * @brief cancelMotion : Stops the Sphero and ends the drive started by
+ * 						moveTo or followPath (CANCELLED)
+ * @return false if no drive was in progress
+ */
+bool Sphero::cancelMotion()
 {
-	return _normalisedSpeed;
-}
+	return _motion.cancel();
+}//END cancelMotion
 
-void Sphero::setNormalisedSpeed(uint16_t normalisedSpeed)
+uint16_t Sphero::getNormalisedSpeed()
 {
-	_normalisedSpeed = normalisedSpeed;
+	return _kinematics.read().normalisedSpeed;
 }
 
 /**
@@ -222,6 +582,9 @@ bool Sphero::connect()
 {
 	disconnect();
 
+		//A monitor thread which disconnected by itself
+	joinMonitor();
+
 	size_t i = 0;
 	while((_bt_socket = _bt_adapter->connection(_address.c_str())) == -1 &&
 		  i++ < MAX_CONNECT_ATTEMPT)
@@ -230,10 +593,32 @@ bool Sphero::connect()
 
 	if(_bt_socket != -1)
 	{
-		pthread_create(&monitor, NULL, monitorStream, this);
+		_framer.reset();
+		_writer.start(_bt_socket);
 
+			//Before the reception starts : an immediate end of stream must
+			//find the Sphero connected to disconnect it
 		_connected = true;
-		_connect_handler.reportAction();
+		++_connections;
+
+		_activeReactor = _reactor;
+		if(_activeReactor != NULL)
+		{
+			_activeReactor->attach(this, _bt_socket);
+		}
+		else
+		{
+				//Before : the thread may disconnect at once
+			_monitorStarted = true;
+			if(pthread_create(&monitor, NULL, monitorStream, this) != 0)
+			{
+				_monitorStarted = false;
+			}
+		}
+
+		callbackEvent event = callbackEvent();
+		event.kind = eventKind::CONNECT;
+		deliver(event);
 
 		setDataStreaming(80, 1, 0, 0,
 				mask2::ODOMETER_X | mask2::ODOMETER_Y | mask2::ACCELONE_0 |mask2::VELOCITY_X | mask2::VELOCITY_Y);
@@ -241,96 +626,406 @@ bool Sphero::connect()
 		return true;
 	}
 
-	return false;
-}//END connect
+	return false;
+}//END connect
+
+/**
+ * @brief notifyPacket : notify sphero that an answer packet has arrived,
+ * 						 completing the matching command
+ * @param seqNum : The answer sequence number
+ * @param mrsp : The message response code
+ * @param dlen : The answer DLEN field
+ * @param data : The answer payload (NULL if empty)
+ */
+void Sphero::notifyPacket(uint8_t seqNum, uint8_t mrsp, uint8_t dlen,
+		const uint8_t* data)
+{
+	_commands.complete(seqNum, mrsp, dlen, data);
+}
+
+
+/**
+ * @brief disconnect : Disconnects the current Sphero
+ */
+void Sphero::disconnect()
+{
+#ifdef MAP
+	fprintf(stderr, "Logging out\n");
+#endif
+
+		//Once, when the user and the reception threads race
+	if(_connected.exchange(false))
+	{
+		if(_activeReactor != NULL)
+		{
+			_activeReactor->detach(this, _bt_socket);
+		}
+
+			//The socket is shut down if the queued packets cannot leave
+		_writer.stop();
+
+			//Wakes the monitor thread up, which leaves its loop. When it is
+			//the one disconnecting, it is joined later
+		shutdown(_bt_socket, SHUT_RDWR);
+		if(_monitorStarted && !pthread_equal(monitor, pthread_self()))
+		{
+			joinMonitor();
+		}
+		_bt_adapter->disconnect();
+		_commands.cancelAll();
+		_motion.disconnected();
+
+		callbackEvent event = callbackEvent();
+		event.kind = eventKind::DISCONNECT;
+		deliver(event);
+	}
+}//END disconnect
+
+
+/**
+ * @brief setReactor : Makes the given reactor receive the Sphero frames
+ * 					   instead of a dedicated monitor thread. Takes effect on
+ * 					   the next connection
+ * @param reactor : The reactor to use, NULL to go back to a dedicated thread
+ *
+ * disconnect() then waits for the reactor to finish dispatching this Sphero
+ * frames, as it joins the monitor thread otherwise : it must not be called
+ * from a thread the Sphero INLINE listeners wait for. The other Spheros of
+ * the reactor do not delay it.
+ */
+void Sphero::setReactor(SpheroReactor* reactor)
+{
+	_reactor = reactor;
+}//END setReactor
+
+
+/**
+ * @brief setDispatchPolicy : Chooses the thread calling the listeners of an
+ * 							 event
+ * @param kind : The event
+ * @param policy : INLINE (default) on the reception thread, ROBOT_EXECUTOR
+ * 				   on a thread of this Sphero, or SHARED_EXECUTOR on the
+ * 				   executor given to setSharedExecutor (inline while there
+ * 				   is none)
+ *
+ * Queued events are copied : a CollisionStruct or an asynchronous payload
+ * stays valid during the call, as inline.
+ */
+void Sphero::setDispatchPolicy(eventKind kind, dispatchPolicy policy)
+{
+	if(kind >= eventKind::NB_KINDS)
+	{
+		return;
+	}
+
+	if(policy == dispatchPolicy::ROBOT_EXECUTOR)
+	{
+		pthread_mutex_lock(&_executorLock);
+		if(_robotExecutor.load(std::memory_order_relaxed) == NULL)
+		{
+			_robotExecutor.store(new CallbackExecutor(1, _robotCapacity,
+						_robotOverflow), std::memory_order_release);
+		}
+		pthread_mutex_unlock(&_executorLock);
+	}
+
+	_dispatchPolicies[(size_t) kind].store((uint8_t) policy,
+			std::memory_order_relaxed);
+}//END setDispatchPolicy
+
+
+/**
+ * @brief configureRobotExecutor : Sets the queue of the Sphero own executor.
+ * 								  Only possible before an event uses it
+ * @param capacity : The most events queued at once
+ * @param overflow : What to do with an event when the queue is full
+ * @return false if the executor is already started
+ */
+bool Sphero::configureRobotExecutor(size_t capacity, overflowPolicy overflow)
+{
+	pthread_mutex_lock(&_executorLock);
+	bool started = _robotExecutor.load(std::memory_order_relaxed) != NULL;
+	if(!started)
+	{
+		_robotCapacity = capacity;
+		_robotOverflow = overflow;
+	}
+	pthread_mutex_unlock(&_executorLock);
+
+	return !started;
+}//END configureRobotExecutor
+
+
+/**
+ * @brief setSharedExecutor : Gives the executor used by the events
+ * 							 dispatched with SHARED_EXECUTOR
+ * @param executor : The executor, NULL for none. It must live until it is
+ * 					 replaced or the Sphero is destroyed
+ *
+ * The events already queued in the former executor are run before the
+ * return.
+ */
+void Sphero::setSharedExecutor(CallbackExecutor* executor)
+{
+	CallbackExecutor* former = _sharedExecutor.exchange(executor);
+	if(former != NULL && former != executor)
+	{
+		former->drain(this);
+	}
+}//END setSharedExecutor
+
+
+/**
+ * @return The counters of the Sphero own executor (zero while it is not
+ * 		   started)
+ */
+ExecutorStats Sphero::getRobotExecutorStats()
+{
+	CallbackExecutor* executor = _robotExecutor.load(std::memory_order_acquire);
+	return executor == NULL ? ExecutorStats() : executor->getStats();
+}//END getRobotExecutorStats
+
+
+bool Sphero::getCollision(void)
+{
+	return collision;
+}
+
+int16_t Sphero::getX()
+{
+	return _kinematics.read().x;
+}
+int16_t Sphero::getY()
+{
+	return _kinematics.read().y;
+}
+int16_t Sphero::getSpeedX()
+{
+	return _kinematics.read().speedX;
+}
+int16_t Sphero::getSpeedY()
+{
+	return _kinematics.read().speedY;
+}
+
+
+/**
+ * @brief getKinematics : Reads position and speed at once, without lock
+ * @return The values of the latest streaming frame, consistent together
+ */
+KinematicSnapshot Sphero::getKinematics()
+{
+	return _kinematics.read();
+}
+
+
+/**
+ * @brief publishKinematics : Replaces the kinematic snapshot
+ * @param snapshot : The values of a streaming frame
+ *
+ * Contract: called by the reception thread only
+ */
+void Sphero::publishKinematics(const KinematicSnapshot& snapshot)
+{
+	_kinematics.publish(snapshot);
+}
+
+/**
+ * @return The outbound queue counters (queue depth, packets per system call,
+ * 		   bytes per system call...)
+ */
+WriterStats Sphero::getWriterStats()
+{
+	return _writer.getStats();
+}//END getWriterStats
+
+
+/**
+ * @brief getLinkStats : Copies the link counters without stopping the
+ * 						 reception (cheap enough to be polled every second).
+ * 						 The copy is consistent : every counter has the
+ * 						 value it had at takenAtUs, unless the counters
+ * 						 moved during LINK_STATS_MAX_READS reads (see
+ * 						 LinkSnapshot::consistent)
+ * @return Bytes and frames in and out, checksum failures,
+ * 		   resynchronizations and discarded bytes, dropped frames, and the round-trip percentiles
+ * 		   and timeouts of every acknowledged command
+ */
+LinkSnapshot Sphero::getLinkStats()
+{
+	LinkSnapshot snapshot;
+	LinkSnapshot check;
+	readLinkCounters(snapshot);
+
+		//The counters only grow : one read twice kept its value in between,
+		//so two equal copies are the values of every counter at once, at
+		//any time between them. Retried while the reception moves them,
+		//a bounded number of times : a busy link must not stall the caller
+	for(unsigned reads = 1 ; reads < LINK_STATS_MAX_READS ; ++reads)
+	{
+		uint64_t takenAtUs = packet_toolbox::monotonicUs();
+		readLinkCounters(check);
+		if(LinkStats::sameCounters(snapshot, check))
+		{
+			snapshot.takenAtUs = takenAtUs;
+			snapshot.consistent = true;
+			return snapshot;
+		}
+		std::swap(snapshot, check);
+	}
+
+	snapshot.takenAtUs = packet_toolbox::monotonicUs();
+	snapshot.consistent = false;
+	return snapshot;
+}//END getLinkStats
+
+
+/**
+ * @brief startCapture : Records every frame received and sent from now on,
+ * 						 for WireReplay
+ * @param path : The capture file, truncated
+ * @return false if the file could not be created
+ */
+bool Sphero::startCapture(const char* path)
+{
+	return _recorder.start(path);
+}//END startCapture
+
+
+/**
+ * @brief stopCapture : Closes the capture file
+ */
+void Sphero::stopCapture()
+{
+	_recorder.stop();
+}//END stopCapture
+
+
+/**
+ * @brief startClockSync : Sets the Sphero clock to the host one on every
+ * 						  connection, then estimates their offset and drift
+ * 						  with pollPacketTimes probes sent by a background
+ * 						  thread
+ * @param periodMs : The delay between two probes
+ * @return false if it is already started
+ */
+bool Sphero::startClockSync(unsigned int periodMs)
+{
+	return _clock.start(periodMs, sendClockProbe, this);
+}//END startClockSync
+
+
+/**
+ * @brief stopClockSync : Stops the probes, the estimation being kept
+ */
+void Sphero::stopClockSync()
+{
+	_clock.stop();
+}//END stopClockSync
+
+
+/**
+ * @return The offset and drift of the Sphero clock
+ */
+ClockEstimate Sphero::getClockEstimate()
+{
+	return _clock.getEstimate();
+}//END getClockEstimate
+
 
-void Sphero::notifyPacket(uint8_t seqNum, uint8_t mrsp, void* pointer)
+/**
+ * @brief toHostTime : Converts a Sphero timestamp
+ * @param deviceMs : The Sphero time, in ms
+ * @param hostUs : Receives the host monotonic time
+ * 				   (packet_toolbox::monotonicUs), in µs
+ * @return false while the clocks are not synchronized
+ */
+bool Sphero::toHostTime(uint32_t deviceMs, uint64_t& hostUs)
 {
-	_syncMRSPCode[seqNum] = mrsp;
-	_syncPacketParameters[seqNum] = pointer;
-	sem_post(&(_syncSempahores[seqNum]));
-}
+	return _clock.toHostUs(deviceMs, hostUs);
+}//END toHostTime
 
-pendingCommandType Sphero::getTodo(uint8_t seqNum)
+
+/**
+ * @brief beginBatch : Until endBatch, every command sent by the calling
+ * 					   thread is sent acknowledged without waiting for the
+ * 					   previous answers (up to PENDING_COMMAND_SLOTS in
+ * 					   flight). The other threads are not affected, nor is
+ * 					   the reception thread, which never waits for a slot
+ */
+void Sphero::beginBatch()
 {
-	return _syncTodo[seqNum];
-}
+	pthread_mutex_lock(&_batchLock);
+	commandBatch* batch = batchOf();
+	if(batch == NULL)
+	{
+		batch = new commandBatch();
+		batch->owner = pthread_self();
+		batch->outstanding = 0;
+		_batches.push_back(batch);
+	}
+	batch->failed = false;
+	batch->maxRttUs = 0;
+	pthread_mutex_unlock(&_batchLock);
+}//END beginBatch
 
 
 /**
- * @brief disconnect : Disconnects the current Sphero
+ * @brief endBatch : Waits for the answers to every command sent by the
+ * 					 calling thread since its beginBatch
+ * @param maxRttUs : If not NULL, receives the longest round-trip time of the
+ * 					 batch, in µs
+ * @return true if every command was answered successfully
  */
-void Sphero::disconnect()
+bool Sphero::endBatch(uint32_t* maxRttUs)
 {
-#ifdef MAP
-	fprintf(stderr, "Logging out\n");
-#endif
+	pthread_mutex_lock(&_batchLock);
+	commandBatch* batch = batchOf();
+	if(batch == NULL)
+	{
+		pthread_mutex_unlock(&_batchLock);
+		if(maxRttUs != NULL)
+		{
+			*maxRttUs = 0;
+		}
+		return true;
+	}
 
-	if(_connected)
+	_batches.erase(std::find(_batches.begin(), _batches.end(), batch));
+	while(batch->outstanding > 0)
 	{
-		_connected = false;
-		pthread_cancel(monitor);
-		_bt_adapter->disconnect();
+		pthread_cond_wait(&_batchDone, &_batchLock);
+	}
+	pthread_mutex_unlock(&_batchLock);
 
-		_disconnect_handler.reportAction();
+	bool succeeded = !batch->failed;
+	if(maxRttUs != NULL)
+	{
+		*maxRttUs = batch->maxRttUs;
 	}
-}//END disconnect
+	delete batch;
 
+	return succeeded;
+}//END endBatch
 
-void Sphero::setX(spherocoord_t x)
-{
-	_x = x;
-}
-void Sphero::setY(spherocoord_t y)
-{
-	_y = y;
-}
-void Sphero::setSpeedX(int16_t speedx)
-{
-	_speedX = speedx;
-}
-void Sphero::setSpeedY(int16_t speedy)
-{
-	_speedY = speedy;
-}
 
-bool Sphero::getCollision(void)
+/**
+ * @brief ping : Creates a ping request to the Sphero
+ */
+void Sphero::ping()
 {
-	return collision;
-}
+	sendCommand<command::ping>();
+}//END ping
 
-int16_t Sphero::getX()
-{
-	return _x;
-}
-int16_t Sphero::getY()
-{
-	return _y;
-}
-int16_t Sphero::getSpeedX()
-{
-	return _speedX;
-}
-int16_t Sphero::getSpeedY()
-{
-	return _speedY;
-}
 
 /**
- * @brief ping : Creates a ping request to the Sphero
+ * @brief ping : Sends an acknowledged ping to the Sphero
+ * @param callback : Called once with the answer (or its absence), on a
+ * 					 thread which must not block (see commandCompletion_t)
  */
-void Sphero::ping()
+void Sphero::ping(commandCompletion_t callback)
 {
-	ClientCommandPacket packet = ClientCommandPacket(
-				DID::core,
-				CID::ping,
-				flags::notNeeded,
-				0x01,
-				NULL,
-				true,
-				true
-				);
-	sendPacket(packet);
+	sendAcknowledgedCommand<command::ping>(callback);
 }//END ping
 
 
@@ -343,51 +1038,54 @@ void Sphero::ping()
  */
 void Sphero::setColor(uint8_t red, uint8_t green, uint8_t blue, bool persist)
 {
-	uint8_t data_payload[4];
-	data_payload[0] = red;
-	data_payload[1] = green;
-	data_payload[2] = blue;
-	if (persist)
-		data_payload[3] = 1;
-	else
-		data_payload[3] = 0;
-
-	ClientCommandPacket packet (
-				DID::sphero,
-				CID::setRGBLEDOutput,
-				flags::notNeeded,
-				0x05,
-				data_payload,
-				_waitConfirm,
-				_resetTimer
-				);
-	sendPacket(packet);
+		//A persisted color must reach the Sphero even if followed by others
+	sendCommand<command::setRGBLEDOutput>(
+			persist ? coalesceClass::NONE : coalesceClass::COLOR,
+			red, green, blue, persist ? 1 : 0);
 }//END setColor
 
 
 /**
- * Commentez-les tous ! (feat Sacha)
+ * @brief getColor : Asks the Sphero for its color and waits for the answer
+ * @param color : Receives the color
+ * @return false if no valid answer came in time, or at once on a thread the
+ * 		   answer would have to come through (a reception thread, or a
+ * 		   timeout completion : see CommandTracker::mayWaitForAnswer)
  */
-ColorStruct* Sphero::getColor()
+bool Sphero::getColor(ColorStruct& color)
 {
-	pthread_mutex_lock(&_mutex_seqNum);
-	uint8_t currentSeq = _seq++;
-	pthread_mutex_unlock(&_mutex_seqNum);
+	if(!CommandTracker::mayWaitForAnswer())
+	{
+		return false;
+	}
+
+	AnswerSlot<ColorStruct> slot(color, SpheroAnswerPacket::decodeColor);
 
-	_syncTodo[currentSeq] = pendingCommandType::GETCOLOR;
+	sendAcknowledgedCommand<command::getRGBLED>(
+		[&slot](const CommandAnswer& answer){
+			slot.complete(answer);
+		});
+
+	return slot.wait();
+}
 
-	ClientCommandPacket packet(
-				DID::sphero,
-				CID::getRGBLED,
-				currentSeq,
-				0x01,
-				nullptr,
-				true,
-				_resetTimer
-				);
 
-	sendAcknowledgedPacket(packet, currentSeq);
-	return (ColorStruct*) _syncPacketParameters[currentSeq];	
+/**
+ * @brief getColor : Asks the Sphero for its color without waiting for the
+ * 					 answer
+ * @param callback : Called once with the color (NULL if no answer came in
+ * 					 time), on a thread which must not block (see
+ * 					 commandCompletion_t)
+ */
+void Sphero::getColor(callback_color_t callback)
+{
+	sendAcknowledgedCommand<command::getRGBLED>(
+		[callback](const CommandAnswer& answer){
+			ColorStruct color;
+			bool decoded = decodeAnswer(answer, SpheroAnswerPacket::decodeColor,
+					color);
+			callback(decoded ? &color : NULL);
+		});
 }
 
 
@@ -398,31 +1096,45 @@ ColorStruct* Sphero::getColor()
  * 		if you're not, here is a clue : it gives informations about
  * 		bluetooth parameters, for example bluetooth name and address.
  *
- * 	@return a BTInfoStruct pointer pointing on a dynamically allocated
- * 	struct that user will be very kind to deallocate himself or null if
- * 	answer wasn't received in time (in this case we tried to manage
- * 	properly the memory, don't be scared).
- */
-BTInfoStruct* Sphero::getBTInfo()
-{
-	pthread_mutex_lock(&_mutex_seqNum);
-	uint8_t currentSeq = _seq++;
-	pthread_mutex_unlock(&_mutex_seqNum);
-
-	_syncTodo[currentSeq] = pendingCommandType::GETBTINFO;
-
-	ClientCommandPacket packet(
-				DID::core,
-				CID::getBluetoothInfo,
-				currentSeq,
-				0x01,
-				nullptr,
-				true,
-				_resetTimer
-			);
-
-	sendAcknowledgedPacket(packet, currentSeq);
-	return (BTInfoStruct*) _syncPacketParameters[currentSeq];	
+ * 	@param btinfo : Receives the name and address
+ * 	@return false if no valid answer came in time (btinfo is then left
+ * 	untouched), or at once on a thread the answer would have to come through
+ * 	(see getColor)
+ */
+bool Sphero::getBTInfo(BTInfoStruct& btinfo)
+{
+	if(!CommandTracker::mayWaitForAnswer())
+	{
+		return false;
+	}
+
+	AnswerSlot<BTInfoStruct> slot(btinfo, SpheroAnswerPacket::decodeBTInfo);
+
+	sendAcknowledgedCommand<command::getBluetoothInfo>(
+		[&slot](const CommandAnswer& answer){
+			slot.complete(answer);
+		});
+
+	return slot.wait();
+}
+
+
+/**
+ * @brief getBTInfo : Asks the Sphero for its bluetooth informations without
+ * 					  waiting for the answer
+ * @param callback : Called once with the informations (NULL if no answer
+ * 					 came in time), on a thread which must not block (see
+ * 					 commandCompletion_t)
+ */
+void Sphero::getBTInfo(callback_btinfo_t callback)
+{
+	sendAcknowledgedCommand<command::getBluetoothInfo>(
+		[callback](const CommandAnswer& answer){
+			BTInfoStruct btinfo;
+			bool decoded = decodeAnswer(answer,
+					SpheroAnswerPacket::decodeBTInfo, btinfo);
+			callback(decoded ? &btinfo : NULL);
+		});
 }
 
 /**
@@ -432,16 +1144,7 @@ BTInfoStruct* Sphero::getBTInfo()
  */
 void Sphero::setBackLedOutput(uint8_t power)
 {
-	ClientCommandPacket packet(
-				DID::sphero,
-				CID::setBackLEDOutput,
-				flags::notNeeded,
-				0x02,
-				&power,
-				_waitConfirm,
-				_resetTimer
-				);
-	sendPacket(packet);
+	sendCommand<command::setBackLEDOutput>(coalesceClass::BACK_LED, power);
 }//END setBackLedOutput
 
 
@@ -452,22 +1155,7 @@ void Sphero::setBackLedOutput(uint8_t power)
  */
 void Sphero::setHeading(uint16_t heading)
 {
-	uint8_t data[2];
-	uint8_t* ptr = (uint8_t*) &heading;
-	data[0] = ptr[1];
-	data[1] = ptr[0];
-
-	ClientCommandPacket packet(
-				DID::sphero,
-				CID::setHeading,
-				flags::notNeeded,
-				0x03,
-				data,
-				_waitConfirm,
-				_resetTimer
-				);
-
-	sendPacket(packet);
+	sendCommand<command::setHeading>(coalesceClass::NONE, heading);
 }//END setHeading
 
 
@@ -477,31 +1165,9 @@ void Sphero::setHeading(uint16_t heading)
  */
 void Sphero::setStabilization(bool on)
 {
-	uint8_t state;
-	state = on ? 1 : 0;
-
-	ClientCommandPacket packet (
-				DID::sphero,
-				CID::setStabilization,
-				flags::notNeeded,
-				0x02,
-				&state,
-				_waitConfirm,
-				_resetTimer
-				);
-	sendPacket(packet);
+	sendCommand<command::setStabilization>(coalesceClass::NONE, on ? 1 : 0);
 }//END setStabilization
 
-void Sphero::lockSeqnum(uint8_t seqnum)
-{
-	pthread_mutex_lock(&(_mutex_syncParameters[seqnum]));
-}
-
-void Sphero::unlockSeqnum(uint8_t seqnum)
-{
-	pthread_mutex_unlock(&(_mutex_syncParameters[seqnum]));
-}
-
 /**
  * @brief setRotationRate : Change the rotation speed
  * @param angspeed : The new rotation speed (new speed will be angspeed*0.784 degrees/sec)
@@ -509,16 +1175,7 @@ void Sphero::unlockSeqnum(uint8_t seqnum)
  */
 void Sphero::setRotationRate(uint8_t angspeed)
 {
-	ClientCommandPacket packet(
-				DID::sphero,
-				CID::setRotationRate,
-				flags::notNeeded,
-				0x02,
-				&angspeed,
-				_waitConfirm,
-				_resetTimer
-				);
-	sendPacket(packet);
+	sendCommand<command::setRotationRate>(coalesceClass::NONE, angspeed);
 }//END setRotationRate
 
 
@@ -561,22 +1218,8 @@ void Sphero::setRotationRate(uint8_t angspeed)
 void Sphero::setSelfLevel(uint8_t options, uint8_t angle_limit,
 						  uint8_t timeout, uint8_t trueTime)
 {
-	uint8_t data_payload[4];
-	data_payload[0] = options;
-	data_payload[1] = angle_limit;
-	data_payload[2] = timeout;
-	data_payload[3] = trueTime;
-
-	ClientCommandPacket packet(
-				DID::sphero,
-				CID::selfLevel,
-				flags::notNeeded,
-				0x05,
-				data_payload,
-				_waitConfirm,
-				_resetTimer
-				);
-	sendPacket(packet);
+	sendCommand<command::selfLevel>(coalesceClass::NONE,
+			options, angle_limit, timeout, trueTime);
 }//END setSelfLevel
 
 
@@ -600,24 +1243,8 @@ void Sphero::setSelfLevel(uint8_t options, uint8_t angle_limit,
 void Sphero::enableCollisionDetection(uint8_t Xt, uint8_t Xspd,
 									  uint8_t Yt,  uint8_t Yspd,  uint8_t Dead)
 {
-	uint8_t data_payload[6];
-	data_payload[0] = 0x01;
-	data_payload[1] = Xt;
-	data_payload[2] = Xspd;
-	data_payload[3] = Yt;
-	data_payload[4] = Yspd;
-	data_payload[5] = Dead;
-
-	ClientCommandPacket packet(
-				DID::sphero,
-				CID::configureCollisionDetection,
-				flags::notNeeded,
-				0x07,
-				data_payload,
-				false,
-				_resetTimer
-				);
-	sendPacket(packet);
+	sendCommand<command::configureCollisionDetection>(coalesceClass::NONE,
+			0x01, Xt, Xspd, Yt, Yspd, Dead);
 }//END enableCollisionDetection
 
 
@@ -626,23 +1253,8 @@ void Sphero::enableCollisionDetection(uint8_t Xt, uint8_t Xspd,
  */
 void Sphero::disableCollisionDetection()
 {
-	uint8_t data_payload[6];
-	data_payload[0] = 0x00;
-	data_payload[1] = 0;
-	data_payload[2] = 0;
-	data_payload[3] = 0;
-	data_payload[4] = 0;
-	data_payload[5] = 0;
-
-	ClientCommandPacket packet(
-				DID::sphero,
-				CID::configureCollisionDetection,
-				flags::notNeeded,
-				0x07,
-				data_payload,
-				_waitConfirm,
-				_resetTimer);
-	sendPacket(packet);
+	sendCommand<command::configureCollisionDetection>(coalesceClass::NONE,
+			0x00, 0, 0, 0, 0, 0);
 }//END disableCollisionDetection
 
 
@@ -671,30 +1283,7 @@ bool Sphero::isConnected()
  */
 void Sphero::configureLocator(uint8_t flags, uint16_t X, uint16_t Y, uint16_t yaw)
 {
-	uint8_t XA = (uint8_t)((X & 0xFF00) >> 8);
-	uint8_t XB = (uint8_t)(X & 0x00FF);
-	uint8_t YA = (uint8_t)((Y & 0xFF00) >> 8);
-	uint8_t YB = (uint8_t)(Y & 0x00FF);
-	uint8_t yawA = (uint8_t)((yaw & 0xFF00) >> 8);
-	uint8_t yawB = (uint8_t)(yaw & 0x00FF);
-	uint8_t data_payload[7];
-	data_payload[0] = flags;
-	data_payload[1] = XA;
-	data_payload[2] = XB;
-	data_payload[3] = YA;
-	data_payload[4] = YB;
-	data_payload[5] = yawA;
-	data_payload[6] = yawB;
-
-	ClientCommandPacket packet(
-				DID::sphero,
-				CID::configureLocator,
-				flags::notNeeded,
-				0x08,
-				data_payload,
-				_waitConfirm,
-				_resetTimer);
-	sendPacket(packet);
+	sendCommand<command::configureLocator>(coalesceClass::NONE, flags, X, Y, yaw);
 }
 
 /**
@@ -708,40 +1297,17 @@ void Sphero::configureLocator(uint8_t flags, uint16_t X, uint16_t Y, uint16_t ya
 void Sphero::setDataStreaming(uint16_t freq, uint16_t delay, uint32_t mask,
 		uint8_t packetCount, uint32_t mask2) {
 	uint16_t M = 400 / freq;
-	byte dlen = (mask2 == 0) ? 0x0a : 0x0e;
-
-	uint8_t data[dlen];
-	data[0] = M >> 8;
-	data[1] = M;
-
-	data[2] = delay >> 8;
-	data[3] = delay;
-
-	data[4] = mask >> 24;
-	data[5] = mask >> 16;
-	data[6] = mask >> 8;
-	data[7] = mask;
-
-	data[8] = packetCount;
 
 	if(mask2)
 	{
-
-		data[9] = mask2 >> 24;
-		data[10] = mask2 >> 16;
-		data[11] = mask2 >> 8;
-		data[12] = mask2;
+		sendCommand<command::setDataStreamingMask2>(coalesceClass::NONE,
+				M, delay, mask, packetCount, mask2);
+	}
+	else
+	{
+		sendCommand<command::setDataStreaming>(coalesceClass::NONE,
+				M, delay, mask, packetCount);
 	}
-
-	ClientCommandPacket packet(
-				DID::sphero,
-				CID::setDataStreaming,
-				flags::notNeeded,
-				dlen,
-				data,
-				_waitConfirm,
-				_resetTimer);
-	sendPacket(packet);
 	updateParameters(delay, mask, mask2);
 }
 
@@ -770,16 +1336,7 @@ DataBuffer* Sphero::getDataBuffer()
  */
 void Sphero::setAccelerometerRange(uint8_t range)
 {
-	ClientCommandPacket packet(
-				DID::sphero,
-				CID::setAccelerometerRange,
-				flags::notNeeded,
-				0x02,
-				&range,
-				_waitConfirm,
-				_resetTimer
-				);
-	sendPacket(packet);
+	sendCommand<command::setAccelerometerRange>(coalesceClass::NONE, range);
 }//END setAccelerometerRange
 
 
@@ -793,24 +1350,7 @@ void Sphero::setAccelerometerRange(uint8_t range)
  */
 void Sphero::roll(uint8_t speed, uint16_t heading, uint8_t state)
 {
-	uint8_t msb = (uint8_t)((heading & 0xFF00) >> 8);
-	uint8_t lsb = (uint8_t)(heading & 0x00FF);
-	uint8_t data_payload[4];
-	data_payload[0] = speed;
-	data_payload[1] = msb;
-	data_payload[2] = lsb;
-	data_payload[3] = state;
-
-	ClientCommandPacket packet(
-				DID::sphero,
-				CID::roll,
-				flags::notNeeded,
-				0x05,
-				data_payload,
-				_waitConfirm,
-				_resetTimer
-				);
-	sendPacket(packet);
+	sendCommand<command::roll>(coalesceClass::ROLL, speed, heading, state);
 }//END roll
 
 
@@ -831,129 +1371,69 @@ void Sphero::setInactivityTimeout(uint16_t timeout)
 	{
 		timeout = 60;
 	}
-	timeout = htobe16(timeout);
-	uint8_t* data = (uint8_t*) &timeout;
-
-	ClientCommandPacket packet(
-				DID::core,
-				CID::setInactivityTimeout,
-				flags::notNeeded,
-				0x03,
-				data,
-				_waitConfirm,
-				_resetTimer
-				);
-	sendPacket(packet);
+
+	sendCommand<command::setInactivityTimeout>(coalesceClass::NONE, timeout);
 }
 
 
 /**
- * @brief updateParameters : Updates the parameters to check on reception
+ * @brief setPowerNotification : Enables or disables the asynchronous power
+ * 								 notifications, sent when the battery state
+ * 								 changes and every 10 seconds (see
+ * 								 onPowerStateChange)
+ * @param enable : true to receive them
+ */
+void Sphero::setPowerNotification(bool enable)
+{
+	sendCommand<command::setPowerNotification>(coalesceClass::NONE,
+			enable ? 1 : 0);
+}//END setPowerNotification
+
+
+/**
+ * @return The battery state of the latest power notification, UNKNOWN if
+ * 		   none was received
+ */
+powerState Sphero::getLastPowerState()
+{
+	return (powerState) _powerState.load(std::memory_order_relaxed);
+}//END getLastPowerState
+
+
+/**
+ * @brief updateParameters : Updates the parameters to check on reception,
+ * 							 the framer included
  * @param nbFrames : the number of frames per packet
  * @param mask : The data mask
  * @param mask2 : The data second mask
  */
 void Sphero::updateParameters(int nbFrames, uint32_t maskVal, uint32_t mask2Val)
 {
-	_nbFrames = nbFrames;
-
 	pthread_mutex_lock(&lock);
+	_stream.configure(nbFrames, maskVal, mask2Val);
+	size_t dlen = _stream.getNbFrames() * _stream.getNbFields() * 2 + 1;
+	_framer.setStreamingDlen(_stream.matches(dlen) ? dlen : 0);
+	pthread_mutex_unlock(&lock);
+}
 
-	_typesLst.clear();
-
-	if(maskVal & mask::RAW_ACCEL_X)
-		_typesLst.push_back(dataTypes::RAW_ACCEL_X);
-
-	if(maskVal & mask::RAW_ACCEL_Y)
-		_typesLst.push_back(dataTypes::RAW_ACCEL_Y);
-
-	if(maskVal & mask::RAW_ACCEL_Z)
-		_typesLst.push_back(dataTypes::RAW_ACCEL_Z);
-
-	if(maskVal & mask::RAW_GYRO_X)
-		_typesLst.push_back(dataTypes::RAW_GYRO_X);
-
-	if(maskVal & mask::RAW_GYRO_Y)
-		_typesLst.push_back(dataTypes::RAW_GYRO_Y);
-
-	if(maskVal & mask::RAW_GYRO_Z)
-		_typesLst.push_back(dataTypes::RAW_GYRO_Z);
-
-	if(maskVal & mask::RAW_RIGHT_MOTOR_BACK_EMF)
-		_typesLst.push_back(dataTypes::RAW_RIGHT_MOTOR_BACK_EMF);
-
-	if(maskVal & mask::RAW_LEFT_MOTOR_BACK_EMF)
-		_typesLst.push_back(dataTypes::RAW_LEFT_MOTOR_BACK_EMF);
-
-	if(maskVal & mask::RAW_LEFT_MOTOR_PWM)
-		_typesLst.push_back(dataTypes::RAW_LEFT_MOTOR_PWM);
-
-	if(maskVal & mask::RAW_RIGHT_MOTOR_PWM)
-		_typesLst.push_back(dataTypes::RAW_RIGHT_MOTOR_PWM);
-
-	if(maskVal & mask::FILTERED_PITCH_IMU)
-		_typesLst.push_back(dataTypes::FILTERED_PITCH_IMU);
-
-	if(maskVal & mask::FILTERED_ROLL_IMU)
-		_typesLst.push_back(dataTypes::FILTERED_ROLL_IMU);
-
-	if(maskVal & mask::FILTERED_YAW_IMU)
-		_typesLst.push_back(dataTypes::FILTERED_YAW_IMU);
-
-	if(maskVal & mask::FILTERED_ACCEL_X)
-		_typesLst.push_back(dataTypes::FILTERED_ACCEL_X);
-
-	if(maskVal & mask::FILTERED_ACCEL_X)
-		_typesLst.push_back(dataTypes::FILTERED_ACCEL_X);
-
-	if(maskVal & mask::FILTERED_ACCEL_Y)
-		_typesLst.push_back(dataTypes::FILTERED_ACCEL_Y);
-
-	if(maskVal & mask::FILTERED_ACCEL_Z)
-		_typesLst.push_back(dataTypes::FILTERED_ACCEL_Z);
-
-	if(maskVal & mask::FILTERED_RIGHT_MOTOR_BACK_EMF)
-		_typesLst.push_back(dataTypes::FILTERED_RIGHT_MOTOR_BACK_EMF);
-
-	if(maskVal & mask::FILTERED_LEFT_MOTOR_BACK_EMF)
-		_typesLst.push_back(dataTypes::FILTERED_LEFT_MOTOR_BACK_EMF);
-
-	if(mask2Val & mask2::QUATERNION_Q0)
-		_typesLst.push_back(dataTypes::QUATERNION_Q0);
-
-	if(mask2Val & mask2::QUATERNION_Q1)
-		_typesLst.push_back(dataTypes::QUATERNION_Q1);
-
-	if(mask2Val & mask2::QUATERNION_Q2)
-		_typesLst.push_back(dataTypes::QUATERNION_Q2);
-
-	if(mask2Val & mask2::QUATERNION_Q3)
-		_typesLst.push_back(dataTypes::QUATERNION_Q3);
-
-	if(mask2Val & mask2::ODOMETER_X)
-		_typesLst.push_back(dataTypes::ODOMETER_X);
-
-	if(mask2Val & mask2::ODOMETER_Y)
-		_typesLst.push_back(dataTypes::ODOMETER_Y);
-
-	if(mask2Val & mask2::ACCELONE_0)
-		_typesLst.push_back(dataTypes::ACCELONE_0);
-
-	if(mask2Val & mask2::VELOCITY_X)
-		_typesLst.push_back(dataTypes::VELOCITY_X);
-
-	if(mask2Val & mask2::VELOCITY_Y)
-		_typesLst.push_back(dataTypes::VELOCITY_Y);
-
-	sort(_typesLst.begin(), _typesLst.end());
-
+const vector<dataTypes> Sphero::getTypesList()
+{
+	pthread_mutex_lock(&lock);
+	vector<dataTypes> types(_stream.getFields(),
+			_stream.getFields() + _stream.getNbFields());
 	pthread_mutex_unlock(&lock);
 
+	return types;
 }
 
-const vector<dataTypes> Sphero::getTypesList()
+
+/**
+ * @return The field table of the streaming packets, to be used
+ * 		   while holding requestLock()
+ */
+const StreamLayout& Sphero::getStreamLayout()
 {
-	return _typesLst;
+	return _stream;
 }
 
 
@@ -964,11 +1444,7 @@ const vector<dataTypes> Sphero::getTypesList()
  */
 bool Sphero::checkValid(int len)
 {
-	bool valid = false;
-	if((unsigned int)len - 1 == _typesLst.size() * 2 * _nbFrames)
-		valid = true;
-
-	return valid;
+	return len > 0 && _stream.matches(len);
 }
 
 /**
@@ -997,63 +1473,75 @@ void Sphero::requestLock(bool take)
  */
 void Sphero::sleep(uint16_t time, uint8_t macro, uint16_t orbbasic)
 {
-	uint8_t msbTime = (uint8_t)((time & 0xFF00) >> 8);
-	uint8_t lsbTime = (uint8_t)(time & 0x00FF);
-	uint8_t msbOrb = (uint8_t)((orbbasic & 0xFF00) >> 8);
-	uint8_t lsbOrb = (uint8_t)(orbbasic & 0x00FF);
-	uint8_t data_payload[5];
-	data_payload[0] = msbTime;
-	data_payload[1] = lsbTime;
-	data_payload[2] = macro;
-	data_payload[3] = msbOrb;
-	data_payload[4] = lsbOrb;
-
-	ClientCommandPacket packet(
-				DID::core,
-				CID::sleep,
-				flags::notNeeded,
-				0x06,
-				data_payload,
-				_waitConfirm,
-				_resetTimer
-				);
-	sendPacket(packet);
-
+	sendCommand<command::sleep>(coalesceClass::NONE, time, macro, orbbasic);
 }//END sleep
 
-/*
-//setRawMotorValue : not needed ?
-
-void Sphero::setMotionTimeout(uint16_t time);
+/**
+ * @brief setMotionTimeout : This sets the ultimate timeout for the last
+ * 							 motion command to keep Sphero from rolling away
+ * 							 in the case of a crashed (or paused) client app.
+ * @param time : Expressed in milliseconds. Defaults to 2000 upon wake-up.
+ */
+void Sphero::setMotionTimeout(uint16_t time)
+{
+	sendCommand<command::setMotionTimeout>(coalesceClass::NONE, time);
+}//END setMotionTimeout
 
-void Sphero::setPermOptFlags(uint32_t flags);
 
-//getPermOptFlags : we'll see
+/**
+ * @brief setPermOptFlags : Assigns the permanent option flags to the
+ * 							provided value and writes them to the config
+ * 							block for persistence across power cycles.
+ * @param flags : OPT_* flags
+ */
+void Sphero::setPermOptFlags(uint32_t flags)
+{
+	sendCommand<command::setPermanentOptionFlags>(coalesceClass::NONE, flags);
+}//END setPermOptFlags
 
-void Sphero::setTmpOptFlags(uint32_t flags);
 
-//getTmpOptFlags : we'll see
+/**
+ * @brief setTmpOptFlags : Assigns the temporary option flags to the
+ * 						   provided value. These do not persist across a
+ * 						   power cycle.
+ * @param flags : TOPT_* flags
+ */
+void Sphero::setTmpOptFlags(uint32_t flags)
+{
+	sendCommand<command::setTemporaryOptionFlags>(coalesceClass::NONE, flags);
+}//END setTmpOptFlags
 
-void Sphero::setDeviceMode(uint8_t value = 0);
-//01h will set to user hack mode,
-// will implement when we will know the usage of this mode
 
-//getDeviceMode
+/**
+ * @brief setDeviceMode
+ * @param value :
+ *			0x01 : user hack mode
+ */
+void Sphero::setDeviceMode(uint8_t value)
+{
+	sendCommand<command::setDeviceMode>(coalesceClass::NONE, value);
+}//END setDeviceMode
 
-void Sphero::runMacro(uint8_t id);
 
-//void saveMacro(Macro macro);
-*/
+/**
+ * @brief runMacro : This attempts to execute the specified macro
+ * @param id : The macro ID
+ */
+void Sphero::runMacro(uint8_t id)
+{
+	sendCommand<command::runMacro>(coalesceClass::NONE, id);
+}//END runMacro
 
 /**
  * @brief onConnect : Event thrown on Sphero connection
  * @param callback : The callback function to assign to this event
  *			Return type : void
  *			Parameters : none (void)
+ * @return The token to give to removeListener
  */
-void Sphero::onConnect(callback_connect_t callback)
+listenerToken_t Sphero::onConnect(callback_connect_t callback)
 {
-	_connect_handler.addActionListener(callback);
+	return _connect_handler.addActionListener(callback);
 }//END onConnect
 
 
@@ -1062,10 +1550,11 @@ void Sphero::onConnect(callback_connect_t callback)
  * @param callback : The callback function to assign to this event
  *			Return type : void
  *			Parameters : none (void)
+ * @return The token to give to removeListener
  */
-void Sphero::onDisconnect(callback_disconnect_t callback)
+listenerToken_t Sphero::onDisconnect(callback_disconnect_t callback)
 {
-	_disconnect_handler.addActionListener(callback);
+	return _disconnect_handler.addActionListener(callback);
 }//END onDisconnect
 
 
@@ -1074,10 +1563,11 @@ void Sphero::onDisconnect(callback_disconnect_t callback)
  * @param callback : The callback function to assign to this event
  *			Return type : void
  *			Parameters : none (void)
+ * @return The token to give to removeListener
  */
-void Sphero::onPreSleep(callback_preSleep_t callback)
+listenerToken_t Sphero::onPreSleep(callback_preSleep_t callback)
 {
-	_preSleep_handler.addActionListener(callback);
+	return _preSleep_handler.addActionListener(callback);
 } //END onPreSleep
 
 
@@ -1085,11 +1575,41 @@ void Sphero::onPreSleep(callback_preSleep_t callback)
  * @brief onCollision : Event thrown when the Sphero detects a collision
  * @param callback : The callback function to assign to this event
  *			Return type : void
- *			Parameters : spherocoord_t xCoord, spherocoord_t yCoord
+ *			Parameters : CollisionStruct*, only valid during the call (copy
+ *			it to keep it)
+ * @return The token to give to removeListener
+ */
+listenerToken_t Sphero::onCollision(callback_collision_t callback)
+{
+	return _collision_handler.addActionListener(callback);
+}
+
+
+/**
+ * @brief onPowerStateChange : Event thrown for every power notification (see
+ * 							  setPowerNotification)
+ * @param callback : The callback function to assign to this event
+ *			Return type : void
+ *			Parameters : powerState
+ * @return The token to give to removeListener
+ */
+listenerToken_t Sphero::onPowerStateChange(callback_powerState_t callback)
+{
+	return _powerState_handler.addActionListener(callback);
+}
+
+
+/**
+ * @brief onSelfLevelComplete : Event thrown when a self-level routine started
+ * 							   by setSelfLevel ends
+ * @param callback : The callback function to assign to this event
+ *			Return type : void
+ *			Parameters : selfLevelResult
+ * @return The token to give to removeListener
  */
-void Sphero::onCollision(callback_collision_t callback)
+listenerToken_t Sphero::onSelfLevelComplete(callback_selfLevel_t callback)
 {
-	_collision_handler.addActionListener(callback);
+	return _selfLevel_handler.addActionListener(callback);
 }
 
 
@@ -1098,10 +1618,68 @@ void Sphero::onCollision(callback_collision_t callback)
  * @param callback : The callback function to assign to this event
  *			Return type : void
  *			Parameters : none (void)
+ * @return The token to give to removeListener
+ */
+listenerToken_t Sphero::onData(callback_data_t callback)
+{
+	return _data_handler.addActionListener(callback);
+}
+
+
+/**
+ * @brief onAsyncPacket : Event thrown for every asynchronous packet of an ID
+ * 						 code, after the library decoded it if it can (power
+ * 						 notification, level 1 diagnostic, orbBasic output,
+ * 						 macro markers... see SpheroAsyncPacket.hpp)
+ * @param id : The ID code
+ * @param callback : The callback function to assign to this event
+ *			Return type : void
+ *			Parameters : const uint8_t* data, size_t length : the payload
+ *			without header nor checksum, only valid during the call
+ * @return The token to give to removeListener, 0 if no packet of this ID
+ * 		   code can ever be delivered
+ */
+listenerToken_t Sphero::onAsyncPacket(uint8_t id, callback_async_t callback)
+{
+	if(!PacketFramer::acceptsAsync(id))
+	{
+		return 0;
+	}
+	return _async_handlers[id].addActionListener(callback);
+}
+
+
+/**
+ * @brief removeListener : Unregisters a callback given to one of the on*
+ * 						  methods
+ * @param token : The token returned on registration
+ * @return true if the callback was registered
+ *
+ * The callback may still run once after the return, on the thread its
+ * events are dispatched to (see setDispatchPolicy).
  */
-void Sphero::onData(callback_data_t callback)
+bool Sphero::removeListener(listenerToken_t token)
 {
-	_data_handler.addActionListener(callback);
+		//Tokens are unique to the process : at most one handler matches
+	if(_connect_handler.removeActionListener(token)
+			|| _disconnect_handler.removeActionListener(token)
+			|| _preSleep_handler.removeActionListener(token)
+			|| _collision_handler.removeActionListener(token)
+			|| _powerState_handler.removeActionListener(token)
+			|| _selfLevel_handler.removeActionListener(token)
+			|| _data_handler.removeActionListener(token))
+	{
+		return true;
+	}
+
+	for(asyncHandler_t& handler : _async_handlers)
+	{
+		if(handler.hasListener() && handler.removeActionListener(token))
+		{
+			return true;
+		}
+	}
+	return false;
 }
 
 
@@ -1111,7 +1689,70 @@ void Sphero::onData(callback_data_t callback)
 void Sphero::reportCollision(CollisionStruct* infos)
 {
 	collision = true;
-	_collision_handler.reportAction(infos);
+	_motion.collided();
+	if(!_collision_handler.hasListener())
+	{
+		return;
+	}
+
+	callbackEvent event = callbackEvent();
+	event.kind = eventKind::COLLISION;
+	event.collision = *infos;
+	deliver(event);
+}
+
+
+/**
+ * @brief reportPreSleep : Exterior accessor for reporting the pre-sleep
+ * 						  warning
+ */
+void Sphero::reportPreSleep()
+{
+	if(!_preSleep_handler.hasListener())
+	{
+		return;
+	}
+
+	callbackEvent event = callbackEvent();
+	event.kind = eventKind::PRE_SLEEP;
+	deliver(event);
+}
+
+
+/**
+ * @brief reportPowerState : Exterior accessor for reporting a power
+ * 							notification
+ */
+void Sphero::reportPowerState(powerState state)
+{
+	_powerState.store((uint8_t) state, std::memory_order_relaxed);
+	if(!_powerState_handler.hasListener())
+	{
+		return;
+	}
+
+	callbackEvent event = callbackEvent();
+	event.kind = eventKind::POWER_STATE;
+	event.power = state;
+	deliver(event);
+}
+
+
+/**
+ * @brief reportSelfLevel : Exterior accessor for reporting the end of a
+ * 						   self-level routine
+ */
+void Sphero::reportSelfLevel(selfLevelResult result)
+{
+	if(!_selfLevel_handler.hasListener())
+	{
+		return;
+	}
+
+	callbackEvent event = callbackEvent();
+	event.kind = eventKind::SELF_LEVEL;
+	event.selfLevel = result;
+	deliver(event);
 }
 
 
@@ -1120,5 +1761,47 @@ void Sphero::reportCollision(CollisionStruct* infos)
  */
 void Sphero::reportData()
 {
-	_data_handler.reportAction();
+		//Once per packet : its frames share a reception time
+	_motion.update(_kinematics.read());
+
+	if(!_data_handler.hasListener())
+	{
+		return;
+	}
+
+	callbackEvent event = callbackEvent();
+	event.kind = eventKind::DATA;
+	deliver(event);
+}
+
+
+/**
+ * @brief reportDroppedFrame : Exterior accessor for counting a valid frame
+ * 							   which could not be used
+ */
+void Sphero::reportDroppedFrame()
+{
+	_linkStats.addDroppedFrame();
+}
+
+
+/**
+ * @brief reportAsyncPacket : Exterior accessor for reporting an asynchronous
+ * 							  packet payload
+ * @return true if a listener was registered for the ID code
+ */
+bool Sphero::reportAsyncPacket(uint8_t id, const uint8_t* data, size_t length)
+{
+	if(id > MAX_ASYNC_ID || !_async_handlers[id].hasListener())
+	{
+		return false;
+	}
+
+	callbackEvent event = callbackEvent();
+	event.kind = eventKind::ASYNC_PACKET;
+	event.asyncId = id;
+	event.data = data;
+	event.length = length;
+	deliver(event);
+	return true;
 }
@@ -11,21 +11,34 @@
 //------------------------------------------------------------- System includes
 #include <pthread.h>
 #include <cstdint>
+#include <atomic>
 #include <string>
 #include <list>
 #include <functional>
 #include <vector>
 #include <sys/time.h>
-#include <semaphore.h>
 
 //-------------------------------------------------------------- Local includes
 #include "bluetooth/bluetooth_connector.h"
 #include "packets/ClientCommandPacket.hpp"
 #include "ActionHandler.hpp"
+#include "CallbackExecutor.hpp"
+#include "ClockSync.hpp"
+#include "MotionController.hpp"
 #include "packets/SpheroAnswerPacket.hpp"
+#include "packets/PacketFramer.hpp"
+#include "packets/SpheroAsyncPacket.hpp"
+#include "packets/PacketWriter.hpp"
+#include "packets/CommandTracker.hpp"
+#include "packets/LinkStats.hpp"
+#include "capture/WireRecorder.hpp"
+#include "packets/Commands.hpp"
 #include "packets/async/DataBuffer.h"
+#include "packets/async/StreamLayout.hpp"
+#include "packets/async/KinematicState.hpp"
 
 #include "packets/async/CollisionStruct.hpp"
+#include "packets/async/NotificationTypes.hpp"
 
 #include "packets/answer/ColorStruct.hpp"
 #include "packets/answer/BTInfoStruct.hpp"
@@ -59,6 +72,7 @@ static time_t const NB_SEC_SYNC_BEFORE_FAILURE = 1;
 //----------------------------------------------------------------------- Types
 class ClientCommandPacket;
 class sphero_listener;
+class SpheroReactor;
 
 typedef int16_t spherocoord_t;
 
@@ -69,18 +83,35 @@ typedef ActionHandler<> disconnectHandler_t;
 typedef ActionHandler<> preSleepHandler_t;
 typedef ActionHandler<CollisionStruct*> collisionHandler_t;
 typedef ActionHandler<> dataHandler_t;
+typedef ActionHandler<powerState> powerStateHandler_t;
+typedef ActionHandler<selfLevelResult> selfLevelHandler_t;
+typedef ActionHandler<const uint8_t*, size_t> asyncHandler_t;
 
 typedef connectHandler_t::listener_t callback_connect_t;
 typedef disconnectHandler_t::listener_t callback_disconnect_t;
 typedef collisionHandler_t::listener_t callback_collision_t;
 typedef preSleepHandler_t::listener_t callback_preSleep_t;
 typedef dataHandler_t::listener_t callback_data_t;
+typedef powerStateHandler_t::listener_t callback_powerState_t;
+typedef selfLevelHandler_t::listener_t callback_selfLevel_t;
+typedef asyncHandler_t::listener_t callback_async_t;
+
+	/* Answers callbacks. The structure is NULL if no valid answer was
+	 * received in time, and is only valid during the call. They run as
+	 * command completions : on the reception thread, the TimerWheel
+	 * deferred thread or the thread calling disconnect(), none of which
+	 * may block (see commandCompletion_t) */
+typedef std::function<void(ColorStruct*)> callback_color_t;
+typedef std::function<void(BTInfoStruct*)> callback_btinfo_t;
 
 
 //------------------------------------------------------------ Class definition
 
 class Sphero
 {
+	friend class SpheroReactor;
+	friend class CallbackExecutor;
+
 	public:
 
 		//----------------------------------------------------------- Operators
@@ -102,11 +133,15 @@ class Sphero
 		//------------------------------------------------------ Public methods
 
 		/**
-		 * @brief : notify sphero that a synchronous packet has arrived
-		 *
-		 * @return nothing since it's a void method :-)
+		 * @brief notifyPacket : notify sphero that an answer packet has
+		 * 						 arrived, completing the matching command
+		 * @param seqNum : The answer sequence number
+		 * @param mrsp : The message response code
+		 * @param dlen : The answer DLEN field
+		 * @param data : The answer payload (NULL if empty)
 		 */
-		void notifyPacket(uint8_t seqNum, uint8_t mrsp, void* pointer);
+		void notifyPacket(uint8_t seqNum, uint8_t mrsp, uint8_t dlen,
+				const uint8_t* data);
 
 		/**
 		 * @brief connect : Initializes the bluetooth connection to the sphero
@@ -120,14 +155,174 @@ class Sphero
 		 */
 		void disconnect();
 
+		/**
+		 * @brief setReactor : Makes the given reactor receive the Sphero
+		 * 					   frames instead of a dedicated monitor thread.
+		 * 					   Takes effect on the next connection
+		 * @param reactor : The reactor to use, NULL to go back to a
+		 * 					dedicated thread
+		 *
+		 * disconnect() then waits for the reactor to finish dispatching
+		 * this Sphero frames, as it joins the monitor thread otherwise :
+		 * it must not be called from a thread the Sphero INLINE listeners
+		 * wait for. The other Spheros of the reactor do not delay it.
+		 */
+		void setReactor(SpheroReactor* reactor);
+
+		/**
+		 * @brief setDispatchPolicy : Chooses the thread calling the
+		 * 							 listeners of an event
+		 * @param kind : The event
+		 * @param policy : INLINE (default) on the reception thread,
+		 * 				   ROBOT_EXECUTOR on a thread of this Sphero, or
+		 * 				   SHARED_EXECUTOR on the executor given to
+		 * 				   setSharedExecutor (inline while there is none)
+		 *
+		 * Queued events are copied : a CollisionStruct or an asynchronous
+		 * payload stays valid during the call, as inline.
+		 */
+		void setDispatchPolicy(eventKind kind, dispatchPolicy policy);
+
+		/**
+		 * @brief configureRobotExecutor : Sets the queue of the Sphero own
+		 * 								  executor. Only possible before an
+		 * 								  event uses it
+		 * @param capacity : The most events queued at once
+		 * @param overflow : What to do with an event when the queue is full
+		 * @return false if the executor is already started
+		 */
+		bool configureRobotExecutor(size_t capacity, overflowPolicy overflow);
+
+		/**
+		 * @brief setSharedExecutor : Gives the executor used by the events
+		 * 							 dispatched with SHARED_EXECUTOR
+		 * @param executor : The executor, NULL for none. It must live until
+		 * 					 it is replaced or the Sphero is destroyed
+		 *
+		 * The events already queued in the former executor are run before
+		 * the return.
+		 */
+		void setSharedExecutor(CallbackExecutor* executor);
+
+		/**
+		 * @return The counters of the Sphero own executor (zero while it is
+		 * 		   not started)
+		 */
+		ExecutorStats getRobotExecutorStats();
+
+		/**
+		 * @return The outbound queue counters (queue depth, packets per
+		 * 		   system call, bytes per system call, roll and LED commands
+		 * 		   replaced before being sent...)
+		 */
+		WriterStats getWriterStats();
+
+		/**
+		 * @brief getLinkStats : Copies the link counters without stopping
+		 * 						 the reception (cheap enough to be polled
+		 * 						 every second). The copy is consistent :
+		 * 						 every counter has the value it had at
+		 * 						 takenAtUs, unless the counters moved
+		 * 						 during LINK_STATS_MAX_READS reads (see
+		 * 						 LinkSnapshot::consistent)
+		 * @return Bytes and frames in and out, checksum failures,
+		 * 		   resynchronizations and discarded bytes, dropped frames,
+		 * 		   and the round-trip
+		 * 		   percentiles and timeouts of every acknowledged command
+		 */
+		LinkSnapshot getLinkStats();
+
+		/**
+		 * @brief startCapture : Records every frame received and sent from
+		 * 						 now on, for WireReplay
+		 * @param path : The capture file, truncated
+		 * @return false if the file could not be created
+		 */
+		bool startCapture(const char* path);
+
+		/**
+		 * @brief stopCapture : Closes the capture file
+		 */
+		void stopCapture();
+
+		/**
+		 * @brief startClockSync : Sets the Sphero clock to the host one on
+		 * 						  every connection, then estimates their
+		 * 						  offset and drift with pollPacketTimes
+		 * 						  probes sent by a background thread
+		 * @param periodMs : The delay between two probes
+		 * @return false if it is already started
+		 *
+		 * Collisions are then stamped with the host time of the impact
+		 * (CollisionStruct::hostTimestampUs).
+		 */
+		bool startClockSync(unsigned int periodMs = CLOCK_SYNC_PERIOD_MS);
+
+		/**
+		 * @brief stopClockSync : Stops the probes, the estimation being
+		 * 						 kept
+		 */
+		void stopClockSync();
+
+		/**
+		 * @return The offset and drift of the Sphero clock
+		 */
+		ClockEstimate getClockEstimate();
+
+		/**
+		 * @brief toHostTime : Converts a Sphero timestamp
+		 * @param deviceMs : The Sphero time, in ms
+		 * @param hostUs : Receives the host monotonic time
+		 * 				   (packet_toolbox::monotonicUs), in µs
+		 * @return false while the clocks are not synchronized
+		 */
+		bool toHostTime(uint32_t deviceMs, uint64_t& hostUs);
+
+		/**
+		 * @brief dispatchFrame : Decodes a frame and performs its action, as
+		 * 						  done for every frame received
+		 * @param frame : The frame, starting at SOP1
+		 * @param length : The frame length, checksum included
+		 *
+		 * Contract: the frame is checksum-valid, and dispatched by the
+		 * reception thread or while it is not running (replay)
+		 */
+		void dispatchFrame(const uint8_t* frame, size_t length);
+
+		/**
+		 * @brief beginBatch : Until endBatch, every command sent by the
+		 * 					   calling thread is sent acknowledged without
+		 * 					   waiting for the previous answers (up to
+		 * 					   PENDING_COMMAND_SLOTS in flight). The other
+		 * 					   threads are not affected, nor is the
+		 * 					   reception thread, which never waits for a slot
+		 */
+		void beginBatch();
+
+		/**
+		 * @brief endBatch : Waits for the answers to every command sent by the
+		 * 					 calling thread since its beginBatch
+		 * @param maxRttUs : If not NULL, receives the longest round-trip time
+		 * 					 of the batch, in µs
+		 * @return true if every command was answered successfully
+		 */
+		bool endBatch(uint32_t* maxRttUs = NULL);
+
 		/**
 		 * @brief ping : Creates a ping request to the Sphero
 		 */
 		void ping();
 
+		/**
+		 * @brief ping : Sends an acknowledged ping to the Sphero
+		 * @param callback : Called once with the answer (or its absence),
+		 * 					 on a thread which must not block (see
+		 * 					 commandCompletion_t)
+		 */
+		void ping(commandCompletion_t callback);
+
 
 		uint16_t getNormalisedSpeed();
-		void setNormalisedSpeed(uint16_t normalisedSpeed);
 
 		/**
 		 * @brief setColor : Changes the Sphero light color
@@ -139,14 +334,24 @@ class Sphero
 		void setColor(uint8_t red, uint8_t green, uint8_t blue, bool persist = false);
 
 		/**
-		 * @brief getColor : Ask to sphero for colors information and pass it to 
-		 * 						to a callback
-		 * @param callback : callback function to be called when answer is
-		 * 					 received. Will be called only one time.
-		 * 					 User needs to manually destruct the ColorStruct*
-		 * 					 argument;
+		 * @brief getColor : Asks the Sphero for its color and waits for the
+		 * 					 answer
+		 * @param color : Receives the color
+		 * @return false if no valid answer came in time, or at once on a
+		 * 		   thread the answer would have to come through (a
+		 * 		   reception thread, or a timeout completion : see
+		 * 		   CommandTracker::mayWaitForAnswer)
+		 */
+		bool getColor(ColorStruct& color);
+
+		/**
+		 * @brief getColor : Asks the Sphero for its color without waiting
+		 * 					 for the answer
+		 * @param callback : Called once with the color (NULL if no answer
+		 * 					 came in time), on a thread which must not
+		 * 					 block (see commandCompletion_t)
 		 */
-		ColorStruct* getColor();
+		void getColor(callback_color_t callback);
 
 		/**
 		 * @brief setBackLedOutput : Lights the back led(used to calibrate
@@ -189,7 +394,7 @@ class Sphero
 		 * 						control system on/off.
 		 * 						An asynchronous message is returned when the
 		 * 						self level routine completes (only when started
-		 * 						by API call)
+		 * 						by API call), see onSelfLevelComplete
 		 *
 		 * @param options : Flags to control the routine behavior. Disponible flags are:
 		 *			Start/stop bit (only one of them can be used at a time):
@@ -221,8 +426,61 @@ class Sphero
 		void setSelfLevel(uint8_t options = 0, uint8_t angle_limit = 3,
 						  uint8_t timeout = 15, uint8_t trueTime = 30);
 
+		/**
+		 * @brief rollToPosition : Enables the collision detection and drives
+		 * 						  to a position, waiting for the end of the
+		 * 						  drive (see moveTo)
+		 * @param x : The target abscissa, in cm
+		 * @param y : The target ordinate, in cm
+		 * @param initSpeed : The highest roll speed
+		 *
+		 * Blocks the calling thread : never call it from an INLINE
+		 * listener, which runs on the reception thread. Gives up if no
+		 * streaming packet comes for MOTION_STALL_MS.
+		 */
 		void rollToPosition(spherocoord_t x, spherocoord_t y, uint8_t initSpeed = 90);
 
+		/**
+		 * @brief moveTo : Drives to a position without waiting, the roll
+		 * 				  commands being computed on every streaming packet
+		 * 				  (see MotionController), and ends the drive in
+		 * 				  progress
+		 * @param x : The target abscissa, in cm
+		 * @param y : The target ordinate, in cm
+		 * @param params : The speeds, tolerance, gains...
+		 * @return The end of the drive. It needs ODOMETER_X and ODOMETER_Y
+		 * 		   in the stream, VELOCITY_X and VELOCITY_Y to stop cleanly
+		 * 		   and correct the heading
+		 */
+		std::future<MotionResult> moveTo(spherocoord_t x, spherocoord_t y,
+				const MotionParams& params = MotionParams());
+
+		/**
+		 * @brief followPath : Drives through waypoints without stopping at
+		 * 					  them, and ends the drive in progress. The path
+		 * 					  from the current position and its velocity
+		 * 					  profile are computed first (see Trajectory),
+		 * 					  then the heading and speed setpoints on every
+		 * 					  streaming packet (see MotionController)
+		 * @param waypoints : The points to go through, in cm
+		 * @param shape : POLYLINE (corners blended) or SPLINE
+		 * @param limits : The speed and accelerations planned
+		 * @param params : The tolerance at the last waypoint, gains...
+		 * @return The end of the drive, at the last waypoint. It needs the
+		 * 		   same streamed fields as moveTo
+		 */
+		std::future<MotionResult> followPath(const std::vector<Waypoint>& waypoints,
+				pathShape shape = pathShape::POLYLINE,
+				const TrajectoryLimits& limits = TrajectoryLimits(),
+				const MotionParams& params = MotionParams());
+
+		/**
+		 * @brief cancelMotion : Stops the Sphero and ends the drive started
+		 * 						by moveTo or followPath (CANCELLED)
+		 * @return false if no drive was in progress
+		 */
+		bool cancelMotion();
+
 		/**
 		 * @brief enableCollisionDetection : Enables the onBoard collision
 		 * 									 detector
@@ -262,15 +520,24 @@ class Sphero
 		 */
 		bool isConnected();
 
-		void setX(spherocoord_t x);
-		void setY(spherocoord_t y);
-		void setSpeedX(int16_t speedx);
-		void setSpeedY(int16_t speedy); //vas donc, vas donc chez speedy, speedy !
-		
 		int16_t getX();
 		int16_t getY();
 		int16_t getSpeedX();
-		int16_t getSpeedY();
+		int16_t getSpeedY(); //vas donc, vas donc chez speedy, speedy !
+
+		/**
+		 * @brief getKinematics : Reads position and speed at once, without lock
+		 * @return The values of the latest streaming frame, consistent together
+		 */
+		KinematicSnapshot getKinematics();
+
+		/**
+		 * @brief publishKinematics : Replaces the kinematic snapshot
+		 * @param snapshot : The values of a streaming frame
+		 *
+		 * Contract: called by the reception thread only
+		 */
+		void publishKinematics(const KinematicSnapshot& snapshot);
 
 		/**
 		 * @brief configureLocator : Configure sphero's internal location
@@ -414,12 +681,21 @@ class Sphero
 		 * 		if you're not, here is a clue : it gives informations about
 		 * 		bluetooth parameters, for example bluetooth name and address.
 		 *
-		 * 	@return a BTInfoStruct pointer pointing on a dynamically allocated
-		 * 	struct that user will be very kind to deallocate himself or null if
-		 * 	answer wasn't received in time (in this case we tried to manage
-		 * 	properly the memory, don't be scared).
+		 * 	@param btinfo : Receives the name and address
+		 * 	@return false if no valid answer came in time (btinfo is then
+		 * 	left untouched), or at once on a thread the answer would have to
+		 * 	come through (see getColor)
+		 */
+		bool getBTInfo(BTInfoStruct& btinfo);
+
+		/**
+		 * @brief getBTInfo : Asks the Sphero for its bluetooth informations
+		 * 					  without waiting for the answer
+		 * @param callback : Called once with the informations (NULL if no
+		 * 					 answer came in time), on a thread which must
+		 * 					 not block (see commandCompletion_t)
 		 */
-		BTInfoStruct* getBTInfo();
+		void getBTInfo(callback_btinfo_t callback);
 
 		/**
 		 * @brief runMacro : This attempts to execute the specified macro
@@ -473,13 +749,29 @@ class Sphero
 		 *					flag is set.
 		 */
 		void setInactivityTimeout(uint16_t timeout);
+
+		/**
+		 * @brief setPowerNotification : Enables or disables the asynchronous
+		 * 								 power notifications, sent when the
+		 * 								 battery state changes and every 10
+		 * 								 seconds (see onPowerStateChange)
+		 * @param enable : true to receive them
+		 */
+		void setPowerNotification(bool enable);
+
+		/**
+		 * @return The battery state of the latest power notification,
+		 * 		   UNKNOWN if none was received
+		 */
+		powerState getLastPowerState();
 		
 		bool getCollision(void);
 
 		//------------------------------------------------ Data streaming utils
 
 		/**
-		 * @brief updateParameters : Updates the parameters to check on reception
+		 * @brief updateParameters : Updates the parameters to check on reception,
+		 * 							 the framer included
 		 * @param nbFrames : the number of frames per packet
 		 * @param mask : The data mask
 		 * @param mask2 : The data second mask
@@ -491,6 +783,12 @@ class Sphero
 		 */
 		const vector<dataTypes> getTypesList();
 
+		/**
+		 * @return The field table of the streaming packets, to be used
+		 * 		   while holding requestLock()
+		 */
+		const StreamLayout& getStreamLayout();
+
 		/**
 		 * @brief checkValid : Checks the validity of a packet length
 		 * @param len : The packet length
@@ -511,8 +809,9 @@ class Sphero
 		 * @param callback : The callback function to assign to this event
 		 *			Return type : void
 		 *			Parameters : none (void)
+		 * @return The token to give to removeListener
 		 */
-		void onConnect(callback_connect_t callback);
+		listenerToken_t onConnect(callback_connect_t callback);
 
 
 		/**
@@ -520,25 +819,51 @@ class Sphero
 		 * @param callback : The callback function to assign to this event
 		 *			Return type : void
 		 *			Parameters : none (void)
+		 * @return The token to give to removeListener
 		 */
-		void onDisconnect(callback_disconnect_t callback);
+		listenerToken_t onDisconnect(callback_disconnect_t callback);
 
 		/**
 		 * @brief onPreSleep : Event thrown 10 sec. before sphero sleeps
 		 * @param callback : The callback function to assign to this event
 		 *			Return type : void
 		 *			Parameters : none (void)
+		 * @return The token to give to removeListener
 		 */
-		void onPreSleep(callback_preSleep_t callback);
+		listenerToken_t onPreSleep(callback_preSleep_t callback);
+
+
+		/**
+		 * @brief onPowerStateChange : Event thrown for every power
+		 * 							  notification (see setPowerNotification)
+		 * @param callback : The callback function to assign to this event
+		 *			Return type : void
+		 *			Parameters : powerState
+		 * @return The token to give to removeListener
+		 */
+		listenerToken_t onPowerStateChange(callback_powerState_t callback);
+
+
+		/**
+		 * @brief onSelfLevelComplete : Event thrown when a self-level routine
+		 * 							   started by setSelfLevel ends
+		 * @param callback : The callback function to assign to this event
+		 *			Return type : void
+		 *			Parameters : selfLevelResult
+		 * @return The token to give to removeListener
+		 */
+		listenerToken_t onSelfLevelComplete(callback_selfLevel_t callback);
 
 
 		/**
 		 * @brief onCollision : Event thrown when the Sphero detects a collision
 		 * @param callback : The callback function to assign to this event
 		 *			Return type : void
-		 *			Parameters : spherocoord_t xCoord, spherocoord_t yCoord
+		 *			Parameters : CollisionStruct*, only valid during the
+		 *			call (copy it to keep it)
+		 * @return The token to give to removeListener
 		 */
-		void onCollision(callback_collision_t callback);
+		listenerToken_t onCollision(callback_collision_t callback);
 
 
 		/**
@@ -546,8 +871,39 @@ class Sphero
 		 * @param callback : The callback function to assign to this event
 		 *			Return type : void
 		 *			Parameters : none (void)
+		 * @return The token to give to removeListener
+		 */
+		listenerToken_t onData(callback_data_t callback);
+
+
+		/**
+		 * @brief onAsyncPacket : Event thrown for every asynchronous packet
+		 * 						 of an ID code, after the library decoded it
+		 * 						 if it can (power notification, level 1
+		 * 						 diagnostic, orbBasic output, macro markers...
+		 * 						 see SpheroAsyncPacket.hpp)
+		 * @param id : The ID code
+		 * @param callback : The callback function to assign to this event
+		 *			Return type : void
+		 *			Parameters : const uint8_t* data, size_t length : the
+		 *			payload without header nor checksum, only valid during
+		 *			the call
+		 * @return The token to give to removeListener, 0 if no packet of
+		 * 		   this ID code can ever be delivered
+		 */
+		listenerToken_t onAsyncPacket(uint8_t id, callback_async_t callback);
+
+
+		/**
+		 * @brief removeListener : Unregisters a callback given to one of the
+		 * 						  on* methods
+		 * @param token : The token returned on registration
+		 * @return true if the callback was registered
+		 *
+		 * The callback may still run once after the return, on the thread
+		 * its events are dispatched to (see setDispatchPolicy).
 		 */
-		void onData(callback_data_t callback);
+		bool removeListener(listenerToken_t token);
 
 
 		/**
@@ -556,35 +912,195 @@ class Sphero
 		void reportCollision(CollisionStruct* infos);
 
 
+
+		/**
+		 * @brief reportPreSleep : Exterior accessor for reporting the
+		 * 						  pre-sleep warning
+		 */
+		void reportPreSleep();
+
+
+		/**
+		 * @brief reportPowerState : Exterior accessor for reporting a power
+		 * 							notification
+		 */
+		void reportPowerState(powerState state);
+
+
+		/**
+		 * @brief reportSelfLevel : Exterior accessor for reporting the end of
+		 * 						   a self-level routine
+		 */
+		void reportSelfLevel(selfLevelResult result);
+
+
 		/**
 		 * @brief reportData : Exterior accessor for reporting a new data from stream
 		 */
 		void reportData();
 
-		void lockSeqnum(uint8_t seqnum);
-		pendingCommandType getTodo(uint8_t sequm);
-		void unlockSeqnum(uint8_t packet);
+
+		/**
+		 * @brief reportDroppedFrame : Exterior accessor for counting a valid
+		 * 							   frame which could not be used
+		 */
+		void reportDroppedFrame();
+
+
+
+		/**
+		 * @brief reportAsyncPacket : Exterior accessor for reporting an
+		 * 							  asynchronous packet payload
+		 * @return true if a listener was registered for the ID code
+		 */
+		bool reportAsyncPacket(uint8_t id, const uint8_t* data, size_t length);
 
 	protected:
 		//--------------------------------------------------- Protected methods
 		static void* monitorStream(void* sphero_ptr);
 
-		void sendAcknowledgedPacket(ClientCommandPacket& packet, uint8_t seqToWait);
+		/**
+		 * @brief joinMonitor : Waits for the end of the monitor thread. On
+		 * 					   the monitor thread itself, it is detached
+		 * 					   instead
+		 */
+		void joinMonitor();
 
-		void sendPacket(ClientCommandPacket& packet);
+		/**
+		 * @brief processIncoming : Reads the available bytes on the socket
+		 * 							and dispatches every complete frame
+		 * @return false if the connection is closed
+		 */
+		bool processIncoming();
+
+		/**
+		 * @brief sendCommand : Serializes and sends a command expecting no
+		 * 						data in return, acknowledged if the calling
+		 * 						thread opened a batch
+		 * @param Command : The command descriptor (see packets/Commands.hpp)
+		 * @param kind : Coalescing class, used only when not acknowledged
+		 * @param values : One value per payload field
+		 */
+		template<typename Command, typename... Args>
+		void sendCommand(coalesceClass kind = coalesceClass::NONE,
+				Args... values);
+
+		/**
+		 * @brief sendAcknowledgedCommand : Serializes and sends a command
+		 * 									asking for an answer, without
+		 * 									waiting for it
+		 * @param Command : The command descriptor (see packets/Commands.hpp)
+		 * @param completion : Called once with the answer, or after
+		 * 					   NB_SEC_SYNC_BEFORE_FAILURE without answer
+		 * 					   (see commandCompletion_t for its thread)
+		 * @param values : One value per payload field
+		 */
+		template<typename Command, typename... Args>
+		void sendAcknowledgedCommand(commandCompletion_t completion,
+				Args... values);
+
+		/**
+		 * @brief sendPacket : Queues the packet for the writer thread
+		 * @param packet : The packet to send to the Sphero
+		 * @param kind : Coalescing class, the unsent packet of the same class
+		 * 				 being dropped
+		 */
+		void sendPacket(ClientCommandPacket& packet,
+				coalesceClass kind = coalesceClass::NONE);
+
+		/**
+		 * @brief sendSerialized : Sends a serialized command expecting no
+		 * 						   data in return, acknowledged if the calling
+		 * 						   thread opened a batch
+		 * @param packet : The packet, which sequence number may be changed
+		 * @param size : The packet size
+		 * @param kind : Coalescing class, used only when not acknowledged
+		 */
+		void sendSerialized(uint8_t* packet, size_t size, coalesceClass kind);
+
+		/**
+		 * @brief sendSerializedAcknowledged : Sends a serialized command
+		 * 									   asking for an answer, without
+		 * 									   waiting for it
+		 * @param packet : The packet, which sequence number is set
+		 * @param size : The packet size
+		 * @param completion : Called once with the answer, or after
+		 * 					   NB_SEC_SYNC_BEFORE_FAILURE without answer
+		 * 					   (see commandCompletion_t for its thread)
+		 */
+		void sendSerializedAcknowledged(uint8_t* packet, size_t size,
+				commandCompletion_t completion);
 
 
 	private:
+		//------------------------------------------------------- Private types
+
+			/* Commands sent by one thread since its beginBatch */
+		struct commandBatch
+		{
+			pthread_t owner;
+			size_t outstanding;
+			bool failed;
+			uint32_t maxRttUs;
+		};
+
+		//----------------------------------------------------- Private methods
+
+		/**
+		 * @brief batchOf : Finds the batch opened by the calling thread. The
+		 * 				   batch lock must be held
+		 * @return The batch, NULL if the thread has none open
+		 */
+		commandBatch* batchOf();
+
+		/**
+		 * @brief deliver : Calls the listeners of an event, or queues it,
+		 * 				   according to the event dispatch policy
+		 * @param event : The event
+		 */
+		void deliver(const callbackEvent& event);
+
+		/**
+		 * @brief runEvent : Calls the listeners of an event
+		 * @param event : The event
+		 */
+		void runEvent(const callbackEvent& event);
+
+		/**
+		 * @brief checkMotion : Checks that a drive can start
+		 * @param outcome : Receives the reason it cannot
+		 * @return false if it cannot
+		 */
+		bool checkMotion(motionOutcome& outcome);
+
+		/**
+		 * @brief readLinkCounters : Reads every link counter once, one by
+		 * 							one
+		 * @param snapshot : Receives them, but takenAtUs and consistent
+		 */
+		void readLinkCounters(LinkSnapshot& snapshot);
+
+		/**
+		 * @brief sendClockProbe : ClockSync probe, setting the Sphero clock
+		 * 						  first after a connection
+		 * @param sphero_ptr : The Sphero
+		 */
+		static void sendClockProbe(void* sphero_ptr);
+
 		//-------------------------------------------------- Private attributes
 		
 		volatile bool collision;
+
+			/* Latest power notification, as a powerState */
+		std::atomic<uint8_t> _powerState;
 		
-		spherocoord_t _x, _y;
-		int16_t _speedX, _speedY;
-		uint16_t _normalisedSpeed;
+			/* Written once per streaming frame, read by any thread */
+		KinematicState _kinematics;
 
 		static const size_t MAX_CONNECT_ATTEMPT = 5;
-		bool _connected;
+
+			/* Read by the reception, writer and user threads */
+		std::atomic<bool> _connected;
 
 		bluetooth_connector* _bt_adapter;
 
@@ -592,11 +1108,9 @@ class Sphero
 
 		/* parameters used for data streaming packet extracting */
 		pthread_mutex_t lock;
-		int _nbFrames;
-		vector<dataTypes> _typesLst;
+		StreamLayout _stream;
 		
 		const std::string _address;
-		uint8_t _seq;
 
 		bool _resetTimer;
 		bool _waitConfirm;
@@ -604,24 +1118,73 @@ class Sphero
 		int _bt_socket;
 		pthread_t monitor;
 
+			/* The monitor thread is to be joined */
+		bool _monitorStarted;
 
-		uint8_t* _syncMRSPCode;	
-		void** _syncPacketParameters;
+			/* When not NULL, replaces the monitor thread */
+		SpheroReactor* _reactor;
+		SpheroReactor* _activeReactor;
 
-		pendingCommandType* _syncTodo;
+			/* Link counters, fed by the framer side, the extractors and the
+			 * command tracker. Declared before the tracker using it */
+		LinkStats _linkStats;
 
+			/* Fed by the answers to its probes : declared before the
+			 * tracker completing them */
+		ClockSync _clock;
 
-		/* Synchronisation for synchronous packet receiving */
-		sem_t* _syncSempahores;
-		pthread_mutex_t* _mutex_syncParameters;
-		pthread_mutex_t _mutex_seqNum;
+			/* Connections made, and the one the Sphero clock was set on
+			 * (probe thread only) */
+		std::atomic<uint32_t> _connections;
+		uint32_t _clockConnection;
+
+			/* Drive started by moveTo or followPath, stepped by the
+			 * streaming packets */
+		MotionController _motion;
+
+			/* Frames capture, used by the reception and writer threads */
+		WireRecorder _recorder;
+
+			/* Receive buffer, only used by the monitor thread */
+		PacketFramer _framer;
+
+			/* Outbound queue, the only one writing to the socket */
+		PacketWriter _writer;
+
+			/* Acknowledged commands waiting for their answer */
+		CommandTracker _commands;
+
+			/* Open batches, one per thread, protected by _batchLock */
+		pthread_mutex_t _batchLock;
+		pthread_cond_t _batchDone;
+		std::vector<commandBatch*> _batches;
 
 		/* Callbacks lists (one for each declared event) */
 		connectHandler_t _connect_handler;
 		disconnectHandler_t _disconnect_handler;
 		collisionHandler_t _collision_handler;
 		preSleepHandler_t _preSleep_handler;
+		powerStateHandler_t _powerState_handler;
+		selfLevelHandler_t _selfLevel_handler;
 		dataHandler_t _data_handler;
+
+			/* Indexed by asynchronous ID code, up to the highest one the
+			 * framer accepts */
+		asyncHandler_t _async_handlers[MAX_ASYNC_ID + 1];
+
+			/* dispatchPolicy of each eventKind */
+		std::atomic<uint8_t> _dispatchPolicies[(size_t) eventKind::NB_KINDS];
+
+			/* Started on first use, with the configured queue */
+		std::atomic<CallbackExecutor*> _robotExecutor;
+		pthread_mutex_t _executorLock;
+		size_t _robotCapacity;
+		overflowPolicy _robotOverflow;
+
+			/* Owned by the application */
+		std::atomic<CallbackExecutor*> _sharedExecutor;
 };
 
+#include "Sphero.tpp"
+
 #endif // SPHERO_HPP
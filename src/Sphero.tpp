@@ -0,0 +1,44 @@
+/******************************************************************************
+	Sphero  -  	Wrapper implementing all sphero-linked features (like packet
+				creation, emission, reception)
+							-------------------
+	started                : 16/03/2015
+******************************************************************************/
+
+//------------------------------------------------------ Protected methods
+
+/**
+ * @brief sendCommand : Serializes and sends a command expecting no data in
+ * 						return, acknowledged if the calling thread opened a
+ * 						batch
+ * @param Command : The command descriptor (see packets/Commands.hpp)
+ * @param kind : Coalescing class, used only when not acknowledged
+ * @param values : One value per payload field
+ */
+template<typename Command, typename... Args>
+void Sphero::sendCommand(coalesceClass kind, Args... values)
+{
+	uint8_t packet[Command::size];
+	Command::serialize(packet, flags::notNeeded, _waitConfirm, _resetTimer,
+			values...);
+	sendSerialized(packet, Command::size, kind);
+}//END sendCommand
+
+
+/**
+ * @brief sendAcknowledgedCommand : Serializes and sends a command asking for
+ * 									an answer, without waiting for it
+ * @param Command : The command descriptor (see packets/Commands.hpp)
+ * @param completion : Called once with the answer, or after
+ * 					   NB_SEC_SYNC_BEFORE_FAILURE without answer
+ * 					   (see commandCompletion_t for its thread)
+ * @param values : One value per payload field
+ */
+template<typename Command, typename... Args>
+void Sphero::sendAcknowledgedCommand(commandCompletion_t completion,
+		Args... values)
+{
+	uint8_t packet[Command::size];
+	Command::serialize(packet, flags::notNeeded, true, _resetTimer, values...);
+	sendSerializedAcknowledged(packet, Command::size, completion);
+}//END sendAcknowledgedCommand
@@ -0,0 +1,226 @@
+/******************************************************************************
+	SpheroReactor  -  Event loop threads sharing the reception of every
+					  connected Sphero through epoll
+							-------------------
+	started                : 17/10/2026
+******************************************************************************/
+
+//------------------------------------------------------------- System includes
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdint>
+#include <sys/eventfd.h>
+
+//-------------------------------------------------------------- Local includes
+#include "SpheroReactor.hpp"
+#include "Sphero.hpp"
+
+//--------------------------------------------- Constructors/Destructor
+
+/**
+ * @brief SpheroReactor : Constructor. Starts the event loop threads
+ * @param nbThreads : The number of event loops (at least 1)
+ */
+SpheroReactor::SpheroReactor(size_t nbThreads):_loops()
+{
+	if(nbThreads == 0)
+	{
+		nbThreads = 1;
+	}
+
+	for(size_t i = 0 ; i < nbThreads ; ++i)
+	{
+		eventLoop* loop = new eventLoop;
+		loop->reactor = this;
+		loop->epollFd = epoll_create1(EPOLL_CLOEXEC);
+		loop->wakeupFd = eventfd(0, EFD_CLOEXEC);
+		loop->nbPending = 0;
+		loop->current = NULL;
+		pthread_mutex_init(&loop->lock, NULL);
+		pthread_cond_init(&loop->dispatched, NULL);
+
+			//The wakeup descriptor is the only one registered without Sphero
+		struct epoll_event ev;
+		ev.events = EPOLLIN;
+		ev.data.ptr = NULL;
+		epoll_ctl(loop->epollFd, EPOLL_CTL_ADD, loop->wakeupFd, &ev);
+
+		pthread_create(&loop->thread, NULL, loopRoutine, loop);
+		_loops.push_back(loop);
+	}
+}
+
+
+SpheroReactor::~SpheroReactor()
+{
+	for(eventLoop* loop : _loops)
+	{
+		uint64_t one = 1;
+		if(write(loop->wakeupFd, &one, sizeof(one)) != sizeof(one))
+		{
+			perror("Reactor wakeup");
+		}
+		pthread_join(loop->thread, NULL);
+
+		close(loop->wakeupFd);
+		close(loop->epollFd);
+		pthread_cond_destroy(&loop->dispatched);
+		pthread_mutex_destroy(&loop->lock);
+		delete loop;
+	}
+}
+
+
+//------------------------------------------------------ Public methods
+
+/**
+ * @brief attach : Starts watching the socket of a Sphero
+ * @param sphero : The Sphero whose frames will be dispatched
+ * @param fd : The Sphero socket
+ * @return true if the socket is now watched
+ */
+bool SpheroReactor::attach(Sphero* sphero, int fd)
+{
+	struct epoll_event ev;
+	ev.events = EPOLLIN | EPOLLRDHUP;
+	ev.data.ptr = sphero;
+
+	if(epoll_ctl(loopFor(fd)->epollFd, EPOLL_CTL_ADD, fd, &ev) == -1)
+	{
+		perror("Reactor attach");
+		return false;
+	}
+
+	return true;
+}
+
+
+/**
+ * @brief detach : Stops watching the socket of a Sphero. Once it returns,
+ * 				   no event loop is using the Sphero anymore (can be called
+ * 				   from an event loop thread)
+ * @param sphero : The Sphero to detach
+ * @param fd : The Sphero socket
+ *
+ * Only waits for the dispatch of this Sphero frames, if its loop is in it :
+ * the caller must not be a thread its INLINE listeners wait for.
+ */
+void SpheroReactor::detach(Sphero* sphero, int fd)
+{
+	eventLoop* loop = loopFor(fd);
+
+	pthread_mutex_lock(&loop->lock);
+
+	epoll_ctl(loop->epollFd, EPOLL_CTL_DEL, fd, NULL);
+
+		//Events of the current batch must not reach the detached Sphero
+	for(int i = 0 ; i < loop->nbPending ; ++i)
+	{
+		if(loop->events[i].data.ptr == sphero)
+		{
+			loop->events[i].events = 0;
+		}
+	}
+
+		//The loop itself, disconnecting the Sphero it dispatches, has
+		//nothing to wait for
+	while(loop->current == sphero
+			&& !pthread_equal(loop->thread, pthread_self()))
+	{
+		pthread_cond_wait(&loop->dispatched, &loop->lock);
+	}
+
+	pthread_mutex_unlock(&loop->lock);
+}
+
+
+/**
+ * @return The number of event loop threads
+ */
+size_t SpheroReactor::getNbThreads()
+{
+	return _loops.size();
+}
+
+
+//----------------------------------------------------- Private methods
+
+void* SpheroReactor::loopRoutine(void* loop_ptr)
+{
+	eventLoop* loop = (eventLoop*) loop_ptr;
+
+		//A command sent from a listener must not wait for an answer this
+		//thread would read
+	CommandTracker::setReceptionThread(true);
+
+	for(;;)
+	{
+		int nbEvents = epoll_wait(loop->epollFd, loop->events,
+				REACTOR_MAX_EVENTS, -1);
+
+		if(nbEvents < 0)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			perror("Reactor wait");
+			return NULL;
+		}
+
+		pthread_mutex_lock(&loop->lock);
+		loop->nbPending = nbEvents;
+
+		for(int i = 0 ; i < nbEvents ; ++i)
+		{
+			Sphero* sphero = (Sphero*) loop->events[i].data.ptr;
+			uint32_t events = loop->events[i].events;
+
+			if(sphero == NULL)
+			{
+				loop->nbPending = 0;
+				pthread_mutex_unlock(&loop->lock);
+				return NULL;
+			}
+
+				//Detached during the batch
+			if(events == 0)
+			{
+				continue;
+			}
+
+				//Unlocked while the listeners run : detach only waits for
+				//the Sphero being dispatched
+			loop->current = sphero;
+			pthread_mutex_unlock(&loop->lock);
+
+			if(events & EPOLLIN)
+			{
+				if(!sphero->processIncoming())
+				{
+					sphero->disconnect();
+				}
+			}
+			else if(events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP))
+			{
+				sphero->disconnect();
+			}
+
+			pthread_mutex_lock(&loop->lock);
+			loop->current = NULL;
+			pthread_cond_broadcast(&loop->dispatched);
+		}
+
+		loop->nbPending = 0;
+		pthread_mutex_unlock(&loop->lock);
+	}
+
+	return NULL;
+}
+
+
+SpheroReactor::eventLoop* SpheroReactor::loopFor(int fd)
+{
+	return _loops[fd % _loops.size()];
+}
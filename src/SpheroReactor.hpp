@@ -0,0 +1,117 @@
+/******************************************************************************
+	SpheroReactor  -  Event loop threads sharing the reception of every
+					  connected Sphero through epoll
+							-------------------
+	started                : 17/10/2026
+******************************************************************************/
+
+#ifndef SPHEROREACTOR_HPP
+#define SPHEROREACTOR_HPP
+
+//------------------------------------------------------------- System includes
+#include <pthread.h>
+#include <cstddef>
+#include <vector>
+#include <sys/epoll.h>
+
+//------------------------------------------------------------------- Constants
+
+	/* Maximum number of events handled by a loop per epoll_wait() call */
+static int const REACTOR_MAX_EVENTS = 64;
+
+//----------------------------------------------------------------------- Types
+class Sphero;
+
+//------------------------------------------------------------ Class definition
+/*
+ * Opt-in replacement for the one monitor thread per Sphero model : the
+ * sockets of every attached Sphero are watched by a small, fixed number of
+ * event loops, which read and dispatch the frames of the Sphero whose
+ * socket became readable.
+ *
+ * Usage : create the reactor, give it to the Spheros (Sphero::setReactor)
+ * before calling connect(), and destroy it only after every Sphero using it
+ * has been disconnected.
+ *
+ * A loop only locks its state between two events : the listeners called
+ * while a Sphero frames are dispatched run unlocked, so that a slow or
+ * blocked listener of one Sphero never holds up the detaching of another.
+ */
+class SpheroReactor
+{
+	public:
+
+		//----------------------------------------------------------- Operators
+			//No sense
+		SpheroReactor& operator=(const SpheroReactor&) = delete;
+
+		//--------------------------------------------- Constructors/Destructor
+			//No sense
+		SpheroReactor(const SpheroReactor&) = delete;
+
+		/**
+		 * @brief SpheroReactor : Constructor. Starts the event loop threads
+		 * @param nbThreads : The number of event loops (at least 1)
+		 */
+		SpheroReactor(size_t nbThreads = 1);
+
+		virtual ~SpheroReactor();
+
+		//------------------------------------------------------ Public methods
+
+		/**
+		 * @brief attach : Starts watching the socket of a Sphero
+		 * @param sphero : The Sphero whose frames will be dispatched
+		 * @param fd : The Sphero socket
+		 * @return true if the socket is now watched
+		 */
+		bool attach(Sphero* sphero, int fd);
+
+		/**
+		 * @brief detach : Stops watching the socket of a Sphero. Once it
+		 * 				   returns, no event loop is using the Sphero anymore
+		 * 				   (can be called from an event loop thread)
+		 * @param sphero : The Sphero to detach
+		 * @param fd : The Sphero socket
+		 *
+		 * Only waits for the dispatch of this Sphero frames, if its loop is
+		 * in it : the caller must not be a thread its INLINE listeners wait
+		 * for.
+		 */
+		void detach(Sphero* sphero, int fd);
+
+		/**
+		 * @return The number of event loop threads
+		 */
+		size_t getNbThreads();
+
+	private:
+		//------------------------------------------------------- Private types
+		struct eventLoop
+		{
+			SpheroReactor* reactor;
+			int epollFd;
+			int wakeupFd;
+			pthread_t thread;
+
+				/* Protects the pending events and current, not held
+				 * while a Sphero is dispatched */
+			pthread_mutex_t lock;
+			pthread_cond_t dispatched;
+			struct epoll_event events[REACTOR_MAX_EVENTS];
+			int nbPending;
+
+				/* The Sphero whose event is being handled, NULL if none */
+			Sphero* current;
+		};
+
+		//----------------------------------------------------- Private methods
+		static void* loopRoutine(void* loop_ptr);
+
+		eventLoop* loopFor(int fd);
+
+		//-------------------------------------------------- Private attributes
+		std::vector<eventLoop*> _loops;
+};
+
+#endif // SPHEROREACTOR_HPP
@@ -0,0 +1,374 @@
+/******************************************************************************
+	TimerWheel  -  Hashed timer wheel shared by every Sphero to expire
+				   pending commands, and the thread their completions
+				   are deferred to
+							-------------------
+	started                : 17/10/2026
+******************************************************************************/
+
+//------------------------------------------------------------- System includes
+#include <ctime>
+
+//-------------------------------------------------------------- Local includes
+#include "TimerWheel.hpp"
+
+//-------------------------------------------------------------------- Functions
+
+static uint64_t monotonicMs()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+//--------------------------------------------- Constructors/Destructor
+
+/**
+ * @brief TimerWheel : Constructor. The wheel thread is only started when the
+ * 					   first timer is scheduled
+ * @param tickMs : The wheel resolution, in milliseconds
+ */
+TimerWheel::TimerWheel(unsigned int tickMs):
+	_tickMs(tickMs == 0 ? 1 : tickMs), _origin(monotonicMs()), _firing(),
+	_lastTick(0), _nbTimers(0), _started(false), _stop(false),
+	_deferStarted(false)
+{
+	pthread_mutexattr_t mutexAttr;
+	pthread_mutexattr_init(&mutexAttr);
+	pthread_mutexattr_settype(&mutexAttr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&_fireLock, &mutexAttr);
+	pthread_mutex_init(&_drainLock, &mutexAttr);
+	pthread_mutexattr_destroy(&mutexAttr);
+
+	pthread_mutex_init(&_lock, NULL);
+
+	pthread_condattr_t condAttr;
+	pthread_condattr_init(&condAttr);
+	pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC);
+	pthread_cond_init(&_cond, &condAttr);
+	pthread_condattr_destroy(&condAttr);
+	pthread_cond_init(&_deferCond, NULL);
+
+	for(std::vector<timer>& bucket : _buckets)
+	{
+		bucket.reserve(TIMER_BUCKET_RESERVE);
+	}
+	_firing.reserve(TIMER_BUCKET_RESERVE);
+	_deferred.reserve(TIMER_BUCKET_RESERVE);
+	_draining.reserve(TIMER_BUCKET_RESERVE);
+}
+
+
+TimerWheel::~TimerWheel()
+{
+	pthread_mutex_lock(&_lock);
+	_stop = true;
+	pthread_cond_signal(&_cond);
+	pthread_cond_signal(&_deferCond);
+	pthread_mutex_unlock(&_lock);
+
+	if(_started)
+	{
+		pthread_join(_thread, NULL);
+	}
+	if(_deferStarted)
+	{
+		pthread_join(_deferThread, NULL);
+	}
+
+	pthread_cond_destroy(&_deferCond);
+	pthread_cond_destroy(&_cond);
+	pthread_mutex_destroy(&_lock);
+	pthread_mutex_destroy(&_drainLock);
+	pthread_mutex_destroy(&_fireLock);
+}
+
+
+//------------------------------------------------------ Public methods
+
+/**
+ * @return The wheel shared by every Sphero instance
+ */
+TimerWheel& TimerWheel::shared()
+{
+	static TimerWheel wheel;
+	return wheel;
+}
+
+
+/**
+ * @brief schedule : Arms a one-shot timer
+ * @param delayMs : The delay before the callback is called (rounded up to
+ * 					the wheel resolution)
+ * @param callback : The function to call on expiry
+ * @param context : The first callback argument, also used to cancel
+ * @param cookie : The second callback argument
+ */
+void TimerWheel::schedule(unsigned int delayMs, timerCallback_t callback,
+		void* context, uint32_t cookie)
+{
+	pthread_mutex_lock(&_lock);
+
+		//One more tick, the current one being already partly elapsed
+	timer t;
+	t.expiry = currentTick() + (delayMs + _tickMs - 1) / _tickMs + 1;
+	t.callback = callback;
+	t.context = context;
+	t.cookie = cookie;
+
+	_buckets[t.expiry % TIMER_WHEEL_SIZE].push_back(t);
+
+	if(_nbTimers++ == 0)
+	{
+		_lastTick = currentTick();
+	}
+
+	if(!_started)
+	{
+		_started = true;
+		pthread_create(&_thread, NULL, wheelRoutine, this);
+	}
+	pthread_cond_signal(&_cond);
+
+	pthread_mutex_unlock(&_lock);
+}
+
+
+/**
+ * @brief defer : Runs a callback as soon as possible on the deferred thread
+ * 				  of the wheel, started on first use. A deferred callback may
+ * 				  block : it delays the other deferred callbacks, never the
+ * 				  timers
+ * @param callback : The function to call
+ * @param context : The first callback argument, also used to cancel
+ * @param cookie : The second callback argument
+ */
+void TimerWheel::defer(timerCallback_t callback, void* context, uint32_t cookie)
+{
+	pthread_mutex_lock(&_lock);
+
+	timer t;
+	t.expiry = 0;
+	t.callback = callback;
+	t.context = context;
+	t.cookie = cookie;
+	_deferred.push_back(t);
+
+	if(!_deferStarted)
+	{
+		_deferStarted = true;
+		pthread_create(&_deferThread, NULL, deferredRoutine, this);
+	}
+	pthread_cond_signal(&_deferCond);
+
+	pthread_mutex_unlock(&_lock);
+}
+
+
+/**
+ * @brief cancel : Drops every timer armed and every callback deferred with
+ * 				   the given context. Once it returns, no callback is running
+ * 				   or will run for that context
+ * @param context : The context given on scheduling
+ */
+void TimerWheel::cancel(void* context)
+{
+	pthread_mutex_lock(&_fireLock);
+	pthread_mutex_lock(&_lock);
+
+	for(size_t b = 0 ; b < TIMER_WHEEL_SIZE && _nbTimers > 0 ; ++b)
+	{
+		std::vector<timer>& bucket = _buckets[b];
+		for(size_t i = 0 ; i < bucket.size() ; )
+		{
+			if(bucket[i].context == context)
+			{
+				bucket[i] = bucket.back();
+				bucket.pop_back();
+				--_nbTimers;
+			}
+			else
+			{
+				++i;
+			}
+		}
+	}
+
+		//Cancelled from a callback : the remaining ones must not run
+	for(timer& t : _firing)
+	{
+		if(t.context == context)
+		{
+			t.callback = NULL;
+		}
+	}
+
+	pthread_mutex_unlock(&_lock);
+	pthread_mutex_unlock(&_fireLock);
+
+		//Not nested with _fireLock : a deferred callback may be waiting for
+		//a timer to fire
+	pthread_mutex_lock(&_drainLock);
+	pthread_mutex_lock(&_lock);
+
+	for(size_t i = 0 ; i < _deferred.size() ; )
+	{
+		if(_deferred[i].context == context)
+		{
+			_deferred.erase(_deferred.begin() + i);
+		}
+		else
+		{
+			++i;
+		}
+	}
+
+	for(timer& t : _draining)
+	{
+		if(t.context == context)
+		{
+			t.callback = NULL;
+		}
+	}
+
+	pthread_mutex_unlock(&_lock);
+	pthread_mutex_unlock(&_drainLock);
+}
+
+
+//----------------------------------------------------- Private methods
+
+void* TimerWheel::wheelRoutine(void* wheel_ptr)
+{
+	TimerWheel* wheel = (TimerWheel*) wheel_ptr;
+
+	for(;;)
+	{
+		pthread_mutex_lock(&wheel->_lock);
+
+		while(!wheel->_stop && wheel->_nbTimers == 0)
+		{
+			pthread_cond_wait(&wheel->_cond, &wheel->_lock);
+		}
+
+		if(!wheel->_stop)
+		{
+			uint64_t deadlineMs = wheel->_origin
+				+ (wheel->_lastTick + 1) * wheel->_tickMs;
+			struct timespec deadline;
+			deadline.tv_sec = deadlineMs / 1000;
+			deadline.tv_nsec = (deadlineMs % 1000) * 1000000;
+			pthread_cond_timedwait(&wheel->_cond, &wheel->_lock, &deadline);
+		}
+
+		if(wheel->_stop)
+		{
+			pthread_mutex_unlock(&wheel->_lock);
+			return NULL;
+		}
+		pthread_mutex_unlock(&wheel->_lock);
+
+		pthread_mutex_lock(&wheel->_fireLock);
+		pthread_mutex_lock(&wheel->_lock);
+
+		uint64_t now = wheel->currentTick();
+		uint64_t first = wheel->_lastTick + 1;
+		if(now + 1 - first > TIMER_WHEEL_SIZE)
+		{
+			first = now + 1 - TIMER_WHEEL_SIZE;
+		}
+
+		for(uint64_t tick = first ; tick <= now ; ++tick)
+		{
+			std::vector<timer>& bucket = wheel->_buckets[tick % TIMER_WHEEL_SIZE];
+			for(size_t i = 0 ; i < bucket.size() ; )
+			{
+				if(bucket[i].expiry <= now)
+				{
+					wheel->_firing.push_back(bucket[i]);
+					bucket[i] = bucket.back();
+					bucket.pop_back();
+					--wheel->_nbTimers;
+				}
+				else
+				{
+					++i;
+				}
+			}
+		}
+		if(now > wheel->_lastTick)
+		{
+			wheel->_lastTick = now;
+		}
+
+		pthread_mutex_unlock(&wheel->_lock);
+
+		for(size_t i = 0 ; i < wheel->_firing.size() ; ++i)
+		{
+			timer t = wheel->_firing[i];
+			if(t.callback != NULL)
+			{
+				t.callback(t.context, t.cookie);
+			}
+		}
+		wheel->_firing.clear();
+
+		pthread_mutex_unlock(&wheel->_fireLock);
+	}
+
+	return NULL;
+}
+
+
+void* TimerWheel::deferredRoutine(void* wheel_ptr)
+{
+	TimerWheel* wheel = (TimerWheel*) wheel_ptr;
+
+	for(;;)
+	{
+		pthread_mutex_lock(&wheel->_lock);
+
+		while(!wheel->_stop && wheel->_deferred.empty())
+		{
+			pthread_cond_wait(&wheel->_deferCond, &wheel->_lock);
+		}
+
+		if(wheel->_stop)
+		{
+			pthread_mutex_unlock(&wheel->_lock);
+			return NULL;
+		}
+		pthread_mutex_unlock(&wheel->_lock);
+
+		pthread_mutex_lock(&wheel->_drainLock);
+		pthread_mutex_lock(&wheel->_lock);
+
+			//Both keep their capacity
+		wheel->_draining.swap(wheel->_deferred);
+
+		pthread_mutex_unlock(&wheel->_lock);
+
+		for(size_t i = 0 ; i < wheel->_draining.size() ; ++i)
+		{
+			timer t = wheel->_draining[i];
+			if(t.callback != NULL)
+			{
+				t.callback(t.context, t.cookie);
+			}
+		}
+		wheel->_draining.clear();
+
+		pthread_mutex_unlock(&wheel->_drainLock);
+	}
+
+	return NULL;
+}
+
+
+/**
+ * @return The number of ticks elapsed since the wheel creation
+ */
+uint64_t TimerWheel::currentTick()
+{
+	return (monotonicMs() - _origin) / _tickMs;
+}
@@ -0,0 +1,147 @@
+/******************************************************************************
+	TimerWheel  -  Hashed timer wheel shared by every Sphero to expire
+				   pending commands, and the thread their completions
+				   are deferred to
+							-------------------
+	started                : 17/10/2026
+******************************************************************************/
+
+#ifndef TIMERWHEEL_HPP
+#define TIMERWHEEL_HPP
+
+//------------------------------------------------------------- System includes
+#include <pthread.h>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+//------------------------------------------------------------------- Constants
+
+	/* Number of buckets of the wheel */
+static size_t const TIMER_WHEEL_SIZE = 256;
+
+	/* Default wheel resolution, in milliseconds */
+static unsigned int const TIMER_WHEEL_TICK_MS = 10;
+
+	/* Timers a bucket holds before growing : a few commands per tick are
+	 * scheduled without allocating, even on the first turn */
+static size_t const TIMER_BUCKET_RESERVE = 8;
+
+//----------------------------------------------------------------------- Types
+
+	/* Called with the context and cookie given on scheduling : by the wheel
+	 * thread for a timer, where it must not block, or by the deferred
+	 * thread (see defer) */
+typedef void (*timerCallback_t)(void* context, uint32_t cookie);
+
+//------------------------------------------------------------ Class definition
+class TimerWheel
+{
+	public:
+
+		//----------------------------------------------------------- Operators
+			//No sense
+		TimerWheel& operator=(const TimerWheel&) = delete;
+
+		//--------------------------------------------- Constructors/Destructor
+			//No sense
+		TimerWheel(const TimerWheel&) = delete;
+
+		/**
+		 * @brief TimerWheel : Constructor. The wheel thread is only started
+		 * 					   when the first timer is scheduled
+		 * @param tickMs : The wheel resolution, in milliseconds
+		 */
+		TimerWheel(unsigned int tickMs = TIMER_WHEEL_TICK_MS);
+
+		virtual ~TimerWheel();
+
+		//------------------------------------------------------ Public methods
+
+		/**
+		 * @return The wheel shared by every Sphero instance
+		 */
+		static TimerWheel& shared();
+
+		/**
+		 * @brief schedule : Arms a one-shot timer
+		 * @param delayMs : The delay before the callback is called (rounded
+		 * 					up to the wheel resolution)
+		 * @param callback : The function to call on expiry
+		 * @param context : The first callback argument, also used to cancel
+		 * @param cookie : The second callback argument
+		 */
+		void schedule(unsigned int delayMs, timerCallback_t callback,
+				void* context, uint32_t cookie);
+
+		/**
+		 * @brief defer : Runs a callback as soon as possible on the deferred
+		 * 				  thread of the wheel, started on first use. A
+		 * 				  deferred callback may block : it delays the other
+		 * 				  deferred callbacks, never the timers
+		 * @param callback : The function to call
+		 * @param context : The first callback argument, also used to cancel
+		 * @param cookie : The second callback argument
+		 */
+		void defer(timerCallback_t callback, void* context, uint32_t cookie);
+
+		/**
+		 * @brief cancel : Drops every timer armed and every callback deferred
+		 * 				   with the given context. Once it returns, no callback
+		 * 				   is running or will run for that context
+		 * @param context : The context given on scheduling
+		 */
+		void cancel(void* context);
+
+	private:
+		//------------------------------------------------------- Private types
+		struct timer
+		{
+			uint64_t expiry;
+			timerCallback_t callback;
+			void* context;
+			uint32_t cookie;
+		};
+
+		//----------------------------------------------------- Private methods
+		static void* wheelRoutine(void* wheel_ptr);
+
+		static void* deferredRoutine(void* wheel_ptr);
+
+		/**
+		 * @return The number of ticks elapsed since the wheel creation
+		 */
+		uint64_t currentTick();
+
+		//-------------------------------------------------- Private attributes
+		unsigned int _tickMs;
+		uint64_t _origin;
+
+		std::vector<timer> _buckets[TIMER_WHEEL_SIZE];
+		std::vector<timer> _firing;
+		uint64_t _lastTick;
+		size_t _nbTimers;
+
+		bool _started;
+		bool _stop;
+		pthread_t _thread;
+
+			/* Protects the buckets */
+		pthread_mutex_t _lock;
+		pthread_cond_t _cond;
+
+			/* Held (recursively) while callbacks are running */
+		pthread_mutex_t _fireLock;
+
+			/* Deferred callbacks : queued, protected by _lock, and running */
+		std::vector<timer> _deferred;
+		std::vector<timer> _draining;
+		bool _deferStarted;
+		pthread_t _deferThread;
+		pthread_cond_t _deferCond;
+
+			/* Held (recursively) while deferred callbacks are running */
+		pthread_mutex_t _drainLock;
+};
+
+#endif // TIMERWHEEL_HPP
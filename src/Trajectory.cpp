@@ -0,0 +1,423 @@
+/******************************************************************************
+	Trajectory  -  Path through waypoints (blended polyline or spline),
+				   sampled by arc length, with the speed allowed at every
+				   sample and the time it is reached
+							-------------------
+	started                : 17/10/2026
+******************************************************************************/
+
+//------------------------------------------------------------- System includes
+#include <cmath>
+#include <algorithm>
+
+//-------------------------------------------------------------- Local includes
+#include "Trajectory.hpp"
+
+//------------------------------------------------------------------- Constants
+
+	/* Waypoints closer than this to the previous one are skipped, in cm */
+static double const MIN_WAYPOINT_DISTANCE = 0.5;
+
+//--------------------------------------------- Constructors/Destructor
+
+TrajectoryLimits::TrajectoryLimits():maxSpeed(TRAJECTORY_MAX_SPEED),
+	maxAccel(TRAJECTORY_MAX_ACCEL),
+	maxLateralAccel(TRAJECTORY_MAX_LATERAL_ACCEL),
+	cornerRadius(TRAJECTORY_CORNER_RADIUS), step(TRAJECTORY_STEP)
+{
+}
+
+
+Trajectory::Trajectory()
+{
+}
+
+
+Trajectory::~Trajectory()
+{
+}
+
+
+//------------------------------------------------------ Public methods
+
+/**
+ * @brief plan : Computes the path and its velocity profile
+ * @param start : The position the path starts from
+ * @param waypoints : The points to go through, in order
+ * @param shape : How the waypoints are joined
+ * @param limits : The speed and accelerations allowed
+ * @return false if no waypoint is away from the start
+ */
+bool Trajectory::plan(Waypoint start, const std::vector<Waypoint>& waypoints,
+		pathShape shape, const TrajectoryLimits& limits)
+{
+	_limits = limits;
+	if(_limits.step <= 0)
+	{
+		_limits.step = TRAJECTORY_STEP;
+	}
+	_samples.clear();
+
+	std::vector<double> points;
+	points.push_back(start.x);
+	points.push_back(start.y);
+	for(const Waypoint& waypoint : waypoints)
+	{
+		if(hypot(waypoint.x - points[points.size() - 2],
+					waypoint.y - points.back()) >= MIN_WAYPOINT_DISTANCE)
+		{
+			points.push_back(waypoint.x);
+			points.push_back(waypoint.y);
+		}
+	}
+
+	size_t nbPoints = points.size() / 2;
+	if(nbPoints < 2)
+	{
+		return false;
+	}
+	const double* p = points.data();
+
+	addPoint(p[0], p[1]);
+	if(shape == pathShape::SPLINE)
+	{
+		for(size_t i = 0 ; i + 1 < nbPoints ; ++i)
+		{
+			const double* p1 = p + 2 * i;
+			const double* p2 = p1 + 2;
+
+				//Missing neighbours at the ends : mirrored
+			double before[2] = {2 * p1[0] - p2[0], 2 * p1[1] - p2[1]};
+			double after[2] = {2 * p2[0] - p1[0], 2 * p2[1] - p1[1]};
+			const double* p0 = (i == 0) ? before : p1 - 2;
+			const double* p3 = (i + 2 < nbPoints) ? p2 + 2 : after;
+
+			addCatmullRom(p0, p1, p2, p3);
+		}
+	}
+	else
+	{
+		for(size_t i = 1 ; i < nbPoints ; ++i)
+		{
+			const double* corner = p + 2 * i;
+			if(i + 1 == nbPoints)
+			{
+				addLine(corner[0], corner[1]);
+				continue;
+			}
+
+			const double* previous = corner - 2;
+			const double* next = corner + 2;
+			double lengthIn = hypot(corner[0] - previous[0], corner[1] - previous[1]);
+			double lengthOut = hypot(next[0] - corner[0], next[1] - corner[1]);
+
+				//The curve starts and ends at most halfway along the sides
+			double blend = std::min(_limits.cornerRadius,
+					std::min(lengthIn, lengthOut) / 2);
+			if(blend <= 0)
+			{
+				addLine(corner[0], corner[1]);
+				continue;
+			}
+
+			addLine(corner[0] - (corner[0] - previous[0]) * blend / lengthIn,
+					corner[1] - (corner[1] - previous[1]) * blend / lengthIn);
+			addBezier(corner[0], corner[1],
+					corner[0] + (next[0] - corner[0]) * blend / lengthOut,
+					corner[1] + (next[1] - corner[1]) * blend / lengthOut);
+		}
+	}
+
+	profile();
+	return true;
+}
+
+
+/**
+ * @return The path length, in cm (0 before plan)
+ */
+double Trajectory::getLength() const
+{
+	return _samples.empty() ? 0 : _samples.back().s;
+}
+
+
+/**
+ * @return The planned duration, in s
+ */
+double Trajectory::getDuration() const
+{
+	return _samples.empty() ? 0 : _samples.back().t;
+}
+
+
+/**
+ * @return The samples, by increasing arc length
+ */
+const std::vector<TrajectorySample>& Trajectory::getSamples() const
+{
+	return _samples;
+}
+
+
+/**
+ * @brief at : Interpolates the path
+ * @param s : The arc length, clamped to the path
+ * @return The position, planned speed and time at s
+ */
+TrajectorySample Trajectory::at(double s) const
+{
+	if(_samples.empty())
+	{
+		return TrajectorySample();
+	}
+
+	size_t i = indexOf(s);
+	if(i + 1 >= _samples.size() || s <= _samples[i].s)
+	{
+		return _samples[i];
+	}
+
+	const TrajectorySample& from = _samples[i];
+	const TrajectorySample& to = _samples[i + 1];
+	double ratio = (s - from.s) / (to.s - from.s);
+
+	TrajectorySample sample;
+	sample.x = from.x + (to.x - from.x) * ratio;
+	sample.y = from.y + (to.y - from.y) * ratio;
+	sample.s = s;
+	sample.speed = from.speed + (to.speed - from.speed) * ratio;
+	sample.t = from.t + (to.t - from.t) * ratio;
+
+	return sample;
+}
+
+
+/**
+ * @brief locate : Projects a position on the path, searching forward from a
+ * 				  known arc length
+ * @param x : The abscissa, in cm
+ * @param y : The ordinate, in cm
+ * @param from : The arc length the search starts from
+ * @param window : How far ahead to search, in cm
+ * @return The arc length of the closest point
+ */
+double Trajectory::locate(double x, double y, double from, double window) const
+{
+	if(_samples.size() < 2)
+	{
+		return 0;
+	}
+
+	double best = from;
+	double bestDistance = -1;
+	for(size_t i = indexOf(from) ; i + 1 < _samples.size()
+			&& _samples[i].s <= from + window ; ++i)
+	{
+		const TrajectorySample& a = _samples[i];
+		const TrajectorySample& b = _samples[i + 1];
+		double length = b.s - a.s;
+
+			//Projection on the segment
+		double u = ((x - a.x) * (b.x - a.x) + (y - a.y) * (b.y - a.y))
+			/ (length * length);
+		u = u < 0 ? 0 : (u > 1 ? 1 : u);
+		double distance = hypot(a.x + (b.x - a.x) * u - x, a.y + (b.y - a.y) * u - y);
+
+		if(bestDistance < 0 || distance < bestDistance)
+		{
+			bestDistance = distance;
+			best = a.s + length * u;
+		}
+	}
+
+		//Never backwards : a loop would send the Sphero round again
+	return std::max(best, from);
+}
+
+
+//----------------------------------------------------- Private methods
+
+/**
+ * @brief addPoint : Appends a sample, its arc length following the previous
+ * 					one
+ */
+void Trajectory::addPoint(double x, double y)
+{
+	TrajectorySample sample = TrajectorySample();
+	sample.x = x;
+	sample.y = y;
+
+	if(!_samples.empty())
+	{
+		const TrajectorySample& last = _samples.back();
+		double length = hypot(x - last.x, y - last.y);
+		if(length < 1e-6)
+		{
+			return;
+		}
+		sample.s = last.s + length;
+	}
+
+	_samples.push_back(sample);
+}
+
+
+/**
+ * @brief addLine : Samples a straight line from the last sample
+ */
+void Trajectory::addLine(double x, double y)
+{
+	double fromX = _samples.back().x;
+	double fromY = _samples.back().y;
+	size_t nbSteps = (size_t) ceil(hypot(x - fromX, y - fromY) / _limits.step);
+
+	for(size_t i = 1 ; i <= nbSteps ; ++i)
+	{
+		addPoint(fromX + (x - fromX) * i / nbSteps, fromY + (y - fromY) * i / nbSteps);
+	}
+}
+
+
+/**
+ * @brief addBezier : Samples a quadratic Bézier curve from the last sample
+ * @param cx, cy : The control point
+ * @param x, y : The end point
+ */
+void Trajectory::addBezier(double cx, double cy, double x, double y)
+{
+	double fromX = _samples.back().x;
+	double fromY = _samples.back().y;
+
+		//The control polygon is longer than the curve
+	double length = hypot(cx - fromX, cy - fromY) + hypot(x - cx, y - cy);
+	size_t nbSteps = std::max((size_t) 2, (size_t) ceil(length / _limits.step));
+
+	for(size_t i = 1 ; i <= nbSteps ; ++i)
+	{
+		double t = (double) i / nbSteps;
+		double a = (1 - t) * (1 - t);
+		double b = 2 * (1 - t) * t;
+		double c = t * t;
+		addPoint(a * fromX + b * cx + c * x, a * fromY + b * cy + c * y);
+	}
+}
+
+
+/**
+ * @brief addCatmullRom : Samples the centripetal Catmull-Rom segment from p1
+ * 						 to p2
+ */
+void Trajectory::addCatmullRom(const double p0[2], const double p1[2],
+		const double p2[2], const double p3[2])
+{
+		//Centripetal : knots spaced by the square root of the distances
+	double t0 = 0;
+	double t1 = t0 + std::max(sqrt(hypot(p1[0] - p0[0], p1[1] - p0[1])), 1e-3);
+	double t2 = t1 + std::max(sqrt(hypot(p2[0] - p1[0], p2[1] - p1[1])), 1e-3);
+	double t3 = t2 + std::max(sqrt(hypot(p3[0] - p2[0], p3[1] - p2[1])), 1e-3);
+
+		//A spline segment is a bit longer than its chord
+	double chord = hypot(p2[0] - p1[0], p2[1] - p1[1]);
+	size_t nbSteps = std::max((size_t) 2, (size_t) ceil(1.2 * chord / _limits.step));
+
+	for(size_t i = 1 ; i <= nbSteps ; ++i)
+	{
+		double t = t1 + (t2 - t1) * i / nbSteps;
+		double point[2];
+
+			//Barry and Goldman pyramidal formulation
+		for(int axis = 0 ; axis < 2 ; ++axis)
+		{
+			double a1 = ((t1 - t) * p0[axis] + (t - t0) * p1[axis]) / (t1 - t0);
+			double a2 = ((t2 - t) * p1[axis] + (t - t1) * p2[axis]) / (t2 - t1);
+			double a3 = ((t3 - t) * p2[axis] + (t - t2) * p3[axis]) / (t3 - t2);
+			double b1 = ((t2 - t) * a1 + (t - t0) * a2) / (t2 - t0);
+			double b2 = ((t3 - t) * a2 + (t - t1) * a3) / (t3 - t1);
+			point[axis] = ((t2 - t) * b1 + (t - t1) * b2) / (t2 - t1);
+		}
+
+		addPoint(point[0], point[1]);
+	}
+}
+
+
+/**
+ * @brief profile : Computes the speed and time of every sample
+ */
+void Trajectory::profile()
+{
+	size_t nbSamples = _samples.size();
+
+		//Curvature (of the circle through the neighbours) limits the speed
+	for(size_t i = 0 ; i < nbSamples ; ++i)
+	{
+		TrajectorySample& sample = _samples[i];
+		sample.speed = _limits.maxSpeed;
+		if(i == 0 || i + 1 == nbSamples)
+		{
+			continue;
+		}
+
+		const TrajectorySample& a = _samples[i - 1];
+		const TrajectorySample& c = _samples[i + 1];
+		double cross = (sample.x - a.x) * (c.y - a.y) - (sample.y - a.y) * (c.x - a.x);
+		double sides = (sample.s - a.s) * (c.s - sample.s) * hypot(c.x - a.x, c.y - a.y);
+		double curvature = sides > 0 ? 2 * fabs(cross) / sides : 0;
+
+		if(curvature > 0)
+		{
+			sample.speed = std::min(sample.speed, sqrt(_limits.maxLateralAccel / curvature));
+		}
+	}
+
+		//From standstill to standstill, within the acceleration
+	_samples.front().speed = 0;
+	_samples.back().speed = 0;
+	for(size_t i = 1 ; i < nbSamples ; ++i)
+	{
+		double ds = _samples[i].s - _samples[i - 1].s;
+		_samples[i].speed = std::min(_samples[i].speed, sqrt(_samples[i - 1].speed
+					* _samples[i - 1].speed + 2 * _limits.maxAccel * ds));
+	}
+	for(size_t i = nbSamples - 1 ; i > 0 ; --i)
+	{
+		double ds = _samples[i].s - _samples[i - 1].s;
+		_samples[i - 1].speed = std::min(_samples[i - 1].speed, sqrt(_samples[i].speed
+					* _samples[i].speed + 2 * _limits.maxAccel * ds));
+	}
+
+		//Constant acceleration between two samples
+	_samples.front().t = 0;
+	for(size_t i = 1 ; i < nbSamples ; ++i)
+	{
+		double ds = _samples[i].s - _samples[i - 1].s;
+		double speeds = _samples[i].speed + _samples[i - 1].speed;
+		_samples[i].t = _samples[i - 1].t + (speeds > 0 ? 2 * ds / speeds : 0);
+	}
+}
+
+
+/**
+ * @return The index of the last sample at or before s
+ */
+size_t Trajectory::indexOf(double s) const
+{
+	size_t low = 0;
+	size_t high = _samples.size();
+
+	while(high - low > 1)
+	{
+		size_t middle = (low + high) / 2;
+		if(_samples[middle].s <= s)
+		{
+			low = middle;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	return low;
+}
@@ -0,0 +1,197 @@
+/******************************************************************************
+	Trajectory  -  Path through waypoints (blended polyline or spline),
+				   sampled by arc length, with the speed allowed at every
+				   sample and the time it is reached
+							-------------------
+	started                : 17/10/2026
+******************************************************************************/
+
+#ifndef TRAJECTORY_HPP
+#define TRAJECTORY_HPP
+
+//------------------------------------------------------------- System includes
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+//------------------------------------------------------------------- Constants
+
+	/* Roll speed units per cm/s : a Sphero rolls about 2 m/s at 255 */
+static double const TRAJECTORY_UNITS_PER_CM_S = 255 / 200.0;
+
+	/* Default limits : speed (about roll speed 90), acceleration and
+	 * lateral acceleration in cm/s², corner blending radius and sampling
+	 * step in cm */
+static double const TRAJECTORY_MAX_SPEED = 70.0;
+static double const TRAJECTORY_MAX_ACCEL = 100.0;
+static double const TRAJECTORY_MAX_LATERAL_ACCEL = 60.0;
+static double const TRAJECTORY_CORNER_RADIUS = 20.0;
+static double const TRAJECTORY_STEP = 2.0;
+
+//----------------------------------------------------------------------- Types
+
+	/* A point to go through, in cm */
+struct Waypoint
+{
+	int16_t x;
+	int16_t y;
+};
+
+	/* How the waypoints are joined */
+enum class pathShape : uint8_t
+{
+		/* Straight lines, corners replaced by a curve of cornerRadius */
+	POLYLINE,
+		/* Catmull-Rom spline going through every waypoint */
+	SPLINE
+};
+
+/*
+ * Limits the velocity profile respects. The constructor gives the defaults
+ */
+struct TrajectoryLimits
+{
+	TrajectoryLimits();
+
+		/* cm/s */
+	double maxSpeed;
+
+		/* Along the path, cm/s² */
+	double maxAccel;
+
+		/* Across the path in curves (v² * curvature), cm/s² */
+	double maxLateralAccel;
+
+		/* cm : distance from a corner where the curve starts (POLYLINE) */
+	double cornerRadius;
+
+		/* cm : distance between two samples */
+	double step;
+};
+
+/*
+ * A point of the path
+ */
+struct TrajectorySample
+{
+		/* Position, in cm */
+	double x;
+	double y;
+
+		/* Arc length from the start, in cm */
+	double s;
+
+		/* Planned speed, in cm/s */
+	double speed;
+
+		/* Planned time from the start, in s */
+	double t;
+};
+
+//------------------------------------------------------------ Class definition
+/*
+ * plan() samples the path every step cm, measures the curvature at every
+ * sample, and computes the fastest speed profile keeping the lateral
+ * acceleration within maxLateralAccel and the acceleration within
+ * maxAccel, from standstill to standstill (forward and backward passes).
+ */
+class Trajectory
+{
+	public:
+
+		//--------------------------------------------- Constructors/Destructor
+		Trajectory();
+
+		virtual ~Trajectory();
+
+		//------------------------------------------------------ Public methods
+
+		/**
+		 * @brief plan : Computes the path and its velocity profile
+		 * @param start : The position the path starts from
+		 * @param waypoints : The points to go through, in order
+		 * @param shape : How the waypoints are joined
+		 * @param limits : The speed and accelerations allowed
+		 * @return false if no waypoint is away from the start
+		 */
+		bool plan(Waypoint start, const std::vector<Waypoint>& waypoints,
+				pathShape shape, const TrajectoryLimits& limits);
+
+		/**
+		 * @return The path length, in cm (0 before plan)
+		 */
+		double getLength() const;
+
+		/**
+		 * @return The planned duration, in s
+		 */
+		double getDuration() const;
+
+		/**
+		 * @return The samples, by increasing arc length
+		 */
+		const std::vector<TrajectorySample>& getSamples() const;
+
+		/**
+		 * @brief at : Interpolates the path
+		 * @param s : The arc length, clamped to the path
+		 * @return The position, planned speed and time at s
+		 */
+		TrajectorySample at(double s) const;
+
+		/**
+		 * @brief locate : Projects a position on the path, searching
+		 * 				  forward from a known arc length
+		 * @param x : The abscissa, in cm
+		 * @param y : The ordinate, in cm
+		 * @param from : The arc length the search starts from
+		 * @param window : How far ahead to search, in cm
+		 * @return The arc length of the closest point
+		 */
+		double locate(double x, double y, double from, double window) const;
+
+	private:
+		//----------------------------------------------------- Private methods
+
+		/**
+		 * @brief addPoint : Appends a sample, its arc length following the
+		 * 					previous one
+		 */
+		void addPoint(double x, double y);
+
+		/**
+		 * @brief addLine : Samples a straight line from the last sample
+		 */
+		void addLine(double x, double y);
+
+		/**
+		 * @brief addBezier : Samples a quadratic Bézier curve from the last
+		 * 					 sample
+		 * @param cx, cy : The control point
+		 * @param x, y : The end point
+		 */
+		void addBezier(double cx, double cy, double x, double y);
+
+		/**
+		 * @brief addCatmullRom : Samples the centripetal Catmull-Rom
+		 * 						 segment from p1 to p2
+		 */
+		void addCatmullRom(const double p0[2], const double p1[2],
+				const double p2[2], const double p3[2]);
+
+		/**
+		 * @brief profile : Computes the speed and time of every sample
+		 */
+		void profile();
+
+		/**
+		 * @return The index of the last sample at or before s
+		 */
+		size_t indexOf(double s) const;
+
+		//-------------------------------------------------- Private attributes
+		TrajectoryLimits _limits;
+		std::vector<TrajectorySample> _samples;
+};
+
+#endif // TRAJECTORY_HPP
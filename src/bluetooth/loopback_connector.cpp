@@ -0,0 +1,102 @@
+/*************************************************************************
+	loopback_connector  -  Connector to an in-process SpheroEmulator,
+						   through a socketpair
+                             -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+//-------------------------------------------------------- System includes
+#include <unistd.h>
+#include <sys/socket.h>
+
+//--------------------------------------------------------- Local includes
+#include "loopback_connector.h"
+
+
+//------------------------------------------------ Constructors/Destructor
+
+loopback_connector::loopback_connector():bluetooth_connector(), _socket(-1),
+	_peer(-1)
+{}
+
+
+loopback_connector::~loopback_connector()
+{
+	if(_socket != -1)
+	{
+		disconnect();
+	}
+}
+
+//--------------------------------------------------------- Public methods
+
+/**
+ * @brief connection : Creates the socketpair and starts the emulator
+ * 					   on its other end
+ * @param address : Ignored
+ * @return The socket ID, or -1 if an error occurred
+ */
+int loopback_connector::connection(const char*)
+{
+	if(_socket != -1)
+	{
+		return _socket;
+	}
+
+	int sv[2];
+	if(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == -1)
+	{
+		perror("Loopback connection");
+		return -1;
+	}
+
+	if(!_emulator.start(sv[1]))
+	{
+		close(sv[0]);
+		close(sv[1]);
+		return -1;
+	}
+
+	_socket = sv[0];
+	_peer = sv[1];
+	return _socket;
+}
+
+
+/**
+ * @brief disconnect : Stops the emulator and closes both ends
+ * @return An error code
+ */
+int loopback_connector::disconnect(void)
+{
+	if(_socket == -1)
+	{
+		return 0;
+	}
+
+	_emulator.stop();
+	close(_peer);
+	int error = close(_socket);
+
+	_socket = _peer = -1;
+	return error;
+}
+
+
+/**
+ * @brief isConnected : Checks the connection status
+ * @return true if the connection is currently established
+ */
+bool loopback_connector::isConnected()
+{
+	return _socket != -1;
+}
+
+
+/**
+ * @return The emulated Sphero
+ */
+SpheroEmulator& loopback_connector::getEmulator()
+{
+	return _emulator;
+}
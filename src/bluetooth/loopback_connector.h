@@ -0,0 +1,73 @@
+/*************************************************************************
+	loopback_connector  -  Connector to an in-process SpheroEmulator,
+						   through a socketpair
+                             -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+#ifndef LOOPBACK_CONNECTOR_H
+#define LOOPBACK_CONNECTOR_H
+
+//-------------------------------------------------------- Local includes
+#include "bluetooth_connector.h"
+#include "../emulator/SpheroEmulator.hpp"
+
+
+//------------------------------------------------------- Class definition
+class loopback_connector : public bluetooth_connector
+{
+	public:
+
+		//-------------------------------------------- Operators overload
+			//No sense
+		loopback_connector & operator=(const loopback_connector &) = delete;
+
+
+		//--------------------------------------- Constructors/Destructor
+			//No sense
+		loopback_connector(const loopback_connector &) = delete;
+
+		/**
+		 * @brief loopback_connector : Constructor
+		 */
+		loopback_connector();
+
+		virtual ~loopback_connector ( );
+
+		//------------------------------------------------ Public methods
+
+		/**
+		 * @brief connection : Creates the socketpair and starts the emulator
+		 * 					   on its other end
+		 * @param address : Ignored
+		 * @return The socket ID, or -1 if an error occurred
+		 */
+		virtual int connection(const char* address);
+
+		/**
+		 * @brief disconnect : Stops the emulator and closes both ends
+		 * @return An error code
+		 */
+		virtual int disconnect(void);
+
+		/**
+		 * @brief isConnected : Checks the connection status
+		 * @return true if the connection is currently established
+		 */
+		virtual bool isConnected();
+
+		/**
+		 * @return The emulated Sphero
+		 */
+		SpheroEmulator& getEmulator();
+
+	private:
+
+			/* The socket given to the library, and the emulator one */
+		int _socket;
+		int _peer;
+
+		SpheroEmulator _emulator;
+};
+
+#endif // LOOPBACK_CONNECTOR_H
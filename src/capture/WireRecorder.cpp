@@ -0,0 +1,125 @@
+/*************************************************************************
+	WireRecorder  -  Opt-in capture of every frame exchanged with the
+					 Sphero, for replaying field issues
+							 -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+//-------------------------------------------------------- System includes
+#include <endian.h>
+#include <cstring>
+
+//--------------------------------------------------------- Local includes
+#include "WireRecorder.hpp"
+#include "../packets/Toolbox.hpp"
+
+//------------------------------------------------ Constructors/Destructor
+
+WireRecorder::WireRecorder():_recording(false), _file(NULL)
+{
+	pthread_mutex_init(&_lock, NULL);
+}
+
+
+/**
+ * Closes the capture file if one is open
+ */
+WireRecorder::~WireRecorder()
+{
+	stop();
+	pthread_mutex_destroy(&_lock);
+}
+
+//--------------------------------------------------------- Public methods
+
+/**
+ * @brief start : Starts recording, the running capture being closed
+ * @param path : The capture file, truncated
+ * @return false if the file could not be created
+ */
+bool WireRecorder::start(const char* path)
+{
+	stop();
+
+	FILE* file = fopen(path, "wb");
+	if(file == NULL)
+	{
+		return false;
+	}
+
+	if(fwrite(CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC), 1, file) != 1)
+	{
+		fclose(file);
+		return false;
+	}
+
+	pthread_mutex_lock(&_lock);
+	_file = file;
+	_recording.store(true, std::memory_order_relaxed);
+	pthread_mutex_unlock(&_lock);
+
+	return true;
+}
+
+
+/**
+ * @brief stop : Flushes and closes the capture file
+ */
+void WireRecorder::stop()
+{
+	pthread_mutex_lock(&_lock);
+	_recording.store(false, std::memory_order_relaxed);
+	if(_file != NULL)
+	{
+		fclose(_file);
+		_file = NULL;
+	}
+	pthread_mutex_unlock(&_lock);
+}
+
+
+/**
+ * @return true while a capture file is open
+ */
+bool WireRecorder::isRecording() const
+{
+	return _recording.load(std::memory_order_relaxed);
+}
+
+
+/**
+ * @brief record : Appends a frame to the capture, if one is running
+ * @param direction : Where the frame goes
+ * @param frame : The frame bytes, from SOP1 to the checksum
+ * @param length : The frame length
+ */
+void WireRecorder::record(captureDirection direction, const uint8_t* frame,
+		size_t length)
+{
+	if(!_recording.load(std::memory_order_relaxed) || length > UINT16_MAX)
+	{
+		return;
+	}
+
+	uint8_t header[CAPTURE_RECORD_HEADER_SIZE];
+	uint64_t timestamp = htole64(packet_toolbox::monotonicUs());
+	uint16_t size = htole16(length);
+	memcpy(header, &timestamp, sizeof(timestamp));
+	memcpy(header + 8, &size, sizeof(size));
+	header[10] = (uint8_t) direction;
+
+	pthread_mutex_lock(&_lock);
+	if(_file != NULL)
+	{
+			//A full disk ends the capture, the records written staying
+			//readable
+		if(fwrite(header, sizeof(header), 1, _file) != 1
+				|| fwrite(frame, length, 1, _file) != 1)
+		{
+			fclose(_file);
+			_file = NULL;
+			_recording.store(false, std::memory_order_relaxed);
+		}
+	}
+	pthread_mutex_unlock(&_lock);
+}
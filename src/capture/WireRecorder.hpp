@@ -0,0 +1,96 @@
+/*************************************************************************
+	WireRecorder  -  Opt-in capture of every frame exchanged with the
+					 Sphero, for replaying field issues
+							 -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+#ifndef WIRERECORDER_HPP
+#define WIRERECORDER_HPP
+
+//-------------------------------------------------------- System includes
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <atomic>
+#include <pthread.h>
+
+//-------------------------------------------------------------- Constants
+
+	/* First bytes of a capture file (format version 1) */
+static char const CAPTURE_MAGIC[8] = {'S', 'P', 'H', 'C', 'A', 'P', '\0', 1};
+
+	/* Timestamp (8) | frame length (2) | direction (1), little-endian */
+static size_t const CAPTURE_RECORD_HEADER_SIZE = 11;
+
+//------------------------------------------------------------------ Types
+enum class captureDirection : uint8_t
+{
+		/* Checksum-valid frame received from the Sphero */
+	INBOUND = 0,
+		/* Client packet written to the socket */
+	OUTBOUND = 1
+};
+
+//------------------------------------------------------- Class definition
+/*
+ * A capture file is CAPTURE_MAGIC followed by one record per frame :
+ * | timestamp (µs, monotonic) | length | direction | <frame bytes> |
+ *
+ * Inbound frames are recorded by the reception thread once validated by the
+ * PacketFramer, outbound ones by the writer thread once written. When no
+ * capture is running, record() costs a relaxed atomic load.
+ */
+class WireRecorder
+{
+	public:
+		//---------------------------------------- Constructors/Destructor
+		WireRecorder();
+
+		/**
+		 * Closes the capture file if one is open
+		 */
+		virtual ~WireRecorder();
+
+			//No sense
+		WireRecorder(const WireRecorder&) = delete;
+		WireRecorder& operator=(const WireRecorder&) = delete;
+
+		//------------------------------------------------- Public methods
+
+		/**
+		 * @brief start : Starts recording, the running capture being closed
+		 * @param path : The capture file, truncated
+		 * @return false if the file could not be created
+		 */
+		bool start(const char* path);
+
+		/**
+		 * @brief stop : Flushes and closes the capture file
+		 */
+		void stop();
+
+		/**
+		 * @return true while a capture file is open
+		 */
+		bool isRecording() const;
+
+		/**
+		 * @brief record : Appends a frame to the capture, if one is running
+		 * @param direction : Where the frame goes
+		 * @param frame : The frame bytes, from SOP1 to the checksum
+		 * @param length : The frame length
+		 */
+		void record(captureDirection direction, const uint8_t* frame,
+				size_t length);
+
+	private:
+		//------------------------------------------------ Private attributes
+		std::atomic<bool> _recording;
+
+			/* Protects _file, written by two threads */
+		pthread_mutex_t _lock;
+		FILE* _file;
+};
+
+#endif // WIRERECORDER_HPP
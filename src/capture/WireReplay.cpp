@@ -0,0 +1,226 @@
+/*************************************************************************
+	WireReplay  -  Feeds a capture file through the reception path of a
+				   Sphero, at recorded speed or as fast as possible
+							 -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+//-------------------------------------------------------- System includes
+#include <endian.h>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+//--------------------------------------------------------- Local includes
+#include "WireReplay.hpp"
+#include "../Sphero.hpp"
+#include "../packets/PacketFramer.hpp"
+#include "../packets/SpheroPacket.hpp"
+#include "../packets/Toolbox.hpp"
+
+//------------------------------------------------ Constructors/Destructor
+
+WireReplay::WireReplay():_map(NULL), _size(0), _cursor(0)
+{}
+
+
+WireReplay::~WireReplay()
+{
+	close();
+}
+
+//--------------------------------------------------------- Public methods
+
+/**
+ * @brief open : Maps a capture file, the previous one being closed
+ * @param path : The file written by a WireRecorder
+ * @return false if the file cannot be read or is not a capture
+ */
+bool WireReplay::open(const char* path)
+{
+	close();
+
+	int fd = ::open(path, O_RDONLY);
+	if(fd == -1)
+	{
+		return false;
+	}
+
+	struct stat st;
+	if(fstat(fd, &st) == -1 || (size_t) st.st_size < sizeof(CAPTURE_MAGIC))
+	{
+		::close(fd);
+		return false;
+	}
+
+	void* map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if(map == MAP_FAILED)
+	{
+		return false;
+	}
+
+	if(memcmp(map, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) != 0)
+	{
+		munmap(map, st.st_size);
+		return false;
+	}
+
+		//Read once, in order
+	madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+	_map = (const uint8_t*) map;
+	_size = st.st_size;
+	_cursor = sizeof(CAPTURE_MAGIC);
+
+	return true;
+}
+
+
+/**
+ * @brief close : Unmaps the capture
+ */
+void WireReplay::close()
+{
+	if(_map != NULL)
+	{
+		munmap((void*) _map, _size);
+		_map = NULL;
+		_size = 0;
+		_cursor = 0;
+	}
+}
+
+
+/**
+ * @brief rewind : Goes back to the first record
+ */
+void WireReplay::rewind()
+{
+	if(_map != NULL)
+	{
+		_cursor = sizeof(CAPTURE_MAGIC);
+	}
+}
+
+
+/**
+ * @brief next : Reads the next record
+ * @param record : Receives the record
+ * @return false at the end of the capture
+ */
+bool WireReplay::next(captureRecord& record)
+{
+	if(_map == NULL || _size - _cursor < CAPTURE_RECORD_HEADER_SIZE)
+	{
+		return false;
+	}
+
+	const uint8_t* header = _map + _cursor;
+	uint64_t timestamp;
+	uint16_t length;
+	memcpy(&timestamp, header, sizeof(timestamp));
+	memcpy(&length, header + 8, sizeof(length));
+	length = le16toh(length);
+
+	if(_size - _cursor - CAPTURE_RECORD_HEADER_SIZE < length)
+	{
+		return false;
+	}
+
+	record.timestampUs = le64toh(timestamp);
+	record.direction = (captureDirection) header[10];
+	record.frame = header + CAPTURE_RECORD_HEADER_SIZE;
+	record.length = length;
+
+	_cursor += CAPTURE_RECORD_HEADER_SIZE + length;
+
+	return true;
+}
+
+
+/**
+ * @brief replay : Dispatches every inbound frame of the capture to a Sphero,
+ * 				  as its reception thread would
+ * @param sphero : The Sphero receiving the frames. Its streaming parameters
+ * 				   must match those of the capture
+ * @param realTime : If true, frames are spaced as they were recorded, else
+ * 					 sent as fast as possible
+ * @return The number of frames dispatched
+ */
+size_t WireReplay::replay(Sphero* sphero, bool realTime)
+{
+	captureRecord record;
+	size_t nbFrames = 0;
+	uint64_t firstRecord = 0;
+	uint64_t start = packet_toolbox::monotonicUs();
+
+	rewind();
+	while(next(record))
+	{
+		if(record.direction != captureDirection::INBOUND
+				|| !isValidFrame(record.frame, record.length))
+		{
+			continue;
+		}
+
+		if(realTime)
+		{
+			if(nbFrames == 0)
+			{
+				firstRecord = record.timestampUs;
+			}
+
+			uint64_t due = start + (record.timestampUs - firstRecord);
+			struct timespec deadline;
+			deadline.tv_sec = due / 1000000;
+			deadline.tv_nsec = (due % 1000000) * 1000;
+			while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline,
+						NULL) != 0)
+			{ }
+		}
+
+		sphero->dispatchFrame(record.frame, record.length);
+		++nbFrames;
+	}
+
+	return nbFrames;
+}
+
+//-------------------------------------------------------- Private methods
+
+/**
+ * @return true if the frame can be given to the extractors : SOP1 SOP2,
+ * 		   DLEN matching the length, and a valid checksum
+ */
+bool WireReplay::isValidFrame(const uint8_t* frame, size_t length)
+{
+	if(length <= FRAME_HEADER_SIZE || frame[0] != START_OF_PACKET_FLAG)
+	{
+		return false;
+	}
+
+	size_t dlen;
+	if(frame[1] == ANSWER_FLAG)
+	{
+		dlen = frame[4];
+	}
+	else if(frame[1] == ASYNC_FLAG)
+	{
+		dlen = (frame[3] << 8) | frame[4];
+	}
+	else
+	{
+		return false;
+	}
+
+	if(FRAME_HEADER_SIZE + dlen != length)
+	{
+		return false;
+	}
+
+	return packet_toolbox::checksum(frame + 2, length - 3) == frame[length - 1];
+}
@@ -0,0 +1,104 @@
+/*************************************************************************
+	WireReplay  -  Feeds a capture file through the reception path of a
+				   Sphero, at recorded speed or as fast as possible
+							 -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+#ifndef WIREREPLAY_HPP
+#define WIREREPLAY_HPP
+
+//-------------------------------------------------------- System includes
+#include <cstdint>
+#include <cstddef>
+
+//--------------------------------------------------------- Local includes
+#include "WireRecorder.hpp"
+
+class Sphero;
+
+//------------------------------------------------------------------ Types
+struct captureRecord
+{
+		/* Monotonic time of the recording, in µs */
+	uint64_t timestampUs;
+	captureDirection direction;
+
+		/* Points into the mapped file : valid until close() */
+	const uint8_t* frame;
+	size_t length;
+};
+
+//------------------------------------------------------- Class definition
+/*
+ * The capture file is mapped read-only and never copied : frames are given
+ * to the extractors straight from the mapping. A record cut by the end of
+ * the file (recorder killed, full disk) ends the capture.
+ */
+class WireReplay
+{
+	public:
+		//---------------------------------------- Constructors/Destructor
+		WireReplay();
+
+		virtual ~WireReplay();
+
+			//No sense
+		WireReplay(const WireReplay&) = delete;
+		WireReplay& operator=(const WireReplay&) = delete;
+
+		//------------------------------------------------- Public methods
+
+		/**
+		 * @brief open : Maps a capture file, the previous one being closed
+		 * @param path : The file written by a WireRecorder
+		 * @return false if the file cannot be read or is not a capture
+		 */
+		bool open(const char* path);
+
+		/**
+		 * @brief close : Unmaps the capture
+		 */
+		void close();
+
+		/**
+		 * @brief rewind : Goes back to the first record
+		 */
+		void rewind();
+
+		/**
+		 * @brief next : Reads the next record
+		 * @param record : Receives the record
+		 * @return false at the end of the capture
+		 */
+		bool next(captureRecord& record);
+
+		/**
+		 * @brief replay : Dispatches every inbound frame of the capture to a
+		 * 				  Sphero, as its reception thread would
+		 * @param sphero : The Sphero receiving the frames. Its streaming
+		 * 				   parameters must match those of the capture
+		 * @param realTime : If true, frames are spaced as they were
+		 * 					 recorded, else sent as fast as possible
+		 * @return The number of frames dispatched
+		 */
+		size_t replay(Sphero* sphero, bool realTime = false);
+
+	private:
+		//--------------------------------------------------- Private methods
+
+		/**
+		 * @return true if the frame can be given to the extractors : SOP1
+		 * 		   SOP2, DLEN matching the length, and a valid checksum
+		 */
+		static bool isValidFrame(const uint8_t* frame, size_t length);
+
+		//------------------------------------------------ Private attributes
+		const uint8_t* _map;
+		size_t _size;
+
+			/* Offset of the next record */
+		size_t _cursor;
+};
+
+#endif // WIREREPLAY_HPP
@@ -0,0 +1,692 @@
+/*************************************************************************
+	SpheroEmulator  -  In-process Sphero firmware speaking the wire
+					   protocol on a socket, to run the library without a
+					   ball nor a Bluetooth stack
+							 -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+//-------------------------------------------------------- System includes
+#include <cmath>
+#include <cstring>
+#include <cerrno>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+//--------------------------------------------------------- Local includes
+#include "SpheroEmulator.hpp"
+#include "../packets/Constants.hpp"
+#include "../packets/ClientCommandPacket.hpp"
+#include "../packets/SpheroAsyncPacket.hpp"
+#include "../packets/Toolbox.hpp"
+
+//-------------------------------------------------------------- Constants
+	//SOP1 SOP2 DID CID SEQ DLEN
+static size_t const CLIENT_HEADER_SIZE = 6;
+
+	//Sensor sampling frequency, divided by N of setDataStreaming
+static uint64_t const SAMPLE_PERIOD_US = 2500;
+
+//-------------------------------------------------------------- Functions
+
+static uint16_t be16(const uint8_t* data)
+{
+	return (uint16_t) (data[0] << 8 | data[1]);
+}
+
+static uint32_t be32(const uint8_t* data)
+{
+	return (uint32_t) data[0] << 24 | (uint32_t) data[1] << 16
+		| (uint32_t) data[2] << 8 | data[3];
+}
+
+static void putBe16(uint8_t* data, uint16_t value)
+{
+	data[0] = value >> 8;
+	data[1] = value;
+}
+
+static void putBe32(uint8_t* data, uint32_t value)
+{
+	putBe16(data, value >> 16);
+	putBe16(data + 2, value);
+}
+
+	//Writes the whole buffer, a peer gone being ignored
+static void writeAll(int fd, const uint8_t* data, size_t length)
+{
+	while(length > 0)
+	{
+		ssize_t written = send(fd, data, length, MSG_NOSIGNAL);
+		if(written < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if(written <= 0)
+		{
+			return;
+		}
+		data += written;
+		length -= written;
+	}
+}
+
+//------------------------------------------------ Constructors/Destructor
+
+SpheroEmulator::SpheroEmulator():_fd(-1), _running(false), _rxLength(0),
+	_answering(true), _headingError(0), _red(0), _green(0), _blue(0), _backLed(0),
+	_powerState((uint8_t) powerState::OK), _powerNotification(false), _x(0),
+	_y(0), _speedX(0), _speedY(0), _targetSpeed(0), _heading(0),
+	_divisor(1), _packetsLeft(0), _streaming(false), _nextPacket(0),
+	_clockOriginUs(packet_toolbox::monotonicUs()), _clockOriginMs(0),
+	_clockRate(1.0)
+{
+	_wake[0] = _wake[1] = -1;
+	memset(&_stats, 0, sizeof(_stats));
+	pthread_mutex_init(&_writeLock, NULL);
+	pthread_mutex_init(&_clockLock, NULL);
+	pthread_mutex_init(&_statsLock, NULL);
+}
+
+
+SpheroEmulator::~SpheroEmulator()
+{
+	stop();
+	pthread_mutex_destroy(&_writeLock);
+	pthread_mutex_destroy(&_clockLock);
+	pthread_mutex_destroy(&_statsLock);
+}
+
+//--------------------------------------------------------- Public methods
+
+/**
+ * @brief start : Starts emulating on a socket
+ * @param fd : The socket end the library does not use
+ * @return true if the emulator thread was started
+ */
+bool SpheroEmulator::start(int fd)
+{
+	if(_running || pipe(_wake) == -1)
+	{
+		return false;
+	}
+
+	_fd = fd;
+	_rxLength = 0;
+	_streaming = false;
+
+	if(pthread_create(&_thread, NULL, run, this) != 0)
+	{
+		close(_wake[0]);
+		close(_wake[1]);
+		return false;
+	}
+
+	_running = true;
+	return true;
+}
+
+
+/**
+ * @brief stop : Stops the emulator thread, the socket staying open
+ */
+void SpheroEmulator::stop()
+{
+	if(!_running)
+	{
+		return;
+	}
+
+	uint8_t wake = 0;
+	while(write(_wake[1], &wake, 1) == -1 && errno == EINTR)
+	{ }
+
+	pthread_join(_thread, NULL);
+	close(_wake[0]);
+	close(_wake[1]);
+	_running = false;
+}
+
+
+/**
+ * @brief injectCollision : Sends a collision packet now
+ * @param collision : The packet fields, axis being XAXIS or YAXIS
+ */
+void SpheroEmulator::injectCollision(const CollisionStruct& collision)
+{
+	uint8_t data[16];
+
+	putBe16(data, collision.impact_component_x);
+	putBe16(data + 2, collision.impact_component_y);
+	putBe16(data + 4, collision.impact_component_z);
+	data[6] = collision.threshold_axis == CollisionStruct::YAXIS ? 1 : 0;
+	putBe16(data + 7, collision.magnitude_component_x);
+	putBe16(data + 9, collision.magnitude_component_y);
+	data[11] = collision.speed;
+	data[12] = collision.timestamp >> 24;
+	data[13] = collision.timestamp >> 16;
+	data[14] = collision.timestamp >> 8;
+	data[15] = collision.timestamp;
+
+	sendAsync(COLLISION_DETECTED, data, sizeof(data));
+
+	pthread_mutex_lock(&_statsLock);
+	++_stats.collisions;
+	pthread_mutex_unlock(&_statsLock);
+}
+
+
+/**
+ * @brief injectPowerState : Changes the battery state, notified if power
+ * 							notifications are enabled
+ * @param state : The new state
+ */
+void SpheroEmulator::injectPowerState(powerState state)
+{
+	_powerState = (uint8_t) state;
+	if(_powerNotification)
+	{
+		uint8_t data = (uint8_t) state;
+		sendAsync(POWER_NOTIFICATION_FLAG, &data, 1);
+	}
+}
+
+
+/**
+ * @brief injectPreSleep : Sends the pre-sleep warning now
+ */
+void SpheroEmulator::injectPreSleep()
+{
+	sendAsync(PRESLEEP_WARNING, NULL, 0);
+}
+
+
+/**
+ * @brief setAnswering : Stops or resumes answering commands,
+ * 						 to emulate a lost link
+ * @param answering : false to drop every command silently
+ */
+void SpheroEmulator::setAnswering(bool answering)
+{
+	_answering = answering;
+}
+
+
+/**
+ * @brief setHeadingError : Makes the ball roll off the commanded heading, as
+ * 						   with a misaligned yaw tare
+ * @param degrees : The error, clockwise
+ */
+void SpheroEmulator::setHeadingError(int16_t degrees)
+{
+	_headingError = degrees;
+}
+
+
+/**
+ * @brief setClockDrift : Makes the emulated clock run fast or slow
+ * @param ppm : The rate error, positive when faster than the host
+ */
+void SpheroEmulator::setClockDrift(double ppm)
+{
+	uint64_t now = packet_toolbox::monotonicUs();
+
+	pthread_mutex_lock(&_clockLock);
+		//The clock goes on from its current value
+	_clockOriginMs += (now - _clockOriginUs) * _clockRate / 1000;
+	_clockOriginUs = now;
+	_clockRate = 1.0 + ppm / 1e6;
+	pthread_mutex_unlock(&_clockLock);
+}
+
+
+/**
+ * @return The emulated clock, in ms, as a collision timestamp
+ */
+uint32_t SpheroEmulator::getDeviceTime()
+{
+	uint64_t now = packet_toolbox::monotonicUs();
+
+	pthread_mutex_lock(&_clockLock);
+	double deviceMs = _clockOriginMs + (now - _clockOriginUs) * _clockRate / 1000;
+	pthread_mutex_unlock(&_clockLock);
+
+	return (uint32_t) (uint64_t) deviceMs;
+}
+
+
+/**
+ * @return The emulator counters
+ */
+EmulatorStats SpheroEmulator::getStats()
+{
+	pthread_mutex_lock(&_statsLock);
+	EmulatorStats stats = _stats;
+	pthread_mutex_unlock(&_statsLock);
+
+	return stats;
+}
+
+//------------------------------------------------------ Protected methods
+
+/**
+ * @brief handleCommand : Applies a client command, answering it if
+ * 						  asked
+ * @param packet : The client packet, checksum checked
+ */
+void SpheroEmulator::handleCommand(const uint8_t* packet)
+{
+	uint8_t did = packet[2];
+	uint8_t cid = packet[3];
+	uint8_t seq = packet[4];
+	uint8_t dlen = packet[5];
+	const uint8_t* data = packet + CLIENT_HEADER_SIZE;
+
+	uint8_t answer[32];
+	size_t answerLength = 0;
+
+	if(did == DID::sphero)
+	{
+		switch(cid)
+		{
+			case CID::roll:
+				if(dlen >= 4)
+				{
+					_targetSpeed = data[0] * EMULATOR_MAX_SPEED / 255;
+					_heading = (be16(data + 1) % 360 + 360 + _headingError % 360) % 360;
+
+					pthread_mutex_lock(&_statsLock);
+					++_stats.rolls;
+					pthread_mutex_unlock(&_statsLock);
+				}
+				break;
+
+			case CID::configureLocator:
+				if(dlen >= 8)
+				{
+					_x = (int16_t) be16(data + 1) * 10.0;
+					_y = (int16_t) be16(data + 3) * 10.0;
+				}
+				break;
+
+			case CID::setDataStreaming:
+				if(dlen >= 10)
+				{
+					_divisor = be16(data) == 0 ? 1 : be16(data);
+					_layout.configure(be16(data + 2), be32(data + 4),
+							dlen >= 14 ? be32(data + 9) : 0);
+					_packetsLeft = data[8];
+					_streaming = _layout.getNbFields() != 0
+						&& _layout.getNbFrames() != 0;
+					_nextPacket = packet_toolbox::monotonicUs()
+						+ _divisor * _layout.getNbFrames() * SAMPLE_PERIOD_US;
+				}
+				break;
+
+			case CID::setRGBLEDOutput:
+				if(dlen >= 4)
+				{
+					_red = data[0];
+					_green = data[1];
+					_blue = data[2];
+				}
+				break;
+
+			case CID::setBackLEDOutput:
+				if(dlen >= 2)
+				{
+					_backLed = data[0];
+				}
+				break;
+
+			case CID::getRGBLED:
+				answer[0] = _red;
+				answer[1] = _green;
+				answer[2] = _blue;
+				answerLength = 3;
+				break;
+		}
+	}
+	else if(did == DID::core && cid == CID::assignTimeValue && dlen >= 5)
+	{
+		setDeviceTime(be32(data));
+	}
+	else if(did == DID::core && cid == CID::pollPacketTimes && dlen >= 5)
+	{
+			//Client time, then reception and answer times
+		uint32_t now = getDeviceTime();
+		memcpy(answer, data, 4);
+		putBe32(answer + 4, now);
+		putBe32(answer + 8, now);
+		answerLength = 12;
+	}
+	else if(did == DID::core && cid == CID::getBluetoothInfo)
+	{
+		memset(answer, 0, 32);
+			//Name, then address, both NUL terminated
+		memcpy(answer, EMULATOR_NAME, sizeof(EMULATOR_NAME));
+		memcpy(answer + 16, EMULATOR_ADDRESS, sizeof(EMULATOR_ADDRESS));
+		answerLength = 32;
+	}
+
+	if(packet[1] & ANS_FLAG)
+	{
+		sendAnswer(MRSP_OK, seq, answer, answerLength);
+	}
+
+		//Asynchronous consequences, after the answer as on the ball
+	if(did == DID::core && cid == CID::setPowerNotification && dlen >= 2)
+	{
+		_powerNotification = data[0] != 0;
+		if(_powerNotification)
+		{
+			uint8_t state = _powerState;
+			sendAsync(POWER_NOTIFICATION_FLAG, &state, 1);
+		}
+	}
+	else if(did == DID::sphero && cid == CID::selfLevel && dlen >= 5
+			&& (data[0] & 0x01))
+	{
+		uint8_t result = (uint8_t) selfLevelResult::SUCCESS;
+		sendAsync(SELF_LEVEL_RESULT, &result, 1);
+	}
+}
+
+
+/**
+ * @brief sendAnswer : Sends a simple response packet
+ * @param mrsp : The response code
+ * @param seq : The echoed sequence number
+ * @param data : The payload
+ * @param length : The payload length
+ */
+void SpheroEmulator::sendAnswer(uint8_t mrsp, uint8_t seq,
+		const uint8_t* data, size_t length)
+{
+	uint8_t packet[6 + 0xFF];
+
+	packet[0] = START_OF_PACKET_FLAG;
+	packet[1] = ANSWER_FLAG;
+	packet[2] = mrsp;
+	packet[3] = seq;
+	packet[4] = length + 1;
+	if(length != 0)
+	{
+		memcpy(packet + 5, data, length);
+	}
+	packet[5 + length] = packet_toolbox::checksum(packet + 2, length + 3);
+
+	pthread_mutex_lock(&_writeLock);
+	writeAll(_fd, packet, length + 6);
+	pthread_mutex_unlock(&_writeLock);
+
+	pthread_mutex_lock(&_statsLock);
+	++_stats.answers;
+	pthread_mutex_unlock(&_statsLock);
+}
+
+
+/**
+ * @brief sendAsync : Sends an asynchronous packet
+ * @param id : The ID code
+ * @param data : The payload
+ * @param length : The payload length
+ */
+void SpheroEmulator::sendAsync(uint8_t id, const uint8_t* data,
+		size_t length)
+{
+	uint8_t packet[FRAMER_BUFFER_SIZE];
+
+	if(length + FRAME_HEADER_SIZE + 1 > sizeof(packet))
+	{
+		return;
+	}
+
+	packet[0] = START_OF_PACKET_FLAG;
+	packet[1] = ASYNC_FLAG;
+	packet[2] = id;
+	putBe16(packet + 3, length + 1);
+	if(length != 0)
+	{
+		memcpy(packet + FRAME_HEADER_SIZE, data, length);
+	}
+	packet[FRAME_HEADER_SIZE + length] =
+		packet_toolbox::checksum(packet + 2, length + 3);
+
+	pthread_mutex_lock(&_writeLock);
+	writeAll(_fd, packet, length + FRAME_HEADER_SIZE + 1);
+	pthread_mutex_unlock(&_writeLock);
+}
+
+//-------------------------------------------------------- Private methods
+
+void* SpheroEmulator::run(void* emulator)
+{
+	SpheroEmulator* self = (SpheroEmulator*) emulator;
+
+	struct pollfd fds[2];
+	fds[0].fd = self->_fd;
+	fds[0].events = POLLIN;
+	fds[1].fd = self->_wake[0];
+	fds[1].events = POLLIN;
+
+	for(;;)
+	{
+		struct timespec timeout;
+		struct timespec* timeoutPtr = NULL;
+
+		if(self->_streaming)
+		{
+			uint64_t now = packet_toolbox::monotonicUs();
+			uint64_t delay = self->_nextPacket > now ? self->_nextPacket - now : 0;
+			timeout.tv_sec = delay / 1000000;
+			timeout.tv_nsec = (delay % 1000000) * 1000;
+			timeoutPtr = &timeout;
+		}
+
+		if(ppoll(fds, 2, timeoutPtr, NULL) < 0 && errno != EINTR)
+		{
+			break;
+		}
+
+		if(fds[1].revents != 0)
+		{
+			break;
+		}
+
+		if((fds[0].revents & (POLLIN | POLLHUP | POLLERR)) && !self->receive())
+		{
+			break;
+		}
+
+		if(self->_streaming)
+		{
+			self->stream(packet_toolbox::monotonicUs());
+		}
+	}
+
+	return NULL;
+}
+
+
+/**
+ * @brief receive : Reads and handles the available client packets
+ * @return false once the library closed its end
+ */
+bool SpheroEmulator::receive()
+{
+	ssize_t nbRead = read(_fd, _rx + _rxLength, sizeof(_rx) - _rxLength);
+	if(nbRead <= 0)
+	{
+		return nbRead < 0 && errno == EINTR;
+	}
+	_rxLength += nbRead;
+
+	size_t start = 0;
+	while(_rxLength - start >= CLIENT_HEADER_SIZE)
+	{
+		const uint8_t* packet = _rx + start;
+
+			//Resynchronizing on the next SOP1 SOP2
+		if(packet[0] != INIT_SOP1 || (packet[1] & 0xFC) != INIT_SOP2)
+		{
+			++start;
+			continue;
+		}
+
+		size_t size = CLIENT_HEADER_SIZE + packet[5];
+		if(packet[5] == 0)
+		{
+			++start;
+			continue;
+		}
+		if(_rxLength - start < size)
+		{
+			break;
+		}
+
+		bool valid = packet_toolbox::checksum((uint8_t*) packet + 2,
+				size - 3) == packet[size - 1];
+
+		pthread_mutex_lock(&_statsLock);
+		++(valid ? _stats.commands : _stats.badChecksums);
+		pthread_mutex_unlock(&_statsLock);
+
+		if(_answering)
+		{
+			if(valid)
+			{
+				handleCommand(packet);
+			}
+			else if(packet[1] & ANS_FLAG)
+			{
+				sendAnswer(MRSP_EBAD_CSUM, packet[4], NULL, 0);
+			}
+		}
+
+		start += size;
+	}
+
+	memmove(_rx, _rx + start, _rxLength - start);
+	_rxLength -= start;
+
+	return true;
+}
+
+
+/**
+ * @brief stream : Sends the streaming packets which time came
+ * @param now : The monotonic time, in microseconds
+ */
+void SpheroEmulator::stream(uint64_t now)
+{
+	size_t nbFields = _layout.getNbFields();
+	size_t nbFrames = _layout.getNbFrames();
+	const dataTypes* fields = _layout.getFields();
+	uint64_t framePeriod = _divisor * SAMPLE_PERIOD_US;
+
+	uint8_t data[FRAMER_BUFFER_SIZE];
+	if(nbFields * nbFrames * 2 + FRAME_HEADER_SIZE + 1 > sizeof(data))
+	{
+		_streaming = false;
+		return;
+	}
+
+	while(_streaming && _nextPacket <= now)
+	{
+		uint8_t* out = data;
+		for(size_t frame = 0 ; frame < nbFrames ; ++frame)
+		{
+			step(framePeriod / 1e6);
+			for(size_t i = 0 ; i < nbFields ; ++i)
+			{
+				putBe16(out, sample(fields[i]));
+				out += 2;
+			}
+		}
+
+		sendAsync(SENSOR_DATA_STREAMING, data, out - data);
+
+		pthread_mutex_lock(&_statsLock);
+		++_stats.streamingPackets;
+		pthread_mutex_unlock(&_statsLock);
+
+		_nextPacket += framePeriod * nbFrames;
+
+		if(_packetsLeft != 0 && --_packetsLeft == 0)
+		{
+			_streaming = false;
+		}
+	}
+}
+
+
+/**
+ * @brief step : Moves the emulated ball by one sample period
+ * @param dt : The period, in seconds
+ */
+void SpheroEmulator::step(double dt)
+{
+		//Heading 0 faces +Y, 90 faces +X
+	double angle = _heading * M_PI / 180;
+	double targetX = _targetSpeed * sin(angle);
+	double targetY = _targetSpeed * cos(angle);
+
+	double gain = 1 - exp(-dt / EMULATOR_SPEED_LAG);
+	_speedX += (targetX - _speedX) * gain;
+	_speedY += (targetY - _speedY) * gain;
+
+	_x += _speedX * dt;
+	_y += _speedY * dt;
+}
+
+
+/**
+ * @return The streamed value of a field, for the current state
+ */
+uint16_t SpheroEmulator::sample(dataTypes type)
+{
+	double speed = sqrt(_speedX * _speedX + _speedY * _speedY);
+
+	switch(type)
+	{
+			//At rest on a flat floor : 1 g on Z
+		case RAW_ACCEL_Z:
+			return 4096;
+		case FILTERED_ACCEL_Z:
+			return 4096;
+		case FILTERED_YAW_IMU:
+			return (uint16_t) (int16_t) (_heading > 180 ? _heading - 360 : _heading);
+		case RAW_LEFT_MOTOR_PWM:
+		case RAW_RIGHT_MOTOR_PWM:
+			return (uint16_t) (speed * 255 / EMULATOR_MAX_SPEED);
+		case QUATERNION_Q0:
+			return 10000;
+		case ODOMETER_X:
+			return (uint16_t) (int16_t) lround(_x / 10);
+		case ODOMETER_Y:
+			return (uint16_t) (int16_t) lround(_y / 10);
+		case ACCELONE_0:
+			return 1000;
+		case VELOCITY_X:
+			return (uint16_t) (int16_t) lround(_speedX);
+		case VELOCITY_Y:
+			return (uint16_t) (int16_t) lround(_speedY);
+		default:
+			return 0;
+	}
+}
+
+
+/**
+ * @brief setDeviceTime : Sets the emulated clock
+ * @param deviceMs : Its new value, in ms
+ */
+void SpheroEmulator::setDeviceTime(uint32_t deviceMs)
+{
+	pthread_mutex_lock(&_clockLock);
+	_clockOriginUs = packet_toolbox::monotonicUs();
+	_clockOriginMs = deviceMs;
+	pthread_mutex_unlock(&_clockLock);
+}
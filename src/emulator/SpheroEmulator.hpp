@@ -0,0 +1,264 @@
+/*************************************************************************
+	SpheroEmulator  -  In-process Sphero firmware speaking the wire
+					   protocol on a socket, to run the library without a
+					   ball nor a Bluetooth stack
+							 -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+#ifndef SPHEROEMULATOR_HPP
+#define SPHEROEMULATOR_HPP
+
+//-------------------------------------------------------- System includes
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <pthread.h>
+
+//--------------------------------------------------------- Local includes
+#include "../packets/async/CollisionStruct.hpp"
+#include "../packets/async/DataBuffer.h"
+#include "../packets/async/NotificationTypes.hpp"
+#include "../packets/async/StreamLayout.hpp"
+
+//-------------------------------------------------------------- Constants
+	//Message response codes
+static uint8_t const MRSP_OK = 0x00;
+static uint8_t const MRSP_EBAD_CSUM = 0x02;
+
+	//Speed reached by roll(255, ...), in mm/s
+static double const EMULATOR_MAX_SPEED = 2000.0;
+
+	//Time constant of the speed response to roll(), in seconds
+static double const EMULATOR_SPEED_LAG = 0.25;
+
+	//Bluetooth name and address given by getBluetoothInfo (at most 15
+	//and 12 characters)
+static char const EMULATOR_NAME[] = "Sphero-EMU";
+static char const EMULATOR_ADDRESS[] = "000000000000";
+
+//------------------------------------------------------------------ Types
+
+/*
+ * Counters of the emulator, for tests and benchmarks
+ */
+struct EmulatorStats
+{
+		/* Valid client packets received, roll commands among them */
+	uint64_t commands;
+	uint64_t rolls;
+
+		/* Client packets with a bad checksum */
+	uint64_t badChecksums;
+
+		/* Answers sent */
+	uint64_t answers;
+
+		/* Streaming and collision packets sent */
+	uint64_t streamingPackets;
+	uint64_t collisions;
+};
+
+//------------------------------------------------------- Class definition
+/*
+ * Runs a thread on one end of a connected socket :
+ * 	- acknowledged commands are answered with their SEQ and MRSP OK, or
+ * 	  EBAD_CSUM when the checksum is wrong,
+ * 	- getRGBLED and getBluetoothInfo answer with data,
+ * 	- setDataStreaming starts streaming packets at its rate, with its
+ * 	  frame count and masks,
+ * 	- roll drives a point moving in the plane, which position and speed
+ * 	  are streamed as ODOMETER_* and VELOCITY_*, off the commanded
+ * 	  heading by the angle given to setHeadingError,
+ * 	- collisions are sent on demand with injectCollision.
+ * 	- setPowerNotification(1) sends the battery state at once, then on
+ * 	  injectPowerState. A started selfLevel succeeds at once. The pre-sleep
+ * 	  warning is sent on demand with injectPreSleep.
+ * 	- a millisecond clock, started at 0 with the emulator and running at
+ * 	  the rate given to setClockDrift, is set by assignTimeValue and read
+ * 	  by pollPacketTimes.
+ */
+class SpheroEmulator
+{
+	public:
+		//---------------------------------------- Constructors/Destructor
+		SpheroEmulator();
+
+		virtual ~SpheroEmulator();
+
+			//No sense
+		SpheroEmulator(const SpheroEmulator&) = delete;
+		SpheroEmulator& operator=(const SpheroEmulator&) = delete;
+
+		//------------------------------------------------- Public methods
+
+		/**
+		 * @brief start : Starts emulating on a socket
+		 * @param fd : The socket end the library does not use
+		 * @return true if the emulator thread was started
+		 */
+		bool start(int fd);
+
+		/**
+		 * @brief stop : Stops the emulator thread, the socket staying open
+		 */
+		void stop();
+
+		/**
+		 * @brief injectCollision : Sends a collision packet now
+		 * @param collision : The packet fields, axis being XAXIS or YAXIS
+		 */
+		void injectCollision(const CollisionStruct& collision);
+
+		/**
+		 * @brief injectPowerState : Changes the battery state, notified if
+		 * 							power notifications are enabled
+		 * @param state : The new state
+		 */
+		void injectPowerState(powerState state);
+
+		/**
+		 * @brief injectPreSleep : Sends the pre-sleep warning now
+		 */
+		void injectPreSleep();
+
+		/**
+		 * @brief setAnswering : Stops or resumes answering commands,
+		 * 						 to emulate a lost link
+		 * @param answering : false to drop every command silently
+		 */
+		void setAnswering(bool answering);
+
+		/**
+		 * @brief setHeadingError : Makes the ball roll off the commanded
+		 * 						   heading, as with a misaligned yaw tare
+		 * @param degrees : The error, clockwise
+		 */
+		void setHeadingError(int16_t degrees);
+
+		/**
+		 * @brief setClockDrift : Makes the emulated clock run fast or slow
+		 * @param ppm : The rate error, positive when faster than the host
+		 */
+		void setClockDrift(double ppm);
+
+		/**
+		 * @return The emulated clock, in ms, as a collision timestamp
+		 */
+		uint32_t getDeviceTime();
+
+		/**
+		 * @return The emulator counters
+		 */
+		EmulatorStats getStats();
+
+	protected:
+		//------------------------------------------------ Protected methods
+
+		/**
+		 * @brief handleCommand : Applies a client command, answering it if
+		 * 						  asked
+		 * @param packet : The client packet, checksum checked
+		 */
+		virtual void handleCommand(const uint8_t* packet);
+
+		/**
+		 * @brief sendAnswer : Sends a simple response packet
+		 * @param mrsp : The response code
+		 * @param seq : The echoed sequence number
+		 * @param data : The payload
+		 * @param length : The payload length
+		 */
+		void sendAnswer(uint8_t mrsp, uint8_t seq, const uint8_t* data,
+				size_t length);
+
+		/**
+		 * @brief sendAsync : Sends an asynchronous packet
+		 * @param id : The ID code
+		 * @param data : The payload
+		 * @param length : The payload length
+		 */
+		void sendAsync(uint8_t id, const uint8_t* data, size_t length);
+
+	private:
+		//--------------------------------------------------- Private methods
+
+		static void* run(void* emulator);
+
+		/**
+		 * @brief receive : Reads and handles the available client packets
+		 * @return false once the library closed its end
+		 */
+		bool receive();
+
+		/**
+		 * @brief stream : Sends the streaming packets which time came
+		 * @param now : The monotonic time, in microseconds
+		 */
+		void stream(uint64_t now);
+
+		/**
+		 * @brief step : Moves the emulated ball by one sample period
+		 * @param dt : The period, in seconds
+		 */
+		void step(double dt);
+
+		/**
+		 * @return The streamed value of a field, for the current state
+		 */
+		uint16_t sample(dataTypes type);
+
+		/**
+		 * @brief setDeviceTime : Sets the emulated clock
+		 * @param deviceMs : Its new value, in ms
+		 */
+		void setDeviceTime(uint32_t deviceMs);
+
+		//------------------------------------------------ Private attributes
+		int _fd;
+		int _wake[2];
+		pthread_t _thread;
+		bool _running;
+
+			/* Serializes the writes of the thread and injectCollision */
+		pthread_mutex_t _writeLock;
+
+		uint8_t _rx[FRAMER_BUFFER_SIZE];
+		size_t _rxLength;
+
+		std::atomic<bool> _answering;
+		std::atomic<int16_t> _headingError;
+
+			/* Only used by the emulator thread from here */
+
+		uint8_t _red, _green, _blue, _backLed;
+
+			/* Battery state, and whether its changes are notified */
+		std::atomic<uint8_t> _powerState;
+		std::atomic<bool> _powerNotification;
+
+			/* Motion : position in mm, speed in mm/s, heading in degrees */
+		double _x, _y;
+		double _speedX, _speedY;
+		double _targetSpeed;
+		uint16_t _heading;
+
+			/* Streaming : N (400 / N Hz), M frames per packet */
+		StreamLayout _layout;
+		uint16_t _divisor;
+		uint32_t _packetsLeft;
+		bool _streaming;
+		uint64_t _nextPacket;
+
+			/* Clock : _clockOriginMs at _clockOriginUs (host monotonic),
+			 * then _clockRate device ms per host ms */
+		pthread_mutex_t _clockLock;
+		uint64_t _clockOriginUs;
+		double _clockOriginMs;
+		double _clockRate;
+
+		pthread_mutex_t _statsLock;
+		EmulatorStats _stats;
+};
+
+#endif // SPHEROEMULATOR_HPP
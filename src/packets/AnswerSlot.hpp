@@ -0,0 +1,83 @@
+/*************************************************************************
+	AnswerSlot  -  Caller-owned destination of a command answer, for the
+				   queries waiting for it
+                             -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+#ifndef ANSWERSLOT_HPP
+#define ANSWERSLOT_HPP
+
+//-------------------------------------------------------- System includes
+#include <cstdint>
+#include <pthread.h>
+
+//--------------------------------------------------------- Local includes
+#include "CommandTracker.hpp"
+
+//------------------------------------------------------- Class definition
+/**
+ * Result : The structure the answer payload is decoded into
+ *
+ * The completion decodes the payload, still in the receive buffer, straight
+ * into the caller result, then wakes up the waiting thread. The slot lives
+ * on the caller stack : nothing is allocated per query, and nothing is left
+ * behind when the command times out, since the tracker always completes it.
+ */
+template<typename Result>
+class AnswerSlot
+{
+	public:
+		//---------------------------------------------------- Local types
+		typedef bool (*decoder_t)(uint8_t dlen, const uint8_t* data,
+				Result& result);
+
+		//--------------------------------------------- Operators overload
+			//No sense
+		AnswerSlot& operator=(const AnswerSlot&) = delete;
+
+		//---------------------------------------- Constructors/Destructor
+			//No sense
+		AnswerSlot(const AnswerSlot&) = delete;
+
+		/**
+		 * @brief AnswerSlot : Constructor
+		 * @param result : Receives the decoded answer
+		 * @param decode : Checks the DLEN field and decodes the payload
+		 */
+		AnswerSlot(Result& result, decoder_t decode);
+
+		virtual ~AnswerSlot();
+
+		//------------------------------------------------- Public methods
+
+		/**
+		 * @brief complete : Command completion, decoding the answer if there
+		 * 					 is one and the Sphero accepted the command
+		 * 					 (MRSP OK)
+		 * @param answer : The answer, or the reason why there is none
+		 */
+		void complete(const CommandAnswer& answer);
+
+		/**
+		 * @brief wait : Waits for the completion
+		 * @return true if a valid answer was decoded into the result
+		 *
+		 * Contract: CommandTracker::mayWaitForAnswer() holds on the calling
+		 * thread, otherwise the completion never comes
+		 */
+		bool wait();
+
+	private:
+		//--------------------------------------------- Private attributes
+		Result& _result;
+		decoder_t _decode;
+		bool _completed;
+		bool _decoded;
+		pthread_mutex_t _lock;
+		pthread_cond_t _done;
+};
+
+#include "AnswerSlot.tpp"
+
+#endif // ANSWERSLOT_HPP
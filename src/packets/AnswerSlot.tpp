@@ -0,0 +1,70 @@
+/*************************************************************************
+	AnswerSlot  -  Caller-owned destination of a command answer, for the
+				   queries waiting for it
+                             -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+//------------------------------------------------ Constructors/Destructor
+
+/**
+ * @brief AnswerSlot : Constructor
+ * @param result : Receives the decoded answer
+ * @param decode : Checks the DLEN field and decodes the payload
+ */
+template<typename Result>
+AnswerSlot<Result>::AnswerSlot(Result& result, decoder_t decode):
+	_result(result), _decode(decode), _completed(false), _decoded(false)
+{
+	pthread_mutex_init(&_lock, NULL);
+	pthread_cond_init(&_done, NULL);
+}
+
+
+template<typename Result>
+AnswerSlot<Result>::~AnswerSlot()
+{
+	pthread_cond_destroy(&_done);
+	pthread_mutex_destroy(&_lock);
+}
+
+
+//--------------------------------------------------------- Public methods
+
+/**
+ * @brief complete : Command completion, decoding the answer if there is one
+ * 					 and the Sphero accepted the command (MRSP OK)
+ * @param answer : The answer, or the reason why there is none
+ */
+template<typename Result>
+void AnswerSlot<Result>::complete(const CommandAnswer& answer)
+{
+	pthread_mutex_lock(&_lock);
+	_decoded = answer.status == commandStatus::ANSWERED && answer.mrsp == 0
+		&& _decode(answer.dlen, answer.data, _result);
+	_completed = true;
+	pthread_cond_signal(&_done);
+	pthread_mutex_unlock(&_lock);
+}
+
+
+/**
+ * @brief wait : Waits for the completion
+ * @return true if a valid answer was decoded into the result
+ *
+ * Contract: CommandTracker::mayWaitForAnswer() holds on the calling thread,
+ * otherwise the completion never comes
+ */
+template<typename Result>
+bool AnswerSlot<Result>::wait()
+{
+	pthread_mutex_lock(&_lock);
+	while(!_completed)
+	{
+		pthread_cond_wait(&_done, &_lock);
+	}
+	bool decoded = _decoded;
+	pthread_mutex_unlock(&_lock);
+
+	return decoded;
+}
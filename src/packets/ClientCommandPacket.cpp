@@ -6,15 +6,12 @@
  *************************************************************************/
 
 //--------------------------------------------------------- System includes
-#include <cstddef>
-#include <sstream>
 #include <iostream>
 
 using namespace std;
 
 //---------------------------------------------------------- Local includes
 #include "ClientCommandPacket.hpp"
-#include "Toolbox.hpp"
 
 //------------------------------------------------- Constructors/Destructor
 
@@ -30,77 +27,104 @@ using namespace std;
  * @param rstTO : if true, reset client inactivity timeout
  */
 ClientCommandPacket::ClientCommandPacket(byte did, byte cid, byte seq, byte dlen,
-										 byte* data, bool acknowledge, bool rstTO):
-			_sop1(INIT_SOP1), _sop2(INIT_SOP2), _did(did), _cid(cid),
-			_seq(seq), _dlen(dlen), _data(data)
+										 const byte* data, bool acknowledge, bool rstTO):
+			_size(serialize(_array, did, cid, seq, dlen, data, acknowledge, rstTO))
 {
+#ifdef MAP
+	std::cout << "Checksum :" << (unsigned int) _array[_size - 1] << std::endl;
+#endif
+}
+
+
+ClientCommandPacket::~ClientCommandPacket()
+{}
+
+
+//---------------------------------------------------------- Public methods
+
+/**
+ * @brief serialize : Writes a whole packet, checksum included, in a single
+ * 					  pass
+ * @param buffer : Receives the packet, must hold dlen + 6 bytes
+ * 				   (CLIENT_PACKET_MAX_SIZE is always enough)
+ * @param did : Device ID
+ * @param cid : Command ID
+ * @param seq : Sequence number
+ * @param dlen : Data length (payload length + 1), at least 1
+ * @param data : The payload, may be NULL if dlen is 1
+ * @param acknowledge : if true, client send reply after acting
+ * @param rstTO : if true, reset client inactivity timeout
+ * @return The packet size
+ */
+size_t ClientCommandPacket::serialize(uint8_t* buffer, byte did, byte cid,
+		byte seq, byte dlen, const byte* data, bool acknowledge, bool rstTO)
+{
+	byte sop2 = INIT_SOP2;
 	if(acknowledge)
 	{
-		_sop2 ^= ANS_FLAG;
+		sop2 |= ANS_FLAG;
 	}
-
 	if(rstTO)
 	{
-		_sop2 ^= RST_FLAG;
+		sop2 |= RST_FLAG;
 	}
 
-	uint8_t* packet_data = new uint8_t[4 + _dlen - 1];
-	
-	packet_data[0] = _did;
-	packet_data[1] = _cid;
-	packet_data[2] = _seq;
-	packet_data[3] = _dlen;
-	
-    for(size_t i = 0; i+1 < _dlen ; packet_data[i + 4] = _data[i], i++)
-	{}
-	
-	_chk = packet_toolbox::checksum(packet_data, 4 + _dlen - 1);
-	
-	delete packet_data;
+	buffer[0] = INIT_SOP1;
+	buffer[1] = sop2;
+	buffer[2] = did;
+	buffer[3] = cid;
+	buffer[4] = seq;
+	buffer[5] = dlen;
 
-#ifdef MAP
-	std::cout << "Checksum :" << (unsigned int) _chk << std::endl;
-#endif
-	array = new uint8_t[6 + _dlen];
-}
+		//The checksum covers DID through the end of the payload
+	uint8_t sum = did + cid + seq + dlen;
+	for(size_t i = 0 ; i + 1 < dlen ; ++i)
+	{
+		buffer[6 + i] = data[i];
+		sum += data[i];
+	}
 
+	size_t size = 6 + (size_t) dlen;
+	buffer[size - 1] = ~sum;
 
-ClientCommandPacket::~ClientCommandPacket()
-{
-	delete array;
+	return size;
 }
 
 
-//---------------------------------------------------------- Public methods
-
 /**
- * @brief toByteArray : transforms the packet data into a single array
- * @return the array containing the final packet structure
+ * @brief setSequence : Changes the sequence number of a serialized packet and
+ * 						asks for an answer, updating the checksum
+ * @param packet : The serialized packet
+ * @param size : The packet size
+ * @param seq : The new sequence number
  */
-uint8_t* ClientCommandPacket::toByteArray()
+void ClientCommandPacket::setSequence(uint8_t* packet, size_t size, byte seq)
 {
-	array[0] = _sop1;
-	array[1] = _sop2;
-	array[2] = _did;
-	array[3] = _cid;
-	array[4] = _seq;
-	array[5] = _dlen;
-
-	for(int i = 0 ; i < _dlen-1 ; ++i)
-	{
-		array[6+i] = _data[i];
-	}
+		//SOP2 is not covered by the checksum
+	packet[1] |= ANS_FLAG;
+
+	uint8_t sum = ~packet[size - 1];
+	sum += seq - packet[4];
+	packet[4] = seq;
+	packet[size - 1] = ~sum;
+}
 
-	array[6+_dlen-1] = _chk;
 
-	return array;
+/**
+ * @brief toByteArray : gives the serialized packet
+ * @return the array containing the final packet structure, valid as long as
+ * 		   the packet
+ */
+const uint8_t* ClientCommandPacket::toByteArray() const
+{
+	return _array;
 }
 
 
 /**
  * @return The final packet size
  */
-size_t ClientCommandPacket::getSize()
+size_t ClientCommandPacket::getSize() const
 {
-	return _dlen+6;
+	return _size;
 }
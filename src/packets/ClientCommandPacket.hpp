@@ -11,7 +11,7 @@
 
 //--------------------------------------------------------- System includes
 #include <cstdint>
-#include <string>
+#include <cstddef>
 
 //------------------------------------------------------------------- Types
 typedef uint8_t byte;
@@ -23,6 +23,9 @@ const byte INIT_SOP1 = 0xFF;
 	//SOP2 is initialized with RST and ANS set to false
 const byte INIT_SOP2 = 0xFC;
 
+	/* SOP1, SOP2, DID, CID, SEQ, DLEN and 255 bytes counted by DLEN */
+const size_t CLIENT_PACKET_MAX_SIZE = 6 + 255;
+
 //-------------------------------------------------------------------------
 /*
  * Packets are sent from client to sphero in the following format
@@ -53,6 +56,10 @@ const byte INIT_SOP2 = 0xFC;
 //-------------------------------------------------------------------------
 
 //-------------------------------------------------------- Class definition
+/*
+ * The packet is serialized once, by the constructor, in an inline buffer :
+ * building one does not allocate.
+ */
 class ClientCommandPacket
 {
 
@@ -71,51 +78,57 @@ class ClientCommandPacket
 		 * @param rstTO : if true, reset client inactivity timeout
 		 */
         ClientCommandPacket(byte did, byte cid, byte seq, byte dlen,
-							byte* data, bool acknowledge = false, bool rstTO = false);
+							const byte* data, bool acknowledge = false, bool rstTO = false);
 
 		virtual ~ClientCommandPacket();
 
 		//-------------------------------------------------- Public methods
 		/**
-		 * @brief toByteArray : transforms the packet data into a single array
-		 * @return the array containing the final packet structure
+		 * @brief serialize : Writes a whole packet, checksum included,
+		 * 					  in a single pass
+		 * @param buffer : Receives the packet, must hold dlen + 6 bytes
+		 * 				   (CLIENT_PACKET_MAX_SIZE is always enough)
+		 * @param did : Device ID
+		 * @param cid : Command ID
+		 * @param seq : Sequence number
+		 * @param dlen : Data length (payload length + 1), at least 1
+		 * @param data : The payload, may be NULL if dlen is 1
+		 * @param acknowledge : if true, client send reply after acting
+		 * @param rstTO : if true, reset client inactivity timeout
+		 * @return The packet size
 		 */
-		uint8_t* toByteArray();
+		static size_t serialize(uint8_t* buffer, byte did, byte cid, byte seq,
+				byte dlen, const byte* data, bool acknowledge, bool rstTO);
 
 		/**
-		 * @return The final packet size
+		 * @brief setSequence : Changes the sequence number of a serialized
+		 * 						packet and asks for an answer, updating the
+		 * 						checksum
+		 * @param packet : The serialized packet
+		 * @param size : The packet size
+		 * @param seq : The new sequence number
 		 */
-		size_t getSize();
-
-	private:
-		/* Start of Packet 1 */
-		byte _sop1 ;
-
-		/* Start of packet 2 */
-		byte _sop2;
-
-		/* Virtual device id */
-		byte _did;
-
-		/* Command id */
-		byte _cid;
+		static void setSequence(uint8_t* packet, size_t size, byte seq);
 
-		/* Sequence identifier (client field) */
-		byte _seq;
-
-		/* Data length  */
-		byte _dlen;
-
-		/* Optional data to accompany the command */
-		byte* _data;
+		/**
+		 * @brief toByteArray : gives the serialized packet
+		 * @return the array containing the final packet structure, valid as
+		 * 		   long as the packet
+		 */
+		const uint8_t* toByteArray() const;
 
-		/* Checksum */
-		byte _chk;
+		/**
+		 * @return The final packet size
+		 */
+		size_t getSize() const;
 
+	private:
 		/* The packet data array */
-		uint8_t *array;
+		uint8_t _array[CLIENT_PACKET_MAX_SIZE];
+
+		/* Number of bytes used in _array */
+		size_t _size;
 
 };
 
 #endif // CLIENTCOMMANDPACKET_H
-
@@ -0,0 +1,121 @@
+/*************************************************************************
+	CommandDescriptor  -  Compile-time description of a client command
+						  (device, command, payload layout) generating its
+						  serializer
+                             -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+#ifndef COMMANDDESCRIPTOR_HPP
+#define COMMANDDESCRIPTOR_HPP
+
+//-------------------------------------------------------- System includes
+#include <cstdint>
+#include <cstddef>
+
+//--------------------------------------------------------- Local includes
+#include "ClientCommandPacket.hpp"
+
+//------------------------------------------------------------ Field types
+
+/*
+ * A payload field : an unsigned integer sent most significant byte first,
+ * as every multi-byte Sphero field is
+ */
+template<typename T>
+struct BigEndian
+{
+	typedef T value_type;
+	static constexpr size_t size = sizeof(T);
+
+	/**
+	 * @brief write : Writes the field
+	 * @param out : Receives the size bytes
+	 * @param value : The field value
+	 * @return The sum of the written bytes, for the checksum
+	 */
+	static uint8_t write(uint8_t* out, T value);
+};
+
+typedef BigEndian<uint8_t> u8;
+typedef BigEndian<uint16_t> be16;
+typedef BigEndian<uint32_t> be32;
+
+/*
+ * Serializes a list of fields, one argument per field
+ */
+template<typename... Fields>
+struct FieldList;
+
+template<>
+struct FieldList<>
+{
+	static constexpr size_t size = 0;
+
+	static uint8_t write(uint8_t*)
+	{
+		return 0;
+	}
+};
+
+template<typename Field, typename... Rest>
+struct FieldList<Field, Rest...>
+{
+	static constexpr size_t size = Field::size + FieldList<Rest...>::size;
+
+	/**
+	 * @brief write : Writes every field
+	 * @param out : Receives the size bytes
+	 * @return The sum of the written bytes, for the checksum
+	 */
+	static uint8_t write(uint8_t* out, typename Field::value_type value,
+			typename Rest::value_type... rest);
+};
+
+//------------------------------------------------------- Class definition
+/*
+ * Did, Cid : The command device and command identifiers
+ * Fields : The payload fields, in order
+ *
+ * Everything but SEQ and the payload is known at compile time, including
+ * the part of the checksum covering DID, CID and DLEN.
+ */
+template<uint8_t Did, uint8_t Cid, typename... Fields>
+struct CommandDescriptor
+{
+	static constexpr uint8_t did = Did;
+	static constexpr uint8_t cid = Cid;
+
+		/* Payload length */
+	static constexpr size_t payloadSize = FieldList<Fields...>::size;
+
+		/* DLEN field : payload and checksum */
+	static constexpr uint8_t dlen = payloadSize + 1;
+
+		/* Whole packet size */
+	static constexpr size_t size = 6 + payloadSize + 1;
+
+		/* Checksum of the constant header bytes */
+	static constexpr uint8_t headerSum = (uint8_t) (Did + Cid + dlen);
+
+	static_assert(payloadSize + 1 <= 0xFF,
+			"The payload does not fit in the DLEN field");
+	static_assert(size <= CLIENT_PACKET_MAX_SIZE,
+			"The packet does not fit in a client packet buffer");
+
+	/**
+	 * @brief serialize : Writes the whole packet, checksum included
+	 * @param buffer : Receives the size bytes of the packet
+	 * @param seq : Sequence number
+	 * @param acknowledge : if true, client send reply after acting
+	 * @param rstTO : if true, reset client inactivity timeout
+	 * @param values : One value per payload field
+	 * @return The packet size
+	 */
+	static size_t serialize(uint8_t* buffer, uint8_t seq, bool acknowledge,
+			bool rstTO, typename Fields::value_type... values);
+};
+
+#include "CommandDescriptor.tpp"
+
+#endif // COMMANDDESCRIPTOR_HPP
@@ -0,0 +1,98 @@
+/*************************************************************************
+	CommandDescriptor  -  Compile-time description of a client command
+						  (device, command, payload layout) generating its
+						  serializer
+                             -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+//------------------------------------------------------ Static attributes
+
+template<typename T>
+constexpr size_t BigEndian<T>::size;
+
+template<typename Field, typename... Rest>
+constexpr size_t FieldList<Field, Rest...>::size;
+
+template<uint8_t Did, uint8_t Cid, typename... Fields>
+constexpr uint8_t CommandDescriptor<Did, Cid, Fields...>::did;
+
+template<uint8_t Did, uint8_t Cid, typename... Fields>
+constexpr uint8_t CommandDescriptor<Did, Cid, Fields...>::cid;
+
+template<uint8_t Did, uint8_t Cid, typename... Fields>
+constexpr size_t CommandDescriptor<Did, Cid, Fields...>::payloadSize;
+
+template<uint8_t Did, uint8_t Cid, typename... Fields>
+constexpr uint8_t CommandDescriptor<Did, Cid, Fields...>::dlen;
+
+template<uint8_t Did, uint8_t Cid, typename... Fields>
+constexpr size_t CommandDescriptor<Did, Cid, Fields...>::size;
+
+template<uint8_t Did, uint8_t Cid, typename... Fields>
+constexpr uint8_t CommandDescriptor<Did, Cid, Fields...>::headerSum;
+
+//--------------------------------------------------------- Public methods
+
+/**
+ * @brief write : Writes the field
+ * @param out : Receives the size bytes
+ * @param value : The field value
+ * @return The sum of the written bytes, for the checksum
+ */
+template<typename T>
+uint8_t BigEndian<T>::write(uint8_t* out, T value)
+{
+	uint8_t sum = 0;
+
+		//Unrolled by the compiler, size being a constant
+	for(size_t i = 0 ; i < size ; ++i)
+	{
+		out[i] = (uint8_t) (value >> (8 * (size - 1 - i)));
+		sum += out[i];
+	}
+
+	return sum;
+}
+
+
+/**
+ * @brief write : Writes every field
+ * @param out : Receives the size bytes
+ * @return The sum of the written bytes, for the checksum
+ */
+template<typename Field, typename... Rest>
+uint8_t FieldList<Field, Rest...>::write(uint8_t* out,
+		typename Field::value_type value, typename Rest::value_type... rest)
+{
+	uint8_t sum = Field::write(out, value);
+	return sum + FieldList<Rest...>::write(out + Field::size, rest...);
+}
+
+
+/**
+ * @brief serialize : Writes the whole packet, checksum included
+ * @param buffer : Receives the size bytes of the packet
+ * @param seq : Sequence number
+ * @param acknowledge : if true, client send reply after acting
+ * @param rstTO : if true, reset client inactivity timeout
+ * @param values : One value per payload field
+ * @return The packet size
+ */
+template<uint8_t Did, uint8_t Cid, typename... Fields>
+size_t CommandDescriptor<Did, Cid, Fields...>::serialize(uint8_t* buffer,
+		uint8_t seq, bool acknowledge, bool rstTO,
+		typename Fields::value_type... values)
+{
+	buffer[0] = INIT_SOP1;
+	buffer[1] = INIT_SOP2 | (acknowledge ? ANS_FLAG : 0) | (rstTO ? RST_FLAG : 0);
+	buffer[2] = Did;
+	buffer[3] = Cid;
+	buffer[4] = seq;
+	buffer[5] = dlen;
+
+	uint8_t sum = headerSum + seq + FieldList<Fields...>::write(buffer + 6, values...);
+	buffer[size - 1] = ~sum;
+
+	return size;
+}
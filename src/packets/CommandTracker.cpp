@@ -0,0 +1,382 @@
+/*************************************************************************
+	CommandTracker  -  Completion table of the acknowledged commands
+					   waiting for their answer
+                             -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+//-------------------------------------------------------- System includes
+#include <utility>
+
+//--------------------------------------------------------- Local includes
+#include "CommandTracker.hpp"
+#include "Toolbox.hpp"
+#include "../TimerWheel.hpp"
+
+//---------------------------------------------------------------- Statics
+	//Set by setReceptionThread
+static thread_local bool receptionThread = false;
+
+	//Set by runExpired while it calls the completions
+static thread_local bool expiringThread = false;
+
+//------------------------------------------------ Constructors/Destructor
+
+/**
+ * @brief CommandTracker : Constructor
+ * @param stats : Receives the round-trip times, timeouts and late answers,
+ * 				  NULL for none
+ */
+CommandTracker::CommandTracker(LinkStats* stats):_stats(stats), _nextSeq(0),
+	_generation(0), _nbPending(0)
+{
+	for(size_t i = 0 ; i < PENDING_COMMAND_SLOTS ; ++i)
+	{
+		_slots[i].pending = false;
+		_slots[i].seq = 0;
+		_slots[i].did = 0;
+		_slots[i].cid = 0;
+		_slots[i].generation = 0;
+		_slots[i].sentAt = 0;
+	}
+
+	_expired.reserve(PENDING_COMMAND_SLOTS);
+
+	pthread_mutex_init(&_lock, NULL);
+	pthread_cond_init(&_slotFreed, NULL);
+}
+
+
+CommandTracker::~CommandTracker()
+{
+	TimerWheel::shared().cancel(this);
+	runExpired(this, 0);
+	cancelAll();
+	pthread_cond_destroy(&_slotFreed);
+	pthread_mutex_destroy(&_lock);
+}
+
+
+//--------------------------------------------------------- Public methods
+
+/**
+ * @brief acquire : Registers a new command waiting for its answer. Blocks
+ * 					while the window is full, that is until an outstanding
+ * 					command is answered or times out, except on a reception
+ * 					thread
+ * @param completion : Called exactly once, with the answer or the reason
+ * 					   why there will be none : by the reception thread for
+ * 					   an answer, by the deferred thread of the timer wheel
+ * 					   for a timeout or a rejection, by cancelAll's caller for a
+ * 					   cancellation
+ * @param timeoutMs : Delay after which the command is completed as TIMEOUT
+ * @param seq : Receives the sequence number to send the command with
+ * @param did : The command device ID, for the statistics
+ * @param cid : The command ID, for the statistics
+ * @return false if the command must not be sent : the window is full on a
+ * 		   reception thread, the completion being deferred as REJECTED
+ */
+bool CommandTracker::acquire(commandCompletion_t completion, unsigned int timeoutMs,
+		uint8_t& seq, uint8_t did, uint8_t cid)
+{
+	pthread_mutex_lock(&_lock);
+
+	if(_nbPending == PENDING_COMMAND_SLOTS && receptionThread)
+	{
+			//Deferred : a completion sending again would recurse here
+		expired e;
+		e.status = commandStatus::REJECTED;
+		e.seq = 0;
+		e.rttUs = 0;
+		e.completion.swap(completion);
+
+		bool first = _expired.empty();
+		_expired.push_back(std::move(e));
+
+		pthread_mutex_unlock(&_lock);
+
+		if(first)
+		{
+			TimerWheel::shared().defer(runExpired, this, 0);
+		}
+		return false;
+	}
+
+	while(_nbPending == PENDING_COMMAND_SLOTS)
+	{
+		pthread_cond_wait(&_slotFreed, &_lock);
+	}
+
+		//Answers may come out of order : skipping the sequence numbers
+		//whose slot is still in use
+	seq = _nextSeq;
+	while(_slots[seq % PENDING_COMMAND_SLOTS].pending)
+	{
+		++seq;
+	}
+	_nextSeq = seq + 1;
+
+	slot& s = _slots[seq % PENDING_COMMAND_SLOTS];
+	s.pending = true;
+	s.seq = seq;
+	s.did = did;
+	s.cid = cid;
+	s.generation = ++_generation & 0xFFFFFF;
+	s.sentAt = packet_toolbox::monotonicUs();
+	s.completion.swap(completion);
+	++_nbPending;
+
+	uint32_t cookie = (s.generation << 8) | seq;
+
+	pthread_mutex_unlock(&_lock);
+
+	TimerWheel::shared().schedule(timeoutMs, onTimeout, this, cookie);
+
+	return true;
+}
+
+
+/**
+ * @brief complete : Completes the command waiting with the given sequence
+ * 					 number (ignored if there is none)
+ * @param seq : The answer sequence number
+ * @param mrsp : The message response code
+ * @param dlen : The answer DLEN field
+ * @param data : The answer payload (NULL if empty)
+ */
+void CommandTracker::complete(uint8_t seq, uint8_t mrsp, uint8_t dlen,
+		const uint8_t* data)
+{
+	commandCompletion_t completion;
+
+	pthread_mutex_lock(&_lock);
+
+	uint32_t rttUs = 0;
+	uint8_t did = 0;
+	uint8_t cid = 0;
+	slot& s = _slots[seq % PENDING_COMMAND_SLOTS];
+	if(s.pending && s.seq == seq)
+	{
+		rttUs = release(s, completion);
+		did = s.did;
+		cid = s.cid;
+	}
+
+	pthread_mutex_unlock(&_lock);
+
+	if(completion)
+	{
+		if(_stats != NULL)
+		{
+			_stats->recordRoundTrip(did, cid, rttUs);
+		}
+		finish(completion, commandStatus::ANSWERED, seq, rttUs, mrsp, dlen, data);
+	}
+	else if(_stats != NULL)
+	{
+		_stats->addLateAnswer();
+	}
+}
+
+
+/**
+ * @brief cancelAll : Completes every pending command as CANCELLED
+ */
+void CommandTracker::cancelAll()
+{
+	for(size_t i = 0 ; i < PENDING_COMMAND_SLOTS ; ++i)
+	{
+		commandCompletion_t completion;
+
+		uint32_t rttUs = 0;
+
+		pthread_mutex_lock(&_lock);
+		uint8_t seq = _slots[i].seq;
+		if(_slots[i].pending)
+		{
+			rttUs = release(_slots[i], completion);
+		}
+		pthread_mutex_unlock(&_lock);
+
+		if(completion)
+		{
+			finish(completion, commandStatus::CANCELLED, seq, rttUs);
+		}
+	}
+}
+
+
+/**
+ * @return The number of commands currently waiting for an answer
+ */
+size_t CommandTracker::getNbPending()
+{
+	pthread_mutex_lock(&_lock);
+	size_t nbPending = _nbPending;
+	pthread_mutex_unlock(&_lock);
+
+	return nbPending;
+}
+
+
+/**
+ * @brief setReceptionThread : Marks the calling thread as one dispatching
+ * 							   answers, on which acquire never waits for a
+ * 							   slot : the answer freeing it would never be
+ * 							   read
+ * @param receiving : true on a reception thread
+ */
+void CommandTracker::setReceptionThread(bool receiving)
+{
+	receptionThread = receiving;
+}
+
+
+/**
+ * @return true if the calling thread was marked by setReceptionThread
+ */
+bool CommandTracker::isReceptionThread()
+{
+	return receptionThread;
+}
+
+
+/**
+ * @return false on the threads an answer or a timeout has to come through :
+ * 		   a reception thread, or the deferred thread of the timer wheel while
+ * 		   it runs timeout and rejection completions. Waiting there for a
+ * 		   completion would wait forever
+ */
+bool CommandTracker::mayWaitForAnswer()
+{
+	return !receptionThread && !expiringThread;
+}
+
+
+//-------------------------------------------------------- Private methods
+
+/**
+ * @brief onTimeout : Timer wheel callback
+ * @param tracker_ptr : The tracker
+ * @param cookie : generation << 8 | sequence number
+ */
+void CommandTracker::onTimeout(void* tracker_ptr, uint32_t cookie)
+{
+	CommandTracker* tracker = (CommandTracker*) tracker_ptr;
+	uint8_t seq = cookie & 0xFF;
+	bool timedOut = false;
+	bool first = false;
+	uint8_t did = 0;
+	uint8_t cid = 0;
+
+	pthread_mutex_lock(&tracker->_lock);
+
+		//The generation tells apart the command from a later one on the slot
+	slot& s = tracker->_slots[seq % PENDING_COMMAND_SLOTS];
+	if(s.pending && s.seq == seq && s.generation == (cookie >> 8))
+	{
+		expired e;
+		e.status = commandStatus::TIMEOUT;
+		e.seq = seq;
+		e.rttUs = tracker->release(s, e.completion);
+		did = s.did;
+		cid = s.cid;
+
+		first = tracker->_expired.empty();
+		tracker->_expired.push_back(std::move(e));
+		timedOut = true;
+	}
+
+	pthread_mutex_unlock(&tracker->_lock);
+
+	if(timedOut && tracker->_stats != NULL)
+	{
+		tracker->_stats->recordTimeout(did, cid);
+	}
+
+		//A single deferral for the commands expiring before it runs
+	if(first)
+	{
+		TimerWheel::shared().defer(runExpired, tracker, 0);
+	}
+}
+
+
+/**
+ * @brief runExpired : Completes the timed out and rejected commands, on
+ * 					   the deferred thread of the timer wheel
+ * @param tracker_ptr : The tracker
+ */
+void CommandTracker::runExpired(void* tracker_ptr, uint32_t)
+{
+	CommandTracker* tracker = (CommandTracker*) tracker_ptr;
+
+		//Also called by the destructor, on any thread
+	bool expiring = expiringThread;
+	expiringThread = true;
+
+	for(;;)
+	{
+		commandCompletion_t completion;
+		commandStatus status;
+		uint8_t seq;
+		uint32_t rttUs;
+
+		pthread_mutex_lock(&tracker->_lock);
+		bool empty = tracker->_expired.empty();
+		if(!empty)
+		{
+			expired& e = tracker->_expired.front();
+			completion.swap(e.completion);
+			status = e.status;
+			seq = e.seq;
+			rttUs = e.rttUs;
+			tracker->_expired.erase(tracker->_expired.begin());
+		}
+		pthread_mutex_unlock(&tracker->_lock);
+
+		if(empty)
+		{
+			break;
+		}
+		finish(completion, status, seq, rttUs);
+	}
+
+	expiringThread = expiring;
+}
+
+
+/**
+ * @brief release : Frees a slot and wakes up the threads waiting for one.
+ * 				  The lock must be held
+ * @param s : The slot, which completion is moved to the argument
+ * @param completion : Receives the completion
+ * @return The time elapsed since the command was sent, in µs
+ */
+uint32_t CommandTracker::release(slot& s, commandCompletion_t& completion)
+{
+	s.pending = false;
+	completion.swap(s.completion);
+	--_nbPending;
+	pthread_cond_signal(&_slotFreed);
+
+	return packet_toolbox::monotonicUs() - s.sentAt;
+}
+
+
+/**
+ * @brief finish : Completes a command whose slot was already freed
+ */
+void CommandTracker::finish(commandCompletion_t& completion, commandStatus status,
+		uint8_t seq, uint32_t rttUs, uint8_t mrsp, uint8_t dlen, const uint8_t* data)
+{
+	CommandAnswer answer;
+	answer.status = status;
+	answer.seq = seq;
+	answer.mrsp = mrsp;
+	answer.dlen = dlen;
+	answer.data = data;
+	answer.rttUs = rttUs;
+
+	completion(answer);
+}
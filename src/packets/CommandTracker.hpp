@@ -0,0 +1,233 @@
+/*************************************************************************
+	CommandTracker  -  Completion table of the acknowledged commands
+					   waiting for their answer
+                             -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+#ifndef COMMANDTRACKER_HPP
+#define COMMANDTRACKER_HPP
+
+//-------------------------------------------------------- System includes
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include <pthread.h>
+
+//--------------------------------------------------------- Local includes
+#include "LinkStats.hpp"
+
+//-------------------------------------------------------------- Constants
+
+	/* Window : number of commands which can wait for an answer at the same
+	 * time. Must divide 256 so that a sequence number always maps the same
+	 * slot */
+static size_t const PENDING_COMMAND_SLOTS = 8;
+
+//------------------------------------------------------------------ Types
+enum class commandStatus
+{
+		/* The Sphero answered, mrsp and data are meaningful */
+	ANSWERED,
+		/* No answer was received in time */
+	TIMEOUT,
+		/* The connection was closed */
+	CANCELLED,
+		/* Not sent : the window was full on a reception thread, which
+		 * cannot wait for the answer freeing a slot */
+	REJECTED
+};
+
+struct CommandAnswer
+{
+	commandStatus status;
+	uint8_t seq;
+	uint8_t mrsp;
+
+		/* DLEN field of the answer (payload length + 1) */
+	uint8_t dlen;
+
+		/* Answer payload, NULL if empty. Only valid during the completion */
+	const uint8_t* data;
+
+		/* Time elapsed between the sending and the completion, in µs */
+	uint32_t rttUs;
+};
+
+	/* Called once per command, on the thread which learns its fate :
+	 * - ANSWERED : the reception thread (monitor thread or reactor loop),
+	 *   or the thread replaying a capture
+	 * - TIMEOUT, REJECTED : the deferred thread of the shared TimerWheel
+	 * - CANCELLED : the thread calling cancelAll, that is Sphero::disconnect
+	 *   or the Sphero destructor
+	 * None of them may block : the reception thread reads the answers, and
+	 * the deferred thread completes the timeouts of every Sphero. Waiting
+	 * there for another answer would never end (see mayWaitForAnswer) */
+typedef std::function<void(const CommandAnswer&)> commandCompletion_t;
+
+//------------------------------------------------------- Class definition
+class CommandTracker
+{
+	public:
+		//--------------------------------------------- Operators overload
+			//No sense
+		CommandTracker& operator=(const CommandTracker&) = delete;
+
+		//---------------------------------------- Constructors/Destructor
+			//No sense
+		CommandTracker(const CommandTracker&) = delete;
+
+		/**
+		 * @brief CommandTracker : Constructor
+		 * @param stats : Receives the round-trip times, timeouts and late
+		 * 				  answers, NULL for none
+		 */
+		CommandTracker(LinkStats* stats = NULL);
+
+		/**
+		 * Pending commands are completed as CANCELLED
+		 */
+		virtual ~CommandTracker();
+
+		//------------------------------------------------- Public methods
+
+		/**
+		 * @brief acquire : Registers a new command waiting for its answer.
+		 * 					Blocks while the window is full, that is until an
+		 * 					outstanding command is answered or times out,
+		 * 					except on a reception thread
+		 * @param completion : Called exactly once, with the answer or the
+		 * 					   reason why there will be none : by the
+		 * 					   reception thread for an answer, by the
+		 * 					   deferred thread of the timer wheel for a
+		 * 					   timeout or a rejection, by cancelAll's
+		 * 					   caller for a cancellation
+		 * @param timeoutMs : Delay after which the command is completed as
+		 * 					  TIMEOUT
+		 * @param seq : Receives the sequence number to send the command with
+		 * @param did : The command device ID, for the statistics
+		 * @param cid : The command ID, for the statistics
+		 * @return false if the command must not be sent : the window is full
+		 * 		   on a reception thread, the completion being deferred as
+		 * 		   REJECTED
+		 */
+		bool acquire(commandCompletion_t completion, unsigned int timeoutMs,
+				uint8_t& seq, uint8_t did = 0, uint8_t cid = 0);
+
+		/**
+		 * @brief complete : Completes the command waiting with the given
+		 * 					 sequence number (ignored if there is none)
+		 * @param seq : The answer sequence number
+		 * @param mrsp : The message response code
+		 * @param dlen : The answer DLEN field
+		 * @param data : The answer payload (NULL if empty)
+		 */
+		void complete(uint8_t seq, uint8_t mrsp, uint8_t dlen, const uint8_t* data);
+
+		/**
+		 * @brief cancelAll : Completes every pending command as CANCELLED
+		 */
+		void cancelAll();
+
+		/**
+		 * @return The number of commands currently waiting for an answer
+		 */
+		size_t getNbPending();
+
+		/**
+		 * @brief setReceptionThread : Marks the calling thread as one
+		 * 							   dispatching answers, on which acquire
+		 * 							   never waits for a slot : the answer
+		 * 							   freeing it would never be read
+		 * @param receiving : true on a reception thread
+		 */
+		static void setReceptionThread(bool receiving);
+
+		/**
+		 * @return true if the calling thread was marked by
+		 * 		   setReceptionThread
+		 */
+		static bool isReceptionThread();
+
+		/**
+		 * @return false on the threads an answer or a timeout has to come
+		 * 		   through : a reception thread, or the deferred thread of the
+		 * 		   timer wheel while it runs timeout and rejection completions.
+		 * 		   Waiting there for a completion would wait forever
+		 */
+		static bool mayWaitForAnswer();
+
+	private:
+		//-------------------------------------------------- Private types
+		struct slot
+		{
+			bool pending;
+			uint8_t seq;
+			uint8_t did;
+			uint8_t cid;
+			uint32_t generation;
+			uint64_t sentAt;
+			commandCompletion_t completion;
+		};
+
+			/* A command timed out or rejected, whose completion is still
+			 * to call */
+		struct expired
+		{
+			commandStatus status;
+			uint8_t seq;
+			uint32_t rttUs;
+			commandCompletion_t completion;
+		};
+
+		//------------------------------------------------ Private methods
+
+		/**
+		 * @brief onTimeout : Timer wheel callback. Frees the slot, the
+		 * 					  completion being deferred (runExpired) : the
+		 * 					  wheel thread never runs user code, which could
+		 * 					  wait for a slot only the wheel frees
+		 * @param tracker_ptr : The tracker
+		 * @param cookie : generation << 8 | sequence number
+		 */
+		static void onTimeout(void* tracker_ptr, uint32_t cookie);
+
+		/**
+		 * @brief runExpired : Completes the timed out and rejected commands,
+		 * 					   on the deferred thread of the timer wheel
+		 * @param tracker_ptr : The tracker
+		 */
+		static void runExpired(void* tracker_ptr, uint32_t);
+
+		/**
+		 * @brief release : Frees a slot and wakes up the threads waiting for
+		 * 				  one. The lock must be held
+		 * @param s : The slot, which completion is moved to the argument
+		 * @param completion : Receives the completion
+		 * @return The time elapsed since the command was sent, in µs
+		 */
+		uint32_t release(slot& s, commandCompletion_t& completion);
+
+		/**
+		 * @brief finish : Completes a command whose slot was already freed
+		 */
+		static void finish(commandCompletion_t& completion, commandStatus status,
+				uint8_t seq, uint32_t rttUs, uint8_t mrsp = 0xFF,
+				uint8_t dlen = 0, const uint8_t* data = NULL);
+
+		//--------------------------------------------- Private attributes
+		slot _slots[PENDING_COMMAND_SLOTS];
+		LinkStats* _stats;
+		uint8_t _nextSeq;
+		uint32_t _generation;
+		size_t _nbPending;
+
+			/* Timed out or rejected, waiting for runExpired, oldest first */
+		std::vector<expired> _expired;
+
+		pthread_mutex_t _lock;
+		pthread_cond_t _slotFreed;
+};
+
+#endif // COMMANDTRACKER_HPP
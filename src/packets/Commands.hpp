@@ -0,0 +1,120 @@
+/*************************************************************************
+	Commands  -  Descriptors of the client commands with a fixed payload
+							 -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+#ifndef COMMANDS_HPP
+#define COMMANDS_HPP
+
+//-------------------------------------------------------- System includes
+#include <cstdint>
+
+//--------------------------------------------------------- Local includes
+#include "Constants.hpp"
+#include "CommandDescriptor.hpp"
+
+//------------------------------------------------------------------ Types
+namespace command
+{
+	//begin core commands
+	typedef CommandDescriptor<DID::core, CID::ping> ping;
+	typedef CommandDescriptor<DID::core, CID::getVersioning> getVersioning;
+
+	typedef CommandDescriptor<DID::core, CID::getBluetoothInfo> getBluetoothInfo;
+		//flag, seconds
+	typedef CommandDescriptor<DID::core, CID::setAutoReconnect, u8, u8> setAutoReconnect;
+	typedef CommandDescriptor<DID::core, CID::getAutoReconnect> getAutoReconnect;
+
+	typedef CommandDescriptor<DID::core, CID::getPowerState> getPowerState;
+		//enable
+	typedef CommandDescriptor<DID::core, CID::setPowerNotification, u8> setPowerNotification;
+		//wakeup, macro, orbBasic line
+	typedef CommandDescriptor<DID::core, CID::sleep, be16, u8, be16> sleep;
+	typedef CommandDescriptor<DID::core, CID::getVoltageTripPoint> getVoltageTripPoint;
+		//Vlow, Vcrit
+	typedef CommandDescriptor<DID::core, CID::setVoltageTripPoint, be16, be16> setVoltageTripPoint;
+		//seconds
+	typedef CommandDescriptor<DID::core, CID::setInactivityTimeout, be16> setInactivityTimeout;
+
+	typedef CommandDescriptor<DID::core, CID::performLevel1Diagnostic> performLevel1Diagnostic;
+	typedef CommandDescriptor<DID::core, CID::performLevel2Diagnostic> performLevel2Diagnostic;
+	typedef CommandDescriptor<DID::core, CID::clearCounters> clearCounters;
+
+		//time
+	typedef CommandDescriptor<DID::core, CID::assignTimeValue, be32> assignTimeValue;
+		//client transmit time
+	typedef CommandDescriptor<DID::core, CID::pollPacketTimes, be32> pollPacketTimes;
+	//end of core commands
+
+
+	//begin sphero commands
+		//heading
+	typedef CommandDescriptor<DID::sphero, CID::setHeading, be16> setHeading;
+		//on
+	typedef CommandDescriptor<DID::sphero, CID::setStabilization, u8> setStabilization;
+		//rate
+	typedef CommandDescriptor<DID::sphero, CID::setRotationRate, u8> setRotationRate;
+	typedef CommandDescriptor<DID::sphero, CID::getChassisID> getChassisID;
+		//options, angle limit, timeout, true time
+	typedef CommandDescriptor<DID::sphero, CID::selfLevel, u8, u8, u8, u8> selfLevel;
+
+		//N, M, mask, packet count
+	typedef CommandDescriptor<DID::sphero, CID::setDataStreaming,
+			be16, be16, be32, u8> setDataStreaming;
+		//N, M, mask, packet count, mask2
+	typedef CommandDescriptor<DID::sphero, CID::setDataStreaming,
+			be16, be16, be32, u8, be32> setDataStreamingMask2;
+		//method, Xt, Xspd, Yt, Yspd, dead time
+	typedef CommandDescriptor<DID::sphero, CID::configureCollisionDetection,
+			u8, u8, u8, u8, u8, u8> configureCollisionDetection;
+		//flags, X, Y, yaw tare
+	typedef CommandDescriptor<DID::sphero, CID::configureLocator,
+			u8, be16, be16, be16> configureLocator;
+		//range
+	typedef CommandDescriptor<DID::sphero, CID::setAccelerometerRange, u8> setAccelerometerRange;
+	typedef CommandDescriptor<DID::sphero, CID::readLocator> readLocator;
+
+		//red, green, blue, persist
+	typedef CommandDescriptor<DID::sphero, CID::setRGBLEDOutput, u8, u8, u8, u8> setRGBLEDOutput;
+		//power
+	typedef CommandDescriptor<DID::sphero, CID::setBackLEDOutput, u8> setBackLEDOutput;
+	typedef CommandDescriptor<DID::sphero, CID::getRGBLED> getRGBLED;
+
+		//speed, heading, state
+	typedef CommandDescriptor<DID::sphero, CID::roll, u8, be16, u8> roll;
+		//left mode, left power, right mode, right power
+	typedef CommandDescriptor<DID::sphero, CID::setRawMotorValues,
+			u8, u8, u8, u8> setRawMotorValues;
+		//milliseconds
+	typedef CommandDescriptor<DID::sphero, CID::setMotionTimeout, be16> setMotionTimeout;
+		//flags
+	typedef CommandDescriptor<DID::sphero, CID::setPermanentOptionFlags, be32> setPermanentOptionFlags;
+	typedef CommandDescriptor<DID::sphero, CID::getPermanentOptionFlags> getPermanentOptionFlags;
+		//flags
+	typedef CommandDescriptor<DID::sphero, CID::setTemporaryOptionFlags, be32> setTemporaryOptionFlags;
+	typedef CommandDescriptor<DID::sphero, CID::getTemporaryOptionFlags> getTemporaryOptionFlags;
+
+		//mode
+	typedef CommandDescriptor<DID::sphero, CID::setDeviceMode, u8> setDeviceMode;
+	typedef CommandDescriptor<DID::sphero, CID::getDeviceMode> getDeviceMode;
+
+		//macro id
+	typedef CommandDescriptor<DID::sphero, CID::runMacro, u8> runMacro;
+	typedef CommandDescriptor<DID::sphero, CID::reinitMacroExecutive> reinitMacroExecutive;
+	typedef CommandDescriptor<DID::sphero, CID::abortMacro> abortMacro;
+	typedef CommandDescriptor<DID::sphero, CID::getMacroStatus> getMacroStatus;
+
+		//area
+	typedef CommandDescriptor<DID::sphero, CID::eraseOrbBasicStorage, u8> eraseOrbBasicStorage;
+		//area, start line
+	typedef CommandDescriptor<DID::sphero, CID::executeOrbBasicProgram,
+			u8, be16> executeOrbBasicProgram;
+	typedef CommandDescriptor<DID::sphero, CID::abortOrbBasicProgram> abortOrbBasicProgram;
+		//value
+	typedef CommandDescriptor<DID::sphero, CID::submitValueToInputStatement,
+			be32> submitValueToInputStatement;
+	//end sphero commands
+}
+
+#endif // COMMANDS_HPP
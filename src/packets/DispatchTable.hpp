@@ -0,0 +1,66 @@
+/*************************************************************************
+	DispatchTable  -  256-entry tables indexed by a frame byte, filled at
+					  compile time
+							 -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+#ifndef DISPATCHTABLE_HPP
+#define DISPATCHTABLE_HPP
+
+//-------------------------------------------------------- System includes
+#include <cstdint>
+#include <cstddef>
+
+//------------------------------------------------------------------ Types
+
+/*
+ * One entry per value of a byte : routing a frame is a single indexed load
+ */
+template<typename T>
+struct dispatchTable
+{
+	T entries[256];
+
+	constexpr T operator[](uint8_t key) const
+	{
+		return entries[key];
+	}
+};
+
+namespace dispatch_table
+{
+		/* C++11 stand-in for std::index_sequence */
+	template<size_t... I>
+	struct indices
+	{};
+
+	template<size_t N, size_t... I>
+	struct makeIndices : makeIndices<N - 1, N - 1, I...>
+	{};
+
+	template<size_t... I>
+	struct makeIndices<0, I...>
+	{
+		typedef indices<I...> type;
+	};
+
+	template<typename T, T (*Entry)(uint8_t), size_t... I>
+	constexpr dispatchTable<T> expand(indices<I...>)
+	{
+		return dispatchTable<T>{{Entry((uint8_t) I)...}};
+	}
+
+	/**
+	 * @brief build : Fills a table at compile time
+	 * @param Entry : A constexpr function giving the entry of a key
+	 * @return The table, usable as a constant initializer
+	 */
+	template<typename T, T (*Entry)(uint8_t)>
+	constexpr dispatchTable<T> build()
+	{
+		return expand<T, Entry>(typename makeIndices<256>::type());
+	}
+}
+
+#endif // DISPATCHTABLE_HPP
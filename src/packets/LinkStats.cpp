@@ -0,0 +1,288 @@
+/*************************************************************************
+	LinkStats  -  Always-on counters of the link with the Sphero and
+				  round-trip latency histograms of acknowledged commands
+							 -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+//--------------------------------------------------------- Local includes
+#include "LinkStats.hpp"
+
+//------------------------------------------------------- LatencyHistogram
+
+LatencyHistogram::LatencyHistogram():timeouts(0), _totalUs(0), _maxUs(0)
+{
+	for(size_t i = 0 ; i < NB_BUCKETS ; ++i)
+	{
+		_buckets[i] = 0;
+	}
+}
+
+
+/**
+ * @brief record : Counts a value, from any thread
+ * @param us : The value, in µs
+ */
+void LatencyHistogram::record(uint32_t us)
+{
+	_buckets[bucketOf(us)].fetch_add(1, std::memory_order_relaxed);
+	_totalUs.fetch_add(us, std::memory_order_relaxed);
+
+	uint32_t max = _maxUs.load(std::memory_order_relaxed);
+	while(us > max && !_maxUs.compare_exchange_weak(max, us,
+				std::memory_order_relaxed))
+	{ }
+}
+
+
+/**
+ * @brief summarize : Fills the counters and percentiles of a summary
+ * @param summary : Receives count, totalUs, percentiles and maxUs
+ */
+void LatencyHistogram::summarize(CommandLatency& summary) const
+{
+	uint32_t counts[NB_BUCKETS];
+	uint64_t count = 0;
+
+	for(size_t i = 0 ; i < NB_BUCKETS ; ++i)
+	{
+		counts[i] = _buckets[i].load(std::memory_order_relaxed);
+		count += counts[i];
+	}
+
+	summary.count = count;
+	summary.timeouts = timeouts.load(std::memory_order_relaxed);
+	summary.totalUs = _totalUs.load(std::memory_order_relaxed);
+	summary.maxUs = _maxUs.load(std::memory_order_relaxed);
+
+	double const ranks[] = {0.5, 0.9, 0.99};
+	uint32_t* const results[] = {&summary.p50Us, &summary.p90Us, &summary.p99Us};
+
+	for(size_t r = 0 ; r < 3 ; ++r)
+	{
+		uint64_t target = (uint64_t) (ranks[r] * count + 0.999999);
+		uint64_t seen = 0;
+		*results[r] = 0;
+
+		for(size_t i = 0 ; i < NB_BUCKETS && count != 0 ; ++i)
+		{
+			seen += counts[i];
+			if(seen >= target)
+			{
+				uint32_t bound = upperBound(i);
+				*results[r] = bound < summary.maxUs ? bound : summary.maxUs;
+				break;
+			}
+		}
+	}
+}
+
+
+/**
+ * @return The bucket counting a value
+ */
+size_t LatencyHistogram::bucketOf(uint32_t us)
+{
+	if(us < 8)
+	{
+		return us;
+	}
+
+		//Exponent, then the 3 bits following the leading one
+	unsigned int exponent = 31 - __builtin_clz(us);
+	return (exponent - 2) * 8 + ((us >> (exponent - 3)) & 7);
+}
+
+
+/**
+ * @return The highest value counted by a bucket
+ */
+uint32_t LatencyHistogram::upperBound(size_t bucket)
+{
+	if(bucket < 8)
+	{
+		return bucket;
+	}
+
+	unsigned int exponent = bucket / 8 + 2;
+	uint64_t lower = (uint64_t) (8 + bucket % 8) << (exponent - 3);
+	return (uint32_t) (lower + ((uint64_t) 1 << (exponent - 3)) - 1);
+}
+
+//------------------------------------------------ Constructors/Destructor
+
+LinkStats::LinkStats():_droppedFrames(0), _lateAnswers(0)
+{
+	for(size_t did = 0 ; did < LINK_STATS_NB_DID ; ++did)
+	{
+		for(size_t cid = 0 ; cid < 256 ; ++cid)
+		{
+			_histograms[did][cid] = NULL;
+		}
+	}
+}
+
+
+LinkStats::~LinkStats()
+{
+	for(size_t did = 0 ; did < LINK_STATS_NB_DID ; ++did)
+	{
+		for(size_t cid = 0 ; cid < 256 ; ++cid)
+		{
+			delete _histograms[did][cid].load();
+		}
+	}
+}
+
+//--------------------------------------------------------- Public methods
+
+/**
+ * @brief recordRoundTrip : Counts an answered command
+ * @param did : The command device ID
+ * @param cid : The command ID
+ * @param rttUs : Its round-trip time, in µs
+ */
+void LinkStats::recordRoundTrip(uint8_t did, uint8_t cid, uint32_t rttUs)
+{
+	LatencyHistogram* latencies = histogram(did, cid);
+	if(latencies != NULL)
+	{
+		latencies->record(rttUs);
+	}
+}
+
+
+/**
+ * @brief recordTimeout : Counts a command left without answer
+ * @param did : The command device ID
+ * @param cid : The command ID
+ */
+void LinkStats::recordTimeout(uint8_t did, uint8_t cid)
+{
+	LatencyHistogram* latencies = histogram(did, cid);
+	if(latencies != NULL)
+	{
+		latencies->timeouts.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+
+/**
+ * @brief addDroppedFrame : Counts a valid frame nobody could use
+ */
+void LinkStats::addDroppedFrame()
+{
+	_droppedFrames.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+/**
+ * @brief addLateAnswer : Counts an answer matching no pending command
+ */
+void LinkStats::addLateAnswer()
+{
+	_lateAnswers.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+/**
+ * @brief fill : Copies the counters and summarizes the histograms
+ * @param snapshot : Receives droppedFrames, lateAnswers and commands
+ */
+void LinkStats::fill(LinkSnapshot& snapshot) const
+{
+	snapshot.droppedFrames = _droppedFrames.load(std::memory_order_relaxed);
+	snapshot.lateAnswers = _lateAnswers.load(std::memory_order_relaxed);
+	snapshot.commands.clear();
+
+	for(size_t did = 0 ; did < LINK_STATS_NB_DID ; ++did)
+	{
+		for(size_t cid = 0 ; cid < 256 ; ++cid)
+		{
+			LatencyHistogram* latencies =
+				_histograms[did][cid].load(std::memory_order_acquire);
+			if(latencies == NULL)
+			{
+				continue;
+			}
+
+			CommandLatency summary;
+			summary.did = did;
+			summary.cid = cid;
+			latencies->summarize(summary);
+			snapshot.commands.push_back(summary);
+		}
+	}
+}
+
+/**
+ * @brief sameCounters : Compares two copies of the counters
+ * @return true if every counter, takenAtUs and consistent aside, has the
+ * 		   same value in both
+ */
+bool LinkStats::sameCounters(const LinkSnapshot& first,
+		const LinkSnapshot& second)
+{
+	if(first.bytesIn != second.bytesIn
+			|| first.framesIn != second.framesIn
+			|| first.checksumFailures != second.checksumFailures
+			|| first.resyncs != second.resyncs
+			|| first.bytesDiscarded != second.bytesDiscarded
+			|| first.droppedFrames != second.droppedFrames
+			|| first.lateAnswers != second.lateAnswers
+			|| first.bytesOut != second.bytesOut
+			|| first.framesOut != second.framesOut
+			|| first.droppedOut != second.droppedOut
+			|| first.coalescedOut != second.coalescedOut
+			|| first.commands.size() != second.commands.size())
+	{
+		return false;
+	}
+
+		//Buckets only grow : equal counts mean equal buckets, hence equal
+		//percentiles
+	for(size_t i = 0 ; i < first.commands.size() ; ++i)
+	{
+		const CommandLatency& a = first.commands[i];
+		const CommandLatency& b = second.commands[i];
+		if(a.did != b.did || a.cid != b.cid || a.count != b.count
+				|| a.timeouts != b.timeouts || a.totalUs != b.totalUs
+				|| a.maxUs != b.maxUs)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//-------------------------------------------------------- Private methods
+
+/**
+ * @return The histogram of a command, created on first use
+ */
+LatencyHistogram* LinkStats::histogram(uint8_t did, uint8_t cid)
+{
+	if(did >= LINK_STATS_NB_DID)
+	{
+		return NULL;
+	}
+
+	std::atomic<LatencyHistogram*>& entry = _histograms[did][cid];
+	LatencyHistogram* latencies = entry.load(std::memory_order_acquire);
+	if(latencies != NULL)
+	{
+		return latencies;
+	}
+
+		//Two threads may race for the first use : one of them wins
+	LatencyHistogram* created = new LatencyHistogram();
+	if(entry.compare_exchange_strong(latencies, created,
+				std::memory_order_acq_rel))
+	{
+		return created;
+	}
+
+	delete created;
+	return latencies;
+}
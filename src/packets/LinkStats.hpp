@@ -0,0 +1,199 @@
+/*************************************************************************
+	LinkStats  -  Always-on counters of the link with the Sphero and
+				  round-trip latency histograms of acknowledged commands
+							 -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+#ifndef LINKSTATS_HPP
+#define LINKSTATS_HPP
+
+//-------------------------------------------------------- System includes
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+//-------------------------------------------------------------- Constants
+	//Devices tracked by the histograms (core, bootloader, sphero)
+static size_t const LINK_STATS_NB_DID = 3;
+
+	//Reads of the counters by getLinkStats before it gives up on a
+	//consistent copy
+static unsigned const LINK_STATS_MAX_READS = 8;
+
+//------------------------------------------------------------------ Types
+
+/*
+ * Round trips of one command
+ */
+struct CommandLatency
+{
+	uint8_t did;
+	uint8_t cid;
+
+		/* Answered commands, and commands which timed out */
+	uint64_t count;
+	uint64_t timeouts;
+
+		/* Round-trip times, in µs. Percentiles are bucket upper bounds,
+		 * within 12.5 % of the exact value */
+	uint64_t totalUs;
+	uint32_t p50Us;
+	uint32_t p90Us;
+	uint32_t p99Us;
+	uint32_t maxUs;
+};
+
+/*
+ * Copy of every counter, taken by getLinkStats
+ */
+struct LinkSnapshot
+{
+		/* Monotonic time of the copy, in µs */
+	uint64_t takenAtUs;
+
+		/* false if the counters kept moving while they were read : each
+		 * one then has a value it had between the last two reads, and
+		 * takenAtUs is the time of the last one */
+	bool consistent;
+
+		/* Reception : bytes read, checksum-valid frames, candidate frames
+		 * failing their checksum, losses of synchronization and the bytes
+		 * skipped to recover, and valid frames nobody could use */
+	uint64_t bytesIn;
+	uint64_t framesIn;
+	uint64_t checksumFailures;
+	uint64_t resyncs;
+	uint64_t bytesDiscarded;
+	uint64_t droppedFrames;
+
+		/* Answers which command was already completed (or unknown) */
+	uint64_t lateAnswers;
+
+		/* Emission, from the packet writer */
+	uint64_t bytesOut;
+	uint64_t framesOut;
+	uint64_t droppedOut;
+	uint64_t coalescedOut;
+
+		/* One entry per command sent acknowledged at least once */
+	std::vector<CommandLatency> commands;
+};
+
+/*
+ * Log-linear histogram : 8 buckets per power of two, as an HDR histogram
+ * with 3 significant bits, covering the whole uint32_t range
+ */
+class LatencyHistogram
+{
+	public:
+		static size_t const NB_BUCKETS = 240;
+
+		LatencyHistogram();
+
+		/**
+		 * @brief record : Counts a value, from any thread
+		 * @param us : The value, in µs
+		 */
+		void record(uint32_t us);
+
+		/**
+		 * @brief summarize : Fills the counters and percentiles of a summary
+		 * @param summary : Receives count, totalUs, percentiles and maxUs
+		 */
+		void summarize(CommandLatency& summary) const;
+
+		/**
+		 * @return The bucket counting a value
+		 */
+		static size_t bucketOf(uint32_t us);
+
+		/**
+		 * @return The highest value counted by a bucket
+		 */
+		static uint32_t upperBound(size_t bucket);
+
+		std::atomic<uint64_t> timeouts;
+
+	private:
+		std::atomic<uint32_t> _buckets[NB_BUCKETS];
+		std::atomic<uint64_t> _totalUs;
+		std::atomic<uint32_t> _maxUs;
+};
+
+//------------------------------------------------------- Class definition
+/*
+ * Counters are updated with relaxed atomic operations and read one by one,
+ * without stopping any thread. As they only grow, two copies found equal
+ * by sameCounters hold the values of every counter at a single instant
+ * between them : readers copy until they get the same values twice.
+ */
+class LinkStats
+{
+	public:
+		//---------------------------------------- Constructors/Destructor
+		LinkStats();
+
+		virtual ~LinkStats();
+
+			//No sense
+		LinkStats(const LinkStats&) = delete;
+		LinkStats& operator=(const LinkStats&) = delete;
+
+		//------------------------------------------------- Public methods
+
+		/**
+		 * @brief recordRoundTrip : Counts an answered command
+		 * @param did : The command device ID
+		 * @param cid : The command ID
+		 * @param rttUs : Its round-trip time, in µs
+		 */
+		void recordRoundTrip(uint8_t did, uint8_t cid, uint32_t rttUs);
+
+		/**
+		 * @brief recordTimeout : Counts a command left without answer
+		 * @param did : The command device ID
+		 * @param cid : The command ID
+		 */
+		void recordTimeout(uint8_t did, uint8_t cid);
+
+		/**
+		 * @brief addDroppedFrame : Counts a valid frame nobody could use
+		 */
+		void addDroppedFrame();
+
+		/**
+		 * @brief addLateAnswer : Counts an answer matching no pending command
+		 */
+		void addLateAnswer();
+
+		/**
+		 * @brief fill : Copies the counters and summarizes the histograms
+		 * @param snapshot : Receives droppedFrames, lateAnswers and commands
+		 */
+		void fill(LinkSnapshot& snapshot) const;
+
+		/**
+		 * @brief sameCounters : Compares two copies of the counters
+		 * @return true if every counter, takenAtUs and consistent aside,
+		 * 		   has the same value in both
+		 */
+		static bool sameCounters(const LinkSnapshot& first,
+				const LinkSnapshot& second);
+
+	private:
+		//--------------------------------------------------- Private methods
+
+		/**
+		 * @return The histogram of a command, created on first use
+		 */
+		LatencyHistogram* histogram(uint8_t did, uint8_t cid);
+
+		//------------------------------------------------ Private attributes
+		std::atomic<LatencyHistogram*> _histograms[LINK_STATS_NB_DID][256];
+		std::atomic<uint64_t> _droppedFrames;
+		std::atomic<uint64_t> _lateAnswers;
+};
+
+#endif // LINKSTATS_HPP
@@ -0,0 +1,339 @@
+/*************************************************************************
+	PacketFramer  -  Per-connection receive buffer splitting the incoming
+					 byte stream into whole, validated frames
+                             -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+//-------------------------------------------------------- System includes
+#include <cstring>
+#include <cstdio>
+#include <sys/socket.h>
+
+//--------------------------------------------------------- Local includes
+#include "PacketFramer.hpp"
+#include "SpheroPacket.hpp"
+#include "SpheroAsyncPacket.hpp"
+
+//-------------------------------------------------------------- Constants
+	/* Biggest DLEN a frame fitting in the buffer can carry */
+static uint16_t const MAX_DLEN = FRAMER_BUFFER_SIZE - FRAME_HEADER_SIZE;
+
+	/* Response codes : ORBOTIX_RSP_CODE_OK (00h) to EUNSUPP (0Bh), then the
+	 * orbBasic ones, EEXEC (31h) to EFULL (35h) */
+static uint8_t const MRSP_LAST_CORE = 0x0B;
+static uint8_t const MRSP_FIRST_ORBBASIC = 0x31;
+static uint8_t const MRSP_LAST_ORBBASIC = 0x35;
+
+//-------------------------------------------------------- Private methods
+
+/**
+ * @return The DLEN bounds of an asynchronous ID code, all 0 if the ID is
+ * 		   unknown
+ */
+constexpr frameBounds PacketFramer::boundsOf(uint8_t id)
+{
+		//Sizes of the decoded packets are exact, the others only bounded
+	return id == POWER_NOTIFICATION_FLAG ? frameBounds{2, 2, 1}
+		: id == PRESLEEP_WARNING ? frameBounds{1, 1, 1}
+		: id == SELF_LEVEL_RESULT ? frameBounds{2, 2, 1}
+		: id == COLLISION_DETECTED ? frameBounds{17, 17, 1}
+			//16 bits values only
+		: id == SENSOR_DATA_STREAMING ? frameBounds{3, MAX_DLEN, 2}
+		: id >= LVL_1_DIAGNOSTIC_RESPONSE && id <= MAX_ASYNC_ID
+			? frameBounds{1, MAX_DLEN, 1}
+		: frameBounds{0, 0, 1};
+}
+
+//-------------------------------------------------------- Class variables
+const dispatchTable<frameBounds> PacketFramer::_asyncBounds =
+	dispatch_table::build<frameBounds, PacketFramer::boundsOf>();
+
+//------------------------------------------------ Constructors/Destructor
+
+/**
+ * @brief PacketFramer : Constructor
+ */
+PacketFramer::PacketFramer():_begin(0), _end(0), _resyncing(false),
+	_bytes(0), _frames(0), _checksumFailures(0), _resyncs(0),
+	_discardedBytes(0), _streamingDlen(0)
+{}
+
+
+PacketFramer::~PacketFramer()
+{}
+
+
+//--------------------------------------------------------- Public methods
+
+/**
+ * @brief fill : Reads everything currently available on the socket with a
+ * 				 single recv() call
+ * @param fd : The socket file descriptor
+ * @return The number of bytes read, 0 if the peer closed the connection,
+ * 		   -1 on error
+ */
+ssize_t PacketFramer::fill(int fd)
+{
+	compact();
+
+	ssize_t rcvVal = recv(fd, _buffer + _end, FRAMER_BUFFER_SIZE - _end, 0);
+	if(rcvVal > 0)
+	{
+		_end += rcvVal;
+		count(_bytes, rcvVal);
+	}
+
+	return rcvVal;
+}
+
+
+/**
+ * @brief nextFrame : Extracts the next complete frame from the buffer
+ * @param frame : Set to the first byte (SOP1) of the frame. Only valid
+ * 				  until the next call to fill() or nextFrame()
+ * @param length : Set to the whole frame length, checksum included
+ * @return true if a checksum-valid frame was found, false if more bytes
+ * 		   are needed
+ */
+bool PacketFramer::nextFrame(const uint8_t*& frame, size_t& length)
+{
+	for(;;)
+	{
+		size_t available = _end - _begin;
+		uint8_t* cursor = _buffer + _begin;
+
+		if(available == 0)
+		{
+			return false;
+		}
+
+			//Looking for SOP1
+		if(*cursor != START_OF_PACKET_FLAG)
+		{
+			uint8_t* sop = (uint8_t*) memchr(cursor, START_OF_PACKET_FLAG, available);
+			discard((sop == NULL) ? available : (size_t) (sop - cursor));
+			continue;
+		}
+
+		if(available < 2)
+		{
+			return false;
+		}
+
+		if(cursor[1] != ANSWER_FLAG && cursor[1] != ASYNC_FLAG)
+		{
+			discard(1);
+			continue;
+		}
+
+		if(available < FRAME_HEADER_SIZE)
+		{
+			return false;
+		}
+
+		size_t dlen = frameDlen(cursor);
+		if(dlen == 0)
+		{
+			discard(1);
+			continue;
+		}
+
+		size_t frameLength = FRAME_HEADER_SIZE + dlen;
+		if(available < frameLength)
+		{
+			return false;
+		}
+
+		uint8_t sum = 0;
+		for(size_t i = 2 ; i < frameLength - 1 ; sum += cursor[i++])
+		{ }
+
+		if((uint8_t) ~sum != cursor[frameLength - 1])
+		{
+#ifdef MAP
+			fprintf(stderr, "Checksum error, searching from the next byte\n");
+#endif
+			count(_checksumFailures);
+				//The SOP may belong to a payload : the bytes it claimed
+				//can still hold the next real frame
+			discard(1);
+			continue;
+		}
+
+			//Dropping an FFh data byte keeps the 8-bit sum valid, the next
+			//SOP1 sliding in as checksum : only such frames, ending with
+			//FFh, are checked against the bytes already received after them
+		if(cursor[frameLength - 1] == START_OF_PACKET_FLAG
+				&& !followedBySop(cursor + frameLength, available - frameLength))
+		{
+			discard(1);
+			continue;
+		}
+
+#ifdef MAP
+		for(size_t i = 0 ; i < frameLength ; ++i)
+		{
+			fprintf(stdout, "%02x ", cursor[i]);
+		}
+		fprintf(stdout, "\n");
+#endif
+
+		_begin += frameLength;
+		_resyncing = false;
+		count(_frames);
+		frame = cursor;
+		length = frameLength;
+		return true;
+	}
+}
+
+
+/**
+ * @brief reset : Drops every buffered byte (used on reconnection)
+ */
+void PacketFramer::reset()
+{
+	_begin = 0;
+	_end = 0;
+	_resyncing = false;
+}
+
+
+/**
+ * @return The reception counters, readable from any thread
+ */
+FramerStats PacketFramer::getStats() const
+{
+	FramerStats stats;
+	stats.bytes = _bytes.load(std::memory_order_relaxed);
+	stats.frames = _frames.load(std::memory_order_relaxed);
+	stats.checksumFailures = _checksumFailures.load(std::memory_order_relaxed);
+	stats.resyncs = _resyncs.load(std::memory_order_relaxed);
+	stats.discardedBytes = _discardedBytes.load(std::memory_order_relaxed);
+
+	return stats;
+}
+
+
+/**
+ * @brief setStreamingDlen : Sets the only DLEN data streaming frames are
+ * 							 accepted with, from any thread
+ * @param dlen : The DLEN of the configured streaming packets, checksum
+ * 				 included, 0 to only check it is plausible (streaming not
+ * 				 configured)
+ */
+void PacketFramer::setStreamingDlen(uint16_t dlen)
+{
+	_streamingDlen.store(dlen, std::memory_order_relaxed);
+}
+
+
+/**
+ * @return true if asynchronous frames of an ID code can be accepted
+ */
+bool PacketFramer::acceptsAsync(uint8_t id)
+{
+	return _asyncBounds[id].maxDlen != 0;
+}
+
+
+//-------------------------------------------------------- Private methods
+
+/**
+ * @brief compact : Moves the pending bytes back to the beginning of the
+ * 					buffer to make room for the next read
+ */
+void PacketFramer::compact()
+{
+	if(_begin == _end)
+	{
+		_begin = 0;
+		_end = 0;
+	}
+	else if(_begin > 0)
+	{
+		memmove(_buffer, _buffer + _begin, _end - _begin);
+		_end -= _begin;
+		_begin = 0;
+	}
+}
+
+
+/**
+ * @brief frameDlen : Checks the header of a candidate frame
+ * @param header : The FRAME_HEADER_SIZE first bytes, SOP2 known
+ * @return The DLEN of the frame, 0 if the header is implausible
+ */
+size_t PacketFramer::frameDlen(const uint8_t* header) const
+{
+	if(header[1] == ANSWER_FLAG)
+	{
+		uint8_t mrsp = header[2];
+
+			//Answer sizes depend on the command : only MRSP can be checked
+		bool known = mrsp <= MRSP_LAST_CORE || (mrsp >= MRSP_FIRST_ORBBASIC
+				&& mrsp <= MRSP_LAST_ORBBASIC);
+		return known ? header[4] : 0;
+	}
+
+	frameBounds bounds = _asyncBounds[header[2]];
+	size_t dlen = (header[3] << 8) | header[4];
+
+		//Once streaming is configured, its frames all have the same size
+	size_t streamingDlen = _streamingDlen.load(std::memory_order_relaxed);
+	if(header[2] == SENSOR_DATA_STREAMING && streamingDlen != 0)
+	{
+		return (dlen == streamingDlen) ? dlen : 0;
+	}
+
+	if(dlen < bounds.minDlen || dlen > bounds.maxDlen
+			|| (dlen - 1) % bounds.unit != 0)
+	{
+		return 0;
+	}
+
+	return dlen;
+}
+
+
+/**
+ * @brief followedBySop : Checks the bytes received after a candidate frame
+ * 						  ending with FFh
+ * @param next : The first byte after the frame
+ * @param available : The number of bytes received after the frame
+ * @return false if they cannot start a frame
+ */
+bool PacketFramer::followedBySop(const uint8_t* next, size_t available)
+{
+	return available == 0 || (next[0] == START_OF_PACKET_FLAG
+			&& (available == 1 || next[1] == ANSWER_FLAG || next[1] == ASYNC_FLAG));
+}
+
+
+/**
+ * @brief discard : Skips bytes while looking for a valid frame
+ * @param n : The number of bytes
+ */
+void PacketFramer::discard(size_t n)
+{
+	if(!_resyncing)
+	{
+		_resyncing = true;
+		count(_resyncs);
+	}
+
+	_begin += n;
+	count(_discardedBytes, n);
+}
+
+
+/**
+ * @brief count : Increments a counter only written by the reading thread
+ */
+void PacketFramer::count(std::atomic<uint64_t>& counter, uint64_t n)
+{
+		//A single writer needs no atomic read-modify-write
+	counter.store(counter.load(std::memory_order_relaxed) + n,
+			std::memory_order_relaxed);
+}
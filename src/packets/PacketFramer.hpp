@@ -0,0 +1,211 @@
+/*************************************************************************
+	PacketFramer  -  Per-connection receive buffer splitting the incoming
+					 byte stream into whole, validated frames
+                             -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+#ifndef PACKETFRAMER_HPP
+#define PACKETFRAMER_HPP
+
+//-------------------------------------------------------- System includes
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <sys/types.h>
+
+//--------------------------------------------------------- Local includes
+#include "DispatchTable.hpp"
+
+//-------------------------------------------------------------- Constants
+
+	/* Receive buffer capacity, also the biggest frame we accept */
+static size_t const FRAMER_BUFFER_SIZE = 4096;
+
+	/* SOP1 SOP2 MRSP|ID SEQ|DLEN_MSB DLEN|DLEN_LSB */
+static size_t const FRAME_HEADER_SIZE = 5;
+
+//------------------------------------------------------------------ Types
+
+/*
+ * Reception counters of a framer
+ */
+struct FramerStats
+{
+		/* Bytes read from the socket */
+	uint64_t bytes;
+
+		/* Checksum-valid frames given by nextFrame */
+	uint64_t frames;
+
+		/* Candidate frames, with a plausible header, failing their
+		 * checksum */
+	uint64_t checksumFailures;
+
+		/* Losses of synchronization : runs of skipped bytes between two
+		 * valid frames */
+	uint64_t resyncs;
+
+		/* Bytes skipped while looking for the next valid frame */
+	uint64_t discardedBytes;
+};
+
+/*
+ * DLEN an asynchronous ID code may carry, checksum included
+ */
+struct frameBounds
+{
+	uint16_t minDlen;
+	uint16_t maxDlen;
+
+		/* The data length is a multiple of it */
+	uint16_t unit;
+};
+
+//------------------------------------------------------- Class definition
+/*
+ * Frames are received from the Sphero in one of the two following formats
+ * | SOP1 | SOP2 = FFh | MRSP | SEQ | DLEN | <data> | CHK     (answer)
+ * | SOP1 | SOP2 = FEh | ID CODE | DLEN_MSB | DLEN_LSB | <data> | CHK (async)
+ *
+ * In both cases DLEN counts the data payload and the checksum, and the
+ * checksum covers every byte from the third one through the end of the data.
+ *
+ * A header is only trusted if its response code or ID code is known and its
+ * DLEN fits that ID, the data streaming DLEN being exact once streaming is
+ * configured (see setStreamingDlen). When a candidate frame is rejected, the
+ * search resumes one byte after its SOP1 rather than after its claimed end :
+ * an SOP read in a payload does not hide the real frames that follow.
+ */
+class PacketFramer
+{
+	public:
+		//--------------------------------------------- Operators overload
+			//No sense
+		PacketFramer& operator=(const PacketFramer&) = delete;
+
+		//---------------------------------------- Constructors/Destructor
+			//No sense
+		PacketFramer(const PacketFramer&) = delete;
+
+		/**
+		 * @brief PacketFramer : Constructor
+		 */
+		PacketFramer();
+
+		virtual ~PacketFramer();
+
+		//------------------------------------------------- Public methods
+
+		/**
+		 * @brief fill : Reads everything currently available on the socket
+		 * 				 with a single recv() call
+		 * @param fd : The socket file descriptor
+		 * @return The number of bytes read, 0 if the peer closed the
+		 * 		   connection, -1 on error
+		 */
+		ssize_t fill(int fd);
+
+		/**
+		 * @brief nextFrame : Extracts the next complete frame from the buffer
+		 * @param frame : Set to the first byte (SOP1) of the frame. Only
+		 * 				  valid until the next call to fill() or nextFrame()
+		 * @param length : Set to the whole frame length, checksum included
+		 * @return true if a checksum-valid frame was found, false if more
+		 * 		   bytes are needed
+		 */
+		bool nextFrame(const uint8_t*& frame, size_t& length);
+
+		/**
+		 * @brief reset : Drops every buffered byte (used on reconnection)
+		 */
+		void reset();
+
+		/**
+		 * @return The reception counters, readable from any thread
+		 */
+		FramerStats getStats() const;
+
+		/**
+		 * @brief setStreamingDlen : Sets the only DLEN data streaming
+		 * 							 frames are accepted with, from any
+		 * 							 thread
+		 * @param dlen : The DLEN of the configured streaming packets,
+		 * 				 checksum included, 0 to only check it is
+		 * 				 plausible (streaming not configured)
+		 */
+		void setStreamingDlen(uint16_t dlen);
+
+		/**
+		 * @return true if asynchronous frames of an ID code can be accepted
+		 */
+		static bool acceptsAsync(uint8_t id);
+
+	private:
+		//------------------------------------------------ Private methods
+
+		/**
+		 * @brief compact : Moves the pending bytes back to the beginning
+		 * 					of the buffer to make room for the next read
+		 */
+		void compact();
+
+		/**
+		 * @brief frameDlen : Checks the header of a candidate frame
+		 * @param header : The FRAME_HEADER_SIZE first bytes, SOP2 known
+		 * @return The DLEN of the frame, 0 if the header is implausible
+		 */
+		size_t frameDlen(const uint8_t* header) const;
+
+		/**
+		 * @brief followedBySop : Checks the bytes received after a
+		 * 						  candidate frame ending with FFh
+		 * @param next : The first byte after the frame
+		 * @param available : The number of bytes received after the frame
+		 * @return false if they cannot start a frame
+		 */
+		static bool followedBySop(const uint8_t* next, size_t available);
+
+		/**
+		 * @brief discard : Skips bytes while looking for a valid frame
+		 * @param n : The number of bytes
+		 */
+		void discard(size_t n);
+
+		/**
+		 * @return The DLEN bounds of an asynchronous ID code, all 0 if
+		 * 		   the ID is unknown
+		 */
+		static constexpr frameBounds boundsOf(uint8_t id);
+
+		/**
+		 * @brief count : Increments a counter only written by the reading
+		 * 				  thread
+		 */
+		static void count(std::atomic<uint64_t>& counter, uint64_t n = 1);
+
+		//--------------------------------------------- Private attributes
+		uint8_t _buffer[FRAMER_BUFFER_SIZE];
+
+			/* Pending bytes are in [_begin, _end[ */
+		size_t _begin;
+		size_t _end;
+
+			/* Bytes were skipped since the last valid frame */
+		bool _resyncing;
+
+			/* Written by the reading thread only, see FramerStats */
+		std::atomic<uint64_t> _bytes;
+		std::atomic<uint64_t> _frames;
+		std::atomic<uint64_t> _checksumFailures;
+		std::atomic<uint64_t> _resyncs;
+		std::atomic<uint64_t> _discardedBytes;
+
+			/* See setStreamingDlen */
+		std::atomic<uint16_t> _streamingDlen;
+
+			/* Indexed by ID code */
+		static const dispatchTable<frameBounds> _asyncBounds;
+};
+
+#endif // PACKETFRAMER_HPP
@@ -0,0 +1,345 @@
+/*************************************************************************
+	PacketWriter  -  Per-connection outbound queue, drained by a single
+					 writer thread coalescing the pending packets
+                             -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+//-------------------------------------------------------- System includes
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <ctime>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+//--------------------------------------------------------- Local includes
+#include "PacketWriter.hpp"
+
+//------------------------------------------------ Constructors/Destructor
+
+/**
+ * @brief PacketWriter : Constructor
+ * @param recorder : Receives the packets once written, NULL for none
+ */
+PacketWriter::PacketWriter(WireRecorder* recorder):_recorder(recorder), _fd(-1), _running(false), _stop(false),
+	_exited(false), _failed(false), _nbReplaced(0), _stats()
+{
+	_pending.reserve(WRITER_MAX_BATCH);
+	forgetLatest();
+	pthread_mutex_init(&_lock, NULL);
+	pthread_cond_init(&_cond, NULL);
+
+	pthread_condattr_t condAttr;
+	pthread_condattr_init(&condAttr);
+	pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC);
+	pthread_cond_init(&_exitCond, &condAttr);
+	pthread_condattr_destroy(&condAttr);
+}
+
+
+PacketWriter::~PacketWriter()
+{
+	stop();
+	pthread_cond_destroy(&_exitCond);
+	pthread_cond_destroy(&_cond);
+	pthread_mutex_destroy(&_lock);
+}
+
+
+//--------------------------------------------------------- Public methods
+
+/**
+ * @brief start : Starts the writer thread on a connected socket
+ * @param fd : The socket file descriptor
+ */
+void PacketWriter::start(int fd)
+{
+	stop();
+
+	pthread_mutex_lock(&_lock);
+	_fd = fd;
+	_stop = false;
+	_exited = false;
+	_failed = false;
+	_pending.clear();
+	_nbReplaced = 0;
+	forgetLatest();
+	_running = true;
+	pthread_mutex_unlock(&_lock);
+
+	pthread_create(&_thread, NULL, writerRoutine, this);
+}
+
+
+/**
+ * @brief stop : Sends the packets still queued and stops the writer thread.
+ * 				 Does nothing if it is not running. If they are not sent
+ * 				 within WRITER_FLUSH_MS, the socket is shut down, so that a
+ * 				 write blocked on a stalled link returns
+ */
+void PacketWriter::stop()
+{
+	pthread_mutex_lock(&_lock);
+	bool running = _running;
+	_stop = true;
+	pthread_cond_signal(&_cond);
+
+	if(running)
+	{
+		struct timespec deadline;
+		clock_gettime(CLOCK_MONOTONIC, &deadline);
+		deadline.tv_sec += WRITER_FLUSH_MS / 1000;
+		deadline.tv_nsec += (WRITER_FLUSH_MS % 1000) * 1000000L;
+		if(deadline.tv_nsec >= 1000000000L)
+		{
+			++deadline.tv_sec;
+			deadline.tv_nsec -= 1000000000L;
+		}
+
+		while(!_exited && pthread_cond_timedwait(&_exitCond, &_lock,
+					&deadline) != ETIMEDOUT)
+		{
+		}
+		if(!_exited)
+		{
+			shutdown(_fd, SHUT_RDWR);
+		}
+	}
+	pthread_mutex_unlock(&_lock);
+
+	if(running)
+	{
+		pthread_join(_thread, NULL);
+
+		pthread_mutex_lock(&_lock);
+		_running = false;
+		pthread_mutex_unlock(&_lock);
+	}
+}
+
+
+/**
+ * @brief enqueue : Queues a packet for sending
+ * @param packet : The whole packet bytes
+ * @param size : The packet size, at most WRITER_FRAME_SIZE
+ * @param kind : If not NONE, the unsent packet of the same class is dropped.
+ * 				 The new one is sent at the end of the queue
+ * @return false if the packet was dropped (writer stopped, or size too big)
+ */
+bool PacketWriter::enqueue(const uint8_t* packet, size_t size, coalesceClass kind)
+{
+	if(size > WRITER_FRAME_SIZE)
+	{
+		return false;
+	}
+
+	pthread_mutex_lock(&_lock);
+
+	if(!_running || _stop || _failed)
+	{
+		++_stats.dropped;
+		pthread_mutex_unlock(&_lock);
+		return false;
+	}
+
+		//Keeping the queue order : the older packet is only marked empty
+	if(kind != coalesceClass::NONE)
+	{
+		ssize_t& latest = _latest[(size_t) kind];
+		if(latest != -1)
+		{
+			_pending[latest].size = 0;
+			++_nbReplaced;
+			++_stats.coalesced;
+		}
+		latest = _pending.size();
+	}
+
+	_pending.emplace_back();
+	frame& f = _pending.back();
+	f.size = size;
+	memcpy(f.bytes, packet, size);
+
+	_stats.queueDepth = _pending.size() - _nbReplaced;
+	_stats.maxQueueDepth = std::max(_stats.maxQueueDepth, _stats.queueDepth);
+
+		//The writer is either waiting or will see the packet on its next turn
+	if(_pending.size() == 1)
+	{
+		pthread_cond_signal(&_cond);
+	}
+
+	pthread_mutex_unlock(&_lock);
+
+	return true;
+}
+
+
+/**
+ * @return A consistent copy of the writer counters
+ */
+WriterStats PacketWriter::getStats()
+{
+	pthread_mutex_lock(&_lock);
+	WriterStats stats = _stats;
+	pthread_mutex_unlock(&_lock);
+
+	return stats;
+}
+
+
+//-------------------------------------------------------- Private methods
+
+void* PacketWriter::writerRoutine(void* writer_ptr)
+{
+	PacketWriter* writer = (PacketWriter*) writer_ptr;
+
+		//Swapped with the pending queue : both keep their capacity
+	std::vector<frame> batch;
+	batch.reserve(WRITER_MAX_BATCH);
+
+	pthread_mutex_lock(&writer->_lock);
+
+	for(;;)
+	{
+		while(!writer->_stop && writer->_pending.empty())
+		{
+			pthread_cond_wait(&writer->_cond, &writer->_lock);
+		}
+
+		if(writer->_pending.empty())
+		{
+			break;
+		}
+
+		batch.swap(writer->_pending);
+		size_t nbLive = batch.size() - writer->_nbReplaced;
+		writer->_nbReplaced = 0;
+		writer->forgetLatest();
+		writer->_stats.queueDepth = 0;
+		bool failed = writer->_failed;
+
+		pthread_mutex_unlock(&writer->_lock);
+
+		WriterStats sent = WriterStats();
+		if(!failed && !writer->writeAll(batch, sent))
+		{
+				//Lets the reception side notice the broken link
+			shutdown(writer->_fd, SHUT_RDWR);
+			failed = true;
+		}
+		else if(!failed && writer->_recorder != NULL
+				&& writer->_recorder->isRecording())
+		{
+			for(size_t i = 0 ; i < batch.size() ; ++i)
+			{
+				if(batch[i].size != 0)
+				{
+					writer->_recorder->record(captureDirection::OUTBOUND,
+							batch[i].bytes, batch[i].size);
+				}
+			}
+		}
+
+		pthread_mutex_lock(&writer->_lock);
+
+		writer->_stats.frames += sent.frames;
+		writer->_stats.bytes += sent.bytes;
+		writer->_stats.syscalls += sent.syscalls;
+		writer->_stats.dropped += nbLive - sent.frames;
+		writer->_stats.maxBatch = std::max(writer->_stats.maxBatch, sent.maxBatch);
+		writer->_failed = failed;
+
+		batch.clear();
+	}
+
+	writer->_exited = true;
+	pthread_cond_broadcast(&writer->_exitCond);
+	pthread_mutex_unlock(&writer->_lock);
+
+	return NULL;
+}
+
+
+/**
+ * @brief writeAll : Sends a batch of packets, WRITER_MAX_BATCH per
+ * 					 system call, resuming after partial writes
+ * @param batch : The packets to send
+ * @param sent : Counts the packets, bytes and system calls
+ * @return false if the socket failed
+ */
+bool PacketWriter::writeAll(std::vector<frame>& batch, WriterStats& sent)
+{
+	struct iovec iov[WRITER_MAX_BATCH];
+
+	for(size_t next = 0 ; next < batch.size() ; )
+	{
+		size_t nbFrames = 0;
+		for( ; next < batch.size() && nbFrames < WRITER_MAX_BATCH ; ++next)
+		{
+			if(batch[next].size != 0)
+			{
+				iov[nbFrames].iov_base = batch[next].bytes;
+				iov[nbFrames].iov_len = batch[next].size;
+				++nbFrames;
+			}
+		}
+		if(nbFrames == 0)
+		{
+			break;
+		}
+
+		struct msghdr msg;
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_iov = iov;
+		msg.msg_iovlen = nbFrames;
+
+		while(msg.msg_iovlen > 0)
+		{
+				//writev() semantics, without SIGPIPE on a closed link
+			ssize_t written = sendmsg(_fd, &msg, MSG_NOSIGNAL);
+			++sent.syscalls;
+
+			if(written < 0)
+			{
+				if(errno == EINTR)
+				{
+					continue;
+				}
+				return false;
+			}
+
+			sent.bytes += written;
+			while(msg.msg_iovlen > 0 && (size_t) written >= msg.msg_iov->iov_len)
+			{
+				written -= msg.msg_iov->iov_len;
+				++msg.msg_iov;
+				--msg.msg_iovlen;
+			}
+			if(msg.msg_iovlen > 0)
+			{
+				msg.msg_iov->iov_base = (uint8_t*) msg.msg_iov->iov_base + written;
+				msg.msg_iov->iov_len -= written;
+			}
+		}
+
+		sent.frames += nbFrames;
+		sent.maxBatch = std::max(sent.maxBatch, nbFrames);
+	}
+
+	return true;
+}
+
+
+/**
+ * @brief forgetLatest : Marks every class as having no queued packet. The
+ * 						 lock must be held
+ */
+void PacketWriter::forgetLatest()
+{
+	for(size_t i = 0 ; i < (size_t) coalesceClass::NB_CLASSES ; ++i)
+	{
+		_latest[i] = -1;
+	}
+}
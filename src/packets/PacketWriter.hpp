@@ -0,0 +1,196 @@
+/*************************************************************************
+	PacketWriter  -  Per-connection outbound queue, drained by a single
+					 writer thread coalescing the pending packets
+                             -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+#ifndef PACKETWRITER_HPP
+#define PACKETWRITER_HPP
+
+//-------------------------------------------------------- System includes
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <pthread.h>
+#include <sys/types.h>
+
+//--------------------------------------------------------- Local includes
+#include "ClientCommandPacket.hpp"
+#include "../capture/WireRecorder.hpp"
+
+//-------------------------------------------------------------- Constants
+
+	/* Biggest client packet */
+static size_t const WRITER_FRAME_SIZE = CLIENT_PACKET_MAX_SIZE;
+
+	/* Maximum number of packets sent with a single system call */
+static size_t const WRITER_MAX_BATCH = 64;
+
+	/* Time given to the queued packets to leave on stop(), in ms. Past it,
+	 * the link is taken as stalled */
+static unsigned int const WRITER_FLUSH_MS = 500;
+
+//------------------------------------------------------------------ Types
+
+	/* Commands describing a state : only the latest one queued of a class
+	 * is worth sending */
+enum class coalesceClass
+{
+	NONE,
+	ROLL,
+	COLOR,
+	BACK_LED,
+	NB_CLASSES
+};
+
+struct WriterStats
+{
+		/* Packets and bytes written to the socket */
+	uint64_t frames;
+	uint64_t bytes;
+
+		/* Number of gathered write system calls */
+	uint64_t syscalls;
+
+		/* Packets dropped because the link was down or broke */
+	uint64_t dropped;
+
+		/* Packets replaced by a newer one of their class before sending */
+	uint64_t coalesced;
+
+		/* Packets currently waiting, and the most seen at once */
+	size_t queueDepth;
+	size_t maxQueueDepth;
+
+		/* Most packets written by a single system call */
+	size_t maxBatch;
+};
+
+//------------------------------------------------------- Class definition
+/*
+ * Any thread may enqueue packets. They are copied, so the caller buffer can
+ * be reused as soon as enqueue() returns. The writer thread sends all the
+ * packets queued since its last wake up with one gathered write, keeping
+ * each packet bytes contiguous on the wire.
+ *
+ * A packet queued with a coalescing class replaces the unsent one of the
+ * same class, which is how stale motion and LED commands are dropped when
+ * the link cannot keep up.
+ */
+class PacketWriter
+{
+	public:
+		//--------------------------------------------- Operators overload
+			//No sense
+		PacketWriter& operator=(const PacketWriter&) = delete;
+
+		//---------------------------------------- Constructors/Destructor
+			//No sense
+		PacketWriter(const PacketWriter&) = delete;
+
+		/**
+		 * @brief PacketWriter : Constructor
+		 * @param recorder : Receives the packets once written, NULL for none
+		 */
+		PacketWriter(WireRecorder* recorder = NULL);
+
+		/**
+		 * Stops the writer thread if it is running
+		 */
+		virtual ~PacketWriter();
+
+		//------------------------------------------------- Public methods
+
+		/**
+		 * @brief start : Starts the writer thread on a connected socket
+		 * @param fd : The socket file descriptor
+		 */
+		void start(int fd);
+
+		/**
+		 * @brief stop : Sends the packets still queued and stops the writer
+		 * 				 thread. Does nothing if it is not running. If they
+		 * 				 are not sent within WRITER_FLUSH_MS, the socket is
+		 * 				 shut down, so that a write blocked on a stalled link
+		 * 				 returns
+		 */
+		void stop();
+
+		/**
+		 * @brief enqueue : Queues a packet for sending
+		 * @param packet : The whole packet bytes
+		 * @param size : The packet size, at most WRITER_FRAME_SIZE
+		 * @param kind : If not NONE, the unsent packet of the same class is
+		 * 				 dropped. The new one is sent at the end of the queue
+		 * @return false if the packet was dropped (writer stopped, or size
+		 * 		   too big)
+		 */
+		bool enqueue(const uint8_t* packet, size_t size,
+				coalesceClass kind = coalesceClass::NONE);
+
+		/**
+		 * @return A consistent copy of the writer counters
+		 */
+		WriterStats getStats();
+
+	private:
+		//-------------------------------------------------- Private types
+		struct frame
+		{
+				/* 0 once replaced by a newer packet of its class */
+			uint16_t size;
+			uint8_t bytes[WRITER_FRAME_SIZE];
+		};
+
+		//------------------------------------------------ Private methods
+		static void* writerRoutine(void* writer_ptr);
+
+		/**
+		 * @brief writeAll : Sends a batch of packets, WRITER_MAX_BATCH per
+		 * 					 system call, resuming after partial writes
+		 * @param batch : The packets to send
+		 * @param sent : Counts the packets, bytes and system calls
+		 * @return false if the socket failed
+		 */
+		bool writeAll(std::vector<frame>& batch, WriterStats& sent);
+
+		/**
+		 * @brief forgetLatest : Marks every class as having no queued
+		 * 						 packet. The lock must be held
+		 */
+		void forgetLatest();
+
+		//--------------------------------------------- Private attributes
+		WireRecorder* _recorder;
+		int _fd;
+		bool _running;
+		bool _stop;
+		pthread_t _thread;
+
+			/* Set by the writer thread when it leaves */
+		bool _exited;
+
+			/* Set once the socket failed : packets are dropped until the
+			 * next start() */
+		bool _failed;
+
+			/* Producers append here, the writer swaps it with its batch */
+		std::vector<frame> _pending;
+
+			/* Index in _pending of the last packet of each class, or -1 */
+		ssize_t _latest[(size_t) coalesceClass::NB_CLASSES];
+
+			/* Packets of _pending replaced by a newer one */
+		size_t _nbReplaced;
+
+		WriterStats _stats;
+
+		pthread_mutex_t _lock;
+		pthread_cond_t _cond;
+
+			/* Signaled when the writer thread leaves, on CLOCK_MONOTONIC */
+		pthread_cond_t _exitCond;
+};
+
+#endif // PACKETWRITER_HPP
@@ -10,171 +10,111 @@
 
 //-------------------------------------------------------- System includes
 #include <iostream>
-#include <sys/socket.h>
-#include <fcntl.h>
+#include <cstring>
+#include <endian.h>
 
 //--------------------------------------------------------- Local includes
 #include "../Sphero.hpp"
 #include "SpheroAnswerPacket.hpp"
-#include "ChecksumComputer.hpp"
-#include "answer/BTInfoStruct.hpp"
-
-//------------------------------------------------ Constructors/Destructor
-
-/**
- * @brief SpheroAnswerPacket : Constructor
- * @param sphero : The Sphero instance that receives the answer packet
- */
-SpheroAnswerPacket::SpheroAnswerPacket(Sphero* sphero) : SpheroPacket(sphero)	
-{}
-
-
-SpheroAnswerPacket::~SpheroAnswerPacket()
-{}
-
+#include "PacketFramer.hpp"
 
 //--------------------------------------------------------- Public methods
 
 /**
- * @brief extractPacket : extracts the packet from a socket
- * @param fd : The socket file descriptor
+ * @brief extractPacket : gives a received answer to the command it completes
+ * @param frame : The frame, starting at SOP1
+ * @param length : The frame length, checksum included
  * @param sphero : The Sphero sending the packet
- * @param packet_ptr : A pointer to a SpheroPacket pointer
- * @return true if the packet was successfully extracted from the socket, false otherwise
  *
- * Contract: the socket has to be in blocking read mode
+ * Contract: the frame has been validated by a PacketFramer
  */
-bool SpheroAnswerPacket::extractPacket(int fd, Sphero* sphero, SpheroPacket**)
+void SpheroAnswerPacket::extractPacket(const uint8_t* frame, size_t,
+		Sphero* sphero)
 {
 #ifdef MAP
 	fprintf(stderr, "Answer packet reception\n\n");
 #endif
 
-	uint8_t msgrsp;
-	uint8_t seq;
-	uint8_t dlen;
-	uint8_t* dataPayload = NULL;
-	uint8_t checksum;
-	
-	int rcvVal;
-	rcvVal = recv(fd, &msgrsp, sizeof(msgrsp), 0);
-	if(rcvVal != sizeof(msgrsp))
-	{
-		return false;
-	}
+	uint8_t msgrsp = frame[2];
+	uint8_t seq = frame[3];
+	uint8_t dlen = frame[4];
+	const uint8_t* dataPayload = (dlen > 1) ? frame + FRAME_HEADER_SIZE : NULL;
 
-	rcvVal = recv(fd, &seq, sizeof(seq), 0);
-	if(rcvVal != sizeof(seq))
-	{
-		return false;
-	}
+#ifdef MAP
+	fprintf(stdout, "msgrsp : %u ;\nseq : %u;\n", msgrsp, seq);
+#endif
 
-	rcvVal = recv(fd, &dlen, sizeof(dlen), 0);
-	if(rcvVal != sizeof(dlen))
-	{
-		return false;
-	}
+	sphero->notifyPacket(seq, msgrsp, dlen, dataPayload);
+}
 
-	if(dlen > 1)
-	{
-		dataPayload = (uint8_t*) malloc((dlen-1) * sizeof(uint8_t));
-		rcvVal = recv(fd, dataPayload, dlen - 1, 0);
-		if(rcvVal != dlen - 1)
-		{
-			free(dataPayload);
-			return false;
-		}
-	}
-	
-	rcvVal = recv(fd, &checksum, sizeof(checksum), 0);
-	if(rcvVal != sizeof(checksum))
+/**
+ * @brief decodeColor : Decodes a getRGBLED answer in place
+ * @param dlen : The answer DLEN field
+ * @param dataPayload : The answer payload, in the receive buffer
+ * @param color : Receives the color
+ * @return false if the answer does not match
+ */
+bool SpheroAnswerPacket::decodeColor(uint8_t dlen, const uint8_t* dataPayload,
+		ColorStruct& color)
+{
+	if(dlen != 0x04)
 	{
-		if(dataPayload != NULL)
-		{
-			free(dataPayload);
-		}
 		return false;
 	}
 
-	ChecksumComputer cc;
-	cc.addField(seq);
-	cc.addField(msgrsp);
-	cc.addField(dlen);
+	color.red = dataPayload[0];
+	color.green = dataPayload[1];
+	color.blue = dataPayload[2];
+	return true;
+}
 
-	if(dataPayload != NULL)
+/**
+ * @brief decodeBTInfo : Decodes a getBluetoothInfo answer in place
+ * @param dlen : The answer DLEN field
+ * @param dataPayload : The answer payload, in the receive buffer
+ * @param btinfo : Receives the name and address
+ * @return false if the answer does not match
+ */
+bool SpheroAnswerPacket::decodeBTInfo(uint8_t dlen, const uint8_t* dataPayload,
+		BTInfoStruct& btinfo)
+{
+	if(dlen != 0x21)
 	{
-		cc.addField(dataPayload, dlen - 1);
+		return false;
 	}
 
-	if(cc() != checksum)
-	{
-#ifdef MAP
-		fprintf(stderr, "Erreur de checksum\n");
-#endif
-		if(dataPayload != NULL)
-		{
-			free(dataPayload);
-			return false;
-		}
-	}
-	
-#ifdef MAP
-	fprintf(stdout, "msgrsp : %u ;\nseq : %u;\n", msgrsp, seq);
-#endif
-
-	sphero->lockSeqnum(seq);
-	pendingCommandType requested = sphero->getTodo(seq);
-	packetFormatter pf = getPacketFromTodo(requested);
-	void* retour = pf(dlen, dataPayload);
-
-	sphero->notifyPacket(seq, msgrsp, retour);
-	
-	sphero->unlockSeqnum(seq);
-	
-	if(dataPayload != NULL)
-	{
-		free(dataPayload);
-	}
+		//Both fields are NUL padded, but may fill their 16 bytes
+	size_t nameLength = strnlen((const char*) dataPayload, BTINFO_FIELD_SIZE);
+	memcpy(btinfo.bt_name, dataPayload, nameLength);
+	btinfo.bt_name[nameLength] = '\0';
 
-	return false;
+	const uint8_t* address = dataPayload + BTINFO_FIELD_SIZE;
+	size_t addressLength = strnlen((const char*) address, BTINFO_FIELD_SIZE);
+	memcpy(btinfo.bt_adress, address, addressLength);
+	btinfo.bt_adress[addressLength] = '\0';
+	return true;
 }
 
-//------------------------------------------------------------- Private methods
-
-packetFormatter SpheroAnswerPacket::getPacketFromTodo(pendingCommandType todo)
+/**
+ * @brief decodePacketTimes : Decodes a pollPacketTimes answer in place
+ * @param dlen : The answer DLEN field
+ * @param dataPayload : The answer payload, in the receive buffer
+ * @param times : Receives the three timestamps
+ * @return false if the answer does not match
+ */
+bool SpheroAnswerPacket::decodePacketTimes(uint8_t dlen,
+		const uint8_t* dataPayload, PacketTimesStruct& times)
 {
-	switch(todo){
-		case pendingCommandType::GETCOLOR:
-			return [](uint8_t dlen, uint8_t* dataPayload){
-				if (dlen != 0x04)
-				{
-					return (void*) NULL;
-				}
-				ColorStruct* color = new ColorStruct;
-				color->red = dataPayload[0];
-				color->green = dataPayload[1];
-				color->blue = dataPayload[2];
-				return (void*) color;
-			};
-			break;
-		case pendingCommandType::GETBTINFO:
-			return [](uint8_t dlen, uint8_t* dataPayload){
-				if (dlen != 0x21)
-				{
-					return (void*) NULL;
-				}
-				BTInfoStruct* btinfo = new BTInfoStruct;
-				
-				btinfo->bt_name = std::string((const char*)dataPayload);
-				btinfo->bt_adress = std::string((const char*)(dataPayload + 16));
-				return (void*) btinfo;
-
-			};
-			break;
-		case pendingCommandType::NONE:
-		case pendingCommandType::SIMPLE_RESPONSE:
-		default:
-			return [](uint8_t, uint8_t* ){ return (void*) NULL; };
-			break;
+	if(dlen != 0x0D)
+	{
+		return false;
 	}
+
+		//Three big endian fields, maybe unaligned in the receive buffer
+	uint32_t fields[3];
+	memcpy(fields, dataPayload, sizeof(fields));
+	times.clientSent = be32toh(fields[0]);
+	times.deviceReceived = be32toh(fields[1]);
+	times.deviceSent = be32toh(fields[2]);
+	return true;
 }
@@ -1,76 +1,75 @@
-/*************************************************************************
-	SpheroAnswerPacket  -  Defines the behavior of
-									"answer" packets received by Sphero
-                             -------------------
-    début                : mar. 28 avril 2015
-*************************************************************************/
-
-#ifndef SPHEROANSWERPACKET_H
-#define SPHEROANSWERPACKET_H
-//--------------------------------------------------------- System includes
-#include <queue>
-
-//--------------------------------------------------------- Local includes
-#include "SpheroPacket.hpp"
-#include "answer/AskedCommandCode.hpp"
-
-#include "answer/ColorStruct.hpp"
-
-//-------------------------------------------------------------- Constants
-
-//------------------------------------------------------------------ Types
-// int uint8_t is dlen and uint8_t* is dataPayload
-typedef void*(*packetFormatter)(uint8_t dlen, uint8_t* dataPayload);
-
-//------------------------------------------------------- Class definition
-class SpheroAnswerPacket : public SpheroPacket
-{
-	public:
-		//--------------------------------------------- Operators overload
-			//No sense
-		SpheroAnswerPacket& operator=(const SpheroAnswerPacket& unSpheroAnswerPacket) = delete;
-
-		//---------------------------------------- Constructors/Destructor
-			//No sense
-		SpheroAnswerPacket(const SpheroAnswerPacket& unSpheroAnswerPacket) = delete;
-
-		virtual ~SpheroAnswerPacket();
-
-		//------------------------------------------------- Public methods
-
-		/**
-		 * @brief extractPacket : extracts the packet from a socket
-		 * @param fd : The socket file descriptor
-		 * @param sphero : The Sphero sending the packet
-		 * @param packet_ptr : A pointer to a SpheroPacket pointer
-		 * @return true if the packet was successfully extracted from the socket, false otherwise
-		 *
-		 * Contract: the socket has to be in blocking read
-		 */
-		static bool extractPacket(int fd, Sphero* sphero, SpheroPacket**);
-
-		/**
-		 * @brief packetAction : Performs the action associated to the packet
-		 *			on the Sphero instance
-		 */
-		virtual void packetAction() = 0;
-
-	protected:
-
-		//--------------------------------------------- Protected methods
-		
-		//-------------------------------------------------- Constructors
-
-		/**
-		 * @brief SpheroAnswerPacket : Constructor
-		 * @param sphero : The Sphero instance that receives the answer packet
-		 */
-		SpheroAnswerPacket(Sphero* sphero);
-
-	private:
-		static packetFormatter getPacketFromTodo(pendingCommandType todo);
-		
-};
-
-#endif // SpheroAnswerPacket_H
-
+/*************************************************************************
+	SpheroAnswerPacket  -  Defines the behavior of
+									"answer" packets received by Sphero
+                             -------------------
+    début                : mar. 28 avril 2015
+*************************************************************************/
+
+#ifndef SPHEROANSWERPACKET_H
+#define SPHEROANSWERPACKET_H
+//--------------------------------------------------------- System includes
+#include <queue>
+
+//--------------------------------------------------------- Local includes
+#include "SpheroPacket.hpp"
+#include "answer/ColorStruct.hpp"
+#include "answer/BTInfoStruct.hpp"
+#include "answer/PacketTimesStruct.hpp"
+
+//-------------------------------------------------------------- Constants
+
+//------------------------------------------------------- Class definition
+class SpheroAnswerPacket : public SpheroPacket
+{
+	public:
+		//------------------------------------------------- Public methods
+
+		/**
+		 * @brief extractPacket : gives a received answer to the command it
+		 * 						  completes
+		 * @param frame : The frame, starting at SOP1
+		 * @param length : The frame length, checksum included
+		 * @param sphero : The Sphero sending the packet
+		 *
+		 * Contract: the frame has been validated by a PacketFramer
+		 */
+		static void extractPacket(const uint8_t* frame, size_t length,
+				Sphero* sphero);
+
+		/**
+		 * @brief decodeColor : Decodes a getRGBLED answer in place
+		 * @param dlen : The answer DLEN field
+		 * @param dataPayload : The answer payload, in the receive buffer
+		 * @param color : Receives the color
+		 * @return false if the answer does not match
+		 */
+		static bool decodeColor(uint8_t dlen, const uint8_t* dataPayload,
+				ColorStruct& color);
+
+		/**
+		 * @brief decodeBTInfo : Decodes a getBluetoothInfo answer in place
+		 * @param dlen : The answer DLEN field
+		 * @param dataPayload : The answer payload, in the receive buffer
+		 * @param btinfo : Receives the name and address
+		 * @return false if the answer does not match
+		 */
+		static bool decodeBTInfo(uint8_t dlen, const uint8_t* dataPayload,
+				BTInfoStruct& btinfo);
+
+		/**
+		 * @brief decodePacketTimes : Decodes a pollPacketTimes answer in
+		 * 							 place
+		 * @param dlen : The answer DLEN field
+		 * @param dataPayload : The answer payload, in the receive buffer
+		 * @param times : Receives the three timestamps
+		 * @return false if the answer does not match
+		 */
+		static bool decodePacketTimes(uint8_t dlen, const uint8_t* dataPayload,
+				PacketTimesStruct& times);
+
+			//No instance : decoding only
+		SpheroAnswerPacket() = delete;
+};
+
+#endif // SpheroAnswerPacket_H
+
@@ -7,67 +7,69 @@
 
 //-------------------------------------------------------- System includes
 #include <iostream>
-#include <sys/socket.h>
-#include <fcntl.h>
 
 //--------------------------------------------------------- Local includes
 #include "SpheroAsyncPacket.hpp"
 #include "async/SpheroCollisionPacket.hpp"
-#include "async/SpheroSimpleStreamingPacket.hpp"
+#include "async/SpheroStreamingPacket.hpp"
+#include "async/SpheroNotificationPacket.hpp"
+#include "PacketFramer.hpp"
+#include "../Sphero.hpp"
 
-//-------------------------------------------------------- Class variables
-extractorMap_t SpheroAsyncPacket::_extractorMap = {
-	{COLLISION_DETECTED, SpheroCollisionPacket::extractPacket},
-	{SENSOR_DATA_STREAMING, SpheroSimpleStreamingPacket::extractPacket}
-};
-
-//------------------------------------------------ Constructors/Destructor
+//-------------------------------------------------------- Private methods
 
 /**
- * @brief SpheroAsyncPacket : Constructor
- * @param sphero : The Sphero instance that receives the asynchronous answer packet
+ * @return The decoder of an ID code, NULL if the library has none
  */
-SpheroAsyncPacket::SpheroAsyncPacket(Sphero* sphero) : SpheroPacket(sphero)
-{}
-
-SpheroAsyncPacket::~SpheroAsyncPacket()
-{}
+constexpr packetExtractor SpheroAsyncPacket::extractorOf(uint8_t id)
+{
+	return id == COLLISION_DETECTED ? SpheroCollisionPacket::extractPacket
+		: id == SENSOR_DATA_STREAMING ? SpheroStreamingPacket::extractPacket
+		: id == POWER_NOTIFICATION_FLAG ? SpheroNotificationPacket::extractPowerState
+		: id == PRESLEEP_WARNING ? SpheroNotificationPacket::extractPreSleep
+		: id == SELF_LEVEL_RESULT ? SpheroNotificationPacket::extractSelfLevel
+		: NULL;
+}
 
+//-------------------------------------------------------- Class variables
+const extractorTable_t SpheroAsyncPacket::_extractorTable =
+	dispatch_table::build<packetExtractor, SpheroAsyncPacket::extractorOf>();
 
 //--------------------------------------------------------- Public methods
 
 /**
- * @brief extractPacket : extracts the packet from a socket
- * @param fd : The socket file descriptor
+ * @brief extractPacket : decodes a received asynchronous frame and reports
+ * 						  its content to the Sphero
+ * @param frame : The frame, starting at SOP1
+ * @param length : The frame length, checksum included
  * @param sphero : The Sphero sending the packet
- * @param packet_ptr : A pointer to a SpheroPacket pointer
- * @return true if the packet was successfully extracted from the socket, false otherwise
  *
- * Contract: the socket has to be in blocking read
+ * The payload is also given to the listeners registered with
+ * Sphero::onAsyncPacket for its ID code, after the library decoder.
+ *
+ * Contract: the frame has been validated by a PacketFramer
  */
-bool SpheroAsyncPacket::extractPacket(int fd, Sphero* sphero, SpheroPacket** packet_ptr)
+void SpheroAsyncPacket::extractPacket(const uint8_t* frame, size_t length,
+		Sphero* sphero)
 {
 
 #ifdef MAP
 	fprintf(stdout, "Asynchronous packet reception\n");
 #endif
-	uint8_t idCode;
-	int rcvVal = 0;
+	uint8_t id = frame[2];
+	packetExtractor extractor = _extractorTable[id];
 
-	rcvVal = recv(fd, &idCode, sizeof(idCode), MSG_PEEK);
-	if(rcvVal != sizeof(idCode))
+	if(extractor != NULL)
 	{
-		return false;
+		extractor(frame, length, sphero);
 	}
 
-	extractorMap_t::iterator mapIt = _extractorMap.find(idCode);
-	if(mapIt != _extractorMap.end())
+		//Payload without header nor checksum
+	bool listened = sphero->reportAsyncPacket(id, frame + FRAME_HEADER_SIZE,
+			length - FRAME_HEADER_SIZE - 1);
+
+	if(extractor == NULL && !listened)
 	{
-		return mapIt->second(fd, sphero, packet_ptr);
+		sphero->reportDroppedFrame();
 	}
-	recv(fd, &idCode, sizeof(idCode), 0);
-	return false;
 }
-
-
-
@@ -8,8 +8,6 @@
 
 //-------------------------------------------------------- System includes
 #include <iostream>
-#include <limits>
-#include <sys/socket.h>
 
 //--------------------------------------------------------- Local includes
 #include "../Sphero.hpp"
@@ -17,72 +15,42 @@
 #include "SpheroAsyncPacket.hpp"
 #include "SpheroAnswerPacket.hpp"
 
-//-------------------------------------------------------- Class variables
-extractorMap_t SpheroPacket::_extractorMap = {
-	{ASYNC_FLAG, SpheroAsyncPacket::extractPacket},
-	{ANSWER_FLAG, SpheroAnswerPacket::extractPacket}
-};
-
-
-//------------------------------------------------ Constructors/Destructor
+//-------------------------------------------------------- Private methods
 
 /**
- * @brief SpheroPacket::SpheroPacket
- * @param sphero : The Sphero instance that receives the packet
+ * @return The extractor of a SOP2 value, NULL if unknown
  */
-SpheroPacket::SpheroPacket(Sphero* sphero):_sphero(sphero)
-{}
-
+constexpr packetExtractor SpheroPacket::extractorOf(uint8_t sop2)
+{
+	return sop2 == ASYNC_FLAG ? SpheroAsyncPacket::extractPacket
+		: sop2 == ANSWER_FLAG ? SpheroAnswerPacket::extractPacket
+		: NULL;
+}
 
-SpheroPacket::~SpheroPacket ( )
-{}
+//-------------------------------------------------------- Class variables
+	//Constant-initialized : no map to build nor hash to compute
+const extractorTable_t SpheroPacket::_extractorTable =
+	dispatch_table::build<packetExtractor, SpheroPacket::extractorOf>();
 
 
 //--------------------------------------------------------- Public methods
 
 /**
- * @brief extractPacket : extracts informations from the file descriptor to build a well made packet
- * @param fd : The socket file descriptor
+ * @brief extractPacket : decodes a received frame and reports its content
+ * 						  to the Sphero
+ * @param frame : The frame, starting at SOP1
+ * @param length : The frame length, checksum included
  * @param sphero : The Sphero sending the packet
- * @param packet_ptr : A pointer to a SpheroPacket pointer
- * @return true if the packet was successfully extracted from the socket, false otherwise
  *
- * Contract: the socket has to be in blocking read
+ * Contract: the frame has been validated by a PacketFramer
  */
-bool SpheroPacket::extractPacket(int fd, Sphero* sphero, SpheroPacket** packet_ptr)
+void SpheroPacket::extractPacket(const uint8_t* frame, size_t length,
+		Sphero* sphero)
 {
-	uint8_t buf;
-	int rcvVal = 0;
+	packetExtractor extractor = _extractorTable[frame[1]];
 
-	for(;;)
+	if(extractor != NULL)
 	{
-		rcvVal = recv(fd, &buf, sizeof(buf), 0);
-
-			//Socket is closed
-		if(rcvVal != sizeof(buf))
-		{
-			return false;
-		}
-#ifdef MAP
-		fprintf(stdout, "%02x ", buf);
-#endif
-		if(buf == START_OF_PACKET_FLAG)
-		{
-			if(recv(fd, &buf, sizeof(buf), 0) != sizeof(buf))
-			{
-				return false;
-			}
-			extractorMap_t::iterator mapIt = _extractorMap.find(buf);
-
-			if(mapIt == _extractorMap.end())
-			{
-				return false;
-			}
-			else
-			{
-				return mapIt->second(fd, sphero, packet_ptr);
-			}
-		}
+		extractor(frame, length, sphero);
 	}
-
 }
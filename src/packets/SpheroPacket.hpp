@@ -9,9 +9,11 @@
 #define SPHEROPACKET_H
 
 //-------------------------------------------------------- System includes
-#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
 
 //--------------------------------------------------------- Local includes
+#include "DispatchTable.hpp"
 
 //-------------------------------------------------------------- Constants
 static uint8_t const START_OF_PACKET_FLAG = 0xFF;
@@ -22,59 +24,46 @@ static uint8_t const ANSWER_FLAG = 0xFF;
 class SpheroPacket;
 class Sphero;
 
-typedef bool (*packetExtractor)(int socketd, Sphero* sphero, SpheroPacket** packet_ptr);
-typedef std::unordered_map<uint8_t, packetExtractor> extractorMap_t;
-typedef std::pair<uint8_t, packetExtractor> extractorMapEntry_t;
+	/* Decodes a frame and reports its content to the Sphero */
+typedef void (*packetExtractor)(const uint8_t* frame, size_t length,
+		Sphero* sphero);
+	/* Extractor of each value of a routing byte, NULL if unknown */
+typedef dispatchTable<packetExtractor> extractorTable_t;
 
 
 //------------------------------------------------------- Class definition
+/*
+ * Received frames are decoded in place, in the receive buffer, and their
+ * content reported to the Sphero at once : no packet object is built.
+ */
 class SpheroPacket
 {
 	public:
-		//--------------------------------------------- Operators overload
-			//No sense
-		SpheroPacket& operator=(const SpheroPacket&) = delete;
-
-		//---------------------------------------- Constructors/Destructor
-			//No sense
-		SpheroPacket(const SpheroPacket&) = delete;
-
-		virtual ~SpheroPacket();
-
 		//------------------------------------------------ Public methods
 
 		/**
-		 * @brief extractPacket : extracts informations from the file descriptor 
-		 * 						  to build a well made packet
-		 * @param fd : The socket file descriptor
+		 * @brief extractPacket : decodes a received frame and reports its
+		 * 						  content to the Sphero
+		 * @param frame : The frame, starting at SOP1
+		 * @param length : The frame length, checksum included
 		 * @param sphero : The Sphero sending the packet
-		 * @param packet_ptr : A pointer to a SpheroPacket pointer
-		 * @return true if the packet was successfully extracted from the 
-		 * 		   socket, false otherwise
 		 *
-		 * Contract: the socket has to be in blocking read
+		 * Contract: the frame has been validated by a PacketFramer
 		 */
-		static bool extractPacket(int fd, Sphero* sphero, SpheroPacket** packet_ptr);
+		static void extractPacket(const uint8_t* frame, size_t length,
+				Sphero* sphero);
 
-		/**
-		 * @brief packetAction : Performs the action associated to the packet
-		 *			on the Sphero instance
-		 */
-		virtual void packetAction() = 0;
-
-	protected:
+			//No instance : decoding only
+		SpheroPacket() = delete;
 
+	private:
 		/**
-		 * @brief SpheroPacket::SpheroPacket
-		 * @param sphero : The Sphero instance that receives the packet
+		 * @return The extractor of a SOP2 value, NULL if unknown
 		 */
-		SpheroPacket(Sphero* sphero);
+		static constexpr packetExtractor extractorOf(uint8_t sop2);
 
-		//------------------------------------------ Protected attributes
-		Sphero* _sphero;
-
-	private:
-		static extractorMap_t _extractorMap;
+			/* Indexed by SOP2 */
+		static const extractorTable_t _extractorTable;
 };
 
 #endif // SPHEROPACKET_H
@@ -1,29 +1,45 @@
-/*************************************************************************
-	Toolbox  -  A bunch of useful functions for packet processin
-                             -------------------
-	started                : 28/04/2015
-*************************************************************************/
-
-//--------------------------------------------------------- Local includes
-#include "Toolbox.hpp"
-
-
-//-------------------------------------------------------------- Functions
-
-/**
- * @brief checksum : Computes a checksum
- * @param packet_data : The packet data on which checksum will be computed
- * @param len : Data array length
- */
-uint8_t packet_toolbox::checksum(uint8_t* packet_data, size_t len)
-{
-	uint8_t checksum = 0;
-
-	for(size_t i = 0 ; i < len ; checksum += packet_data[i++])
-	{ }
-
-		//Inverting result sum
-	checksum ^= 0xFF;
-
-	return checksum;
-}
+/*************************************************************************
+	Toolbox  -  A bunch of useful functions for packet processin
+                             -------------------
+	started                : 28/04/2015
+*************************************************************************/
+
+//-------------------------------------------------------- System includes
+#include <ctime>
+
+//--------------------------------------------------------- Local includes
+#include "Toolbox.hpp"
+
+
+//-------------------------------------------------------------- Functions
+
+/**
+ * @brief checksum : Computes a checksum
+ * @param packet_data : The packet data on which checksum will be computed
+ * @param len : Data array length
+ */
+uint8_t packet_toolbox::checksum(const uint8_t* packet_data, size_t len)
+{
+	uint8_t checksum = 0;
+
+	for(size_t i = 0 ; i < len ; checksum += packet_data[i++])
+	{ }
+
+		//Inverting result sum
+	checksum ^= 0xFF;
+
+	return checksum;
+}
+
+
+/**
+ * @brief monotonicUs : Reads the monotonic clock
+ * @return The current monotonic time, in microseconds
+ */
+uint64_t packet_toolbox::monotonicUs()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
@@ -1,15 +0,0 @@
-/*************************************************************************
-    AskedCommandCode  - liste de valeurs des commandes demandées 
-                             -------------------
-    début                : dim. 24 mai 2015
-*************************************************************************/
-
-#ifndef ASKEDCOMMANDCODE_H
-#define ASKEDCOMMANDCODE_H
-
-enum class pendingCommandType{
-	NONE, SIMPLE_RESPONSE, GETCOLOR, GETBTINFO
-};
-
-#endif // ASKEDCOMMANDCODE_H
-
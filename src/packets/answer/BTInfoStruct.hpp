@@ -9,9 +9,12 @@
 #define BTINFOSTRUCT_H
 
 //--------------------------------------------------- Interfaces utilisées
-#include <string>
+
 //------------------------------------------------------------- Constantes 
 
+	/* Size of the name and address fields of the answer */
+static unsigned int const BTINFO_FIELD_SIZE = 16;
+
 //------------------------------------------------------------------ Types 
 
 //------------------------------------------------------------------------ 
@@ -21,18 +24,17 @@ struct BTInfoStruct
 //----------------------------------------------------------------- PUBLIC
 	
 	/**
-	 * @field bt_name Ascii encoded bluetooth name
+	 * @field bt_name Ascii encoded bluetooth name, NUL terminated
 	 */
-	std::string bt_name;
+	char bt_name[BTINFO_FIELD_SIZE + 1];
 
 	/**
-	 * @field bt_adress Ascii encoded bluetooth adress
+	 * @field bt_adress Ascii encoded bluetooth adress, NUL terminated
 	 */
-	std::string bt_adress;
+	char bt_adress[BTINFO_FIELD_SIZE + 1];
 
 };
 
 //----------------------------------------- Types dépendants de <BTInfoStruct>
 
 #endif // BTINFOSTRUCT_H
-
@@ -1,6 +1,8 @@
 #ifndef COLORSTRUCT_HPP
 #define COLORSTRUCT_HPP
 
+#include <cstdint>
+
 struct ColorStruct
 {
 	uint8_t red;
@@ -0,0 +1,24 @@
+/*************************************************************************
+	PacketTimesStruct  -  Timestamps of a pollPacketTimes answer
+                             -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+#ifndef PACKETTIMESSTRUCT_HPP
+#define PACKETTIMESSTRUCT_HPP
+
+#include <cstdint>
+
+struct PacketTimesStruct
+{
+		/* Client time sent with the command, echoed (T1) */
+	uint32_t clientSent;
+
+		/* Sphero time when the command was received (T2), in ms */
+	uint32_t deviceReceived;
+
+		/* Sphero time when the answer was sent (T3), in ms */
+	uint32_t deviceSent;
+};
+
+#endif // PACKETTIMESSTRUCT_HPP
@@ -50,7 +50,13 @@ struct CollisionStruct
 	
 	uint8_t speed;
 	
+		/* Sphero clock at the impact, in ms */
 	uint32_t timestamp;
+
+		/* Host monotonic time of the impact, in µs (see
+		 * Sphero::startClockSync), or of the reception while the clock is
+		 * not synchronized */
+	uint64_t hostTimestampUs;
 };
 
 #endif // COLLISIONSTRUCT_HPP
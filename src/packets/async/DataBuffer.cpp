@@ -1,26 +1,52 @@
-
 #include <iostream>
-#include <deque>
-#include <unistd.h>
+#include <ctime>
+#include <cerrno>
 #include <pthread.h>
 #include <cstdint>
 
 using namespace std;
 
 #include "DataBuffer.h"
+#include "../Toolbox.hpp"
 
-DataBuffer::DataBuffer()
+/**
+ * @brief DataBuffer : Constructor
+ * @param depth : The number of values kept for each type, rounded
+ * 				  up to a power of two
+ */
+DataBuffer::DataBuffer(size_t depth):_depth(1), _nbWaiters(0)
 {
-	_dataValues = new uint16_t[27];
-	for(int i = 0; i < 27; ++i)
-		_dataValues[i] = 0;
+	while(_depth < depth)
+		_depth <<= 1;
+
+	for(size_t i = 0; i < NB_DATA_TYPES; ++i)
+	{
+		_rings[i].head = 0;
+		_rings[i].floor = 0;
+		_rings[i].slots = new slot_t[_depth];
+		for(size_t j = 0; j < _depth; ++j)
+		{
+			_rings[i].slots[j].tag = 0;
+			_rings[i].slots[j].data = 0;
+		}
+	}
+
+	pthread_condattr_t attr;
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&_newData, &attr);
+	pthread_condattr_destroy(&attr);
 
 	pthread_mutex_init(&lock, NULL);
 }
 
 DataBuffer::~DataBuffer()
 {
-	delete[] _dataValues;
+	for(size_t i = 0; i < NB_DATA_TYPES; ++i)
+		delete[] _rings[i].slots;
+
+	pthread_cond_destroy(&_newData);
+	pthread_mutex_destroy(&lock);
 }
 
 
@@ -28,32 +54,104 @@ DataBuffer::~DataBuffer()
  * @brief waitForNext : Waits for the next value in the list
  * @param valueType : The value type
  * @param returnValue : a reference to the variable in which will be placed the value
- * @param wait : the wait time (in µs) between each try. If -1, the function isn't blocking
- * @param timeout : The trying timeout time (in µs)
+ * @param wait : If -1, the function isn't blocking and gives the
+ * 				 latest value. Otherwise, waits for a value received
+ * 				 after the call
+ * @param timeout : The waiting timeout (in µs), 0 for none
  * @return true if the value has been found, false if the timeout came before
  */
 bool DataBuffer::waitForNext(dataTypes valueType, uint16_t &returnValue, int wait, int timeout)
 {
-	int remaining = timeout / wait + 1;
+	DataSample sample;
 
-	do
+	if(wait < 0)
 	{
-		pthread_mutex_lock(&lock);
-		returnValue = _dataValues[valueType];
+		if(getLast(valueType, &sample, 1) == 0)
+			return false;
 
-		pthread_mutex_unlock(&lock);
+		returnValue = sample.value;
 		return true;
-			
-		/*pthread_mutex_unlock(&lock);
+	}
 
-		if(wait < 0)
-			return false;
-		usleep(wait);
+	if(!waitForNext(valueType, sample, getLastSeq(valueType), timeout))
+		return false;
+
+	returnValue = sample.value;
+	return true;
+}
+
+
+/**
+ * @brief waitForNext : Waits for the value following a known one,
+ * 					   without losing any still kept
+ * @param valueType : The value type
+ * @param sample : Receives the oldest kept sample which sequence
+ * 				   number is greater than afterSeq
+ * @param afterSeq : Sequence number of the last sample read, 0 for
+ * 					 none
+ * @param timeout : The waiting timeout (in µs), 0 for none
+ * @return true if a sample has been found, false if the timeout came before
+ */
+bool DataBuffer::waitForNext(dataTypes valueType, DataSample& sample,
+		uint64_t afterSeq, int timeout)
+{
+	const ring_t& ring = _rings[valueType];
+	struct timespec deadline;
+
+	if(timeout > 0)
+	{
+		uint64_t end = packet_toolbox::monotonicUs() + timeout;
+		deadline.tv_sec = end / 1000000;
+		deadline.tv_nsec = (end % 1000000) * 1000;
+	}
+
+	for(;;)
+	{
+		uint64_t head = ring.head.load(memory_order_acquire);
+		if(head > afterSeq)
+		{
+				//Oldest sample still kept and not flushed
+			uint64_t seq = afterSeq + 1;
+			uint64_t floor = ring.floor.load(memory_order_relaxed);
+			if(seq <= floor)
+				seq = floor + 1;
+			if(head >= _depth && seq <= head - _depth)
+				seq = head - _depth + 1;
+
+			if(seq > head)
+			{
+					//Everything was flushed : waiting for a new one
+				afterSeq = head;
+			}
+			else if(read(ring, seq, sample))
+			{
+				return true;
+			}
+
+				//Overwritten while reading, or flushed : trying again
+			continue;
+		}
 
-		--remaining;*/
-	}while(remaining > 0);
+			//Nothing new : sleeping until notify()
+		_nbWaiters.fetch_add(1);
+		atomic_thread_fence(memory_order_seq_cst);
+
+		bool timedOut = false;
+		pthread_mutex_lock(&lock);
+		while(!timedOut && ring.head.load(memory_order_acquire) <= afterSeq)
+		{
+			if(timeout > 0)
+				timedOut = pthread_cond_timedwait(&_newData, &lock, &deadline) == ETIMEDOUT;
+			else
+				pthread_cond_wait(&_newData, &lock);
+		}
+		pthread_mutex_unlock(&lock);
 
-	return false;
+		_nbWaiters.fetch_sub(1);
+
+		if(timedOut && ring.head.load(memory_order_acquire) <= afterSeq)
+			return false;
+	}
 }
 
 
@@ -63,9 +161,8 @@ bool DataBuffer::waitForNext(dataTypes valueType, uint16_t &returnValue, int wai
  */
 void DataBuffer::flush(dataTypes valueType)
 {
-	pthread_mutex_lock(&lock);
-	_dataValues[valueType] = 0;
-	pthread_mutex_unlock(&lock);
+	ring_t& ring = _rings[valueType];
+	ring.floor.store(ring.head.load(memory_order_acquire), memory_order_relaxed);
 }
 
 
@@ -73,13 +170,146 @@ void DataBuffer::flush(dataTypes valueType)
  * @brief addValue : Adds a new value to the type queue
  * @param valueType : The type of the value
  * @param value : The new value
+ *
+ * Contract: called by a single thread
  */
 void DataBuffer::addValue(dataTypes valueType, uint16_t value)
 {
-	pthread_mutex_lock(&lock);
+	push(valueType, value, packet_toolbox::monotonicUs());
+	notify();
+}
 
-	_dataValues[valueType] = value;
 
-	pthread_mutex_unlock(&lock);
+/**
+ * @brief addFrame : Adds one value per field of a streaming frame
+ * @param fields : The type of each value
+ * @param values : The values
+ * @param nbFields : The number of values
+ * @param timestampUs : Monotonic reception time, in microseconds
+ *
+ * Contract: called by a single thread
+ */
+void DataBuffer::addFrame(const dataTypes* fields, const uint16_t* values,
+		size_t nbFields, uint64_t timestampUs)
+{
+	for(size_t i = 0 ; i < nbFields ; ++i)
+	{
+		push(fields[i], values[i], timestampUs);
+	}
+
+	notify();
 }
 
+
+/**
+ * @brief getLast : Copies the most recent values of a type, without
+ * 				   lock
+ * @param valueType : The value type
+ * @param samples : Receives the samples, oldest first
+ * @param nbSamples : The wanted number of samples
+ * @return The number of copied samples, at most getDepth()
+ */
+size_t DataBuffer::getLast(dataTypes valueType, DataSample* samples,
+		size_t nbSamples) const
+{
+	const ring_t& ring = _rings[valueType];
+
+	uint64_t head = ring.head.load(memory_order_acquire);
+	uint64_t floor = ring.floor.load(memory_order_relaxed);
+
+	if(nbSamples > _depth)
+		nbSamples = _depth;
+	if(nbSamples > head - floor)
+		nbSamples = head - floor;
+
+		//Samples overwritten while copying are dropped from the front
+	size_t nbRead = 0;
+	for(uint64_t seq = head - nbSamples + 1 ; seq <= head ; ++seq)
+	{
+		if(read(ring, seq, samples[nbRead]))
+			++nbRead;
+		else
+			nbRead = 0;
+	}
+
+	return nbRead;
+}
+
+
+/**
+ * @return The sequence number of the latest value of a type, 0 if
+ * 		   none was received
+ */
+uint64_t DataBuffer::getLastSeq(dataTypes valueType) const
+{
+	return _rings[valueType].head.load(memory_order_acquire);
+}
+
+
+/**
+ * @return The number of values kept for each type
+ */
+size_t DataBuffer::getDepth() const
+{
+	return _depth;
+}
+
+
+/**
+ * @brief push : Writes a sample, without waking the waiters
+ */
+void DataBuffer::push(dataTypes valueType, uint16_t value, uint64_t timestampUs)
+{
+	ring_t& ring = _rings[valueType];
+	uint64_t seq = ring.head.load(memory_order_relaxed) + 1;
+	slot_t& slot = ring.slots[(seq - 1) & (_depth - 1)];
+
+	slot.tag.store(2 * seq - 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+	slot.data.store(timestampUs << 16 | value, memory_order_relaxed);
+	slot.tag.store(2 * seq, memory_order_release);
+
+	ring.head.store(seq, memory_order_release);
+}
+
+
+/**
+ * @brief read : Reads the sample seq of a ring
+ * @return false if the sample was overwritten meanwhile
+ */
+bool DataBuffer::read(const ring_t& ring, uint64_t seq, DataSample& sample) const
+{
+	const slot_t& slot = ring.slots[(seq - 1) & (_depth - 1)];
+
+	if(slot.tag.load(memory_order_acquire) != 2 * seq)
+		return false;
+
+	uint64_t data = slot.data.load(memory_order_relaxed);
+	atomic_thread_fence(memory_order_acquire);
+
+	if(slot.tag.load(memory_order_relaxed) != 2 * seq)
+		return false;
+
+	sample.value = (uint16_t) data;
+	sample.timestampUs = data >> 16;
+	sample.seq = seq;
+	return true;
+}
+
+
+/**
+ * @brief notify : Wakes the waiters up, if any
+ */
+void DataBuffer::notify()
+{
+		//Pairs with the fence of waitForNext : either the waiter sees the
+		//new head, or this sees the waiter
+	atomic_thread_fence(memory_order_seq_cst);
+
+	if(_nbWaiters.load(memory_order_relaxed) != 0)
+	{
+		pthread_mutex_lock(&lock);
+		pthread_cond_broadcast(&_newData);
+		pthread_mutex_unlock(&lock);
+	}
+}
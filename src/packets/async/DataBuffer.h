@@ -9,8 +9,9 @@
 
 
 //-------------------------------------------------------- System includes
-#include <deque>
+#include <atomic>
 #include <cstdint>
+#include <cstddef>
 #include <pthread.h>
 
 using namespace std;
@@ -48,34 +49,89 @@ enum dataTypes
 	VELOCITY_Y
 };
 
+/*
+ * A received value
+ */
+struct DataSample
+{
+	uint16_t value;
+
+		/* Monotonic reception time, in microseconds */
+	uint64_t timestampUs;
+
+		/* Position in the type stream, starting at 1 */
+	uint64_t seq;
+};
+
+//-------------------------------------------------------------- Constants
+static size_t const NB_DATA_TYPES = VELOCITY_Y + 1;
+
+	//Default number of values kept for each type
+static size_t const DATA_BUFFER_DEPTH = 64;
+
 
 //------------------------------------------------------- Class definition
+/*
+ * One ring per type, written by a single thread (the reception thread) and
+ * read by any number of threads without lock : each slot carries the
+ * sequence number of its sample, checked before and after reading it, so
+ * a reader overtaken by the writer drops the sample instead of returning a
+ * torn one. Only waitForNext sleeps, on a condition variable the writer
+ * signals when someone waits.
+ */
 class DataBuffer
 {
 	public:
 
 		//---------------------------------------- Constructors/Destructor
-		DataBuffer();
+
+		/**
+		 * @brief DataBuffer : Constructor
+		 * @param depth : The number of values kept for each type, rounded
+		 * 				  up to a power of two
+		 */
+		DataBuffer(size_t depth = DATA_BUFFER_DEPTH);
 
 		virtual ~DataBuffer();
 
+			//No sense
+		DataBuffer(const DataBuffer&) = delete;
+		DataBuffer& operator=(const DataBuffer&) = delete;
+
 		//------------------------------------------------- Public methods
 
 		/**
 		 * @brief waitForNext : Waits for the next value in the list
 		 * @param valueType : The value type
 		 * @param returnValue : a reference to the variable in which will be placed the value
-		 * @param wait : the wait time (in µs) between each try. If -1, the function isn't blocking
-		 * @param timeout : The trying timeout time (in µs)
+		 * @param wait : If -1, the function isn't blocking and gives the
+		 * 				 latest value. Otherwise, waits for a value received
+		 * 				 after the call
+		 * @param timeout : The waiting timeout (in µs), 0 for none
 		 * @return true if the value has been found, false if the timeout came before
 		 */
 		bool waitForNext(dataTypes valueType, uint16_t& returnValue, int wait = -1, int timeout = 0);
 
 
+		/**
+		 * @brief waitForNext : Waits for the value following a known one,
+		 * 					   without losing any still kept
+		 * @param valueType : The value type
+		 * @param sample : Receives the oldest kept sample which sequence
+		 * 				   number is greater than afterSeq
+		 * @param afterSeq : Sequence number of the last sample read, 0 for
+		 * 					 none
+		 * @param timeout : The waiting timeout (in µs), 0 for none
+		 * @return true if a sample has been found, false if the timeout came before
+		 */
+		bool waitForNext(dataTypes valueType, DataSample& sample,
+				uint64_t afterSeq, int timeout = 0);
+
+
 		/**
 		 * @brief flush : Flushes the specified queue (can be used when
 		 * configuring locator, to avoid meaningless ... (fill with your
-		 * favorite word)) 
+		 * favorite word))
 		 * @param valueType
 		 */
 		void flush(dataTypes valueType);
@@ -85,14 +141,97 @@ class DataBuffer
 		 * @brief addValue : Adds a new value to the type queue
 		 * @param valueType : The type of the value
 		 * @param value : The new value
+		 *
+		 * Contract: called by a single thread
 		 */
 		void addValue(dataTypes valueType, uint16_t value);
 
+
+		/**
+		 * @brief addFrame : Adds one value per field of a streaming frame
+		 * @param fields : The type of each value
+		 * @param values : The values
+		 * @param nbFields : The number of values
+		 * @param timestampUs : Monotonic reception time, in microseconds
+		 *
+		 * Contract: called by a single thread
+		 */
+		void addFrame(const dataTypes* fields, const uint16_t* values,
+				size_t nbFields, uint64_t timestampUs);
+
+
+		/**
+		 * @brief getLast : Copies the most recent values of a type, without
+		 * 				   lock
+		 * @param valueType : The value type
+		 * @param samples : Receives the samples, oldest first
+		 * @param nbSamples : The wanted number of samples
+		 * @return The number of copied samples, at most getDepth()
+		 */
+		size_t getLast(dataTypes valueType, DataSample* samples,
+				size_t nbSamples) const;
+
+
+		/**
+		 * @return The sequence number of the latest value of a type, 0 if
+		 * 		   none was received
+		 */
+		uint64_t getLastSeq(dataTypes valueType) const;
+
+
+		/**
+		 * @return The number of values kept for each type
+		 */
+		size_t getDepth() const;
+
 	private:
-		pthread_mutex_t lock;
-		uint16_t *_dataValues;
+		//------------------------------------------------------------- Types
+		struct slot_t
+		{
+				/* 2 * seq while readable, odd while written */
+			atomic<uint64_t> tag;
+
+				/* timestamp << 16 | value */
+			atomic<uint64_t> data;
+		};
+
+		struct ring_t
+		{
+				/* Number of samples ever written */
+			atomic<uint64_t> head;
+
+				/* Samples up to this number were flushed */
+			atomic<uint64_t> floor;
 
+			slot_t* slots;
+		};
 
+		//--------------------------------------------------- Private methods
+
+		/**
+		 * @brief push : Writes a sample, without waking the waiters
+		 */
+		void push(dataTypes valueType, uint16_t value, uint64_t timestampUs);
+
+		/**
+		 * @brief read : Reads the sample seq of a ring
+		 * @return false if the sample was overwritten meanwhile
+		 */
+		bool read(const ring_t& ring, uint64_t seq, DataSample& sample) const;
+
+		/**
+		 * @brief notify : Wakes the waiters up, if any
+		 */
+		void notify();
+
+		//------------------------------------------------ Private attributes
+		ring_t _rings[NB_DATA_TYPES];
+		size_t _depth;
+
+			/* Only used to sleep in waitForNext */
+		pthread_mutex_t lock;
+		pthread_cond_t _newData;
+		atomic<size_t> _nbWaiters;
 };
 
 #endif // DATABUFFER_H
@@ -0,0 +1,15 @@
+/*************************************************************************
+	KinematicState  -  Latest position and speed of the Sphero, published
+					   by the reception thread and read without lock
+							 -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+//--------------------------------------------------------- Local includes
+#include "KinematicState.hpp"
+
+//------------------------------------------------ Constructors/Destructor
+
+KinematicState::KinematicState():_version(0), _motion(0), _speedTime(0),
+	_seq(0)
+{}
@@ -0,0 +1,154 @@
+/*************************************************************************
+	KinematicState  -  Latest position and speed of the Sphero, published
+					   by the reception thread and read without lock
+							 -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+#ifndef KINEMATICSTATE_HPP
+#define KINEMATICSTATE_HPP
+
+//-------------------------------------------------------- System includes
+#include <atomic>
+#include <cstdint>
+
+//------------------------------------------------------------------ Types
+
+/*
+ * Kinematic values of one streaming frame, always consistent together
+ */
+struct KinematicSnapshot
+{
+		/* Position (ODOMETER_X, ODOMETER_Y), in centimeters */
+	int16_t x;
+	int16_t y;
+
+		/* Velocity (VELOCITY_X, VELOCITY_Y) */
+	int16_t speedX;
+	int16_t speedY;
+
+		/* Speed norm (ACCELONE_0) */
+	uint16_t normalisedSpeed;
+
+		/* Monotonic reception time of the frame, in microseconds */
+	uint64_t timestampUs;
+
+		/* Number of frames published so far, 0 before the first one */
+	uint64_t seq;
+};
+
+//------------------------------------------------------- Class definition
+/*
+ * Seqlock : the writer makes the version odd while it updates the values,
+ * and a reader retries until it reads the same even version before and
+ * after copying them. Readers never write shared memory, so they do not
+ * slow each other nor the writer down.
+ */
+class KinematicState
+{
+	public:
+		//---------------------------------------- Constructors/Destructor
+		KinematicState();
+
+			//No sense
+		KinematicState(const KinematicState&) = delete;
+		KinematicState& operator=(const KinematicState&) = delete;
+
+		//------------------------------------------------- Public methods
+
+		/**
+		 * @brief publish : Replaces the snapshot
+		 * @param snapshot : The new values, which seq is ignored
+		 * @return The sequence number given to the snapshot
+		 *
+		 * Contract: called by a single thread
+		 */
+		uint64_t publish(const KinematicSnapshot& snapshot);
+
+		/**
+		 * @brief read : Copies the latest snapshot
+		 * @return A snapshot which values all come from the same publish()
+		 */
+		KinematicSnapshot read() const;
+
+	private:
+		//-------------------------------------------------- Private attributes
+		std::atomic<uint32_t> _version;
+
+			/* x, y, speedX, speedY, 16 bits each */
+		std::atomic<uint64_t> _motion;
+
+			/* timestampUs << 16 | normalisedSpeed */
+		std::atomic<uint64_t> _speedTime;
+
+		std::atomic<uint64_t> _seq;
+};
+
+//--------------------------------------------------------- Public methods
+	//Inline : read in the readers' loops
+
+/**
+ * @brief publish : Replaces the snapshot
+ * @param snapshot : The new values, which seq is ignored
+ * @return The sequence number given to the snapshot
+ *
+ * Contract: called by a single thread
+ */
+inline uint64_t KinematicState::publish(const KinematicSnapshot& snapshot)
+{
+	uint32_t version = _version.load(std::memory_order_relaxed);
+	uint64_t seq = _seq.load(std::memory_order_relaxed) + 1;
+
+	uint64_t motion = (uint64_t) (uint16_t) snapshot.x << 48
+		| (uint64_t) (uint16_t) snapshot.y << 32
+		| (uint64_t) (uint16_t) snapshot.speedX << 16
+		| (uint16_t) snapshot.speedY;
+
+	_version.store(version + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	_motion.store(motion, std::memory_order_relaxed);
+	_speedTime.store(snapshot.timestampUs << 16 | snapshot.normalisedSpeed,
+			std::memory_order_relaxed);
+	_seq.store(seq, std::memory_order_relaxed);
+
+	_version.store(version + 2, std::memory_order_release);
+
+	return seq;
+}
+
+
+/**
+ * @brief read : Copies the latest snapshot
+ * @return A snapshot which values all come from the same publish()
+ */
+inline KinematicSnapshot KinematicState::read() const
+{
+	uint32_t before, after;
+	uint64_t motion, speedTime, seq;
+
+	do
+	{
+		before = _version.load(std::memory_order_acquire);
+
+		motion = _motion.load(std::memory_order_relaxed);
+		speedTime = _speedTime.load(std::memory_order_relaxed);
+		seq = _seq.load(std::memory_order_relaxed);
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		after = _version.load(std::memory_order_relaxed);
+	}while(before != after || (before & 1));
+
+	KinematicSnapshot snapshot;
+	snapshot.x = (int16_t) (motion >> 48);
+	snapshot.y = (int16_t) (motion >> 32);
+	snapshot.speedX = (int16_t) (motion >> 16);
+	snapshot.speedY = (int16_t) motion;
+	snapshot.normalisedSpeed = (uint16_t) speedTime;
+	snapshot.timestampUs = speedTime >> 16;
+	snapshot.seq = seq;
+
+	return snapshot;
+}
+
+#endif // KINEMATICSTATE_HPP
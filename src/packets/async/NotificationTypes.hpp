@@ -0,0 +1,44 @@
+/*************************************************************************
+	NotificationTypes  -  Values carried by the power, pre-sleep and
+						  self-level asynchronous packets
+							 -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+#ifndef NOTIFICATIONTYPES_HPP
+#define NOTIFICATIONTYPES_HPP
+
+#include <cstdint>
+
+//------------------------------------------------------------------ Types
+
+/*
+ * Battery state, sent when it changes (and every 10 seconds) once enabled
+ * by setPowerNotification
+ */
+enum class powerState : uint8_t
+{
+	UNKNOWN = 0,
+	CHARGING = 1,
+	OK = 2,
+	LOW = 3,
+	CRITICAL = 4
+};
+
+/*
+ * Outcome of a self-level routine started by setSelfLevel
+ */
+enum class selfLevelResult : uint8_t
+{
+	UNKNOWN = 0,
+		/* The level was not reached before the timeout */
+	TIMED_OUT = 1,
+	SENSORS_ERROR = 2,
+		/* Disabled by the option flags */
+	DISABLED = 3,
+	ABORTED = 4,
+	CHARGER_NOT_FOUND = 5,
+	SUCCESS = 6
+};
+
+#endif // NOTIFICATIONTYPES_HPP
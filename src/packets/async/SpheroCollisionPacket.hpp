@@ -9,7 +9,6 @@
 
 //--------------------------------------------------------- Local includes
 #include "../SpheroAsyncPacket.hpp"
-struct CollisionStruct;
 
 
 //------------------------------------------------------- Class definition
@@ -19,48 +18,19 @@ class SpheroCollisionPacket : public SpheroAsyncPacket
 		//------------------------------------------------- Public methods
 
 		/**
-		 * @brief extractPacket : extracts the packet from a socket
-		 * @param fd : The socket file descriptor
+		 * @brief extractPacket : decodes a collision frame in place and
+		 * 						  reports the collision to the Sphero
+		 * @param frame : The frame, starting at SOP1
+		 * @param length : The frame length, checksum included
 		 * @param sphero : The Sphero sending the packet
-		 * @param packet_ptr : A pointer to a SpheroPacket pointer
-		 * @return true if the packet was successfully extracted from the 
-		 * 		   socket, false otherwise
 		 *
-		 * Contract: the socket has to be in blocking read
+		 * Contract: the frame has been validated by a PacketFramer
 		 */
-		static bool extractPacket(int fd, Sphero* sphero, SpheroPacket** packet_ptr);
+		static void extractPacket(const uint8_t* frame, size_t length,
+				Sphero* sphero);
 
-
-		/**
-		 * @brief packetAction : Performs the action associated to the packet
-		 *			on the Sphero instance
-		 */
-		virtual void packetAction();
-
-		//--------------------------------------------- Operators overload
-			//No sense
-		SpheroCollisionPacket& operator=(
-				const SpheroCollisionPacket& unSpheroCollisionPacket) = delete;
-
-
-		//---------------------------------------- Constructors/Destructor
-			//No sense
-		SpheroCollisionPacket(
-				const SpheroCollisionPacket& unSpheroCollisionPacket) = delete;
-
-
-		virtual ~SpheroCollisionPacket();
-
-
-	protected:
-
-		/**
-		 * @brief SpheroCollisionPacket : Constructor
-		 * @param sphero : The Sphero instance that sends the collision packet
-		 */
-		SpheroCollisionPacket(Sphero* sphero, CollisionStruct* collisionInfos);
-
-		CollisionStruct* _collisionInfos;
+			//No instance : decoding only
+		SpheroCollisionPacket() = delete;
 };
 
 #endif // SPHEROCOLLISIONPACKET_H
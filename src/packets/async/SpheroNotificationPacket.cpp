@@ -0,0 +1,79 @@
+/*************************************************************************
+   SpheroNotificationPacket  - Decoders of the one-byte asynchronous
+							   notifications : power state, pre-sleep
+							   warning and self-level result
+							 -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+//--------------------------------------------------------- Local includes
+#include "SpheroNotificationPacket.hpp"
+#include "NotificationTypes.hpp"
+#include "../PacketFramer.hpp"
+#include "../../Sphero.hpp"
+
+//-------------------------------------------------------------- Constants
+	//Header, one byte of data and the checksum
+static size_t const ONE_BYTE_PACKET_SIZE = FRAME_HEADER_SIZE + 2;
+
+//--------------------------------------------------------- Public methods
+
+/**
+ * @brief extractPowerState : extracts a power notification
+ * @param frame : The frame, starting at SOP1
+ * @param length : The frame length, checksum included
+ * @param sphero : The Sphero sending the packet
+ *
+ * Contract: the frame has been validated by a PacketFramer
+ */
+void SpheroNotificationPacket::extractPowerState(const uint8_t* frame,
+		size_t length, Sphero* sphero)
+{
+	uint8_t state = frame[FRAME_HEADER_SIZE];
+	if(length != ONE_BYTE_PACKET_SIZE || state > (uint8_t) powerState::CRITICAL)
+	{
+		sphero->reportDroppedFrame();
+		return;
+	}
+
+	sphero->reportPowerState((powerState) state);
+}
+
+
+/**
+ * @brief extractPreSleep : extracts a pre-sleep warning, sent 10 seconds
+ * 						   before the Sphero sleeps
+ * @param frame : The frame, starting at SOP1
+ * @param length : The frame length, checksum included
+ * @param sphero : The Sphero sending the packet
+ *
+ * Contract: the frame has been validated by a PacketFramer
+ */
+void SpheroNotificationPacket::extractPreSleep(const uint8_t*, size_t,
+		Sphero* sphero)
+{
+		//No data : the ID code is the whole message
+	sphero->reportPreSleep();
+}
+
+
+/**
+ * @brief extractSelfLevel : extracts a self-level result
+ * @param frame : The frame, starting at SOP1
+ * @param length : The frame length, checksum included
+ * @param sphero : The Sphero sending the packet
+ *
+ * Contract: the frame has been validated by a PacketFramer
+ */
+void SpheroNotificationPacket::extractSelfLevel(const uint8_t* frame,
+		size_t length, Sphero* sphero)
+{
+	uint8_t result = frame[FRAME_HEADER_SIZE];
+	if(length != ONE_BYTE_PACKET_SIZE || result > (uint8_t) selfLevelResult::SUCCESS)
+	{
+		sphero->reportDroppedFrame();
+		return;
+	}
+
+	sphero->reportSelfLevel((selfLevelResult) result);
+}
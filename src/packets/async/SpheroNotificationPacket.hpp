@@ -0,0 +1,63 @@
+/*************************************************************************
+   SpheroNotificationPacket  - Decoders of the one-byte asynchronous
+							   notifications : power state, pre-sleep
+							   warning and self-level result
+							 -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+#ifndef SPHERONOTIFICATIONPACKET_H
+#define SPHERONOTIFICATIONPACKET_H
+
+//--------------------------------------------------------- Local includes
+#include "../SpheroAsyncPacket.hpp"
+
+//------------------------------------------------------- Class definition
+/*
+ * Like collisions and streaming, notifications are reported to the Sphero
+ * during the extraction : no packet object is built.
+ */
+class SpheroNotificationPacket : public SpheroAsyncPacket
+{
+	public:
+		//------------------------------------------------- Public methods
+
+		/**
+		 * @brief extractPowerState : extracts a power notification
+		 * @param frame : The frame, starting at SOP1
+		 * @param length : The frame length, checksum included
+		 * @param sphero : The Sphero sending the packet
+		 *
+		 * Contract: the frame has been validated by a PacketFramer
+		 */
+		static void extractPowerState(const uint8_t* frame, size_t length,
+				Sphero* sphero);
+
+		/**
+		 * @brief extractPreSleep : extracts a pre-sleep warning, sent 10
+		 * 						   seconds before the Sphero sleeps
+		 * @param frame : The frame, starting at SOP1
+		 * @param length : The frame length, checksum included
+		 * @param sphero : The Sphero sending the packet
+		 *
+		 * Contract: the frame has been validated by a PacketFramer
+		 */
+		static void extractPreSleep(const uint8_t* frame, size_t length,
+				Sphero* sphero);
+
+		/**
+		 * @brief extractSelfLevel : extracts a self-level result
+		 * @param frame : The frame, starting at SOP1
+		 * @param length : The frame length, checksum included
+		 * @param sphero : The Sphero sending the packet
+		 *
+		 * Contract: the frame has been validated by a PacketFramer
+		 */
+		static void extractSelfLevel(const uint8_t* frame, size_t length,
+				Sphero* sphero);
+
+			//No instance : decoding only
+		SpheroNotificationPacket() = delete;
+};
+
+#endif // SPHERONOTIFICATIONPACKET_H
@@ -10,91 +10,88 @@
 //#endif
 
 #include <vector>
-#include <sys/socket.h>
-#include <endian.h>
 
 using namespace std;
 
 //--------------------------------------------------------- Local includes
 #include "SpheroStreamingPacket.hpp"
 #include "../../Sphero.hpp"
-#include "../Toolbox.hpp"
+#include "../PacketFramer.hpp"
 #include "../Constants.hpp"
+#include "../Toolbox.hpp"
 #include "DataBuffer.h"
-
-//------------------------------------------------ Constructors/Destructor
-
-/**
- * @brief SpheroStreamingPacket : Constructor
- * @param sphero : The Sphero instance that sends the collision packet
- */
-SpheroStreamingPacket::SpheroStreamingPacket(
-		Sphero* sphero):	SpheroAsyncPacket(sphero)
-{}
-
-
-SpheroStreamingPacket::~SpheroStreamingPacket ( )
-{
-#ifdef MAP
-	std::cout << "<SpheroStreamingPacket> destructor called" << std::endl;
-#endif
-}
-
+#include "StreamLayout.hpp"
 
 //--------------------------------------------------------- Public methods
 
 /**
- * @brief extractPacket : extracts the packet from a socket
- * @param fd : The socket file descriptor
+ * @brief extractPacket : decodes a data streaming frame in place, stores
+ * 						  its values and reports them
+ * @param frame : The frame, starting at SOP1
+ * @param length : The frame length, checksum included
  * @param sphero : The Sphero sending the packet
- * @param packet_ptr : A pointer to a SpheroPacket pointer
- * @return true if the packet was successfully extracted from the socket, false otherwise
  *
- * Contract: the socket has to be in blocking read
+ * Contract: the frame has been validated by a PacketFramer
  */
-bool SpheroStreamingPacket::extractPacket(int fd,  Sphero* sphero, SpheroPacket** packet_ptr)
+void SpheroStreamingPacket::extractPacket(const uint8_t* frame, size_t length,
+		Sphero* sphero)
 {
-	uint8_t data;
-	uint16_t len;
+	uint16_t len = (frame[3] << 8) | frame[4];
+	uint16_t values[STREAM_MAX_VALUES];
 
 	sphero->requestLock();
 
-	recv(fd, &data, sizeof(data), 0); // garbage?
-	recv(fd, &data, sizeof(data), 0); // len MSB
-		len = data << 8;
-
-	recv(fd, &data, sizeof(data), 0); // len LSB
-		len |= data;
-
-	if(!sphero->checkValid(len))
+	const StreamLayout& layout = sphero->getStreamLayout();
+	if(!layout.matches(len) || length != FRAME_HEADER_SIZE + len)
 	{
 		sphero->requestLock(false);
-		return false;
+		sphero->reportDroppedFrame();
+		return;
 	}
 
-	for(int i = 0; i < (len-1)/2; i++)
-	{
-		uint16_t value;
-		recv(fd, &data, sizeof(data), 0);
-		value = data << 8;
-		recv(fd, &data, sizeof(data), 0);
-		value |= data;
+	uint64_t receivedAt = packet_toolbox::monotonicUs();
+	size_t nbFrames = layout.decode(frame + FRAME_HEADER_SIZE, values);
+	size_t nbFields = layout.getNbFields();
 
-		sphero->getDataBuffer()->addValue(sphero->getTypesList()[i%sphero->getTypesList().size()], value);
-	}
+	int x = layout.getIndex(ODOMETER_X);
+	int y = layout.getIndex(ODOMETER_Y);
+	int speed = layout.getIndex(ACCELONE_0);
+	int speedX = layout.getIndex(VELOCITY_X);
+	int speedY = layout.getIndex(VELOCITY_Y);
+	bool kinematic = x != -1 || y != -1 || speed != -1 || speedX != -1
+		|| speedY != -1;
 
-	sphero->requestLock(false);
+		//Fields not streamed keep their previous value
+	KinematicSnapshot state = sphero->getKinematics();
+	state.timestampUs = receivedAt;
 
-	*packet_ptr = new SpheroStreamingPacket(sphero);
-	return true;
-}
+		//Every frame, oldest first
+	for(size_t i = 0 ; i < nbFrames ; ++i)
+	{
+		const uint16_t* frameValues = values + i * nbFields;
+
+		sphero->getDataBuffer()->addFrame(layout.getFields(), frameValues,
+				nbFields, receivedAt);
+
+		if(!kinematic)
+			continue;
+
+		if(x != -1)
+			state.x = (int16_t) frameValues[x];
+		if(y != -1)
+			state.y = (int16_t) frameValues[y];
+		if(speed != -1)
+			state.normalisedSpeed = frameValues[speed];
+		if(speedX != -1)
+			state.speedX = (int16_t) frameValues[speedX];
+		if(speedY != -1)
+			state.speedY = (int16_t) frameValues[speedY];
+
+		sphero->publishKinematics(state);
+	}
 
+	sphero->requestLock(false);
 
-/**
- * @brief packetAction : Performs the action associated to the packet
- *			on the Sphero instance
- */
-void SpheroStreamingPacket::packetAction()
-{
-	_sphero->reportData();
+		//Reported at once : no packet to allocate for each frame
+	sphero->reportData();
 }
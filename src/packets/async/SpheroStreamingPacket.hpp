@@ -22,47 +22,19 @@ class SpheroStreamingPacket : public SpheroAsyncPacket
 		//------------------------------------------------- Public methods
 
 		/**
-		 * @brief extractPacket : extracts the packet from a socket
-		 * @param fd : The socket file descriptor
+		 * @brief extractPacket : decodes a data streaming frame in place,
+		 * 						  stores its values and reports them
+		 * @param frame : The frame, starting at SOP1
+		 * @param length : The frame length, checksum included
 		 * @param sphero : The Sphero sending the packet
-		 * @param packet_ptr : A pointer to a SpheroPacket pointer
-		 * @return true if the packet was successfully extracted from the
-		 * 		   socket, false otherwise
 		 *
-		 * Contract: the socket has to be in blocking read
+		 * Contract: the frame has been validated by a PacketFramer
 		 */
-		static bool extractPacket(int fd, Sphero* sphero, SpheroPacket** packet_ptr);
+		static void extractPacket(const uint8_t* frame, size_t length,
+				Sphero* sphero);
 
-
-		/**
-		 * @brief packetAction : Performs the action associated to the packet
-		 *			on the Sphero instance
-		 */
-		virtual void packetAction();
-
-
-		//--------------------------------------------- Operators overload
-			//No sense
-		SpheroStreamingPacket& operator=(
-				const SpheroStreamingPacket& unSpheroStreamingPacket) = delete;
-
-
-		//---------------------------------------- Constructors/Destructor
-			//No sense
-		SpheroStreamingPacket(
-				const SpheroStreamingPacket& unSpheroStreamingPacket) = delete;
-
-
-		virtual ~SpheroStreamingPacket();
-
-
-	protected:
-
-		/**
-		 * @brief SpheroStreamingPacket : Constructor
-		 * @param sphero : The Sphero instance that sends the collision packet
-		 */
-		SpheroStreamingPacket(Sphero* sphero);
+			//No instance : decoding only
+		SpheroStreamingPacket() = delete;
 };
 
 #endif // SPHEROSTREAMINGPACKET_H
@@ -0,0 +1,163 @@
+/*************************************************************************
+	StreamLayout  -  Field table of the data streaming packets, computed
+					 from the streaming masks
+							 -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+//--------------------------------------------------------- Local includes
+#include "StreamLayout.hpp"
+#include "../Constants.hpp"
+
+//------------------------------------------------------------------ Types
+
+namespace
+{
+	struct maskBit_t
+	{
+		bool second;
+		uint32_t bit;
+		dataTypes type;
+	};
+
+		//In wire order
+	maskBit_t const MASK_BITS[NB_DATA_TYPES] = {
+		{false, mask::RAW_ACCEL_X, RAW_ACCEL_X},
+		{false, mask::RAW_ACCEL_Y, RAW_ACCEL_Y},
+		{false, mask::RAW_ACCEL_Z, RAW_ACCEL_Z},
+		{false, mask::RAW_GYRO_X, RAW_GYRO_X},
+		{false, mask::RAW_GYRO_Y, RAW_GYRO_Y},
+		{false, mask::RAW_GYRO_Z, RAW_GYRO_Z},
+		{false, mask::RAW_RIGHT_MOTOR_BACK_EMF, RAW_RIGHT_MOTOR_BACK_EMF},
+		{false, mask::RAW_LEFT_MOTOR_BACK_EMF, RAW_LEFT_MOTOR_BACK_EMF},
+		{false, mask::RAW_LEFT_MOTOR_PWM, RAW_LEFT_MOTOR_PWM},
+		{false, mask::RAW_RIGHT_MOTOR_PWM, RAW_RIGHT_MOTOR_PWM},
+		{false, mask::FILTERED_PITCH_IMU, FILTERED_PITCH_IMU},
+		{false, mask::FILTERED_ROLL_IMU, FILTERED_ROLL_IMU},
+		{false, mask::FILTERED_YAW_IMU, FILTERED_YAW_IMU},
+		{false, mask::FILTERED_ACCEL_X, FILTERED_ACCEL_X},
+		{false, mask::FILTERED_ACCEL_Y, FILTERED_ACCEL_Y},
+		{false, mask::FILTERED_ACCEL_Z, FILTERED_ACCEL_Z},
+		{false, mask::FILTERED_RIGHT_MOTOR_BACK_EMF, FILTERED_RIGHT_MOTOR_BACK_EMF},
+		{false, mask::FILTERED_LEFT_MOTOR_BACK_EMF, FILTERED_LEFT_MOTOR_BACK_EMF},
+		{true, mask2::QUATERNION_Q0, QUATERNION_Q0},
+		{true, mask2::QUATERNION_Q1, QUATERNION_Q1},
+		{true, mask2::QUATERNION_Q2, QUATERNION_Q2},
+		{true, mask2::QUATERNION_Q3, QUATERNION_Q3},
+		{true, mask2::ODOMETER_X, ODOMETER_X},
+		{true, mask2::ODOMETER_Y, ODOMETER_Y},
+		{true, mask2::ACCELONE_0, ACCELONE_0},
+		{true, mask2::VELOCITY_X, VELOCITY_X},
+		{true, mask2::VELOCITY_Y, VELOCITY_Y}
+	};
+}
+
+//------------------------------------------------ Constructors/Destructor
+
+StreamLayout::StreamLayout():_nbFields(0), _nbFrames(0)
+{
+	for(size_t i = 0 ; i < NB_DATA_TYPES ; ++i)
+	{
+		_index[i] = -1;
+	}
+}
+
+//--------------------------------------------------------- Public methods
+
+/**
+ * @brief configure : Builds the field table
+ * @param nbFrames : The number of frames per packet
+ * @param mask : The data mask (see constants mask::*)
+ * @param mask2 : The data second mask (see constants mask2::*)
+ */
+void StreamLayout::configure(uint16_t nbFrames, uint32_t mask, uint32_t mask2)
+{
+	_nbFrames = nbFrames;
+	_nbFields = 0;
+
+	for(size_t i = 0 ; i < NB_DATA_TYPES ; ++i)
+	{
+		const maskBit_t& field = MASK_BITS[i];
+		_index[field.type] = -1;
+
+		if((field.second ? mask2 : mask) & field.bit)
+		{
+			_index[field.type] = _nbFields;
+			_fields[_nbFields++] = field.type;
+		}
+	}
+}
+
+
+/**
+ * @brief matches : Checks a packet length against the table
+ * @param dlen : The DLEN field of the packet, checksum included
+ * @return true if the packet holds nbFrames whole frames
+ */
+bool StreamLayout::matches(size_t dlen) const
+{
+	return _nbFields != 0 && dlen == _nbFrames * _nbFields * 2 + 1
+		&& dlen - 1 <= STREAM_MAX_VALUES * 2;
+}
+
+
+/**
+ * @brief decode : Converts every value of a packet, all frames at once
+ * @param payload : The packet data, after DLEN
+ * @param values : Receives getNbFrames() * getNbFields() values,
+ * 				   frame after frame
+ * @return The number of decoded frames
+ *
+ * Contract: matches() accepted the packet
+ */
+size_t StreamLayout::decode(const uint8_t* payload, uint16_t* values) const
+{
+	size_t nbValues = _nbFrames * _nbFields;
+
+		//Frames are back to back : one flat loop, without dependency
+		//between iterations, that the compiler vectorizes
+	for(size_t i = 0 ; i < nbValues ; ++i)
+	{
+		values[i] = (uint16_t) ((payload[2 * i] << 8) | payload[2 * i + 1]);
+	}
+
+	return _nbFrames;
+}
+
+
+/**
+ * @return The fields of a frame, in order
+ */
+const dataTypes* StreamLayout::getFields() const
+{
+	return _fields;
+}
+
+
+/**
+ * @return The number of fields of a frame
+ */
+size_t StreamLayout::getNbFields() const
+{
+	return _nbFields;
+}
+
+
+/**
+ * @return The number of frames of a packet
+ */
+size_t StreamLayout::getNbFrames() const
+{
+	return _nbFrames;
+}
+
+
+/**
+ * @brief getIndex : Position of a field in the frames
+ * @param type : The field
+ * @return The field index in a frame, -1 if not streamed
+ */
+int StreamLayout::getIndex(dataTypes type) const
+{
+	return _index[type];
+}
@@ -0,0 +1,93 @@
+/*************************************************************************
+	StreamLayout  -  Field table of the data streaming packets, computed
+					 from the streaming masks
+							 -------------------
+	started                : 17/10/2026
+*************************************************************************/
+
+#ifndef STREAMLAYOUT_HPP
+#define STREAMLAYOUT_HPP
+
+//-------------------------------------------------------- System includes
+#include <cstdint>
+#include <cstddef>
+
+//--------------------------------------------------------- Local includes
+#include "DataBuffer.h"
+#include "../PacketFramer.hpp"
+
+//-------------------------------------------------------------- Constants
+	//Most 16 bits values a streaming frame fitting in the framer can hold
+static size_t const STREAM_MAX_VALUES = FRAMER_BUFFER_SIZE / 2;
+
+//------------------------------------------------------- Class definition
+/*
+ * Sphero sends the selected fields of each frame in the mask bits order,
+ * most significant bit of mask first, then mask2, each field being a big
+ * endian 16 bits value. A packet holds nbFrames such frames back to back.
+ */
+class StreamLayout
+{
+	public:
+		//---------------------------------------- Constructors/Destructor
+		StreamLayout();
+
+		//------------------------------------------------- Public methods
+
+		/**
+		 * @brief configure : Builds the field table
+		 * @param nbFrames : The number of frames per packet
+		 * @param mask : The data mask (see constants mask::*)
+		 * @param mask2 : The data second mask (see constants mask2::*)
+		 */
+		void configure(uint16_t nbFrames, uint32_t mask, uint32_t mask2);
+
+		/**
+		 * @brief matches : Checks a packet length against the table
+		 * @param dlen : The DLEN field of the packet, checksum included
+		 * @return true if the packet holds nbFrames whole frames
+		 */
+		bool matches(size_t dlen) const;
+
+		/**
+		 * @brief decode : Converts every value of a packet, all frames at once
+		 * @param payload : The packet data, after DLEN
+		 * @param values : Receives getNbFrames() * getNbFields() values,
+		 * 				   frame after frame
+		 * @return The number of decoded frames
+		 *
+		 * Contract: matches() accepted the packet
+		 */
+		size_t decode(const uint8_t* payload, uint16_t* values) const;
+
+		/**
+		 * @return The fields of a frame, in order
+		 */
+		const dataTypes* getFields() const;
+
+		/**
+		 * @return The number of fields of a frame
+		 */
+		size_t getNbFields() const;
+
+		/**
+		 * @return The number of frames of a packet
+		 */
+		size_t getNbFrames() const;
+
+		/**
+		 * @brief getIndex : Position of a field in the frames
+		 * @param type : The field
+		 * @return The field index in a frame, -1 if not streamed
+		 */
+		int getIndex(dataTypes type) const;
+
+	private:
+		//-------------------------------------------------- Private attributes
+		dataTypes _fields[NB_DATA_TYPES];
+		int8_t _index[NB_DATA_TYPES];
+		size_t _nbFields;
+		size_t _nbFrames;
+};
+
+#endif // STREAMLAYOUT_HPP